@@ -0,0 +1,81 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "bench.h"
+#include "rotor/asio.hpp"
+#include <thread>
+
+using namespace bench;
+namespace asio = boost::asio;
+namespace ra = rotor::asio;
+
+namespace {
+
+using strand_t = asio::io_context::strand;
+using supervisor_ptr_t = r::intrusive_ptr_t<ra::supervisor_asio_t>;
+
+const auto timeout = r::pt::milliseconds{500};
+
+supervisor_ptr_t make_supervisor(ra::system_context_ptr_t &sys_ctx, asio::io_context &io_ctx) {
+    auto strand = std::make_shared<strand_t>(io_ctx);
+    return sys_ctx->create_supervisor<ra::supervisor_asio_t>().strand(strand).timeout(timeout).guard_context(true).finish();
+}
+
+template <typename Run>
+result_t ping_pong(std::size_t operations, supervisor_ptr_t &sup1, supervisor_ptr_t &sup2, Run &&run) {
+    auto ponger = sup2->create_actor<ponger_t>().timeout(timeout).finish();
+    auto pinger = sup1->create_actor<pinger_t>().timeout(timeout).finish();
+    pinger->ponger_addr = ponger->get_address();
+    pinger->pings_left = operations;
+    pinger->on_done = [s1 = sup1.get(), s2 = sup2.get()]() {
+        s1->shutdown();
+        s2->shutdown();
+    };
+    ponger->pinger_addr = pinger->get_address();
+
+    sup1->start();
+    sup2->start();
+    run();
+    return result_t{operations * 2, pinger->seconds, {}};
+}
+
+/* cross-strand: supervisors are on different strands of the same io_context, which is run by 2 threads */
+result_t cross_strand(std::size_t operations) {
+    asio::io_context io_ctx;
+    auto sys_ctx1 = ra::system_context_ptr_t{new ra::system_context_asio_t(io_ctx)};
+    auto sys_ctx2 = ra::system_context_ptr_t{new ra::system_context_asio_t(io_ctx)};
+    auto sup1 = make_supervisor(sys_ctx1, io_ctx);
+    auto sup2 = make_supervisor(sys_ctx2, io_ctx);
+    return ping_pong(operations, sup1, sup2, [&]() {
+        auto t1 = std::thread([&] { io_ctx.run(); });
+        auto t2 = std::thread([&] { io_ctx.run(); });
+        t1.join();
+        t2.join();
+    });
+}
+
+/* cross-thread: supervisors are on different io_contexts, each one is run by its own thread */
+result_t cross_thread(std::size_t operations) {
+    asio::io_context io_ctx1;
+    asio::io_context io_ctx2;
+    auto sys_ctx1 = ra::system_context_ptr_t{new ra::system_context_asio_t(io_ctx1)};
+    auto sys_ctx2 = ra::system_context_ptr_t{new ra::system_context_asio_t(io_ctx2)};
+    auto sup1 = make_supervisor(sys_ctx1, io_ctx1);
+    auto sup2 = make_supervisor(sys_ctx2, io_ctx2);
+    return ping_pong(operations, sup1, sup2, [&]() {
+        auto t1 = std::thread([&] { io_ctx1.run(); });
+        auto t2 = std::thread([&] { io_ctx2.run(); });
+        t1.join();
+        t2.join();
+    });
+}
+
+} // namespace
+
+void bench::register_asio(scenarios_t &scenarios) {
+    scenarios.emplace_back(scenario_t{"cross-strand-ping-pong", "asio", 100000, &cross_strand});
+    scenarios.emplace_back(scenario_t{"cross-thread-ping-pong", "asio", 100000, &cross_thread});
+}
@@ -0,0 +1,172 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+/* Runs the benchmark scenarios and prints the results as JSON, i.e.
+ *
+ *   rotor_bench [--filter substring] [--scale factor] [--repeat count] [--output file] [--list]
+ *
+ * The `--scale` multiplies the default amount of operations of each scenario;
+ * with `--repeat` each scenario is run several times and the median run is reported. */
+
+#include "bench.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+using namespace bench;
+
+double bench::percentile(const std::vector<double> &sorted, double p) noexcept {
+    if (sorted.empty()) {
+        return 0;
+    }
+    auto index = static_cast<std::size_t>(std::lround(p * static_cast<double>(sorted.size() - 1)));
+    return sorted[index];
+}
+
+namespace {
+
+struct options_t {
+    std::string filter;
+    std::string output;
+    double scale = 1.0;
+    std::size_t repeat = 1;
+    bool list = false;
+};
+
+std::string escape(const std::string &value) {
+    std::string r;
+    for (auto c : value) {
+        if (c == '"' || c == '\\') {
+            r += '\\';
+        }
+        r += c;
+    }
+    return r;
+}
+
+bool parse(int argc, char **argv, options_t &options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--list") {
+            options.list = true;
+        } else if (arg == "--filter" && has_value) {
+            options.filter = argv[++i];
+        } else if (arg == "--output" && has_value) {
+            options.output = argv[++i];
+        } else if (arg == "--scale" && has_value) {
+            options.scale = std::atof(argv[++i]);
+        } else if (arg == "--repeat" && has_value) {
+            options.repeat = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--filter substring] [--scale factor] [--repeat count] [--output file] [--list]\n";
+            return false;
+        }
+    }
+    return options.scale > 0;
+}
+
+void write_json(std::ostream &out, const options_t &options, const scenarios_t &scenarios,
+                const std::vector<std::vector<result_t>> &results) {
+    out << std::setprecision(10);
+    out << "{\n";
+    out << "  \"library\": \"rotor\",\n";
+    out << "  \"version\": \"" << ROTOR_BENCH_VERSION << "\",\n";
+    out << "  \"scale\": " << options.scale << ",\n";
+    out << "  \"repeat\": " << options.repeat << ",\n";
+    out << "  \"benchmarks\": [";
+    for (std::size_t i = 0; i < scenarios.size(); ++i) {
+        auto runs = results[i];
+        std::sort(runs.begin(), runs.end(), [](auto &a, auto &b) { return a.seconds < b.seconds; });
+        auto &median = runs[runs.size() / 2];
+        auto &s = scenarios[i];
+        auto ops_per_sec = median.seconds > 0 ? median.operations / median.seconds : 0;
+        out << (i ? ",\n" : "\n");
+        out << "    {\n";
+        out << "      \"name\": \"" << escape(s.name) << "\",\n";
+        out << "      \"backend\": \"" << escape(s.backend) << "\",\n";
+        out << "      \"operations\": " << median.operations << ",\n";
+        out << "      \"seconds\": " << median.seconds << ",\n";
+        out << "      \"ops_per_sec\": " << ops_per_sec << ",\n";
+        out << "      \"runs\": [";
+        for (std::size_t j = 0; j < results[i].size(); ++j) {
+            out << (j ? ", " : "") << results[i][j].seconds;
+        }
+        out << "],\n";
+        out << "      \"metrics\": {";
+        for (std::size_t j = 0; j < median.metrics.size(); ++j) {
+            auto &m = median.metrics[j];
+            out << (j ? ", " : "") << "\"" << escape(m.first) << "\": " << m.second;
+        }
+        out << "}\n";
+        out << "    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    options_t options;
+    if (!parse(argc, argv, options)) {
+        return 1;
+    }
+
+    scenarios_t all;
+    register_core(all);
+    register_serialization(all);
+#ifdef ROTOR_BENCH_ASIO
+    register_asio(all);
+#endif
+#ifdef ROTOR_BENCH_EV
+    register_ev(all);
+#endif
+#ifdef ROTOR_BENCH_THREAD
+    register_thread(all);
+#endif
+
+    scenarios_t scenarios;
+    for (auto &s : all) {
+        auto full_name = s.backend + "/" + s.name;
+        if (options.filter.empty() || full_name.find(options.filter) != std::string::npos) {
+            scenarios.emplace_back(s);
+        }
+    }
+
+    if (options.list) {
+        for (auto &s : scenarios) {
+            std::cout << s.backend << "/" << s.name << "\n";
+        }
+        return 0;
+    }
+
+    std::vector<std::vector<result_t>> results;
+    for (auto &s : scenarios) {
+        auto operations = static_cast<std::size_t>(std::max(1.0, s.operations * options.scale));
+        std::cerr << "running " << s.backend << "/" << s.name << " (" << operations << " ops)\n";
+        std::vector<result_t> runs;
+        for (std::size_t i = 0; i < options.repeat; ++i) {
+            runs.emplace_back(s.fn(operations));
+        }
+        results.emplace_back(std::move(runs));
+    }
+
+    if (options.output.empty()) {
+        write_json(std::cout, options, scenarios, results);
+    } else {
+        std::ofstream out(options.output);
+        if (!out) {
+            std::cerr << "cannot open " << options.output << "\n";
+            return 1;
+        }
+        write_json(out, options, scenarios, results);
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor.hpp"
+#include <chrono>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+namespace r = rotor;
+
+/** \brief the results of a single scenario run */
+struct result_t {
+    /** \brief amount of performed operations (messages, requests, spawns etc.) */
+    std::size_t operations = 0;
+
+    /** \brief wall-clock time of the run */
+    double seconds = 0;
+
+    /** \brief scenario-specific values, e.g. latency percentiles */
+    std::vector<std::pair<std::string, double>> metrics;
+};
+
+/** \brief runs scenario for the requested amount of operations */
+using scenario_fn_t = std::function<result_t(std::size_t operations)>;
+
+/** \brief named scenario with the default amount of operations */
+struct scenario_t {
+    std::string name;
+    std::string backend;
+    std::size_t operations;
+    scenario_fn_t fn;
+};
+
+using scenarios_t = std::vector<scenario_t>;
+
+using bench_clock_t = std::chrono::steady_clock;
+
+/** \brief seconds passed since `start` */
+inline double elapsed(bench_clock_t::time_point start) noexcept {
+    return std::chrono::duration<double>(bench_clock_t::now() - start).count();
+}
+
+/** \brief returns `p`-th (0..1) percentile of already sorted samples */
+double percentile(const std::vector<double> &sorted, double p) noexcept;
+
+void register_core(scenarios_t &scenarios);
+void register_serialization(scenarios_t &scenarios);
+#ifdef ROTOR_BENCH_ASIO
+void register_asio(scenarios_t &scenarios);
+#endif
+#ifdef ROTOR_BENCH_EV
+void register_ev(scenarios_t &scenarios);
+#endif
+#ifdef ROTOR_BENCH_THREAD
+void register_thread(scenarios_t &scenarios);
+#endif
+
+/** \brief loopless supervisor, i.e. messages are processed via `do_process()` by the caller */
+struct supervisor_loopless_t : public r::supervisor_t {
+    using r::supervisor_t::supervisor_t;
+
+    void start_timer(const r::pt::time_duration &, r::request_id_t) noexcept override {}
+    void cancel_timer(r::request_id_t) noexcept override {}
+    void start() noexcept override {}
+    void shutdown() noexcept override { do_shutdown(); }
+    void enqueue(r::message_ptr_t) noexcept override {}
+};
+
+struct ping_t {};
+struct pong_t {};
+
+/** \brief sends pings one by one and invokes `on_done` after the last pong
+ *
+ * The pinger is linked to the ponger, i.e. it starts only when the ponger
+ * is operational, even if it is in the different locality.
+ */
+struct pinger_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&pinger_t::on_pong); });
+        plugin.with_casted<r::plugin::link_client_plugin_t>([&](auto &p) { p.link(ponger_addr, true, [](auto &) {}); });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        started = bench_clock_t::now();
+        send_ping();
+    }
+
+    void on_pong(r::message_t<pong_t> &) noexcept { send_ping(); }
+
+    void send_ping() noexcept {
+        if (pings_left) {
+            send<ping_t>(ponger_addr);
+            --pings_left;
+        } else {
+            seconds = elapsed(started);
+            on_done();
+        }
+    }
+
+    r::address_ptr_t ponger_addr;
+    std::size_t pings_left = 0;
+    std::function<void()> on_done;
+    bench_clock_t::time_point started;
+    double seconds = 0;
+};
+
+/** \brief replies to each ping with pong */
+struct ponger_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&ponger_t::on_ping); });
+    }
+
+    void on_ping(r::message_t<ping_t> &) noexcept { send<pong_t>(pinger_addr); }
+
+    r::address_ptr_t pinger_addr;
+};
+
+} // namespace bench
@@ -0,0 +1,309 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+/* Backend-independent scenarios: everything happens in a single loopless
+ * supervisor, i.e. they measure the pure rotor overhead. */
+
+#include "bench.h"
+#include <algorithm>
+
+using namespace bench;
+
+namespace {
+
+const auto timeout = r::pt::milliseconds{500};
+
+struct sample_t {
+    std::size_t value;
+};
+struct ack_t {};
+struct cycle_t {};
+
+namespace payload {
+struct echo_res_t {
+    std::size_t value;
+};
+struct echo_req_t {
+    using response_t = echo_res_t;
+    std::size_t value;
+};
+} // namespace payload
+
+namespace message {
+using echo_req_t = r::request_traits_t<payload::echo_req_t>::request::message_t;
+using echo_res_t = r::request_traits_t<payload::echo_req_t>::response::message_t;
+} // namespace message
+
+r::intrusive_ptr_t<supervisor_loopless_t> make_supervisor(r::system_context_t &ctx) {
+    return ctx.create_supervisor<supervisor_loopless_t>().timeout(timeout).finish();
+}
+
+void finish(supervisor_loopless_t &sup) {
+    sup.do_shutdown();
+    sup.do_process();
+}
+
+/* local send: messages are sent in bursts, the sink acknowledges each burst */
+struct sink_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&sink_t::on_sample); });
+    }
+
+    void on_sample(r::message_t<sample_t> &) noexcept {
+        if (++received % burst == 0) {
+            send<ack_t>(source_addr);
+        }
+    }
+
+    r::address_ptr_t source_addr;
+    std::size_t burst = 0;
+    std::size_t received = 0;
+};
+
+struct source_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&source_t::on_ack); });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        started = bench_clock_t::now();
+        send_burst();
+    }
+
+    void on_ack(r::message_t<ack_t> &) noexcept { send_burst(); }
+
+    void send_burst() noexcept {
+        if (!left) {
+            seconds = elapsed(started);
+            return;
+        }
+        for (std::size_t i = 0; i < burst; ++i) {
+            send<sample_t>(sink_addr, i);
+        }
+        left -= burst;
+    }
+
+    r::address_ptr_t sink_addr;
+    std::size_t burst = 0;
+    std::size_t left = 0;
+    bench_clock_t::time_point started;
+    double seconds = 0;
+};
+
+result_t local_send(std::size_t operations) {
+    std::size_t burst = std::min<std::size_t>(operations, 1000);
+    operations = std::max<std::size_t>(operations / burst, 1) * burst;
+
+    r::system_context_t ctx;
+    auto sup = make_supervisor(ctx);
+    auto source = sup->create_actor<source_t>().timeout(timeout).finish();
+    auto sink = sup->create_actor<sink_t>().timeout(timeout).finish();
+    source->sink_addr = sink->get_address();
+    source->burst = burst;
+    source->left = operations;
+    sink->source_addr = source->get_address();
+    sink->burst = burst;
+
+    sup->do_process();
+    finish(*sup);
+    return result_t{sink->received, source->seconds, {}};
+}
+
+/* request/response: requests are sent one after another, each roundtrip is timed */
+struct server_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&server_t::on_request); });
+    }
+
+    void on_request(message::echo_req_t &req) noexcept { reply_to(req, req.payload.request_payload.value); }
+};
+
+struct client_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&client_t::on_response); });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        started = bench_clock_t::now();
+        send_request();
+    }
+
+    void on_response(message::echo_res_t &) noexcept {
+        samples.emplace_back(std::chrono::duration<double, std::nano>(bench_clock_t::now() - sent).count());
+        send_request();
+    }
+
+    void send_request() noexcept {
+        if (left) {
+            --left;
+            sent = bench_clock_t::now();
+            request<payload::echo_req_t>(server_addr, left).send(timeout);
+        } else {
+            seconds = elapsed(started);
+        }
+    }
+
+    r::address_ptr_t server_addr;
+    std::size_t left = 0;
+    std::vector<double> samples;
+    bench_clock_t::time_point started;
+    bench_clock_t::time_point sent;
+    double seconds = 0;
+};
+
+result_t request_response(std::size_t operations) {
+    r::system_context_t ctx;
+    auto sup = make_supervisor(ctx);
+    auto server = sup->create_actor<server_t>().timeout(timeout).finish();
+    auto client = sup->create_actor<client_t>().timeout(timeout).finish();
+    client->server_addr = server->get_address();
+    client->left = operations;
+    client->samples.reserve(operations);
+
+    sup->do_process();
+    finish(*sup);
+
+    auto &samples = client->samples;
+    std::sort(samples.begin(), samples.end());
+    return result_t{samples.size(),
+                    client->seconds,
+                    {
+                        {"p50_ns", percentile(samples, 0.50)},
+                        {"p90_ns", percentile(samples, 0.90)},
+                        {"p99_ns", percentile(samples, 0.99)},
+                        {"p999_ns", percentile(samples, 0.999)},
+                        {"max_ns", samples.empty() ? 0 : samples.back()},
+                    }};
+}
+
+/* subscription churn: the handler is subscribed and unsubscribed in turns */
+struct churner_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&churner_t::on_cycle); });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        started = bench_clock_t::now();
+        send<cycle_t>(address);
+    }
+
+    void on_cycle(r::message_t<cycle_t> &) noexcept {
+        if (info) {
+            lifetime->unsubscribe(info);
+            info.reset();
+            ++cycles;
+        } else if (cycles < total) {
+            info = subscribe(&churner_t::on_sample);
+        } else {
+            seconds = elapsed(started);
+            return;
+        }
+        send<cycle_t>(address);
+    }
+
+    void on_sample(r::message_t<sample_t> &) noexcept {}
+
+    std::size_t total = 0;
+    std::size_t cycles = 0;
+    r::subscription_info_ptr_t info;
+    bench_clock_t::time_point started;
+    double seconds = 0;
+};
+
+result_t subscription_churn(std::size_t operations) {
+    r::system_context_t ctx;
+    auto sup = make_supervisor(ctx);
+    auto churner = sup->create_actor<churner_t>().timeout(timeout).finish();
+    churner->total = operations;
+
+    sup->do_process();
+    finish(*sup);
+    return result_t{churner->cycles, churner->seconds, {}};
+}
+
+/* spawn/shutdown: an actor is created, started and shut down, one after another */
+struct dummy_actor_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+};
+
+result_t spawn_shutdown(std::size_t operations) {
+    r::system_context_t ctx;
+    auto sup = make_supervisor(ctx);
+    sup->do_process();
+
+    auto started = bench_clock_t::now();
+    for (std::size_t i = 0; i < operations; ++i) {
+        auto actor = sup->create_actor<dummy_actor_t>().timeout(timeout).finish();
+        sup->do_process();
+        actor->do_shutdown();
+        sup->do_process();
+    }
+    auto seconds = elapsed(started);
+
+    finish(*sup);
+    return result_t{operations, seconds, {}};
+}
+
+/* spawn rate: the workers are created one by one, each is initialized under its own timer */
+result_t spawn_each(std::size_t operations) {
+    r::system_context_t ctx;
+    auto sup = make_supervisor(ctx);
+    sup->do_process();
+
+    auto started = bench_clock_t::now();
+    for (std::size_t i = 0; i < operations; ++i) {
+        sup->create_actor<dummy_actor_t>().timeout(timeout).finish();
+    }
+    sup->do_process();
+    auto seconds = elapsed(started);
+
+    finish(*sup);
+    return result_t{operations, seconds, {}};
+}
+
+/* spawn rate: the workers are created as a group and initialized under the single shared timer */
+result_t spawn_bulk(std::size_t operations) {
+    r::system_context_t ctx;
+    auto sup = make_supervisor(ctx);
+    sup->do_process();
+
+    auto started = bench_clock_t::now();
+    sup->create_actor<dummy_actor_t>().timeout(timeout).finish(operations);
+    sup->do_process();
+    auto seconds = elapsed(started);
+
+    finish(*sup);
+    return result_t{operations, seconds, {}};
+}
+
+} // namespace
+
+void bench::register_core(scenarios_t &scenarios) {
+    scenarios.emplace_back(scenario_t{"local-send", "core", 2000000, &local_send});
+    scenarios.emplace_back(scenario_t{"request-response", "core", 200000, &request_response});
+    scenarios.emplace_back(scenario_t{"subscription-churn", "core", 100000, &subscription_churn});
+    scenarios.emplace_back(scenario_t{"spawn-shutdown", "core", 20000, &spawn_shutdown});
+    scenarios.emplace_back(scenario_t{"spawn-each", "core", 10000, &spawn_each});
+    scenarios.emplace_back(scenario_t{"spawn-bulk", "core", 10000, &spawn_bulk});
+}
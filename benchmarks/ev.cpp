@@ -0,0 +1,60 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "bench.h"
+#include "rotor/ev.hpp"
+#include <thread>
+
+using namespace bench;
+namespace rev = rotor::ev;
+
+namespace {
+
+using supervisor_ptr_t = r::intrusive_ptr_t<rev::supervisor_ev_t>;
+
+const auto timeout = r::pt::milliseconds{500};
+
+supervisor_ptr_t make_supervisor(rev::system_context_ptr_t &sys_ctx, struct ev_loop *loop) {
+    return sys_ctx->create_supervisor<rev::supervisor_ev_t>()
+        .loop(loop)
+        .loop_ownership(true)
+        .timeout(timeout)
+        .finish();
+}
+
+/* cross-thread: supervisors are on different ev loops, each one is run by its own thread */
+result_t cross_thread(std::size_t operations) {
+    auto sys_ctx1 = rev::system_context_ptr_t{new rev::system_context_ev_t()};
+    auto sys_ctx2 = rev::system_context_ptr_t{new rev::system_context_ev_t()};
+    auto *loop1 = ev_loop_new(0);
+    auto *loop2 = ev_loop_new(0);
+    auto sup1 = make_supervisor(sys_ctx1, loop1);
+    auto sup2 = make_supervisor(sys_ctx2, loop2);
+
+    auto ponger = sup2->create_actor<ponger_t>().timeout(timeout).finish();
+    auto pinger = sup1->create_actor<pinger_t>().timeout(timeout).finish();
+    pinger->ponger_addr = ponger->get_address();
+    pinger->pings_left = operations;
+    pinger->on_done = [s1 = sup1.get(), s2 = sup2.get()]() {
+        s1->shutdown();
+        s2->shutdown();
+    };
+    ponger->pinger_addr = pinger->get_address();
+
+    sup1->start();
+    sup2->start();
+    auto t1 = std::thread([loop1] { ev_run(loop1); });
+    auto t2 = std::thread([loop2] { ev_run(loop2); });
+    t1.join();
+    t2.join();
+    return result_t{operations * 2, pinger->seconds, {}};
+}
+
+} // namespace
+
+void bench::register_ev(scenarios_t &scenarios) {
+    scenarios.emplace_back(scenario_t{"cross-thread-ping-pong", "ev", 100000, &cross_thread});
+}
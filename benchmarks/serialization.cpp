@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+/* Serialization throughput: the mix of serializable rotor messages (see
+ * `serialization_registry_t::add_builtin`) is encoded into the single buffer
+ * and decoded back into messages. */
+
+#include "bench.h"
+#include <unordered_map>
+
+using namespace bench;
+
+namespace {
+
+const auto timeout = r::pt::milliseconds{500};
+
+struct addresses_t : r::address_codec_t {
+    std::uint64_t encode(const r::address_ptr_t &address) noexcept override {
+        auto it = ids.find(address.get());
+        return it != ids.end() ? it->second : 0;
+    }
+
+    r::address_ptr_t decode(std::uint64_t id) noexcept override {
+        return id && id <= addresses.size() ? addresses[id - 1] : r::address_ptr_t{};
+    }
+
+    void add(const r::address_ptr_t &address) {
+        addresses.emplace_back(address);
+        ids.emplace(address.get(), addresses.size());
+    }
+
+    std::vector<r::address_ptr_t> addresses;
+    std::unordered_map<const r::address_t *, std::uint64_t> ids;
+};
+
+struct fixture_t {
+    fixture_t() {
+        sup = ctx.create_supervisor<supervisor_loopless_t>().timeout(timeout).finish();
+        auto a1 = sup->make_address();
+        auto a2 = sup->make_address();
+        addresses.add(a1);
+        addresses.add(a2);
+        registry.add_builtin();
+
+        namespace p = r::payload;
+        using link_t = r::request_traits_t<p::link_request_t>::request::wrapped_t;
+        using registration_t = r::request_traits_t<p::registration_request_t>::request::wrapped_t;
+        using discovery_t = r::request_traits_t<p::discovery_request_t>::request::wrapped_t;
+        messages.emplace_back(r::make_message<p::shutdown_trigger_t>(a1, a2));
+        messages.emplace_back(r::make_message<link_t>(a1, r::request_id_t{1}, a2, a2, true));
+        messages.emplace_back(r::make_message<registration_t>(a1, r::request_id_t{2}, a2, a2, "service.name", a2));
+        messages.emplace_back(r::make_message<discovery_t>(a1, r::request_id_t{3}, a2, a2, "service.name"));
+        messages.emplace_back(r::make_message<p::discovery_cancel_t>(a1, a2, "service.name"));
+        messages.emplace_back(r::make_message<p::unlink_notify_t>(a1, a2));
+        messages.emplace_back(r::make_message<p::backpressure_t>(a1, a2, r::overflow_policy_t::reject));
+        messages.emplace_back(r::make_message<p::start_actor_t>(a1));
+    }
+
+    ~fixture_t() {
+        sup->do_shutdown();
+        sup->do_process();
+    }
+
+    /* encodes `operations` messages, returns the amount of encoded messages */
+    std::size_t encode(r::serialization_buffer_t &buffer, std::size_t operations) {
+        r::encoder_t encoder(buffer, &addresses);
+        std::size_t encoded = 0;
+        for (std::size_t i = 0; i < operations; ++i) {
+            encoded += registry.encode(encoder, *messages[i % messages.size()]) ? 1 : 0;
+        }
+        return encoded;
+    }
+
+    r::system_context_t ctx;
+    r::intrusive_ptr_t<supervisor_loopless_t> sup;
+    addresses_t addresses;
+    r::serialization_registry_t registry;
+    std::vector<r::message_ptr_t> messages;
+};
+
+result_t serialize_encode(std::size_t operations) {
+    fixture_t fixture;
+    r::serialization_buffer_t buffer;
+    // the buffer capacity is not measured
+    fixture.encode(buffer, operations);
+    buffer.clear();
+
+    auto started = bench_clock_t::now();
+    auto encoded = fixture.encode(buffer, operations);
+    auto seconds = elapsed(started);
+    auto bytes = static_cast<double>(buffer.size());
+    return result_t{encoded, seconds, {{"bytes_per_message", encoded ? bytes / encoded : 0}}};
+}
+
+result_t serialize_decode(std::size_t operations) {
+    fixture_t fixture;
+    r::serialization_buffer_t buffer;
+    fixture.encode(buffer, operations);
+    auto destination = fixture.addresses.addresses[0];
+
+    auto started = bench_clock_t::now();
+    r::decoder_t decoder(buffer.data(), buffer.size(), &fixture.addresses);
+    std::size_t decoded = 0;
+    while (decoder.remaining()) {
+        auto message = fixture.registry.decode(decoder, destination);
+        if (!message) {
+            break;
+        }
+        ++decoded;
+    }
+    auto seconds = elapsed(started);
+    auto bytes = static_cast<double>(buffer.size());
+    return result_t{decoded, seconds, {{"bytes_per_message", decoded ? bytes / decoded : 0}}};
+}
+
+} // namespace
+
+void bench::register_serialization(scenarios_t &scenarios) {
+    scenarios.emplace_back(scenario_t{"serialize-encode", "core", 2000000, &serialize_encode});
+    scenarios.emplace_back(scenario_t{"serialize-decode", "core", 2000000, &serialize_decode});
+}
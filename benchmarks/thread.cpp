@@ -0,0 +1,39 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "bench.h"
+#include "rotor/thread.hpp"
+
+using namespace bench;
+namespace rth = rotor::thread;
+
+namespace {
+
+/* cross-thread: pinger and ponger are in different supervisors (localities) of the 2 workers pool */
+result_t cross_thread(std::size_t operations) {
+    auto timeout = r::pt::milliseconds{500};
+    auto ctx = rth::system_context_ptr_t{new rth::system_context_thread_t(2)};
+    auto root = ctx->create_supervisor<rth::supervisor_thread_t>().timeout(timeout).finish();
+    auto sup1 = root->create_actor<rth::supervisor_thread_t>().timeout(timeout).finish();
+    auto sup2 = root->create_actor<rth::supervisor_thread_t>().timeout(timeout).finish();
+    auto ponger = sup2->create_actor<ponger_t>().timeout(timeout).finish();
+
+    auto pinger = sup1->create_actor<pinger_t>().timeout(timeout).finish();
+    pinger->ponger_addr = ponger->get_address();
+    pinger->pings_left = operations;
+    pinger->on_done = [sup = root.get()]() { sup->shutdown(); };
+    ponger->pinger_addr = pinger->get_address();
+
+    root->start();
+    ctx->run();
+    return result_t{operations * 2, pinger->seconds, {}};
+}
+
+} // namespace
+
+void bench::register_thread(scenarios_t &scenarios) {
+    scenarios.emplace_back(scenario_t{"cross-thread-ping-pong", "thread", 200000, &cross_thread});
+}
@@ -0,0 +1,160 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+/* Measures throughput of bursty cross-strand delivery: producer sends a
+ * burst of messages to the consumer on another thread, then waits for
+ * the acknowledgement of the whole burst. */
+
+#include "rotor.hpp"
+#include "rotor/asio.hpp"
+#include <boost/asio.hpp>
+#include <boost/lexical_cast.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace asio = boost::asio;
+namespace pt = boost::posix_time;
+namespace ra = rotor::asio;
+namespace r = rotor;
+
+struct sample_t {};
+struct ack_t {};
+
+struct producer_t : public r::actor_base_t {
+    using timepoint_t = std::chrono::time_point<std::chrono::high_resolution_clock>;
+
+    using r::actor_base_t::actor_base_t;
+
+    void set_consumer_addr(const r::address_ptr_t &addr) { consumer_addr = addr; }
+    void set_load(std::size_t bursts_, std::size_t burst_size_) {
+        bursts_left = bursts_count = bursts_;
+        burst_size = burst_size_;
+    }
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&producer_t::on_ack); });
+        plugin.with_casted<r::plugin::link_client_plugin_t>([&](auto &p) { p.link(consumer_addr, true); });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        start = std::chrono::high_resolution_clock::now();
+        do_send_burst();
+    }
+
+    void on_ack(r::message_t<ack_t> &) noexcept { do_send_burst(); }
+
+    void do_send_burst() noexcept {
+        if (bursts_left) {
+            --bursts_left;
+            for (std::size_t i = 0; i < burst_size; ++i) {
+                send<sample_t>(consumer_addr);
+            }
+        } else {
+            using namespace std::chrono;
+            auto end = high_resolution_clock::now();
+            std::chrono::duration<double> diff = end - start;
+            double freq = ((double)bursts_count * burst_size) / diff.count();
+            std::cout << "bursts: " << bursts_count << " x " << burst_size << " in " << diff.count() << "s"
+                      << ", freq = " << std::fixed << std::setprecision(10) << freq << "\n";
+            do_shutdown();
+        }
+    }
+
+    void shutdown_finish() noexcept override {
+        r::actor_base_t::shutdown_finish();
+        supervisor->shutdown();
+        consumer_addr->supervisor.shutdown();
+    }
+
+    std::size_t bursts_left = 0;
+
+  private:
+    timepoint_t start;
+    std::size_t bursts_count = 0;
+    std::size_t burst_size = 0;
+    r::address_ptr_t consumer_addr;
+};
+
+struct consumer_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void set_producer_addr(const r::address_ptr_t &addr) { producer_addr = addr; }
+    void set_burst_size(std::size_t value) { burst_size = value; }
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&consumer_t::on_sample); });
+    }
+
+    void on_sample(r::message_t<sample_t> &) noexcept {
+        if (++received == burst_size) {
+            received = 0;
+            send<ack_t>(producer_addr);
+        }
+    }
+
+  private:
+    std::size_t burst_size = 0;
+    std::size_t received = 0;
+    r::address_ptr_t producer_addr;
+};
+
+int main(int argc, char **argv) {
+    asio::io_context io_ctx1;
+    asio::io_context io_ctx2;
+    try {
+        std::size_t bursts = 1000;
+        std::size_t burst_size = 100;
+        if (argc > 1) {
+            boost::conversion::try_lexical_convert(argv[1], bursts);
+        }
+        if (argc > 2) {
+            boost::conversion::try_lexical_convert(argv[2], burst_size);
+        }
+
+        auto sys_ctx1 = ra::system_context_asio_t::ptr_t{new ra::system_context_asio_t(io_ctx1)};
+        auto sys_ctx2 = ra::system_context_asio_t::ptr_t{new ra::system_context_asio_t(io_ctx2)};
+        auto strand1 = std::make_shared<asio::io_context::strand>(io_ctx1);
+        auto strand2 = std::make_shared<asio::io_context::strand>(io_ctx2);
+        auto timeout = boost::posix_time::milliseconds{100};
+        auto sup1 = sys_ctx1->create_supervisor<ra::supervisor_asio_t>()
+                        .strand(strand1)
+                        .timeout(timeout)
+                        .guard_context(true)
+                        .finish();
+        auto sup2 = sys_ctx2->create_supervisor<ra::supervisor_asio_t>()
+                        .strand(strand2)
+                        .timeout(timeout)
+                        .guard_context(true)
+                        .finish();
+
+        auto consumer = sup2->create_actor<consumer_t>().timeout(timeout).finish();
+        auto producer = sup1->create_actor<producer_t>().timeout(timeout).finish();
+        producer->set_load(bursts, burst_size);
+        producer->set_consumer_addr(consumer->get_address());
+        consumer->set_producer_addr(producer->get_address());
+        consumer->set_burst_size(burst_size);
+
+        sup1->start();
+        sup2->start();
+
+        auto t1 = std::thread([&] { io_ctx1.run(); });
+        auto t2 = std::thread([&] { io_ctx2.run(); });
+        t1.join();
+        t2.join();
+
+        std::cout << "bursts left: " << producer->bursts_left << "\n";
+    } catch (const std::exception &ex) {
+        std::cout << "exception : " << ex.what();
+    }
+
+    std::cout << "exiting...\n";
+    return 0;
+}
@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+/* Measures request-response throughput, when every request timeout is
+ * guarded by its own asio timer (default) and by the supervisor timer wheel. */
+
+#include "rotor.hpp"
+#include "rotor/asio.hpp"
+#include <boost/asio.hpp>
+#include <boost/lexical_cast.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace asio = boost::asio;
+namespace pt = boost::posix_time;
+namespace ra = rotor::asio;
+namespace r = rotor;
+
+struct pong_t {};
+
+struct ping_t {
+    using response_t = pong_t;
+};
+
+namespace message {
+using ping_t = r::request_traits_t<::ping_t>::request::message_t;
+using pong_t = r::request_traits_t<::ping_t>::response::message_t;
+} // namespace message
+
+struct pinger_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void set_ponger_addr(const r::address_ptr_t &addr) { ponger_addr = addr; }
+    void set_pings(std::size_t pings) { pings_left = pings; }
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&pinger_t::on_pong); });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        do_send_ping();
+    }
+
+    void on_pong(message::pong_t &msg) noexcept {
+        if (msg.payload.ec) {
+            std::cout << "pong error: " << msg.payload.ec.message() << "\n";
+            pings_left = 0;
+        }
+        do_send_ping();
+    }
+
+    void do_send_ping() noexcept {
+        if (pings_left) {
+            --pings_left;
+            request<ping_t>(ponger_addr).send(pt::seconds{1});
+        } else {
+            supervisor->do_shutdown();
+        }
+    }
+
+    std::size_t pings_left = 0;
+    r::address_ptr_t ponger_addr;
+};
+
+struct ponger_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&ponger_t::on_ping); });
+    }
+
+    void on_ping(message::ping_t &req) noexcept { reply_to(req); }
+};
+
+static double measure(std::size_t count, const pt::time_duration &resolution) {
+    asio::io_context io_context{1};
+    auto system_context = ra::system_context_asio_t::ptr_t{new ra::system_context_asio_t(io_context)};
+    auto strand = std::make_shared<asio::io_context::strand>(io_context);
+    auto timeout = pt::milliseconds{100};
+    auto sup = system_context->create_supervisor<ra::supervisor_asio_t>()
+                   .strand(strand)
+                   .timeout(timeout)
+                   .timer_resolution(resolution)
+                   .finish();
+
+    auto pinger = sup->create_actor<pinger_t>().timeout(timeout).finish();
+    auto ponger = sup->create_actor<ponger_t>().timeout(timeout).finish();
+    pinger->set_pings(count);
+    pinger->set_ponger_addr(ponger->get_address());
+
+    auto start = std::chrono::high_resolution_clock::now();
+    sup->start();
+    io_context.run();
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> diff = end - start;
+    return count / diff.count();
+}
+
+int main(int argc, char **argv) {
+    std::size_t count = 100000;
+    if (argc > 1) {
+        boost::conversion::try_lexical_convert(argv[1], count);
+    }
+
+    try {
+        auto timers = measure(count, pt::time_duration{});
+        auto wheel = measure(count, pt::milliseconds{1});
+        std::cout << std::fixed << std::setprecision(2) << "requests/sec, asio timers: " << timers
+                  << ", timer wheel: " << wheel << ", ratio: " << wheel / timers << "\n";
+    } catch (const std::exception &ex) {
+        std::cout << "exception : " << ex.what();
+    }
+    return 0;
+}
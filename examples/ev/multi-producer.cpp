@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+/* Measures throughput of cross-thread delivery into a single ev loop: a few
+ * producer threads enqueue messages to the consumer actor concurrently. */
+
+#include <rotor/ev.hpp>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+struct sample_t {
+    std::size_t value;
+};
+
+struct consumer_t : public rotor::actor_base_t {
+    using timepoint_t = std::chrono::time_point<std::chrono::high_resolution_clock>;
+
+    using rotor::actor_base_t::actor_base_t;
+
+    void set_load(std::size_t producers_, std::size_t messages_) {
+        producers = producers_;
+        messages = messages_;
+    }
+
+    void configure(rotor::plugin::plugin_base_t &plugin) noexcept override {
+        rotor::actor_base_t::configure(plugin);
+        plugin.with_casted<rotor::plugin::starter_plugin_t>(
+            [](auto &p) { p.subscribe_actor(&consumer_t::on_sample); });
+    }
+
+    void on_start() noexcept override {
+        rotor::actor_base_t::on_start();
+        std::cout << "producers: " << producers << ", messages per producer: " << messages << "\n";
+        start = std::chrono::high_resolution_clock::now();
+        for (std::size_t i = 0; i < producers; ++i) {
+            threads.emplace_back([addr = address, count = messages]() {
+                auto &sup = addr->supervisor;
+                for (std::size_t j = 0; j < count; ++j) {
+                    sup.enqueue(rotor::make_message<sample_t>(addr, j));
+                }
+            });
+        }
+    }
+
+    void on_sample(rotor::message_t<sample_t> &) noexcept {
+        if (++received == producers * messages) {
+            using namespace std::chrono;
+            auto end = high_resolution_clock::now();
+            std::chrono::duration<double> diff = end - start;
+            double freq = ((double)received) / diff.count();
+            std::cout << "received " << received << " in " << diff.count() << "s"
+                      << ", freq = " << std::fixed << std::setprecision(10) << freq << "\n";
+            for (auto &t : threads) {
+                t.join();
+            }
+            supervisor->shutdown();
+        }
+    }
+
+  private:
+    timepoint_t start;
+    std::size_t producers = 0;
+    std::size_t messages = 0;
+    std::size_t received = 0;
+    std::vector<std::thread> threads;
+};
+
+int main(int argc, char **argv) {
+    try {
+        std::size_t producers = 4;
+        std::size_t count = 100000;
+        if (argc > 1) {
+            producers = static_cast<std::size_t>(std::atoi(argv[1]));
+        }
+        if (argc > 2) {
+            count = static_cast<std::size_t>(std::atoi(argv[2]));
+        }
+
+        auto *loop = ev_loop_new(0);
+        auto system_context = rotor::ev::system_context_ptr_t{new rotor::ev::system_context_ev_t()};
+        auto timeout = boost::posix_time::milliseconds{10};
+        auto sup = system_context->create_supervisor<rotor::ev::supervisor_ev_t>()
+                       .loop(loop)
+                       .loop_ownership(true) /* let supervisor takes ownership on the loop */
+                       .timeout(timeout)
+                       .finish();
+
+        auto consumer = sup->create_actor<consumer_t>().timeout(timeout).finish();
+        consumer->set_load(producers, count);
+
+        sup->start();
+        ev_run(loop);
+    } catch (const std::exception &ex) {
+        std::cout << "exception : " << ex.what();
+    }
+
+    std::cout << "exiting...\n";
+    return 0;
+}
@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+/* Measures local ping-pong throughput with message pool enabled (default)
+ * and disabled (i.e. every message goes via global heap). */
+
+#include "rotor.hpp"
+#include <boost/lexical_cast.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+struct ping_t {};
+struct pong_t {};
+
+struct pinger_t : public rotor::actor_base_t {
+    using rotor::actor_base_t::actor_base_t;
+
+    void set_ponger_addr(const rotor::address_ptr_t &addr) { ponger_addr = addr; }
+    void set_pings(std::size_t pings) { pings_left = pings; }
+
+    void configure(rotor::plugin::plugin_base_t &plugin) noexcept override {
+        rotor::actor_base_t::configure(plugin);
+        plugin.with_casted<rotor::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&pinger_t::on_pong); });
+    }
+
+    void on_start() noexcept override {
+        rotor::actor_base_t::on_start();
+        do_send_ping();
+    }
+
+    void on_pong(rotor::message_t<pong_t> &) noexcept { do_send_ping(); }
+
+    void do_send_ping() noexcept {
+        if (pings_left) {
+            --pings_left;
+            send<ping_t>(ponger_addr);
+        } else {
+            supervisor->do_shutdown();
+        }
+    }
+
+    std::size_t pings_left = 0;
+    rotor::address_ptr_t ponger_addr;
+};
+
+struct ponger_t : public rotor::actor_base_t {
+    using rotor::actor_base_t::actor_base_t;
+    void set_pinger_addr(const rotor::address_ptr_t &addr) { pinger_addr = addr; }
+
+    void configure(rotor::plugin::plugin_base_t &plugin) noexcept override {
+        rotor::actor_base_t::configure(plugin);
+        plugin.with_casted<rotor::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&ponger_t::on_ping); });
+    }
+
+    void on_ping(rotor::message_t<ping_t> &) noexcept { send<pong_t>(pinger_addr); }
+
+  private:
+    rotor::address_ptr_t pinger_addr;
+};
+
+struct dummy_supervisor : public rotor::supervisor_t {
+    using rotor::supervisor_t::supervisor_t;
+
+    void start_timer(const rotor::pt::time_duration &, rotor::request_id_t) noexcept override {}
+    void cancel_timer(rotor::request_id_t) noexcept override {}
+    void start() noexcept override {}
+    void shutdown() noexcept override {}
+    void enqueue(rotor::message_ptr_t) noexcept override {}
+};
+
+static double measure(std::size_t count) {
+    rotor::system_context_t ctx{};
+    auto timeout = boost::posix_time::milliseconds{500}; /* does not matter */
+    auto sup = ctx.create_supervisor<dummy_supervisor>().timeout(timeout).finish();
+
+    auto pinger = sup->create_actor<pinger_t>().timeout(timeout).finish();
+    auto ponger = sup->create_actor<ponger_t>().timeout(timeout).finish();
+    pinger->set_pings(count);
+    pinger->set_ponger_addr(ponger->get_address());
+    ponger->set_pinger_addr(pinger->get_address());
+
+    auto start = std::chrono::high_resolution_clock::now();
+    sup->do_process();
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> diff = end - start;
+    return (count * 2) / diff.count();
+}
+
+int main(int argc, char **argv) {
+    std::size_t count = 100000;
+    if (argc > 1) {
+        boost::conversion::try_lexical_convert(argv[1], count);
+    }
+
+    auto capacity = rotor::message_pool_t::get_capacity();
+    auto pooled = measure(count);
+
+    rotor::message_pool_t::set_capacity(0);
+    auto heap = measure(count);
+    rotor::message_pool_t::set_capacity(capacity);
+
+    std::cout << std::fixed << std::setprecision(2) << "messages/sec, pooled: " << pooled << ", heap: " << heap
+              << ", ratio: " << pooled / heap << "\n";
+    return 0;
+}
@@ -0,0 +1,96 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+/* Micro-benchmark of subscription_t::get_recipients, i.e. of the lookup, which
+ * is performed for every delivered message: thousands of addresses, each one
+ * has a few message types subscribed with a single handler. */
+
+#include "rotor.hpp"
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace r = rotor;
+
+struct dummy_supervisor : public r::supervisor_t {
+    using r::supervisor_t::supervisor_t;
+
+    void start_timer(const r::pt::time_duration &, r::request_id_t) noexcept override {}
+    void cancel_timer(r::request_id_t) noexcept override {}
+    void start() noexcept override {}
+    void shutdown() noexcept override {}
+    void enqueue(r::message_ptr_t) noexcept override {}
+};
+
+struct dummy_handler_t : public r::handler_base_t {
+    using r::handler_base_t::handler_base_t;
+    void call(r::message_ptr_t &) noexcept override {}
+};
+
+struct probe_message_t : public r::message_base_t {
+    using r::message_base_t::message_base_t;
+};
+
+int main(int argc, char **argv) {
+    std::size_t addresses_count = 4096;
+    std::size_t types_count = 8;
+    std::size_t rounds = 100;
+    if (argc > 1) {
+        boost::conversion::try_lexical_convert(argv[1], addresses_count);
+    }
+    if (argc > 2) {
+        boost::conversion::try_lexical_convert(argv[2], types_count);
+    }
+    if (argc > 3) {
+        boost::conversion::try_lexical_convert(argv[3], rounds);
+    }
+
+    r::system_context_t ctx{};
+    auto timeout = boost::posix_time::milliseconds{500}; /* does not matter */
+    auto sup = ctx.create_supervisor<dummy_supervisor>().timeout(timeout).finish();
+
+    /* any unique pointers will do as message types */
+    std::vector<char> types(types_count);
+    static const char handler_type = 0;
+
+    r::subscription_t subscription(*sup);
+    std::vector<r::subscription_info_ptr_t> infos;
+    std::vector<r::message_ptr_t> probes;
+    for (std::size_t i = 0; i < addresses_count; ++i) {
+        auto addr = sup->create_address();
+        for (std::size_t j = 0; j < types_count; ++j) {
+            auto handler = r::handler_ptr_t(new dummy_handler_t(*sup, &types[j], &handler_type));
+            infos.emplace_back(subscription.materialize(r::subscription_point_t(handler, addr)));
+            probes.emplace_back(new probe_message_t(&types[j], addr));
+        }
+    }
+    std::shuffle(probes.begin(), probes.end(), std::mt19937{0});
+
+    std::size_t found = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (std::size_t i = 0; i < rounds; ++i) {
+        for (auto &probe : probes) {
+            auto recipients = subscription.get_recipients(*probe);
+            found += recipients->internal.size();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> diff = end - start;
+
+    auto lookups = probes.size() * rounds;
+    std::cout << "keys: " << probes.size() << ", lookups: " << lookups << ", found: " << found << "\n";
+    std::cout << std::fixed << std::setprecision(2) << "ns/lookup: " << diff.count() * 1e9 / lookups
+              << ", lookups/sec: " << lookups / diff.count() << "\n";
+
+    for (auto &info : infos) {
+        subscription.forget(info);
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+/* Measures how the plain threads backend scales: every pinger/ponger pair
+ * lives in its own supervisor (locality), the localities are spread over
+ * the workers pool. */
+
+#include <rotor/thread.hpp>
+#include <atomic>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+
+namespace rth = rotor::thread;
+
+struct ping_t {};
+struct pong_t {};
+
+static std::atomic<std::size_t> pairs_left{0};
+
+struct pinger_t : public rotor::actor_base_t {
+    using rotor::actor_base_t::actor_base_t;
+
+    void set_pings(std::size_t pings) { pings_left = pings; }
+
+    void set_ponger_addr(const rotor::address_ptr_t &addr) { ponger_addr = addr; }
+
+    void configure(rotor::plugin::plugin_base_t &plugin) noexcept override {
+        rotor::actor_base_t::configure(plugin);
+        plugin.with_casted<rotor::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&pinger_t::on_pong); });
+    }
+
+    void on_start() noexcept override {
+        rotor::actor_base_t::on_start();
+        send_ping();
+    }
+
+    void on_pong(rotor::message_t<pong_t> &) noexcept { send_ping(); }
+
+  private:
+    void send_ping() {
+        if (pings_left) {
+            send<ping_t>(ponger_addr);
+            --pings_left;
+        } else if (--pairs_left == 0) {
+            static_cast<rth::supervisor_thread_t *>(supervisor)->get_context()->get_supervisor()->shutdown();
+        }
+    }
+
+    rotor::address_ptr_t ponger_addr;
+    std::size_t pings_left;
+};
+
+struct ponger_t : public rotor::actor_base_t {
+    using rotor::actor_base_t::actor_base_t;
+
+    void set_pinger_addr(const rotor::address_ptr_t &addr) { pinger_addr = addr; }
+
+    void configure(rotor::plugin::plugin_base_t &plugin) noexcept override {
+        rotor::actor_base_t::configure(plugin);
+        plugin.with_casted<rotor::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&ponger_t::on_ping); });
+    }
+
+    void on_ping(rotor::message_t<ping_t> &) noexcept { send<pong_t>(pinger_addr); }
+
+  private:
+    rotor::address_ptr_t pinger_addr;
+};
+
+static double measure(std::size_t workers, std::size_t pairs, std::size_t pings) {
+    auto system_context = rth::system_context_ptr_t{new rth::system_context_thread_t(workers)};
+    auto timeout = boost::posix_time::milliseconds{500};
+    auto sup = system_context->create_supervisor<rth::supervisor_thread_t>().timeout(timeout).finish();
+    for (std::size_t i = 0; i < pairs; ++i) {
+        auto child = sup->create_actor<rth::supervisor_thread_t>().timeout(timeout).finish();
+        auto pinger = child->create_actor<pinger_t>().timeout(timeout).finish();
+        auto ponger = child->create_actor<ponger_t>().timeout(timeout).finish();
+        pinger->set_pings(pings);
+        pinger->set_ponger_addr(ponger->get_address());
+        ponger->set_pinger_addr(pinger->get_address());
+    }
+    pairs_left = pairs;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    sup->start();
+    system_context->run();
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> diff = end - start;
+    return static_cast<double>(pairs * pings * 2) / diff.count();
+}
+
+int main(int argc, char **argv) {
+    std::size_t workers = 0;
+    std::size_t pairs = 8;
+    std::size_t pings = 100000;
+    if (argc > 1) {
+        workers = static_cast<std::size_t>(std::atoi(argv[1]));
+    }
+    if (argc > 2) {
+        pairs = static_cast<std::size_t>(std::atoi(argv[2]));
+    }
+    if (argc > 3) {
+        pings = static_cast<std::size_t>(std::atoi(argv[3]));
+    }
+
+    auto single = measure(1, pairs, pings);
+    auto multi = measure(workers, pairs, pings);
+    std::cout << "pairs: " << pairs << ", pings per pair: " << pings << "\n"
+              << "messages/sec, 1 worker: " << std::fixed << std::setprecision(2) << single
+              << ", all workers: " << multi << ", ratio: " << multi / single << "\n";
+    return 0;
+}
@@ -12,10 +12,13 @@
 
 #include "rotor/actor_base.h"
 #include "rotor/address.hpp"
+#include "rotor/broker.h"
 #include "rotor/message.h"
 #include "rotor/registry.h"
+#include "rotor/serialization.h"
 #include "rotor/supervisor.h"
 #include "rotor/system_context.h"
+#include "rotor/transport_base.h"
 
 /// Basic namespace for all rotor functionalities
 namespace rotor {}
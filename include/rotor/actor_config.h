@@ -10,6 +10,7 @@
 #include <tuple>
 #include <functional>
 #include <memory>
+#include <vector>
 #include "arc.hpp"
 #include "plugins.h"
 #include "policy.h"
@@ -92,6 +93,17 @@ template <typename Actor> struct actor_config_builder_t {
      */
     using install_action_t = std::function<void(actor_ptr_t &)>;
 
+    /** \brief list of typed actors, constructed at once */
+    using actors_t = std::vector<intrusive_ptr_t<Actor>>;
+
+    /** \brief actors group post-constructor callback type
+     *
+     * For example, supervisor creates the group of children with single message
+     * and initializes them under single shared timeout.
+     *
+     */
+    using group_action_t = std::function<void(std::vector<rotor::actor_ptr_t> &&)>;
+
     /** \brief bit mask for init timeout validation */
     constexpr static const std::uint32_t INIT_TIMEOUT = 1 << 0;
 
@@ -104,6 +116,9 @@ template <typename Actor> struct actor_config_builder_t {
     /** \brief post-construction callback */
     install_action_t install_action;
 
+    /** \brief post-construction callback for actors group (if it is empty, `install_action` is used per actor) */
+    group_action_t group_action;
+
     /** \brief raw pointer to `supervisor_t` (is `null` for top-level supervisors) */
     supervisor_t *supervisor;
 
@@ -152,6 +167,9 @@ template <typename Actor> struct actor_config_builder_t {
     /** \brief constructs actor from the current config */
     actor_ptr_t finish() &&;
 
+    /** \brief constructs `count` homogeneous actors from the current config */
+    std::vector<intrusive_ptr_t<Actor>> finish(std::size_t count) &&;
+
   private:
     void init_ctor() noexcept {
         config.plugins_constructor = []() -> plugin_storage_ptr_t {
@@ -10,6 +10,7 @@
  * A convenience header to include rotor support for boost::asio
  */
 
+#include "rotor/asio/bridge.h"
 #include "rotor/asio/forwarder.hpp"
 #include "rotor/asio/supervisor_asio.h"
 #include "rotor/asio/supervisor_config_asio.h"
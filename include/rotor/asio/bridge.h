@@ -0,0 +1,615 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/serialization.h"
+#include "rotor/transport_base.h"
+#include "rotor/asio/supervisor_asio.h"
+#include <boost/asio.hpp>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace rotor {
+namespace asio {
+
+namespace asio = boost::asio;
+namespace sys = boost::system;
+
+/** \brief the connected stream socket (TCP, unix domain socket etc.), used by {@link bridge_t} */
+using bridge_socket_t = asio::generic::stream_protocol::socket;
+
+/** \brief alias for bridge socket shared pointer */
+using bridge_socket_ptr_t = std::shared_ptr<bridge_socket_t>;
+
+/** \struct bridge_config_t
+ *  \brief network bridge configuration
+ */
+struct bridge_config_t : transport_base_config_t {
+    /** \brief the already connected socket */
+    bridge_socket_ptr_t socket;
+
+    /** \brief the maximum frame size (in bytes); the connection is closed on larger inbound frames */
+    std::size_t max_frame = 1 << 20;
+
+    /** \brief how long the automatically imported address is kept since its last use */
+    pt::time_duration lease_timeout = pt::seconds{60};
+
+    using transport_base_config_t::transport_base_config_t;
+};
+
+/** \brief CRTP network bridge config builder */
+template <typename Actor> struct bridge_config_builder_t : transport_base_config_builder_t<Actor> {
+    /** \brief final builder class */
+    using builder_t = typename Actor::template config_builder_t<Actor>;
+
+    /** \brief parent config builder */
+    using parent_t = transport_base_config_builder_t<Actor>;
+    using parent_t::parent_t;
+
+    /** \brief takes ownership of the connected stream socket, e.g. `tcp::socket` or `local::stream_protocol::socket` */
+    template <typename Socket> builder_t &&socket(Socket &&value) &&noexcept {
+        parent_t::config.socket = std::make_shared<bridge_socket_t>(std::move(value));
+        return std::move(*static_cast<builder_t *>(this));
+    }
+
+    /** \brief sets the maximum frame size */
+    builder_t &&max_frame(std::size_t value) &&noexcept {
+        parent_t::config.max_frame = value;
+        return std::move(*static_cast<builder_t *>(this));
+    }
+
+    /** \brief sets how long the automatically imported address is kept since its last use */
+    builder_t &&lease_timeout(const pt::time_duration &value) &&noexcept {
+        parent_t::config.lease_timeout = value;
+        return std::move(*static_cast<builder_t *>(this));
+    }
+
+    /** \brief checks that the socket is connected and the maximum frame size is sane */
+    bool validate() noexcept override {
+        auto &c = parent_t::config;
+        return c.socket && c.socket->is_open() && c.max_frame >= 64 && parent_t::validate();
+    }
+};
+
+/** \struct bridge_t
+ *  \brief bridges rotor messages to the other process (host) via the stream socket
+ *
+ * The bridge pair shares the single connection (TCP or unix domain socket),
+ * which is established by the user (i.e. accepted or connected) and handed
+ * over to the bridge. Any amount of the logical links between actors are
+ * multiplexed over the connection: the actor addresses are identified on the
+ * wire by the stable ids (see {@link transport_base_t}). The messages, sent to
+ * a proxy address, are serialized (see {@link serializer_t}) into the
+ * length-prefixed frames and delivered by the other side bridge to the
+ * exported address.
+ *
+ * The addresses inside payloads (e.g. the request origin) are translated
+ * automatically: the local addresses are exported on demand, and the proxy
+ * addresses are created on demand for the other side addresses. So, the
+ * actor on the other side can reply or send a message to the origin. Such
+ * proxy address is kept while it is used by links, and then for `lease_timeout`
+ * since its last use (i.e. since it has been received or something has been
+ * sent to it); after that the proxy is forgotten, and the other side is told
+ * how many times the address has been received. The exporting side counts
+ * how many times the address has been sent, and forgets the address when all
+ * of them are released by the other side, and it is not used by requests
+ * or links.
+ *
+ * Requests and responses are supported: the request is remembered until the
+ * response arrives from the other side, and then the response is delivered to
+ * the original requester as if the request were local. The request to the
+ * address, which is not exported by the other side, is replied with
+ * `transport_unknown_address` error.
+ *
+ * Linking to the proxy address (see {@link plugin::link_client_plugin_t}) links
+ * to the actor on the other side. The links are tracked by the bridge: when the
+ * connection is lost or the bridge shuts down, the local clients receive unlink
+ * request (as if the server were shutting down), and the local servers receive
+ * unlink notification (as if the client were shutting down); the pending
+ * requests are replied with `transport_disconnected` error.
+ *
+ * The outbound frames are queued while the previous write is in progress, and
+ * then all queued frames are written at once via scatter/gather I/O.
+ *
+ * The message types, exported and imported addresses should be registered
+ * before the bridge initialization; the link-related messages are registered
+ * by default. The bridge should be run on the boost::asio supervisor.
+ *
+ */
+struct bridge_t : public transport_base_t {
+    /** \brief injects an alias for bridge_config_t */
+    using config_t = bridge_config_t;
+
+    /** \brief injects templated bridge_config_builder_t */
+    template <typename Actor> using config_builder_t = bridge_config_builder_t<Actor>;
+
+    /** \brief constructs the bridge from the config */
+    explicit bridge_t(config_t &config);
+
+    /** \brief registers serializable plain message payload type `T` */
+    template <typename T> void register_message() noexcept {
+        static_assert(is_serializable_v<T>, "payload should be serializable");
+        if (registry.find(message_t<T>::message_type)) {
+            return;
+        }
+        registry.add<T>();
+        subscribers.emplace_back(&bridge_t::template subscribe_message<T>);
+    }
+
+    /** \brief registers serializable request payload type `R` (and its response) */
+    template <typename R> void register_request() noexcept {
+        using response_t = typename request_traits_t<R>::response::wrapped_t::response_t;
+        static_assert(is_serializable_v<R>, "request payload should be serializable");
+        static_assert(is_serializable_v<response_t>, "response payload should be serializable");
+        auto codec = request_codec_t{&bridge_t::template decode_request<R>, &bridge_t::template decode_response<R>};
+        if (!request_codecs.emplace(serializer_t<R>::type_id, codec).second) {
+            return;
+        }
+        subscribers.emplace_back(&bridge_t::template subscribe_request<R>);
+        responders.emplace_back(&bridge_t::template subscribe_response<R>);
+    }
+
+    /** \brief makes the local address available to the other side under the stable non-zero `id` */
+    void export_address(std::uint64_t id, const address_ptr_t &addr) noexcept override;
+
+    address_ptr_t import_address(std::uint64_t id) noexcept override;
+
+    void configure(plugin::plugin_base_t &plugin) noexcept override;
+    void on_start() noexcept override;
+    void shutdown_start() noexcept override;
+    void shutdown_finish() noexcept override;
+
+    /** \brief some bytes have been read from the socket */
+    void on_read(std::size_t bytes) noexcept;
+
+    /** \brief reading from the socket failed */
+    void on_read_error(const sys::error_code &ec) noexcept;
+
+    /** \brief all the queued frames have been written into the socket */
+    void on_write(std::size_t bytes) noexcept;
+
+    /** \brief writing into the socket failed */
+    void on_write_error(const sys::error_code &ec) noexcept;
+
+  protected:
+    /** \brief the kind of the frame on the wire */
+    enum class frame_kind_t : std::uint8_t { message = 1, request, response, release };
+
+    /** \brief decodes the request (or response) frame and puts the message into the supervisor */
+    using frame_decoder_t = bool (*)(bridge_t &bridge, decoder_t &decoder) noexcept;
+
+    /** \brief subscribes the encoding handlers of the registered type on the proxy address */
+    using subscriber_t = void (*)(bridge_t &bridge, plugin::starter_plugin_t *plugin, const address_ptr_t &proxy,
+                                  std::uint64_t remote_id) noexcept;
+
+    /** \brief subscribes the response encoding handler of the registered request type */
+    using responder_t = void (*)(bridge_t &bridge, plugin::starter_plugin_t &plugin) noexcept;
+
+    /** \struct request_codec_t
+     *  \brief the registered request type decoders */
+    struct request_codec_t {
+        /** \brief inbound request decoder */
+        frame_decoder_t decode_request;
+
+        /** \brief inbound response decoder */
+        frame_decoder_t decode_response;
+    };
+
+    /** \struct addresses_t
+     * \brief translates addresses in payloads, exporting local and importing remote addresses on demand
+     *
+     * The address is encoded as `id << 1` for the local (exported) address, and
+     * as `id << 1 | 1` for the proxy of the other side address.
+     */
+    struct addresses_t : address_codec_t {
+        /** \brief constructs the address codec of the bridge */
+        addresses_t(bridge_t &bridge_) noexcept : bridge{bridge_} {}
+
+        std::uint64_t encode(const address_ptr_t &address) noexcept override;
+        address_ptr_t decode(std::uint64_t id) noexcept override;
+
+        /** \brief the owner bridge */
+        bridge_t &bridge;
+
+        /** \brief the automatically exported addresses, referred by the frame being encoded */
+        std::vector<address_ptr_t> referred;
+    };
+
+    /** \struct lease_t
+     *  \brief the usage of the automatically exported or imported address */
+    struct lease_t {
+        /** \brief the amount of requests and links, which use the address */
+        std::size_t users = 0;
+
+        /** \brief how many times the address has been sent to (exported) or received from (imported) the other side */
+        std::uint64_t refs = 0;
+
+        /** \brief the last use of the imported address */
+        clock_t::time_point touched;
+    };
+
+    /** \struct link_t
+     *  \brief the link between actors on the different sides of the bridge */
+    struct link_t {
+        /** \brief the client (linking) actor address */
+        address_ptr_t client;
+
+        /** \brief the server (linked) actor address */
+        address_ptr_t server;
+    };
+
+    /** \brief the list of links (type) */
+    using links_t = std::vector<link_t>;
+
+    /** \brief stable type id to request codec mapping (type) */
+    using request_codecs_t = std::unordered_map<std::uint32_t, request_codec_t>;
+
+    /** \brief address to stable id mapping (type) */
+    using ids_map_t = std::unordered_map<const address_t *, std::uint64_t>;
+
+    /** \brief automatically exported or imported address to its usage mapping (type) */
+    using leases_t = std::unordered_map<const address_t *, lease_t>;
+
+    /** \brief proxy address to its encoding handlers subscriptions mapping (type) */
+    using subscriptions_map_t = std::unordered_map<const address_t *, std::vector<subscription_info_ptr_t>>;
+
+    /** \brief list of frames (type) */
+    using frames_t = std::vector<serialization_buffer_t>;
+
+    /** \brief encodes the frame via `fn` and queues it for writing, returns `false` if it cannot be sent */
+    template <typename Fn> bool write_frame(frame_kind_t kind, Fn &&fn) noexcept {
+        addresses.referred.clear();
+        if (!connected) {
+            return false;
+        }
+        auto frame = make_frame();
+        encoder_t encoder(frame, &addresses);
+        encoder.put(kind);
+        fn(encoder);
+        return queue_frame(std::move(frame));
+    }
+
+    /** \brief returns the empty frame with the reserved space for the length prefix */
+    serialization_buffer_t make_frame() noexcept;
+
+    /** \brief prepends the frame length and queues the frame for writing
+     *
+     * The addresses, referred by the frame, which cannot be sent, are released.
+     */
+    bool queue_frame(serialization_buffer_t &&frame) noexcept;
+
+    /** \brief writes all queued frames at once, unless the previous write is in progress */
+    void flush() noexcept;
+
+    /** \brief initiates reading from the socket */
+    void read() noexcept;
+
+    /** \brief decodes the inbound frame */
+    void decode_frame(const std::uint8_t *data, std::size_t size) noexcept;
+
+    /** \brief stops accepting frames, unlinks the linked actors and fails the pending requests
+     *
+     * The already queued frames are still written, and then the socket is closed.
+     */
+    void disconnect() noexcept;
+
+    /** \brief closes the socket, i.e. the pending read is aborted */
+    void close() noexcept;
+
+    /** \brief the automatically exported or imported address is used by one more request or link */
+    void retain(const address_ptr_t &address) noexcept override;
+
+    /** \brief the automatically exported or imported address is not used by the request or link anymore
+     *
+     * The exported address, which is not used by anything and is released by the other side, is
+     * forgotten; the imported address is forgotten when it expires. The addresses, exported or
+     * imported by user, are kept.
+     */
+    void release(const address_ptr_t &address) noexcept override;
+
+    /** \brief the automatically imported address has been used, i.e. its lease is prolonged */
+    void touch(const address_ptr_t &address) noexcept;
+
+    /** \brief the other side has released `refs` references to the automatically exported address */
+    void unrefer(std::uint64_t id, std::uint64_t refs) noexcept;
+
+    /** \brief forgets the automatically exported address, if it is not used by anything */
+    void forget_unused(const address_ptr_t &address) noexcept;
+
+    /** \brief forgets the expired imported addresses, and releases them on the other side */
+    void expire_leases() noexcept;
+
+    /** \brief forgets the expired pending requests and the expired leases, even if the socket is idle */
+    void on_expiry() noexcept override;
+
+    /** \brief forgets the automatically exported or imported address */
+    void forget_address(const address_ptr_t &address) noexcept;
+
+    /** \brief adds the link, its addresses are retained */
+    void remember_link(links_t &links, const address_ptr_t &client, const address_ptr_t &server) noexcept;
+
+    /** \brief removes the link (if it is known), its addresses are released */
+    void forget_link(links_t &links, const address_ptr_t &client, const address_ptr_t &server) noexcept;
+
+    /** \brief the plain message encoder */
+    template <typename T>
+    static void subscribe_message(bridge_t &self, plugin::starter_plugin_t *plugin, const address_ptr_t &proxy,
+                                  std::uint64_t remote_id) noexcept {
+        using message_t = rotor::message_t<T>;
+        auto encoder = [&self, remote_id](message_t &message) noexcept {
+            auto ok = self.write_frame(frame_kind_t::message, [&](encoder_t &e) {
+                e.put(remote_id);
+                self.registry.encode(e, message);
+            });
+            if (!ok) {
+                ++self.dropped;
+            }
+            self.touch(message.address);
+            // the client address should be still known, when the notification is encoded
+            if constexpr (std::is_same_v<T, payload::unlink_notify_t>) {
+                self.forget_link(self.links_out, message.payload.client_addr, message.address);
+            }
+        };
+        if (plugin) {
+            plugin->subscribe_actor(lambda<message_t>(std::move(encoder)), proxy);
+        } else {
+            auto info = self.subscribe(lambda<message_t>(std::move(encoder)), proxy);
+            self.proxy_subscriptions[proxy.get()].emplace_back(std::move(info));
+        }
+    }
+
+    /** \brief the request encoder, the request is remembered until the response arrives */
+    template <typename R>
+    static void subscribe_request(bridge_t &self, plugin::starter_plugin_t *plugin, const address_ptr_t &proxy,
+                                  std::uint64_t remote_id) noexcept {
+        using request_message_t = typename request_traits_t<R>::request::message_t;
+        auto encoder = [&self, remote_id](request_message_t &message) noexcept {
+            auto sequence = ++self.last_request;
+            auto &payload = message.payload;
+            auto ok = self.write_frame(frame_kind_t::request, [&](encoder_t &e) {
+                e.put(serializer_t<R>::type_id);
+                e.put(remote_id);
+                e.put(sequence);
+                e.put(payload.origin);
+                e.put(payload.request_payload);
+            });
+            self.touch(message.address);
+            if (ok) {
+                auto fail = &bridge_t::template fail_request<R>;
+                self.remember(sequence, message_ptr_t(&message), fail, payload.origin);
+            } else {
+                auto ec = self.connected ? error_code_t::transport_overflow : error_code_t::transport_disconnected;
+                self.reply_with_error(message, make_error_code(ec));
+            }
+        };
+        if (plugin) {
+            plugin->subscribe_actor(lambda<request_message_t>(std::move(encoder)), proxy);
+        } else {
+            auto info = self.subscribe(lambda<request_message_t>(std::move(encoder)), proxy);
+            self.proxy_subscriptions[proxy.get()].emplace_back(std::move(info));
+        }
+    }
+
+    /** \brief the response encoder, the local actors reply to the bridge on behalf of the other side */
+    template <typename R> static void subscribe_response(bridge_t &self, plugin::starter_plugin_t &plugin) noexcept {
+        using response_message_t = typename request_traits_t<R>::response::message_t;
+        auto encoder = [&self](response_message_t &message) noexcept {
+            auto &req = message.payload.req;
+            auto &ec = message.payload.ec;
+            if constexpr (std::is_same_v<R, payload::link_request_t>) {
+                if (!ec) {
+                    if (!self.connected) {
+                        // the client is gone, but the server is not aware of that yet
+                        self.send<payload::unlink_notify_t>(req->address, req->payload.origin);
+                        return;
+                    }
+                    self.remember_link(self.links_in, req->payload.origin, req->address);
+                }
+            }
+            if constexpr (std::is_same_v<R, payload::unlink_request_t>) {
+                if (!ec) {
+                    self.forget_link(self.links_out, req->address, req->payload.request_payload.server_addr);
+                }
+            }
+            if (!self.connected) {
+                // the requester has gone, e.g. the request has been issued by the bridge itself
+                return;
+            }
+            auto ok = self.write_frame(frame_kind_t::response, [&](encoder_t &e) {
+                e.put(serializer_t<R>::type_id);
+                e.put(static_cast<std::uint64_t>(req->payload.id));
+                e.put(ec);
+                if (!ec) {
+                    e.put(message.payload.res);
+                }
+            });
+            if (!ok) {
+                // the requester will get timeout
+                ++self.dropped;
+            }
+            if constexpr (std::is_same_v<R, payload::link_request_t>) {
+                self.release(req->payload.origin);
+            } else {
+                self.touch(req->payload.origin);
+            }
+        };
+        plugin.subscribe_actor(lambda<response_message_t>(std::move(encoder)), self.reply_address);
+    }
+
+    /** \brief the inbound request decoder, the bridge is the reply destination */
+    template <typename R> static bool decode_request(bridge_t &self, decoder_t &decoder) noexcept {
+        using wrapped_t = typename request_traits_t<R>::request::wrapped_t;
+        std::uint64_t dest_id;
+        std::uint64_t sequence;
+        address_ptr_t origin;
+        R payload{};
+        if (!(decoder.get(dest_id) && decoder.get(sequence) && decoder.get(origin) && decoder.get(payload))) {
+            return false;
+        }
+        auto dest = self.find_export(dest_id);
+        if (!dest) {
+            // the requester should not wait for the response, which will never come
+            self.write_frame(frame_kind_t::response, [&](encoder_t &e) {
+                e.put(serializer_t<R>::type_id);
+                e.put(sequence);
+                e.put(make_error_code(error_code_t::transport_unknown_address));
+            });
+            ++self.dropped;
+            return true;
+        }
+        if constexpr (std::is_same_v<R, payload::link_request_t>) {
+            // the link client should be known until the link is established (or rejected)
+            self.retain(origin);
+        }
+        auto id = static_cast<request_id_t>(sequence);
+        auto &reply_to = self.reply_address;
+        self.supervisor->put(make_message<wrapped_t>(*dest, id, reply_to, origin, std::move(payload)));
+        return true;
+    }
+
+    /** \brief the inbound response decoder, the response is delivered to the original requester */
+    template <typename R> static bool decode_response(bridge_t &self, decoder_t &decoder) noexcept {
+        using traits_t = request_traits_t<R>;
+        using response_wrapped_t = typename traits_t::response::wrapped_t;
+        using response_t = typename response_wrapped_t::response_t;
+
+        std::uint64_t sequence;
+        std::error_code ec;
+        response_t res{};
+        if (!(decoder.get(sequence) && decoder.get(ec)) || (!ec && !decoder.get(res))) {
+            return false;
+        }
+        auto req = self.take_pending<R>(sequence);
+        if (!req) {
+            ++self.dropped;
+            return true;
+        }
+        if constexpr (std::is_same_v<R, payload::link_request_t>) {
+            if (!ec) {
+                self.remember_link(self.links_out, req->payload.origin, req->address);
+            }
+        }
+        if constexpr (std::is_same_v<R, payload::unlink_request_t>) {
+            if (!ec) {
+                self.forget_link(self.links_in, req->address, req->payload.request_payload.server_addr);
+            }
+        }
+        self.release(req->payload.origin);
+        auto reply_to = req->payload.reply_to;
+        if (ec) {
+            self.supervisor->put(make_message<response_wrapped_t>(reply_to, ec, std::move(req)));
+        } else {
+            self.supervisor->put(make_message<response_wrapped_t>(reply_to, std::move(req), std::move(res)));
+        }
+        return true;
+    }
+
+    /** \brief replies with the error to the pending request
+     *
+     * The pending unlink request is completed successfully instead, as the client
+     * on the other side is gone anyway.
+     */
+    template <typename R>
+    static void fail_request(transport_base_t &transport, message_base_t &message, const std::error_code &ec) noexcept {
+        using request_message_t = typename request_traits_t<R>::request::message_t;
+        if constexpr (std::is_same_v<R, payload::unlink_request_t>) {
+            auto &self = static_cast<bridge_t &>(transport);
+            auto &request = static_cast<request_message_t &>(message);
+            auto &client = request.address;
+            self.forget_link(self.links_in, client, request.payload.request_payload.server_addr);
+            self.reply_to(request, client);
+        } else {
+            transport_base_t::fail_request<R>(transport, message, ec);
+        }
+    }
+
+    /** \brief the connected socket */
+    bridge_socket_ptr_t socket;
+
+    /** \brief the maximum frame size */
+    std::size_t max_frame;
+
+    /** \brief how long the automatically imported address is kept since its last use */
+    clock_t::duration lease_timeout;
+
+    /** \brief the expired imported addresses are not looked for until that time */
+    clock_t::time_point next_expiry;
+
+    /** \brief the destination of the responses to the requests from the other side
+     *
+     * It is not the bridge own address, as the bridge itself might be the link client or server.
+     */
+    address_ptr_t reply_address;
+
+    /** \brief whether the connection is still alive, i.e. the frames are accepted */
+    bool connected = true;
+
+    /** \brief whether the encoding handlers of the proxy addresses can be subscribed without starter plugin */
+    bool configured = false;
+
+    /** \brief whether the write is in progress */
+    bool writing = false;
+
+    /** \brief the registered plain message payload types */
+    serialization_registry_t registry;
+
+    /** \brief the registered request types */
+    request_codecs_t request_codecs;
+
+    /** \brief proxy address handlers subscribers of the registered types */
+    std::vector<subscriber_t> subscribers;
+
+    /** \brief own address response handlers subscribers of the registered request types */
+    std::vector<responder_t> responders;
+
+    /** \brief the addresses translator for payloads */
+    addresses_t addresses;
+
+    /** \brief the stable ids of the exported addresses */
+    ids_map_t exported_ids;
+
+    /** \brief the stable ids of the proxy addresses */
+    ids_map_t imported_ids;
+
+    /** \brief the automatically exported and imported addresses, which can be released */
+    leases_t leases;
+
+    /** \brief the encoding handlers subscriptions of the proxy addresses, created after configuration */
+    subscriptions_map_t proxy_subscriptions;
+
+    /** \brief the last stable id of automatically exported addresses */
+    std::uint64_t last_export;
+
+    /** \brief local clients linked to the other side servers (via proxies) */
+    links_t links_out;
+
+    /** \brief other side clients (via proxies) linked to local servers */
+    links_t links_in;
+
+    /** \brief inbound bytes */
+    std::vector<std::uint8_t> rx;
+
+    /** \brief the amount of inbound bytes, which are not decoded yet */
+    std::size_t rx_size = 0;
+
+    /** \brief frames, queued for writing */
+    frames_t outbox;
+
+    /** \brief frames, being written */
+    frames_t inflight;
+
+    /** \brief the written frames buffers, kept for reuse */
+    frames_t spare;
+
+    /** \brief scatter/gather buffers of the frames being written */
+    std::vector<asio::const_buffer> gather;
+};
+
+} // namespace asio
+} // namespace rotor
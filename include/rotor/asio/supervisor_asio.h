@@ -7,6 +7,7 @@
 //
 
 #include "rotor/supervisor.h"
+#include "rotor/inbound_queue.hpp"
 #include "supervisor_config_asio.h"
 #include "system_context_asio.h"
 #include "forwarder.hpp"
@@ -46,6 +47,10 @@ template <typename Actor, typename Handler, typename ArgsCount, typename ErrHand
  * handler, the change should be performed in synchronized way, i.e.
  * via `strand`.
  *
+ * Messages from other strands are collected in the inbound queue of the
+ * locality leader; only the first message of a burst schedules drain
+ * handler on the strand, the following ones are just appended to the queue.
+ *
  */
 struct supervisor_asio_t : public supervisor_t {
 
@@ -117,6 +122,11 @@ struct supervisor_asio_t : public supervisor_t {
 
     /** \brief guard to control ownership of the io-context */
     guard_ptr_t guard;
+
+    /** \brief inbound messages queue, i.e. the structure to hold messages
+     * received from other strands / threads
+     */
+    inbound_queue_t inbound;
 };
 
 template <typename Actor> inline boost::asio::io_context::strand &get_strand(Actor &actor) {
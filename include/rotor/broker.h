@@ -0,0 +1,260 @@
+#pragma once
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "actor_base.h"
+#include "messages.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace rotor {
+
+namespace payload {
+
+/** \struct topic_response_t
+ *  \brief the address of the topic, where messages should be published
+ */
+struct topic_response_t {
+    /** \brief the topic address */
+    address_ptr_t topic_addr;
+};
+
+/** \struct topic_request_t
+ *  \brief asks the broker for the topic address, the topic is created if it does not exist
+ */
+struct topic_request_t {
+    /** \brief link to topic response payload type */
+    using response_t = topic_response_t;
+
+    /** \brief dot-separated topic name, e.g. `feed.eq.AAPL` */
+    std::string topic;
+};
+
+/** \struct topic_subscription_response_t
+ *  \brief confirms the topics pattern subscription
+ */
+struct topic_subscription_response_t {};
+
+/** \struct topic_subscription_request_t
+ *  \brief subscribes to the announcements of all topics, which match the pattern
+ *
+ * The pattern is a dot-separated topic name, where the `*` segment matches
+ * any single segment, and the `#` segment (only the last one) matches one or
+ * more trailing segments, e.g. `feed.eq.*` or `feed.#`.
+ */
+struct topic_subscription_request_t {
+    /** \brief link to topic subscription response payload type */
+    using response_t = topic_subscription_response_t;
+
+    /** \brief the topics pattern */
+    std::string pattern;
+
+    /** \brief the address, where {@link topic_announcement_t} will be sent */
+    address_ptr_t subscriber_addr;
+};
+
+/** \struct topic_announcement_t
+ *  \brief the broker notifies a subscriber about the topic, which matches its pattern
+ *
+ * The message is sent once per topic and subscriber address for all existing and
+ * for all future matching topics. The subscriber is expected to subscribe its
+ * handlers on the `topic_addr`.
+ */
+struct topic_announcement_t {
+    /** \brief the topic name */
+    std::string topic;
+
+    /** \brief the topic address */
+    address_ptr_t topic_addr;
+};
+
+/** \struct topic_unsubscription_t
+ *  \brief cancels the previous topics pattern subscription
+ *
+ * The handlers, which are already subscribed to the topics addresses, are not
+ * touched, i.e. they should be unsubscribed by the subscriber itself (they are
+ * unsubscribed automatically upon actor shutdown).
+ */
+struct topic_unsubscription_t {
+    /** \brief the topics pattern */
+    std::string pattern;
+
+    /** \brief the subscriber address, used in the subscription request */
+    address_ptr_t subscriber_addr;
+};
+
+} // namespace payload
+
+/** \brief broker messages are never dropped due to the queue overflow */
+template <> struct bounded_payload_t<payload::topic_request_t> : std::false_type {};
+/** \brief broker messages are never dropped due to the queue overflow */
+template <> struct bounded_payload_t<payload::topic_subscription_request_t> : std::false_type {};
+/** \brief broker messages are never dropped due to the queue overflow */
+template <> struct bounded_payload_t<payload::topic_announcement_t> : std::false_type {};
+/** \brief broker messages are never dropped due to the queue overflow */
+template <> struct bounded_payload_t<payload::topic_unsubscription_t> : std::false_type {};
+
+namespace message {
+
+/** \brief topic address request */
+using topic_request_t = request_traits_t<payload::topic_request_t>::request::message_t;
+/** \brief topic address response */
+using topic_response_t = request_traits_t<payload::topic_request_t>::response::message_t;
+/** \brief topics pattern subscription request */
+using topic_subscription_request_t = request_traits_t<payload::topic_subscription_request_t>::request::message_t;
+/** \brief topics pattern subscription response */
+using topic_subscription_response_t = request_traits_t<payload::topic_subscription_request_t>::response::message_t;
+/** \brief matching topic announcement */
+using topic_announcement_t = message_t<payload::topic_announcement_t>;
+/** \brief topics pattern unsubscription */
+using topic_unsubscription_t = message_t<payload::topic_unsubscription_t>;
+
+} // namespace message
+
+/** \struct broker_t
+ *  \brief hierarchical topics index for pub/sub
+ *
+ * Each topic is backed by the plain rotor address, created by the broker,
+ * so the publisher resolves the topic once via {@link payload::topic_request_t}
+ * and then just sends messages to the topic address. The delivery is the
+ * regular one, i.e. it is O(subscribers) and it does not involve any
+ * string processing.
+ *
+ * The subscribers declare their interest via topics patterns (with `*` and `#`
+ * wildcards), which are kept in the trie. The pattern is matched once per
+ * topic: the broker announces all matching topics (existing and new ones) to the
+ * subscriber, which then subscribes its handlers to the topics addresses, i.e.
+ * the match result is materialized as the regular rotor subscriptions, and the
+ * usual subscriptions lifecycle (e.g. unsubscription on shutdown) applies.
+ *
+ * The broker links to the actor, which made the subscription request, so the
+ * patterns of the subscriber are dropped when that actor shuts down, even if
+ * it did not unsubscribe them. If the same pattern for the same subscriber
+ * address was requested by several actors, it is kept until all of them
+ * shut down. The trie nodes without patterns are dropped too.
+ *
+ * The topic is forgotten, when its address is not referred by anything but
+ * the broker, i.e. there are neither publishers nor subscribed handlers; the
+ * topics are looked through each time their amount doubles.
+ *
+ */
+struct broker_t : public actor_base_t {
+    using actor_base_t::actor_base_t;
+
+    void configure(plugin::plugin_base_t &plugin) noexcept override;
+
+    /** \brief replies with the topic address, the topic is created if needed */
+    virtual void on_topic(message::topic_request_t &request) noexcept;
+
+    /** \brief records the topics pattern and announces matching topics to the subscriber */
+    virtual void on_subscription(message::topic_subscription_request_t &request) noexcept;
+
+    /** \brief forgets the topics pattern of the subscriber */
+    virtual void on_unsubscription(message::topic_unsubscription_t &message) noexcept;
+
+  protected:
+    /** \struct entry_t
+     *  \brief the subscriber address of the pattern in the trie
+     */
+    struct entry_t {
+        /** \brief the subscriber address */
+        address_ptr_t subscriber_addr;
+
+        /** \brief amount of origin actors, which subscribed the pattern for the subscriber */
+        std::size_t refs;
+    };
+
+    /** \brief list of pattern subscribers (type) */
+    using entries_t = std::vector<entry_t>;
+
+    /** \struct node_t
+     *  \brief the patterns trie node, the children are keyed by the pattern segment (including `*`)
+     */
+    struct node_t {
+        /** \brief child nodes */
+        std::unordered_map<std::string, std::unique_ptr<node_t>> children;
+
+        /** \brief subscribers, whose patterns end at the node */
+        entries_t exact;
+
+        /** \brief subscribers, whose patterns end with `#` at the node */
+        entries_t rest;
+    };
+
+    /** \struct subscriber_t
+     *  \brief subscriber address related information */
+    struct subscriber_t {
+        /** \brief amount of subscribed patterns */
+        std::size_t patterns = 0;
+
+        /** \brief already announced topics */
+        std::unordered_set<std::string> announced;
+    };
+
+    /** \struct origin_pattern_t
+     *  \brief the pattern, subscribed by the origin actor for the subscriber address */
+    struct origin_pattern_t {
+        /** \brief the topics pattern */
+        std::string pattern;
+
+        /** \brief the subscriber address */
+        address_ptr_t subscriber_addr;
+    };
+
+    /** \brief topic name to topic address mapping (type) */
+    using topics_map_t = std::unordered_map<std::string, address_ptr_t>;
+
+    /** \brief linked actor address to the patterns of its requests mapping (type) */
+    using origins_map_t = std::unordered_map<address_ptr_t, std::vector<origin_pattern_t>>;
+
+    /** \brief subscriber address to subscriber information mapping (type) */
+    using subscribers_map_t = std::unordered_map<address_ptr_t, subscriber_t>;
+
+    /** \brief sends the announcement, unless it was already sent to the subscriber */
+    void announce(const address_ptr_t &subscriber_addr, const std::string &topic,
+                  const address_ptr_t &topic_addr) noexcept;
+
+    /** \brief links to the subscription origin actor to drop its patterns upon its shutdown */
+    void track(const address_ptr_t &origin) noexcept;
+
+    /** \brief releases all patterns, which were subscribed by the origin actor */
+    void forget_origin(const address_ptr_t &origin) noexcept;
+
+    /** \brief adds the origin reference to the pattern of the subscriber */
+    void acquire(const std::string &pattern, const address_ptr_t &subscriber_addr) noexcept;
+
+    /** \brief removes the origin reference (or all of them) to the pattern of the subscriber
+     *
+     * The subscriber is removed from the pattern, when there are no more references.
+     */
+    void release(const std::string &pattern, const address_ptr_t &subscriber_addr, bool all) noexcept;
+
+    /** \brief forgets the topics, whose addresses are referred by the broker only */
+    void forget_topics() noexcept;
+
+    /** \brief the patterns trie root */
+    node_t root;
+
+    /** \brief topic name to topic address mapping */
+    topics_map_t topics_map;
+
+    /** \brief the unused topics are not looked for, while there are less topics */
+    static constexpr std::size_t min_topics_threshold = 64;
+
+    /** \brief the unused topics are forgotten, when there are that many topics */
+    std::size_t topics_threshold = min_topics_threshold;
+
+    /** \brief subscriber address to subscriber information mapping */
+    subscribers_map_t subscribers_map;
+
+    /** \brief linked actor address to the patterns of its requests mapping */
+    origins_map_t origins_map;
+};
+
+} // namespace rotor
@@ -0,0 +1,119 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#if !defined(ROTOR_COROUTINES)
+#error "rotor should be built with BUILD_COROUTINES option to use coroutines"
+#endif
+
+#include "supervisor.h"
+#include <cassert>
+#include <coroutine>
+#include <exception>
+
+namespace rotor {
+
+/** \struct task_t
+ *  \brief fire-and-forget coroutine type for actors methods
+ *
+ * The coroutine starts eagerly and its frame is destroyed upon completion,
+ * i.e. the caller does not need to keep or await it.
+ *
+ * \code
+ * rotor::task_t my_actor_t::flow() noexcept {
+ *     auto res = co_await request<payload::sample_req_t>(server_addr, 5).await(timeout);
+ *     if (!res->payload.ec) {
+ *         ...
+ *     }
+ * }
+ * \endcode
+ *
+ */
+struct task_t {
+    /** \brief the coroutine promise of the `task_t` */
+    struct promise_type {
+        /** \brief returns the (empty) task */
+        task_t get_return_object() noexcept { return {}; }
+
+        /** \brief the coroutine is started immediately */
+        std::suspend_never initial_suspend() noexcept { return {}; }
+
+        /** \brief the coroutine frame is destroyed upon completion */
+        std::suspend_never final_suspend() noexcept { return {}; }
+
+        /** \brief no result */
+        void return_void() noexcept {}
+
+        /** \brief rotor is exception-free, so an escaped exception is fatal */
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+/** \struct request_awaiter_t
+ *  \brief awaitable of the response to the request
+ *
+ * The awaiter is created via `request_builder_t::await(timeout)`: the request
+ * is dispatched as usual, i.e. it has got request id and timeout timer, but
+ * the response (or timeout error) is not delivered to the actor's address;
+ * instead the suspended coroutine is resumed with the response message in
+ * the context of the actor's supervisor. So, there is no need to subscribe
+ * to the response.
+ *
+ * The coroutine is always resumed, either with the response or with the
+ * error response, and the actor is kept alive till then. The coroutine,
+ * which is still suspended on the supervisor shutdown, is resumed with
+ * `request_timeout` error response.
+ *
+ */
+template <typename T> struct request_awaiter_t {
+    /** \brief message type of the response */
+    using response_message_t = typename request_traits_t<T>::response::message_t;
+
+    /** \brief intrusive pointer to the response message */
+    using response_ptr_t = intrusive_ptr_t<response_message_t>;
+
+    /** \brief constructs awaiter of the already dispatched request */
+    request_awaiter_t(supervisor_t &sup_, actor_base_t &actor_, request_id_t request_id_) noexcept
+        : sup{sup_}, actor{&actor_}, request_id{request_id_} {}
+
+    request_awaiter_t(const request_awaiter_t &) = delete;
+
+    /** \brief the response can be delivered only by the supervisor, so it always suspends */
+    bool await_ready() const noexcept { return false; }
+
+    /** \brief records the coroutine as the continuation of the request */
+    void await_suspend(std::coroutine_handle<> handle_) noexcept {
+        handle = handle_;
+        auto curry = sup.request_map.find(request_id);
+        assert(curry && "request should be in-flight");
+        curry->continuation = &on_response;
+        curry->continuation_context = this;
+    }
+
+    /** \brief returns the response message */
+    response_ptr_t await_resume() noexcept { return std::move(response); }
+
+  private:
+    static void on_response(void *context, message_ptr_t &message) noexcept {
+        auto self = static_cast<request_awaiter_t *>(context);
+        self->response.reset(static_cast<response_message_t *>(message.get()));
+        self->handle.resume();
+    }
+
+    supervisor_t &sup;
+    actor_ptr_t actor;
+    request_id_t request_id;
+    std::coroutine_handle<> handle;
+    response_ptr_t response;
+};
+
+template <typename T> request_awaiter_t<T> request_builder_t<T>::await(pt::time_duration timeout) noexcept {
+    auto id = send(timeout);
+    return request_awaiter_t<T>(sup, actor, id);
+}
+
+} // namespace rotor
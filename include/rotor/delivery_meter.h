@@ -0,0 +1,119 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+namespace rotor {
+
+struct actor_base_t;
+
+/** \struct histogram_t
+ *  \brief log2-bucketed histogram of durations (in nanoseconds)
+ *
+ * The bucket `i` holds the amount of durations in the `[2^(i-1), 2^i)`
+ * nanoseconds range (the bucket `0` holds zero durations).
+ */
+struct histogram_t {
+    /** \brief amount of buckets, the last one holds all too long durations */
+    static constexpr std::size_t buckets_count = 40;
+
+    /** \brief amount of durations per bucket */
+    std::array<std::uint64_t, buckets_count> buckets{};
+
+    /** \brief total sum of durations */
+    std::uint64_t sum_ns = 0;
+
+    /** \brief returns the bucket index for the duration */
+    static std::size_t bucket_of(std::uint64_t ns) noexcept;
+
+    /** \brief returns the total amount of recorded durations */
+    std::uint64_t count() const noexcept;
+
+    /** \brief returns the upper bound (in nanoseconds) of the bucket, which contains `p`-th (0..1) percentile */
+    std::uint64_t percentile(double p) const noexcept;
+};
+
+/** \struct delivery_stats_t
+ *  \brief delivery statistics of a message type or of an actor
+ */
+struct delivery_stats_t {
+    /** \brief amount of delivered messages (for message type) or handler calls (for actor) */
+    std::uint64_t count = 0;
+
+    /** \brief handlers execution time */
+    histogram_t handler_time;
+
+    /** \brief time between putting the message into the queue and its delivery */
+    histogram_t queue_wait;
+};
+
+/** \struct delivery_snapshot_t
+ *  \brief the summary of delivery statistics of all threads
+ */
+struct delivery_snapshot_t {
+    /** \brief statistics per message type, i.e. per `message_base_t::type_index` */
+    std::unordered_map<const void *, delivery_stats_t> by_type;
+
+    /** \brief statistics per recipient actor
+     *
+     * The pointers are just identities of the alive actors: the statistics
+     * of an actor are dropped upon its destruction.
+     */
+    std::unordered_map<const actor_base_t *, delivery_stats_t> by_actor;
+};
+
+/** \struct delivery_meter_t
+ *  \brief collects the statistics of the `metered_local_delivery_t` policy
+ *
+ * The metering is disabled by default; in the disabled state it costs a
+ * single relaxed atomic load per delivered message.
+ *
+ * Each thread records the statistics into its own shard, so recording does
+ * not need locks nor atomic read-modify-write operations; the shards are
+ * summed up on `snapshot()`, which can be invoked from any thread at any time.
+ *
+ */
+struct delivery_meter_t {
+    /** \brief enables or disables the metering (globally) */
+    static void enable(bool value) noexcept;
+
+    /** \brief returns `true` if the metering is enabled */
+    static inline bool enabled() noexcept { return active.load(std::memory_order_relaxed); }
+
+    /** \brief sums up the statistics of all threads */
+    static delivery_snapshot_t snapshot() noexcept;
+
+    /** \brief zeroes the statistics of all threads */
+    static void reset() noexcept;
+
+    /** \brief monotonic time in nanoseconds, used for messages stamps */
+    static inline std::uint64_t now() noexcept {
+        auto t = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t).count());
+    }
+
+    /** \brief records the message delivery into the statistics of the current thread */
+    static void record_message(const void *type_index, std::uint64_t handler_ns, std::uint64_t wait_ns,
+                               bool has_wait) noexcept;
+
+    /** \brief records the handler call into the statistics of the current thread */
+    static void record_handler(const actor_base_t *actor, std::uint64_t handler_ns, std::uint64_t wait_ns,
+                               bool has_wait) noexcept;
+
+    /** \brief drops the statistics of the actor, which is being destroyed */
+    static void forget(const actor_base_t *actor) noexcept;
+
+  private:
+    static inline std::atomic<bool> active{false};
+};
+
+} // namespace rotor
@@ -21,6 +21,12 @@ enum class error_code_t {
     actor_not_linkable,
     already_linked,
     unknown_service,
+    queue_overflow,
+    invalid_topic,
+    transport_overflow,
+    transport_mismatch,
+    transport_disconnected,
+    transport_unknown_address,
 };
 
 namespace details {
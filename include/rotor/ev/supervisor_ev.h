@@ -7,11 +7,12 @@
 //
 
 #include "rotor/supervisor.h"
+#include "rotor/inbound_queue.hpp"
 #include "rotor/ev/supervisor_config_ev.h"
 #include "rotor/ev/system_context_ev.h"
 #include "rotor/system_context.h"
 #include <ev.h>
-#include <mutex>
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 
@@ -85,6 +86,9 @@ struct supervisor_ev_t : public supervisor_t {
      */
     virtual void on_async() noexcept;
 
+    /** \brief sends wake-up notification to the locality leader, unless it is already pending */
+    void notify_leader() noexcept;
+
     /** \brief a pointer to EV event loop, copied from config */
     struct ev_loop *loop;
 
@@ -94,10 +98,7 @@ struct supervisor_ev_t : public supervisor_t {
     /** \brief ev-loop specific thread-safe wake-up notifier for external messages delivery */
     ev_async async_watcher;
 
-    /** \brief mutex for protecting inbound queue and pending flag */
-    std::mutex inbound_mutex;
-
-    /** \brief whether refcounter should be decreased
+    /** \brief whether wake-up notification has been sent and not yet handled
      *
      * Async events are "compressed" by EV, i.e. a few async sygnals can be
      * delivere as one. As we do inc/dec for atomic counter, this might be
@@ -105,12 +106,15 @@ struct supervisor_ev_t : public supervisor_t {
      * only once.
      *
      */
-    bool pending;
+    std::atomic<bool> pending;
 
     /** \brief inbound messages queue, i.e.the structure to hold messages
      * received from other supervisors / threads
+     *
+     * The queue is lock-free, so there is no contention between producers
+     * beyond a single CAS per message.
      */
-    messages_queue_t inbound;
+    inbound_queue_t inbound;
 
     /** \brief timer_id to timer map */
     timers_map_t timers_map;
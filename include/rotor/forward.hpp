@@ -7,14 +7,18 @@
 
 #include "arc.hpp"
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <cstdint>
 
 namespace rotor {
 
 struct address_t;
 struct actor_base_t;
 struct handler_base_t;
+struct message_base_t;
 struct supervisor_t;
 struct system_context_t;
+template <typename T> struct request_awaiter_t;
+template <auto... Handlers> struct handlers_table_t;
 
 using address_ptr_t = intrusive_ptr_t<address_t>;
 
@@ -24,10 +28,17 @@ using actor_ptr_t = intrusive_ptr_t<actor_base_t>;
 /** \brief intrusive pointer for handler */
 using handler_ptr_t = intrusive_ptr_t<handler_base_t>;
 
+/** \brief non-virtual handler invoker, which does not check message type */
+using handler_fn_t = void (*)(handler_base_t &, message_base_t &) noexcept;
+
 namespace pt = boost::posix_time;
 
-/** \brief timer identifier type in the scope of the actor */
-using request_id_t = std::size_t;
+/** \brief timer identifier type in the scope of the actor
+ *
+ * It is 64-bit wide on all platforms, as it encodes the slot index and the
+ * slot generation of the request map.
+ */
+using request_id_t = std::uint64_t;
 
 } // namespace rotor
 
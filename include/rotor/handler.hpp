@@ -117,11 +117,22 @@ struct handler_base_t : public arc_base_t<handler_base_t> {
     /** \brief precalculated hash for the handler */
     size_t precalc_hash;
 
+    /** \brief direct (non-virtual) invoker of the handler, if available
+     *
+     * Unlike `call`, it does not check the message type, i.e. the caller
+     * must guarantee that the message type matches the handler `message_type`,
+     * as {@link subscription_t} does.
+     */
+    handler_fn_t direct_call;
+
     /** \brief constructs `handler_base_t` from raw pointer to actor, raw
-     * pointer to message type and raw pointer to handler type
+     * pointer to message type, raw pointer to handler type and optional
+     * direct invoker
      */
-    explicit handler_base_t(actor_base_t &actor, const void *message_type_, const void *handler_type_)
-        : message_type{message_type_}, handler_type{handler_type_}, actor_ptr{&actor}, raw_actor_ptr{&actor} {
+    explicit handler_base_t(actor_base_t &actor, const void *message_type_, const void *handler_type_,
+                            handler_fn_t direct_call_ = nullptr)
+        : message_type{message_type_}, handler_type{handler_type_}, actor_ptr{&actor},
+          raw_actor_ptr{&actor}, direct_call{direct_call_} {
         auto h1 = reinterpret_cast<std::size_t>(handler_type);
         auto h2 = reinterpret_cast<std::size_t>(&actor);
         precalc_hash = h1 ^ (h2 << 1);
@@ -185,17 +196,22 @@ struct handler_t<Handler, std::enable_if_t<details::is_actor_handler_v<Handler>>
 
     /** \brief constructs handler from actor & pointer-to-member function  */
     explicit handler_t(actor_base_t &actor, Handler &&handler_)
-        : handler_base_t{actor, final_message_t::message_type, handler_type}, handler{handler_} {}
+        : handler_base_t{actor, final_message_t::message_type, handler_type, &invoke}, handler{handler_} {}
 
     void call(message_ptr_t &message) noexcept override {
-        using backend_t = typename traits::backend_t;
         if (message->type_index == final_message_t::message_type) {
-            auto final_message = static_cast<final_message_t *>(message.get());
-            auto &final_obj = static_cast<backend_t &>(*actor_ptr);
-            (final_obj.*handler)(*final_message);
+            invoke(*this, *message);
         }
     }
 
+    /** \brief invokes the handler without message type check */
+    static void invoke(handler_base_t &self, message_base_t &message) noexcept {
+        using backend_t = typename traits::backend_t;
+        auto &me = static_cast<handler_t &>(self);
+        auto &final_obj = static_cast<backend_t &>(*me.actor_ptr);
+        (final_obj.*me.handler)(static_cast<final_message_t &>(message));
+    }
+
   private:
     using traits = handler_traits<Handler>;
     using final_message_t = typename traits::message_t;
@@ -221,18 +237,24 @@ struct handler_t<Handler, std::enable_if_t<details::is_plugin_handler_v<Handler>
 
     /** \brief ctor form plugin and plugin handler (pointer-to-member function of the plugin) */
     explicit handler_t(plugin::plugin_base_t &plugin_, Handler &&handler_)
-        : handler_base_t{*plugin_.access<details::to::actor>(), final_message_t::message_type, handler_type},
+        : handler_base_t{*plugin_.access<details::to::actor>(), final_message_t::message_type, handler_type,
+                         &invoke},
           plugin{plugin_}, handler{handler_} {}
 
     void call(message_ptr_t &message) noexcept override {
-        using backend_t = typename traits::backend_t;
         if (message->type_index == final_message_t::message_type) {
-            auto final_message = static_cast<final_message_t *>(message.get());
-            auto &final_obj = static_cast<backend_t &>(plugin);
-            (final_obj.*handler)(*final_message);
+            invoke(*this, *message);
         }
     }
 
+    /** \brief invokes the handler without message type check */
+    static void invoke(handler_base_t &self, message_base_t &message) noexcept {
+        using backend_t = typename traits::backend_t;
+        auto &me = static_cast<handler_t &>(self);
+        auto &final_obj = static_cast<backend_t &>(me.plugin);
+        (final_obj.*me.handler)(static_cast<final_message_t &>(message));
+    }
+
   private:
     using traits = handler_traits<Handler>;
     using final_message_t = typename traits::message_t;
@@ -259,16 +281,21 @@ struct handler_t<lambda_holder_t<Handler, M>,
 
     /** \brief constructs handler from actor & lambda wrapper */
     explicit handler_t(actor_base_t &actor, handler_backend_t &&handler_)
-        : handler_base_t{actor, final_message_t::message_type, handler_type}, handler{std::forward<handler_backend_t>(
-                                                                                  handler_)} {}
+        : handler_base_t{actor, final_message_t::message_type, handler_type, &invoke},
+          handler{std::forward<handler_backend_t>(handler_)} {}
 
     void call(message_ptr_t &message) noexcept override {
         if (message->type_index == final_message_t::message_type) {
-            auto final_message = static_cast<final_message_t *>(message.get());
-            handler.fn(*final_message);
+            invoke(*this, *message);
         }
     }
 
+    /** \brief invokes the handler without message type check */
+    static void invoke(handler_base_t &self, message_base_t &message) noexcept {
+        auto &me = static_cast<handler_t &>(self);
+        me.handler.fn(static_cast<final_message_t &>(message));
+    }
+
   private:
     using final_message_t = typename handler_backend_t::message_t;
 };
@@ -278,6 +305,26 @@ const void *handler_t<lambda_holder_t<Handler, M>,
                       std::enable_if_t<details::is_lambda_handler_v<lambda_holder_t<Handler, M>>>>::handler_type =
     static_cast<const void *>(typeid(Handler).name());
 
+/** \struct handlers_table_t
+ *  \brief compile-time set of actor handlers (pointers to member functions)
+ *
+ * Most actors have fixed set of handlers, which can be declared once per actor type, i.e.
+ *
+ * ~~~{.cpp}
+ * using handlers_table_t = rotor::handlers_table_t<&my_actor_t::on_ping, &my_actor_t::on_pong>;
+ * ~~~
+ *
+ * and then subscribed at once via `starter_plugin_t::subscribe_actor(handlers_table_t{})`.
+ *
+ */
+template <auto... Handlers> struct handlers_table_t {
+    static_assert(sizeof...(Handlers) > 0, "handlers table should not be empty");
+    static_assert((details::is_actor_handler_v<decltype(Handlers)> && ...), "only actor handlers are allowed");
+
+    /** \brief amount of handlers in the table */
+    static constexpr std::size_t size = sizeof...(Handlers);
+};
+
 } // namespace rotor
 
 namespace std {
@@ -0,0 +1,96 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "message.h"
+#include <atomic>
+
+namespace rotor {
+
+/** \struct inbound_queue_t
+ *  \brief lock-free multi-producer single-consumer queue of messages
+ *
+ * The queue is intended for messages delivery from other threads (localities)
+ * into the locality leader, i.e. as the backing structure of `supervisor_t::enqueue`.
+ *
+ * Messages are linked intrusively via `message_base_t::next_inbound`, so
+ * pushing a message does not allocate. Producers push with a single CAS, while
+ * the consumer takes the whole batch at once with a single exchange and
+ * restores the FIFO order.
+ *
+ * The `push` reports whether the queue was empty before, which allows to
+ * wake up the consumer (e.g. `ev_async_send`) only once per batch.
+ *
+ * A message can be in a single inbound queue at a time.
+ *
+ */
+struct inbound_queue_t {
+    inbound_queue_t() noexcept : head{nullptr} {}
+    inbound_queue_t(const inbound_queue_t &) = delete;
+    inbound_queue_t(inbound_queue_t &&) = delete;
+
+    /** \brief releases not-yet-consumed messages */
+    ~inbound_queue_t() {
+        auto top = head.exchange(nullptr, std::memory_order_acquire);
+        while (top) {
+            auto next = top->next_inbound;
+            top->next_inbound = nullptr;
+            intrusive_ptr_release(top);
+            top = next;
+        }
+    }
+
+    /** \brief appends message to the queue (thread-safe)
+     *
+     * The message is marked as shared (see `message_base_t::share`), as it is
+     * going to be used by the consumer thread.
+     *
+     * Returns `true` if the queue was empty, i.e. the consumer should be notified.
+     */
+    bool push(message_ptr_t message) noexcept {
+        message->share();
+        auto raw = message.detach();
+        auto top = head.load(std::memory_order_relaxed);
+        do {
+            raw->next_inbound = top;
+        } while (!head.compare_exchange_weak(top, raw, std::memory_order_release, std::memory_order_relaxed));
+        return top == nullptr;
+    }
+
+    /** \brief moves all queued messages in FIFO order to the back of `queue`
+     *
+     * Should be invoked only from the consumer thread. Returns the amount
+     * of moved messages.
+     */
+    template <typename Queue> std::size_t drain(Queue &queue) {
+        auto top = head.exchange(nullptr, std::memory_order_acquire);
+        message_base_t *reversed = nullptr;
+        std::size_t count = 0;
+        while (top) {
+            auto next = top->next_inbound;
+            top->next_inbound = reversed;
+            reversed = top;
+            top = next;
+            ++count;
+        }
+        while (reversed) {
+            auto next = reversed->next_inbound;
+            reversed->next_inbound = nullptr;
+            queue.emplace_back(message_ptr_t{reversed, false});
+            reversed = next;
+        }
+        return count;
+    }
+
+    /** \brief returns `true` if there are no messages in the queue */
+    bool empty() const noexcept { return head.load(std::memory_order_acquire) == nullptr; }
+
+  private:
+    std::atomic<message_base_t *> head;
+};
+
+} // namespace rotor
@@ -8,11 +8,39 @@
 
 #include "arc.hpp"
 #include "address.hpp"
+#include "message_pool.h"
+#include <atomic>
+#include <cstdint>
 #include <typeindex>
-#include <deque>
+#include <new>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace rotor {
 
+/** \brief the lane of the supervisor queue, the lanes are listed in priority order
+ *
+ * See {@link messages_queue_t}.
+ */
+enum class message_lane_t : std::uint8_t {
+    /** \brief rotor lifecycle messages (e.g. init, start, shutdown, subscriptions, links) and error responses */
+    system = 0,
+
+    /** \brief user messages, which should be processed before the regular ones */
+    high,
+
+    /** \brief regular user messages (default) */
+    normal,
+
+    /** \brief user messages, which can be delayed in favor of the regular ones */
+    bulk,
+};
+
+/** \brief the total amount of {@link message_lane_t} lanes */
+constexpr std::size_t message_lanes_count = 4;
+
 /** \struct message_base_t
  *  \brief Base class for `rotor` message.
  *
@@ -21,8 +49,14 @@ namespace rotor {
  *
  * The actual message payload meant to be provided by derived classes
  *
+ * The message uses hybrid reference counter: while the message is used within
+ * the single locality (i.e. by the single thread), the counter is updated without
+ * atomic read-modify-write operations. When the message crosses locality boundary
+ * (i.e. it is handed over to the supervisor of other locality), it is marked as
+ * shared, and since then the counter is updated atomically.
+ *
  */
-struct message_base_t : public arc_base_t<message_base_t> {
+struct message_base_t {
     virtual ~message_base_t();
 
     /**
@@ -37,12 +71,226 @@ struct message_base_t : public arc_base_t<message_base_t> {
     /** \brief message destination address */
     address_ptr_t address;
 
-    /** \brief constructor which takes destination address */
-    message_base_t(const void *type_index_, const address_ptr_t &addr) : type_index{type_index_}, address{addr} {}
+    /** \brief intrusive link, used by {@link inbound_queue_t} only */
+    message_base_t *next_inbound = nullptr;
+
+    /** \brief the time (in nanoseconds) the message was put into the queue
+     *
+     * It is set only when {@link delivery_meter_t} is enabled, otherwise it is zero.
+     */
+    std::uint64_t stamp = 0;
+
+    /** \brief the supervisor queue lane of the message (see {@link payload_lane_t}) */
+    message_lane_t lane;
+
+    /** \brief constructor which takes destination address and, optionally, the queue lane */
+    message_base_t(const void *type_index_, const address_ptr_t &addr,
+                   message_lane_t lane_ = message_lane_t::normal)
+        : type_index{type_index_}, address{addr}, lane{lane_} {}
+
+    /** \brief allocates memory for a message via {@link message_pool_t} */
+    static void *operator new(std::size_t size) { return message_pool_t::allocate(size); }
+
+    /** \brief returns memory of the destroyed message into {@link message_pool_t}
+     *
+     * As the destructor is virtual, the `size` is the size of the final message type.
+     */
+    static void operator delete(void *ptr, std::size_t size) noexcept { message_pool_t::deallocate(ptr, size); }
+
+    /** \brief over-aligned messages bypass the pool */
+    static void *operator new(std::size_t size, std::align_val_t align) { return ::operator new(size, align); }
+
+    /** \brief over-aligned messages bypass the pool */
+    static void operator delete(void *ptr, std::size_t size, std::align_val_t align) noexcept {
+        ::operator delete(ptr, size, align);
+    }
+
+    /** \brief returns `true` if the message is subject of the supervisor queue capacity
+     *
+     * See {@link bounded_payload_t}.
+     */
+    virtual bool is_bounded() const noexcept { return false; }
+
+    /** \brief makes the error response for the request message, which was rejected due
+     * to the queue overflow; returns empty pointer for non-request messages
+     */
+    virtual intrusive_ptr_t<message_base_t> make_overflow_response(const std::error_code &) noexcept { return {}; }
+
+    /** \brief marks the message as shared between threads, i.e. further reference
+     * counting is performed atomically
+     *
+     * It should be invoked, while the message is still exclusively owned by the
+     * current thread. Messages, referenced by the payload, are marked too (see
+     * {@link payload_sharing_t}).
+     */
+    virtual void share() noexcept {
+        if (!shared.load(std::memory_order_relaxed)) {
+            shared.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    /** \brief returns `true` if the message has been marked as shared between threads */
+    bool is_shared() const noexcept { return shared.load(std::memory_order_relaxed); }
+
+    /** \brief returns the current value of the reference counter */
+    unsigned int use_count() const noexcept { return counter.load(std::memory_order_relaxed); }
+
+#if defined(ROTOR_DEBUG_REFCOUNT)
+    /** \brief the amount of messages reference counter updates in the current thread */
+    static inline thread_local std::size_t refcount_ops = 0;
+#endif
+
+    /** \brief increments reference counter */
+    friend inline void intrusive_ptr_add_ref(const message_base_t *message) noexcept {
+#if defined(ROTOR_DEBUG_REFCOUNT)
+        ++refcount_ops;
+#endif
+        auto &counter = message->counter;
+#ifndef ROTOR_REFCOUNT_THREADUNSAFE
+        if (message->shared.load(std::memory_order_relaxed)) {
+            counter.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+#endif
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /** \brief decrements reference counter and destroys the message if it was the last reference */
+    friend inline void intrusive_ptr_release(const message_base_t *message) noexcept {
+#if defined(ROTOR_DEBUG_REFCOUNT)
+        ++refcount_ops;
+#endif
+        auto &counter = message->counter;
+#ifndef ROTOR_REFCOUNT_THREADUNSAFE
+        if (message->shared.load(std::memory_order_relaxed)) {
+            if (counter.fetch_sub(1, std::memory_order_release) == 1) {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                delete message;
+            }
+            return;
+        }
+#endif
+        auto value = counter.load(std::memory_order_relaxed) - 1;
+        counter.store(value, std::memory_order_relaxed);
+        if (value == 0) {
+            delete message;
+        }
+    }
+
+  private:
+    mutable std::atomic<unsigned int> counter{0};
+    std::atomic<bool> shared{false};
 };
 
 inline message_base_t::~message_base_t() {}
 
+namespace details {
+
+/* tag of the default (not customized) payload sharing */
+struct default_payload_sharing_t {};
+
+/* the fields limit of the aggregate payloads inspection */
+constexpr std::size_t payload_fields_limit = 32;
+
+/* converts to any type, probes aggregate initialization */
+template <std::size_t> struct any_field_t {
+    template <typename U> operator U() const noexcept;
+};
+
+/* converts only to intrusive pointers to messages; it is not copyable to
+ * avoid false positives with the members, constructible from any value */
+struct message_field_t {
+    message_field_t() = default;
+    message_field_t(const message_field_t &) = delete;
+    template <typename M, typename = std::enable_if_t<std::is_base_of_v<message_base_t, M>>>
+    operator intrusive_ptr_t<M>() const noexcept;
+};
+
+template <typename T, typename Fields, typename = void> struct is_initializable : std::false_type {};
+template <typename T, typename... Fields>
+struct is_initializable<T, std::tuple<Fields...>, std::void_t<decltype(T{Fields{}...})>> : std::true_type {};
+
+template <typename T, std::size_t... I> constexpr std::size_t fields_count(std::index_sequence<I...>) noexcept {
+    constexpr auto count = sizeof...(I);
+    if constexpr (count < payload_fields_limit) {
+        if constexpr (is_initializable<T, std::tuple<any_field_t<I>..., any_field_t<count>>>::value) {
+            return fields_count<T>(std::make_index_sequence<count + 1>{});
+        }
+    }
+    return count;
+}
+
+template <typename T, std::size_t Probe, std::size_t... I>
+constexpr bool has_message_field_at(std::index_sequence<I...>) noexcept {
+    return is_initializable<T, std::tuple<std::conditional_t<I == Probe, message_field_t, any_field_t<I>>...>>::value;
+}
+
+template <typename T, std::size_t... I> constexpr bool has_message_field(std::index_sequence<I...>) noexcept {
+    return (has_message_field_at<T, I>(std::index_sequence<I...>{}) || ...);
+}
+
+template <typename T> constexpr bool references_messages() noexcept {
+    if constexpr (std::is_aggregate_v<T> && !std::is_array_v<T>) {
+        constexpr auto count = fields_count<T>(std::index_sequence<>{});
+        return has_message_field<T>(std::make_index_sequence<count>{});
+    } else {
+        return false;
+    }
+}
+
+} // namespace details
+
+/** \brief `true` if the aggregate payload `T` has direct intrusive pointer to message members
+ *
+ * The detection is limited: the nested members (e.g. containers of messages or the
+ * members of the members) and the members of non-aggregate payloads are not detected.
+ */
+template <typename T> inline constexpr bool payload_references_messages_v = details::references_messages<T>();
+
+/** \brief marks messages, referenced by the payload `T`, as shared between threads
+ *
+ * The default implementation does nothing. It should be specialized for the
+ * payloads, which hold intrusive pointers to other messages, as they cross
+ * locality boundary together with the message, otherwise the reference counter
+ * of the referenced message is updated non-atomically from different threads.
+ *
+ * The direct intrusive pointer to message members of aggregate payloads are
+ * detected at compile time (see {@link payload_references_messages_v}), and the
+ * `message_t` of such payload does not compile, unless the trait is specialized
+ * (or `ROTOR_SKIP_SHARING_CHECK` is defined).
+ */
+template <typename T> struct payload_sharing_t : details::default_payload_sharing_t {
+    /** \brief no referenced messages, nothing to do */
+    static void share(T &) noexcept {}
+};
+
+/** \brief whether the messages with the payload `T` are subject of the supervisor queue capacity
+ *
+ * All user messages and requests are bounded, while rotor-internal messages and
+ * responses are not, i.e. they are always enqueued.
+ */
+template <typename T> struct bounded_payload_t : std::true_type {};
+
+/** \brief helper to specialize {@link payload_lane_t} */
+template <message_lane_t Lane> using lane_constant_t = std::integral_constant<message_lane_t, Lane>;
+
+/** \brief the supervisor queue lane of the messages with the payload `T`
+ *
+ * All user messages go to the `normal` lane by default, while rotor lifecycle
+ * messages go to the `system` lane. Specialize the trait to change the lane
+ * of the user messages.
+ */
+template <typename T> struct payload_lane_t : lane_constant_t<message_lane_t::normal> {};
+
+/** \brief builds the error response for the rejected request message (none for non-requests) */
+template <typename T> struct overflow_response_t {
+    /** \brief returns empty pointer, as the message is not a request */
+    template <typename Message>
+    static intrusive_ptr_t<message_base_t> make(Message &, const std::error_code &) noexcept {
+        return {};
+    }
+};
+
 /** \struct message_t
  *  \brief the generic message meant to hold user-specific payload
  *  \tparam T payload type
@@ -55,11 +303,34 @@ template <typename T> struct message_t : public message_base_t {
     /** \brief forwards `args` for payload construction */
     template <typename... Args>
     message_t(const address_ptr_t &addr, Args &&... args)
-        : message_base_t{message_type, addr}, payload{std::forward<Args>(args)...} {}
+        : message_base_t{message_type, addr, payload_lane_t<T>::value}, payload{std::forward<Args>(args)...} {}
+
+    /** \brief puts the message into the `lane_` instead of the payload one, forwards `args` for payload construction */
+    template <typename... Args>
+    message_t(message_lane_t lane_, const address_ptr_t &addr, Args &&... args)
+        : message_base_t{message_type, addr, lane_}, payload{std::forward<Args>(args)...} {}
+
+#if !defined(ROTOR_SKIP_SHARING_CHECK)
+    static_assert(!payload_references_messages_v<T> ||
+                      !std::is_base_of_v<details::default_payload_sharing_t, payload_sharing_t<T>>,
+                  "the payload holds intrusive pointers to messages, which cross locality boundary "
+                  "together with it; specialize payload_sharing_t for the payload type");
+#endif
 
     /** \brief user-defined payload */
     T payload;
 
+    bool is_bounded() const noexcept override { return bounded_payload_t<T>::value; }
+
+    intrusive_ptr_t<message_base_t> make_overflow_response(const std::error_code &ec) noexcept override {
+        return overflow_response_t<T>::make(*this, ec);
+    }
+
+    void share() noexcept override {
+        message_base_t::share();
+        payload_sharing_t<T>::share(payload);
+    }
+
     /** \brief static type which uniquely identifies payload-type specialized `message_t` */
     static const void *message_type;
 };
@@ -67,9 +338,6 @@ template <typename T> struct message_t : public message_base_t {
 /** \brief intrusive pointer for message */
 using message_ptr_t = intrusive_ptr_t<message_base_t>;
 
-/** \brief structure to hold messages (intrusive pointers) */
-using messages_queue_t = std::deque<message_ptr_t>;
-
 template <typename T> const void *message_t<T>::message_type = static_cast<const void *>(typeid(message_t<T>).name());
 
 /** \brief constucts message by constructing it's payload; intrusive pointer for the message is returned */
@@ -77,4 +345,10 @@ template <typename M, typename... Args> auto make_message(const address_ptr_t &a
     return message_ptr_t{new message_t<M>(addr, std::forward<Args>(args)...)};
 }
 
+/** \brief constucts message in the specified queue lane; intrusive pointer for the message is returned */
+template <typename M, typename... Args>
+auto make_message(message_lane_t lane, const address_ptr_t &addr, Args &&... args) -> message_ptr_t {
+    return message_ptr_t{new message_t<M>(lane, addr, std::forward<Args>(args)...)};
+}
+
 } // namespace rotor
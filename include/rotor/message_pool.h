@@ -0,0 +1,61 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include <cstddef>
+
+namespace rotor {
+
+/** \struct message_pool_t
+ *  \brief recycles memory blocks of destroyed messages
+ *
+ * Messages are created and destroyed at very high rate, i.e. at least once
+ * per `send`. To avoid global heap on the hot path, the memory blocks of
+ * destroyed messages are kept in thread-local free-lists, grouped by size
+ * class (the message size is rounded up to `granularity`), and then reused
+ * for new messages of the same size class.
+ *
+ * As locality is always executed on a single thread, the pool is
+ * effectively per-locality. A message can be destroyed on different thread
+ * than it was created (e.g. it was sent to a supervisor of different locality);
+ * that is fine, the block just migrates into the free-list of the destroying
+ * thread.
+ *
+ * The amount of cached blocks per size class per thread is limited by
+ * `capacity`; when the free-list is full, or when the message is larger than
+ * `max_block_size`, the block is returned to the global heap. The zero
+ * capacity effectively disables the pool.
+ *
+ */
+struct message_pool_t {
+    /** \brief size classes step (and the minimal allocation size) */
+    static constexpr std::size_t granularity = 16;
+
+    /** \brief messages larger than that are always allocated on global heap */
+    static constexpr std::size_t max_block_size = 512;
+
+    /** \brief the default maximum amount of cached blocks per size class per thread */
+    static constexpr std::size_t default_capacity = 1024;
+
+    /** \brief returns memory block, suitable for holding an object of the `size` */
+    static void *allocate(std::size_t size);
+
+    /** \brief returns memory block back into the pool or into global heap */
+    static void deallocate(void *ptr, std::size_t size) noexcept;
+
+    /** \brief sets maximum amount of cached blocks per size class per thread
+     *
+     * The new capacity is applied for all threads; already cached blocks
+     * are not released.
+     */
+    static void set_capacity(std::size_t value) noexcept;
+
+    /** \brief returns maximum amount of cached blocks per size class per thread */
+    static std::size_t get_capacity() noexcept;
+};
+
+} // namespace rotor
@@ -8,10 +8,13 @@
 
 #include "address.hpp"
 #include "message.h"
+#include "policy.h"
 #include "state.h"
 #include "request.hpp"
 #include "subscription_point.h"
 #include "forward.hpp"
+#include <boost/container/small_vector.hpp>
+#include <vector>
 
 namespace rotor {
 
@@ -59,6 +62,21 @@ struct create_actor_t {
     pt::time_duration timeout;
 };
 
+/** \struct create_actors_t
+ *  \brief Message with this payload is sent to supervisor when a group of
+ * homogeneous actors is created at once.
+ *
+ * All actors of the group are initialized under the single shared timeout.
+ *
+ */
+struct create_actors_t {
+    /** \brief the intrusive pointers to created actors */
+    std::vector<actor_ptr_t> actors;
+
+    /** \brief maximum time for initialization of all actors of the group */
+    pt::time_duration timeout;
+};
+
 /** \struct shutdown_trigger_t
  *  \brief Message with this payload is sent to ask an actor's supervisor
  * to initate shutdown procedure.
@@ -97,12 +115,19 @@ struct shutdown_request_t {
  *
  */
 struct handler_call_t {
+    /** \brief handlers list, the single handler is stored inline */
+    using handlers_t = boost::container::small_vector<handler_ptr_t, 1>;
+
     /** \brief The original message (intrusive pointer) sent to an address */
     message_ptr_t orig_message;
 
-    /** \brief The handler (intrusive pointer) on some external supervisor,
-     * which can process the original message */
-    handler_ptr_t handler;
+    /** \brief The handlers (intrusive pointers) on some external supervisor,
+     * which can process the original message
+     *
+     * All the handlers belong to the same supervisor, i.e. there is a single
+     * call envelope per supervisor, no matter how many subscribers it has.
+     */
+    handlers_t handlers{};
 };
 
 /** \struct external_subscription_t
@@ -308,8 +333,81 @@ struct unlink_request_t {
     address_ptr_t server_addr;
 };
 
+/** \struct backpressure_t
+ *  \brief supervisor notifies that the locality queue is full and messages are dropped
+ *
+ * The message is sent to the locality leader address once per overflow episode,
+ * i.e. it is sent again only after the queue was drained down to the half of
+ * its capacity. Actors, which are interested in the notification, should
+ * subscribe to it on the locality leader address (see
+ * `supervisor_t::get_leader_address`), including the actors of other localities,
+ * which send messages to the overflowing one.
+ */
+struct backpressure_t {
+    /** \brief the address of the locality leader, which queue is full */
+    address_ptr_t leader_addr;
+
+    /** \brief the applied overflow policy */
+    overflow_policy_t policy;
+};
+
 } // namespace payload
 
+/* rotor-internal messages are never dropped due to the queue overflow */
+template <> struct bounded_payload_t<payload::initialize_actor_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::start_actor_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::create_actor_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::create_actors_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::shutdown_trigger_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::shutdown_request_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::handler_call_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::external_subscription_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::subscription_confirmation_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::external_unsubscription_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::commit_unsubscription_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::unsubscription_confirmation_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::state_request_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::registration_request_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::deregistration_notify_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::deregistration_service_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::discovery_request_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::discovery_promise_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::discovery_cancel_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::link_request_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::unlink_notify_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::unlink_request_t> : std::false_type {};
+template <> struct bounded_payload_t<payload::backpressure_t> : std::false_type {};
+
+/* rotor lifecycle messages are delivered before the user messages */
+template <> struct payload_lane_t<payload::initialize_actor_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::start_actor_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::create_actor_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::create_actors_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::shutdown_trigger_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::shutdown_request_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::external_subscription_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::subscription_confirmation_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::external_unsubscription_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::commit_unsubscription_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::unsubscription_confirmation_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::state_request_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::registration_request_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::deregistration_notify_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::deregistration_service_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::discovery_request_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::discovery_promise_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::discovery_cancel_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::link_request_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::unlink_notify_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::unlink_request_t> : lane_constant_t<message_lane_t::system> {};
+template <> struct payload_lane_t<payload::backpressure_t> : lane_constant_t<message_lane_t::system> {};
+
+/** \brief the original message crosses locality boundary together with the call envelope */
+template <> struct payload_sharing_t<payload::handler_call_t> {
+    /** \brief marks the original message as shared */
+    static void share(payload::handler_call_t &payload) noexcept { payload.orig_message->share(); }
+};
+
 /// namespace for rotor core messages (which just transform payloads)
 namespace message {
 
@@ -352,6 +450,9 @@ using shutdown_response_t = request_traits_t<payload::shutdown_request_t>::respo
 /** \brief supervisor's message upon actor instantiation */
 using create_actor_t = message_t<payload::create_actor_t>;
 
+/** \brief supervisor's message upon actors group instantiation */
+using create_actors_t = message_t<payload::create_actors_t>;
+
 // registry-related
 /** \brief name/address registration request */
 using registration_request_t = request_traits_t<payload::registration_request_t>::request::message_t;
@@ -390,6 +491,8 @@ using unlink_response_t = request_traits_t<payload::unlink_request_t>::response:
 using state_request_t = request_traits_t<payload::state_request_t>::request::message_t;
 /** \brief actor state response */
 using state_response_t = request_traits_t<payload::state_request_t>::response::message_t;
+/** \brief locality queue overflow notification */
+using backpressure_t = message_t<payload::backpressure_t>;
 
 } // namespace message
 
@@ -0,0 +1,173 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "message.h"
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+
+namespace rotor {
+
+/** \brief weights of `high`, `normal` and `bulk` lanes of {@link messages_queue_t} */
+using lane_weights_t = std::array<std::uint32_t, message_lanes_count - 1>;
+
+/** \struct messages_queue_t
+ *  \brief the supervisor messages queue with priority lanes
+ *
+ * Each message is put into its lane (see {@link payload_lane_t}). The `system`
+ * lane is always drained first, i.e. the lifecycle messages (e.g. shutdown requests
+ * or unlink notifications) are not stuck behind the user messages. The other lanes
+ * are drained in weighted round-robin manner: up to `weight` messages are taken
+ * from a lane in a row, then the next non-empty lane is served.
+ *
+ * Within the lane the messages are delivered in FIFO order. Unless the lanes are
+ * enabled via `set_weights`, all messages go into the single lane, i.e. the queue
+ * is plain FIFO.
+ *
+ */
+struct messages_queue_t {
+    /** \brief the FIFO queue of the single lane (type) */
+    using lane_queue_t = std::deque<message_ptr_t>;
+
+    /** \brief the default weights of `high`, `normal` and `bulk` lanes */
+    static constexpr lane_weights_t default_weights = {8, 4, 1};
+
+    /** \brief enables the lanes with the specified weights; all-zeroes weights disable the lanes
+     *
+     * Zero weight of an individual lane is treated as one. The method should be invoked
+     * only when the queue is empty.
+     */
+    void set_weights(const lane_weights_t &weights_) noexcept {
+        enabled = false;
+        for (std::size_t i = 0; i < weights_.size(); ++i) {
+            enabled = enabled || weights_[i];
+            weights[i + 1] = weights_[i] ? weights_[i] : 1;
+        }
+        current = system_lane + 1;
+        credit = weights[current];
+    }
+
+    /** \brief returns `true` if the messages are distributed among the lanes */
+    inline bool has_lanes() const noexcept { return enabled; }
+
+    /** \brief enqueues the message into its lane */
+    inline void emplace_back(message_ptr_t &&message) noexcept {
+        auto lane = enabled ? static_cast<std::size_t>(message->lane) : default_lane;
+        lanes[lane].emplace_back(std::move(message));
+        last = lane;
+        ++count;
+    }
+
+    /** \brief returns the next message to be delivered */
+    inline message_ptr_t &front() noexcept { return lanes[enabled ? pick() : default_lane].front(); }
+
+    /** \brief removes the next message to be delivered */
+    inline void pop_front() noexcept {
+        auto lane = enabled ? pick() : default_lane;
+        lanes[lane].pop_front();
+        --count;
+        if (lane == last && lanes[lane].empty()) {
+            last = no_lane;
+        }
+        if (!enabled) {
+            return;
+        }
+        if (lane != system_lane) {
+            --credit;
+        }
+    }
+
+    /** \brief returns the most recently enqueued message
+     *
+     * The message should be still in the queue, i.e. neither delivered nor
+     * taken back via `pop_back`.
+     */
+    inline message_ptr_t &back() noexcept {
+        assert(last != no_lane && "the most recent message is in the queue");
+        return lanes[last].back();
+    }
+
+    /** \brief removes the most recently enqueued message
+     *
+     * Only the single (most recent) message can be taken back; the next `pop_back`
+     * is possible only after the next `emplace_back`.
+     */
+    inline void pop_back() noexcept {
+        assert(last != no_lane && "the most recent message is in the queue");
+        lanes[last].pop_back();
+        last = no_lane;
+        --count;
+    }
+
+    /** \brief returns the total amount of messages in all lanes */
+    inline std::size_t size() const noexcept { return count; }
+
+    /** \brief returns `true` if there are no messages in all lanes */
+    inline bool empty() const noexcept { return count == 0; }
+
+    /** \brief removes all messages */
+    inline void clear() noexcept {
+        for (auto &queue : lanes) {
+            queue.clear();
+        }
+        last = no_lane;
+        count = 0;
+    }
+
+    /** \brief returns the messages of the lane */
+    inline lane_queue_t &lane(message_lane_t lane) noexcept { return lanes[static_cast<std::size_t>(lane)]; }
+
+    /** \brief removes the first message, which matches the predicate, starting from the lowest priority lane
+     *
+     * Returns `true` if a message was removed.
+     */
+    template <typename Predicate> bool erase_first(Predicate &&predicate) noexcept {
+        for (auto i = lanes.size(); i > 0; --i) {
+            auto &queue = lanes[i - 1];
+            for (auto it = queue.begin(); it != queue.end(); ++it) {
+                if (predicate(*it)) {
+                    if (i - 1 == last && std::next(it) == queue.end()) {
+                        last = no_lane;
+                    }
+                    queue.erase(it);
+                    --count;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+  private:
+    static constexpr std::size_t system_lane = static_cast<std::size_t>(message_lane_t::system);
+    static constexpr std::size_t default_lane = static_cast<std::size_t>(message_lane_t::normal);
+    static constexpr std::size_t no_lane = message_lanes_count;
+
+    /* returns the lane of the next message, the queue should not be empty */
+    inline std::size_t pick() noexcept {
+        if (!lanes[system_lane].empty()) {
+            return system_lane;
+        }
+        while (!credit || lanes[current].empty()) {
+            current = current + 1 < message_lanes_count ? current + 1 : system_lane + 1;
+            credit = weights[current];
+        }
+        return current;
+    }
+
+    std::array<lane_queue_t, message_lanes_count> lanes;
+    std::array<std::uint32_t, message_lanes_count> weights = {0, 1, 1, 1};
+    std::size_t count = 0;
+    std::size_t current = default_lane;
+    std::size_t last = no_lane;
+    std::uint32_t credit = 1;
+    bool enabled = false;
+};
+
+} // namespace rotor
@@ -35,6 +35,13 @@ struct child_manager_plugin_t : public plugin_base_t {
     /** \brief pre-initializes child and sends create_child message to the supervisor */
     virtual void create_child(const actor_ptr_t &actor) noexcept;
 
+    /** \brief pre-initializes children group and sends single create_actors message to the supervisor
+     *
+     * The children are expected to be homogeneous, i.e. the init timeout of the first one
+     * is used as the shared init timeout of the whole group.
+     */
+    virtual void create_children(std::vector<actor_ptr_t> &&children) noexcept;
+
     /** \brief removes the child from the supervisor
      *
      * If there was an error, the supervisor might trigger shutdown self (in accordance with policy)
@@ -52,6 +59,9 @@ struct child_manager_plugin_t : public plugin_base_t {
     /** \brief sends initialization request upon actor creation message */
     virtual void on_create(message::create_actor_t &message) noexcept;
 
+    /** \brief sends initialization requests, guarded by the single shared timer, upon actors group creation */
+    virtual void on_create_group(message::create_actors_t &message) noexcept;
+
     /** \brief reaction on (maybe unsuccessful) init confirmatinon
      *
      * Possibilities:
@@ -119,6 +129,10 @@ struct child_manager_plugin_t : public plugin_base_t {
     using initializing_actors_t = std::unordered_set<address_ptr_t>;
 
     bool postponed_init = false;
+
+    /** \brief amount of children, which are not confirmed initialization yet */
+    std::size_t uninitialized = 0;
+
     /** \brief local address to local actor (intrusive pointer) mapping */
     actors_map_t actors_map;
 };
@@ -7,6 +7,7 @@
 //
 
 #include "plugin_base.h"
+#include "../messages_queue.h"
 #include <string>
 
 namespace rotor::plugin {
@@ -28,6 +29,13 @@ struct local_delivery_t {
      */
 
     static void delivery(message_ptr_t &message, const subscription_t::joint_handlers_t &local_recipients) noexcept;
+
+    /** \brief forwards the message to the external handlers
+     *
+     * The external handlers are grouped by their supervisors (see `subscription_t`),
+     * so a single {@link payload::handler_call_t} is enqueued per supervisor.
+     */
+    static void forward(message_ptr_t &message, const subscription_t::handlers_t &external) noexcept;
 };
 
 /** \struct inspected_local_delivery_t
@@ -42,6 +50,26 @@ struct inspected_local_delivery_t {
     static void delivery(message_ptr_t &message, const subscription_t::joint_handlers_t &local_recipients) noexcept;
 };
 
+/** \struct metered_local_delivery_t
+ *
+ * \brief local message delivery implementation, which collects statistics
+ *
+ * When {@link delivery_meter_t} is enabled, the amount of delivered messages,
+ * the handlers execution time and the queue wait time (i.e. since the message was
+ * put into the queue and till its delivery) are recorded per message type and
+ * per recipient actor. Otherwise it is the same as `local_delivery_t`.
+ *
+ * The messages forwarded to the foreign supervisors are not timed by the
+ * sender side.
+ *
+ * To use it, the `plugin::delivery_plugin_t<plugin::metered_local_delivery_t>`
+ * should be specified in the supervisor's `plugins_list_t`.
+ */
+struct metered_local_delivery_t {
+    /** \brief delivers the message to the recipients, possibly metering it */
+    static void delivery(message_ptr_t &message, const subscription_t::joint_handlers_t &local_recipients) noexcept;
+};
+
 #if defined(NDEBUG) || defined(ROTOR_DEBUG_DELIVERY)
 using default_local_delivery_t = local_delivery_t;
 #else
@@ -65,6 +93,9 @@ struct delivery_plugin_base_t : public plugin_base_t {
     /** \brief non-owning raw pointer of supervisor's messages queue */
     messages_queue_t *queue = nullptr;
 
+    /** \brief non-owning raw pointer to the locality leader (owner of the queue and budget) */
+    supervisor_t *leader = nullptr;
+
     /** \brief non-owning raw pointer to supervisor's main address */
     address_t *address = nullptr;
 
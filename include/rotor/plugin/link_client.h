@@ -73,6 +73,13 @@ struct link_client_plugin_t : public plugin_base_t {
     /** \brief continues previously suspended unlink request */
     void forget_link(message::unlink_request_t &message) noexcept;
 
+    /** \brief confirms the unlink request and forgets the server, the actor is not shut down
+     *
+     * It is intended for the unlink reactions of the actors, which just track
+     * the server lifetime, i.e. which do not depend on the server.
+     */
+    void detach_link(message::unlink_request_t &message) noexcept;
+
   private:
     enum class link_state_t { LINKING, OPERATIONAL, UNLINKING };
     struct server_record_t {
@@ -10,6 +10,7 @@
 #include "link_client.h"
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace rotor::plugin {
 
@@ -25,6 +26,17 @@ namespace rotor::plugin {
  * no reverse operation during shutdown phase, because unlinking will be handled
  * by {@link plugin::link_client_plugin_t} plugin.
  *
+ * If the registry is sharded (see `supervisor_config_t::registry_shards`), the
+ * requests are sent to the shard, which serves the name, and the plugin links
+ * only with the needed shards.
+ *
+ * If the supervisor has discovery cache enabled (`supervisor_config_t::discovery_cache`),
+ * the successfully discovered addresses are stored in the supervisor's plugin
+ * instance, and the subsequent discoveries of the same name by the actors of the
+ * supervisor are resolved from the cache without contacting registry. The
+ * supervisor's plugin listens for the deregistration messages on the registry
+ * addresses to invalidate the cache entries.
+ *
  */
 struct registry_plugin_t : public plugin_base_t {
     using plugin_base_t::plugin_base_t;
@@ -66,6 +78,7 @@ struct registry_plugin_t : public plugin_base_t {
         bool link_on_discovery = false;
         bool operational_only = false;
         bool requested = false;
+        bool cached = false;
         callback_t task_callback;
 
         friend struct registry_plugin_t;
@@ -87,6 +100,12 @@ struct registry_plugin_t : public plugin_base_t {
     /** \brief reaction on discovery future */
     virtual void on_future(message::discovery_future_t &message) noexcept;
 
+    /** \brief drops all cached names of the deregistered service address */
+    virtual void on_cache_dereg(message::deregistration_notify_t &message) noexcept;
+
+    /** \brief drops the cached name of the deregistered service */
+    virtual void on_cache_dereg_service(message::deregistration_service_t &message) noexcept;
+
     /** \brief enqueues name/address registration
      *
      * It links with registry actor first upon demand, and then sends to it
@@ -120,7 +139,11 @@ struct registry_plugin_t : public plugin_base_t {
         auto it = discovery_map.find(service);
         assert(it != discovery_map.end());
         if (!ec) {
-            *it->second.address = message.payload.res.service_addr;
+            auto &service_addr = message.payload.res.service_addr;
+            *it->second.address = service_addr;
+            if (auto owner = cache_owner(); owner) {
+                owner->cache.insert_or_assign(service, service_addr);
+            }
         }
         it->second.on_discovery(ec);
     }
@@ -132,6 +155,8 @@ struct registry_plugin_t : public plugin_base_t {
     };
     using register_map_t = std::unordered_map<std::string, register_info_t>;
     using discovery_map_t = std::unordered_map<std::string, discovery_task_t>;
+    using cache_t = std::unordered_map<std::string, address_ptr_t>;
+    using registries_t = std::unordered_set<address_ptr_t>;
 
     enum plugin_state_t : std::uint32_t {
         CONFIGURED = 1 << 0,
@@ -143,8 +168,18 @@ struct registry_plugin_t : public plugin_base_t {
     register_map_t register_map;
     discovery_map_t discovery_map;
 
+    /* the linked (or being linked) registries */
+    registries_t registries;
+    std::size_t pending_links = 0;
+
+    /* discovered addresses, used only by the supervisor's plugin instance */
+    cache_t cache;
+
     void link_registry() noexcept;
-    void on_link(const std::error_code &ec) noexcept;
+    void on_link(const address_ptr_t &registry_addr, const std::error_code &ec) noexcept;
+    void resolve_cached() noexcept;
+    void watch_registries() noexcept;
+    registry_plugin_t *cache_owner() noexcept;
     bool has_registering() noexcept;
     virtual void continue_init(const std::error_code &ec) noexcept;
 };
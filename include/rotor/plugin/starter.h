@@ -33,6 +33,14 @@ struct starter_plugin_t : public plugin_base_t {
     /** \brief subscribes *actor* handler on arbitrary address */
     template <typename Handler> handler_ptr_t subscribe_actor(Handler &&handler, const address_ptr_t &addr) noexcept;
 
+    /** \brief subscribes all *actor* handlers of the table on main actor address at once
+     *
+     * Unlike per-handler subscription, only single subscription confirmation
+     * is sent; the handlers are subscribed for the whole actor lifetime.
+     *
+     */
+    template <auto... Handlers> void subscribe_actor(handlers_table_t<Handlers...>) noexcept;
+
     bool handle_init(message::init_request_t *) noexcept override;
     void handle_start(message::start_trigger_t *message) noexcept override;
     bool handle_subscription(message::subscription_t &message) noexcept override;
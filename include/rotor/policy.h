@@ -19,4 +19,17 @@ enum class supervisor_policy_t {
     shutdown_failed,
 };
 
+/** \brief what to do with a new message, when the supervisor queue is full */
+enum class overflow_policy_t {
+    /** \brief the new message is dropped */
+    drop_newest = 1,
+
+    /** \brief the oldest (bounded) message in the queue is dropped, and the new one is enqueued */
+    drop_oldest,
+
+    /** \brief the new message is dropped; if it is a request, the requester receives
+     * an error response with `error_code_t::queue_overflow` */
+    reject,
+};
+
 } // namespace rotor
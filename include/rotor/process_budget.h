@@ -0,0 +1,63 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace rotor {
+
+/** \struct process_budget_t
+ *  \brief limits of the single `supervisor_t::do_process` invocation
+ *
+ * When any of the limits is reached and there are still messages in the
+ * locality queue, the supervisor yields back to the event loop and
+ * re-schedules itself, i.e. other loop events (I/O, timers, UI) are not
+ * starved by the storm of messages. At least one message is processed
+ * per invocation.
+ *
+ * Zero values mean no limit.
+ */
+struct process_budget_t {
+    /** \brief the maximum amount of messages processed in a row */
+    std::size_t messages = 0;
+
+    /** \brief the maximum time of the messages processing in a row */
+    std::chrono::nanoseconds time{0};
+
+    /** \brief returns `true` if any of the limits is set */
+    inline bool limited() const noexcept { return messages || time.count(); }
+};
+
+/** \struct process_stats_t
+ *  \brief counters of the locality queue processing
+ *
+ * The counters are updated by the locality leader once per `do_process`
+ * invocation, and can be read from any thread.
+ */
+struct process_stats_t {
+    /** \brief the amount of `do_process` invocations */
+    std::atomic<std::uint64_t> runs{0};
+
+    /** \brief the total amount of processed messages */
+    std::atomic<std::uint64_t> messages{0};
+
+    /** \brief how many times the processing was interrupted due to the budget */
+    std::atomic<std::uint64_t> budget_hits{0};
+
+    /** \brief accounts the `do_process` invocation (single writer, no read-modify-write) */
+    inline void record(std::uint64_t processed, bool budget_hit) noexcept {
+        runs.store(runs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        messages.store(messages.load(std::memory_order_relaxed) + processed, std::memory_order_relaxed);
+        if (budget_hit) {
+            budget_hits.store(budget_hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+};
+
+} // namespace rotor
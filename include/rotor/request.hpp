@@ -10,6 +10,7 @@
 #include "message.h"
 #include "error_code.h"
 #include "forward.hpp"
+#include "timer_wheel.h"
 #include <unordered_map>
 
 namespace rotor {
@@ -284,6 +285,9 @@ template <typename Request> struct wrapped_response_t {
 typedef message_ptr_t(error_producer_t)(const address_ptr_t &reply_to, message_base_t &msg,
                                         const std::error_code &ec) noexcept;
 
+/** \brief free function type, which takes the response message of the awaited request */
+typedef void(request_continuation_t)(void *context, message_ptr_t &response) noexcept;
+
 /** \struct request_curry_t
  * \brief the recorded context, which is needed to produce error response to the original request */
 struct request_curry_t {
@@ -295,6 +299,20 @@ struct request_curry_t {
 
     /** \brief the original request message */
     message_ptr_t request_message;
+
+    /** \brief the timeout timer handle, if the supervisor uses timer wheel */
+    timer_wheel_t::handle_t timer_handle = timer_wheel_t::invalid_handle;
+
+    /** \brief the requests group id, if the request has no own timer, but the shared one */
+    request_id_t group = 0;
+
+    /** \brief optional callback, which takes the response (or timeout error) instead
+     * of its delivery to the `origin` address (see {@link request_awaiter_t})
+     */
+    request_continuation_t *continuation = nullptr;
+
+    /** \brief opaque context of the `continuation` */
+    void *continuation_context = nullptr;
 };
 
 /** \struct request_traits_t
@@ -334,7 +352,11 @@ template <typename R> struct request_traits_t {
         using message_ptr_t = intrusive_ptr_t<message_t>;
     };
 
-    /** \brief helper free function to produce error reply to the original request */
+    /** \brief helper free function to produce error reply to the original request
+     *
+     * The error reply (e.g. timeout) goes to the `system` lane, i.e. it is not
+     * stuck behind the user messages of the request payload lane.
+     */
     static message_ptr_t make_error_response(const address_ptr_t &reply_to, message_base_t &message,
                                              const std::error_code &ec) noexcept {
         using reply_message_t = typename response::message_t;
@@ -342,10 +364,38 @@ template <typename R> struct request_traits_t {
         auto &request = static_cast<typename request::message_t &>(message);
         auto req_ptr = request_message_ptr(&request);
         auto raw_reply = new reply_message_t{reply_to, ec, req_ptr};
+        raw_reply->lane = message_lane_t::system;
         return message_ptr_t{raw_reply};
     }
 };
 
+/** \brief requests are bounded, unless the original request payload is not */
+template <typename T, typename E> struct bounded_payload_t<wrapped_request_t<T, E>> : bounded_payload_t<T> {};
+
+/** \brief responses are never bounded, as they finish already accepted requests */
+template <typename T> struct bounded_payload_t<wrapped_response_t<T>> : std::false_type {};
+
+/** \brief requests are delivered in the lane of the original request payload */
+template <typename T, typename E> struct payload_lane_t<wrapped_request_t<T, E>> : payload_lane_t<T> {};
+
+/** \brief responses are delivered in the lane of the original request payload, error responses
+ * are delivered in the `system` lane (see `request_traits_t::make_error_response`) */
+template <typename T> struct payload_lane_t<wrapped_response_t<T>> : payload_lane_t<T> {};
+
+/** \brief the original request message crosses locality boundary together with the response */
+template <typename T> struct payload_sharing_t<wrapped_response_t<T>> {
+    /** \brief marks the original request message as shared */
+    static void share(wrapped_response_t<T> &payload) noexcept { payload.req->share(); }
+};
+
+/** \brief replies with `error_code_t::queue_overflow` to the rejected request */
+template <typename T, typename E> struct overflow_response_t<wrapped_request_t<T, E>> {
+    /** \brief makes the error response, addressed to the request `reply_to` address */
+    template <typename Message> static message_ptr_t make(Message &message, const std::error_code &ec) noexcept {
+        return request_traits_t<T>::make_error_response(message.payload.reply_to, message, ec);
+    }
+};
+
 /** \struct request_builder_t
  * \brief builder pattern implentation for the original request
  */
@@ -356,6 +406,11 @@ template <typename T> struct [[nodiscard]] request_builder_t {
     request_builder_t(supervisor_t & sup_, actor_base_t & actor_, const address_ptr_t &destination_,
                       const address_ptr_t &reply_to_, Args &&... args);
 
+    request_builder_t(const request_builder_t &) = delete;
+
+    /** \brief frees the reserved request id, if the request has not been sent */
+    ~request_builder_t();
+
     /** \brief actually dispatches requests and spawns timeout timer
      *
      * The request id of the dispatched request is returned
@@ -363,24 +418,35 @@ template <typename T> struct [[nodiscard]] request_builder_t {
      */
     request_id_t send(pt::time_duration send) noexcept;
 
+    /** \brief dispatches requests, guarded by the shared timeout timer of the requests group
+     *
+     * The group should be previously created via `supervisor_t::create_request_group`;
+     * no own timer is spawned for the request.
+     *
+     */
+    request_id_t send_within(request_id_t group_id) noexcept;
+
+#if defined(ROTOR_COROUTINES)
+    /** \brief dispatches request and returns awaitable of its response
+     *
+     * See {@link request_awaiter_t} for details.
+     *
+     */
+    request_awaiter_t<T> await(pt::time_duration timeout) noexcept;
+#endif
+
   private:
     using traits_t = request_traits_t<T>;
     using request_message_t = typename traits_t::request::message_t;
     using request_message_ptr_t = typename traits_t::request::message_ptr_t;
-    using response_message_t = typename traits_t::response::message_t;
-    using response_message_ptr_t = typename traits_t::response::message_ptr_t;
-    using wrapped_res_t = typename traits_t::response::wrapped_t;
 
     supervisor_t &sup;
     actor_base_t &actor;
     request_id_t request_id;
     const address_ptr_t &destination;
     const address_ptr_t &reply_to;
-    bool do_install_handler;
-    request_message_ptr_t req;
     address_ptr_t imaginary_address;
-
-    void install_handler() noexcept;
+    request_message_ptr_t req;
 };
 
 } // namespace rotor
@@ -0,0 +1,155 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "request.hpp"
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace rotor {
+
+/** \struct request_map_t
+ *  \brief generational slot array of in-flight requests
+ *
+ * The request id encodes the slot index (lower half of bits) and the slot
+ * generation (upper half of bits). The slot generation is incremented every
+ * time the slot is freed, so the stale ids (i.e. late responses to already
+ * timed out requests) are rejected by the generation check.
+ *
+ * The free slots are recycled via free-list, so reserving, looking up and
+ * erasing a request are constant-time operations, which do not allocate
+ * (once the slots array has grown enough).
+ *
+ * The request id is never zero.
+ *
+ */
+struct request_map_t {
+    /** \brief reserves the slot for a new request and returns its id
+     *
+     * The reserved slot should be either filled via `emplace` or freed
+     * via `discard`.
+     */
+    request_id_t reserve() noexcept {
+        index_t index;
+        if (spare != invalid_index) {
+            index = spare;
+            spare = slots[index].next;
+        } else {
+            assert(slots.size() < index_mask && "too many in-flight requests");
+            index = static_cast<index_t>(slots.size());
+            slots.emplace_back();
+        }
+        auto &slot = slots[index];
+        slot.state = state_t::RESERVED;
+        return make_id(index, slot.generation);
+    }
+
+    /** \brief records the request curry into the previously reserved slot */
+    request_curry_t &emplace(request_id_t request_id, request_curry_t &&curry) noexcept {
+        auto &slot = slots[index_of(request_id)];
+        assert(slot.state == state_t::RESERVED && slot.generation == generation_of(request_id));
+        slot.state = state_t::ACTIVE;
+        slot.curry = std::move(curry);
+        ++count;
+        return slot.curry;
+    }
+
+    /** \brief returns the request curry or `nullptr` if there is no such (active) request */
+    request_curry_t *find(request_id_t request_id) noexcept {
+        auto index = index_of(request_id);
+        if (index >= slots.size()) {
+            return nullptr;
+        }
+        auto &slot = slots[index];
+        if (slot.state != state_t::ACTIVE || slot.generation != generation_of(request_id)) {
+            return nullptr;
+        }
+        return &slot.curry;
+    }
+
+    /** \brief removes the active request */
+    void erase(request_id_t request_id) noexcept {
+        auto index = index_of(request_id);
+        assert(slots[index].state == state_t::ACTIVE);
+        --count;
+        release(index);
+    }
+
+    /** \brief frees the reserved (and not filled) slot; otherwise does nothing */
+    void discard(request_id_t request_id) noexcept {
+        auto index = index_of(request_id);
+        if (index < slots.size()) {
+            auto &slot = slots[index];
+            if (slot.state == state_t::RESERVED && slot.generation == generation_of(request_id)) {
+                release(index);
+            }
+        }
+    }
+
+    /** \brief invokes `fn(request_id, curry)` for each active request */
+    template <typename Fn> void for_each(Fn &&fn) noexcept {
+        for (std::size_t index = 0; index < slots.size(); ++index) {
+            auto &slot = slots[index];
+            if (slot.state == state_t::ACTIVE) {
+                fn(make_id(static_cast<index_t>(index), slot.generation), slot.curry);
+            }
+        }
+    }
+
+    /** \brief returns amount of active requests */
+    inline std::size_t size() const noexcept { return count; }
+
+    /** \brief returns `true` if there are no active requests */
+    inline bool empty() const noexcept { return count == 0; }
+
+  private:
+    using index_t = std::uint32_t;
+
+    static_assert(sizeof(request_id_t) >= 2 * sizeof(index_t), "request id should hold slot index and generation");
+    static constexpr unsigned shift = sizeof(index_t) * 8;
+    static constexpr request_id_t index_mask = (request_id_t(1) << shift) - 1;
+
+    using generation_t = request_id_t;
+    static constexpr index_t invalid_index = static_cast<index_t>(-1);
+
+    enum class state_t : std::uint8_t { FREE, RESERVED, ACTIVE };
+
+    struct slot_t {
+        request_curry_t curry;
+        generation_t generation = 1;
+        index_t next = invalid_index;
+        state_t state = state_t::FREE;
+    };
+    using slots_t = std::vector<slot_t>;
+
+    static inline request_id_t make_id(index_t index, generation_t generation) noexcept {
+        return (generation << shift) | static_cast<request_id_t>(index);
+    }
+    static inline index_t index_of(request_id_t request_id) noexcept {
+        return static_cast<index_t>(request_id & index_mask);
+    }
+    static inline generation_t generation_of(request_id_t request_id) noexcept { return request_id >> shift; }
+
+    void release(index_t index) noexcept {
+        auto &slot = slots[index];
+        slot.curry = request_curry_t{};
+        slot.state = state_t::FREE;
+        slot.generation = (slot.generation + 1) & index_mask;
+        if (!slot.generation) {
+            slot.generation = 1;
+        }
+        slot.next = spare;
+        spare = index;
+    }
+
+    slots_t slots;
+    index_t spare = invalid_index;
+    std::size_t count = 0;
+};
+
+} // namespace rotor
@@ -0,0 +1,453 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "actor_base.h"
+#include "messages.hpp"
+#include "request.hpp"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace rotor {
+
+/** \brief the bytes buffer, where payloads are serialized */
+using serialization_buffer_t = std::vector<std::uint8_t>;
+
+/** \brief the bit, which distinguishes the stable type id of the request from the id of its payload
+ *
+ * I.e. the stable type id of `wrapped_request_t<R>` is `serializer_t<R>::type_id | request_type_bit`,
+ * so the user type ids should be less than `request_type_bit`.
+ */
+constexpr std::uint32_t request_type_bit = 1u << 31;
+
+/** \brief the stable type ids less than the value are reserved for rotor payloads */
+constexpr std::uint32_t user_type_id_min = 256;
+
+/** \struct address_codec_t
+ *  \brief maps addresses to the stable (e.g. network-wide) ids and back
+ *
+ * Addresses are process-local, so they are serialized as ids; the mapping is
+ * defined by the user of the serialization (e.g. a transport). The zero id
+ * is reserved for the null address.
+ */
+struct address_codec_t {
+    virtual ~address_codec_t() = default;
+
+    /** \brief returns the stable id of the address (zero for the null address) */
+    virtual std::uint64_t encode(const address_ptr_t &address) noexcept = 0;
+
+    /** \brief returns the address by its stable id, or null address if it is unknown */
+    virtual address_ptr_t decode(std::uint64_t id) noexcept = 0;
+};
+
+struct encoder_t;
+struct decoder_t;
+
+/** \struct serializer_t
+ *  \brief opt-in payload serialization trait
+ *
+ * The payload `T` is serializable, if the trait is specialized as:
+ *
+ * \code
+ * template <> struct rotor::serializer_t<my_payload_t> {
+ *     static constexpr std::uint32_t type_id = 1000;
+ *     static void encode(rotor::encoder_t &e, const my_payload_t &p) noexcept { e.put(p.name); e.put(p.value); }
+ *     static bool decode(rotor::decoder_t &d, my_payload_t &p) noexcept { return d.get(p.name) && d.get(p.value); }
+ * };
+ * \endcode
+ *
+ * The `type_id` should be stable, i.e. the same in all processes, which
+ * exchange the payload. The ids less than `user_type_id_min` are reserved
+ * for rotor payloads. The `decode` is invoked on the default-constructed payload.
+ *
+ * Requests (`wrapped_request_t<R>`) are serializable, if the request payload `R` is.
+ */
+template <typename T, typename = void> struct serializer_t;
+
+namespace details {
+
+template <typename T, typename = void> struct is_serializable : std::false_type {};
+
+template <typename T>
+struct is_serializable<T, std::void_t<decltype(serializer_t<T>::type_id)>> : std::true_type {};
+
+} // namespace details
+
+/** \brief `true` if the payload `T` has {@link serializer_t} specialization */
+template <typename T> inline constexpr bool is_serializable_v = details::is_serializable<T>::value;
+
+/** \struct encoder_t
+ *  \brief appends values into the buffer in compact binary format
+ *
+ * The format is: unsigned integers as LEB128 varints, signed integers as zigzag
+ * varints, `bool` as single byte, floating point numbers as little-endian IEEE 754
+ * bits, strings as varint length followed by the bytes, enums as their underlying
+ * type, addresses as varint ids (see {@link address_codec_t}). Other types are
+ * encoded via {@link serializer_t}.
+ */
+struct encoder_t {
+    /** \brief constructs encoder, which appends to the buffer */
+    encoder_t(serialization_buffer_t &buffer_, address_codec_t *addresses_ = nullptr) noexcept
+        : buffer{buffer_}, addresses{addresses_} {}
+
+    /** \brief appends LEB128 varint */
+    inline void put_varint(std::uint64_t value) noexcept {
+        while (value >= 0x80) {
+            buffer.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    /** \brief appends raw bytes */
+    inline void put_bytes(const void *data, std::size_t size) noexcept {
+        auto ptr = static_cast<const std::uint8_t *>(data);
+        buffer.insert(buffer.end(), ptr, ptr + size);
+    }
+
+    /** \brief appends the error code (category marker and value) */
+    void put(const std::error_code &ec) noexcept;
+
+    /** \brief appends the value */
+    template <typename T> void put(const T &value) noexcept {
+        if constexpr (std::is_same_v<T, bool>) {
+            buffer.push_back(value ? 1 : 0);
+        } else if constexpr (std::is_enum_v<T>) {
+            put(static_cast<std::underlying_type_t<T>>(value));
+        } else if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T>) {
+            put_varint(value);
+        } else if constexpr (std::is_integral_v<T>) {
+            auto v = static_cast<std::int64_t>(value);
+            put_varint((static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            using bits_t = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+            static_assert(sizeof(T) == sizeof(bits_t), "unsupported floating point type");
+            bits_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            for (std::size_t i = 0; i < sizeof(bits); ++i) {
+                buffer.push_back(static_cast<std::uint8_t>(bits >> (i * 8)));
+            }
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            put_varint(value.size());
+            put_bytes(value.data(), value.size());
+        } else if constexpr (std::is_same_v<T, address_ptr_t>) {
+            put_varint(addresses && value ? addresses->encode(value) : 0);
+        } else {
+            static_assert(is_serializable_v<T>, "the type should have serializer_t specialization");
+            serializer_t<T>::encode(*this, value);
+        }
+    }
+
+    /** \brief the buffer, where values are appended */
+    serialization_buffer_t &buffer;
+
+    /** \brief the addresses mapping (optional) */
+    address_codec_t *addresses;
+};
+
+/** \struct decoder_t
+ *  \brief reads values from the bytes, written by {@link encoder_t}
+ *
+ * Any read failure (truncated data, out of range value) is sticky, i.e. all
+ * further reads fail too.
+ */
+struct decoder_t {
+    /** \brief constructs decoder over the bytes */
+    decoder_t(const void *data, std::size_t size, address_codec_t *addresses_ = nullptr) noexcept
+        : addresses{addresses_}, ptr{static_cast<const std::uint8_t *>(data)}, end{ptr + size} {}
+
+    /** \brief reads LEB128 varint */
+    inline bool get_varint(std::uint64_t &value) noexcept {
+        std::uint64_t result = 0;
+        for (unsigned shift = 0; !failed && ptr != end && shift < 64; shift += 7) {
+            auto byte = *ptr++;
+            result |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                value = result;
+                return true;
+            }
+        }
+        return fail();
+    }
+
+    /** \brief reads raw bytes */
+    inline bool get_bytes(void *data, std::size_t size) noexcept {
+        if (failed || static_cast<std::size_t>(end - ptr) < size) {
+            return fail();
+        }
+        std::memcpy(data, ptr, size);
+        ptr += size;
+        return true;
+    }
+
+    /** \brief reads the error code */
+    bool get(std::error_code &ec) noexcept;
+
+    /** \brief reads the value */
+    template <typename T> bool get(T &value) noexcept {
+        if constexpr (std::is_same_v<T, bool>) {
+            std::uint8_t byte;
+            if (!get_bytes(&byte, 1) || byte > 1) {
+                return fail();
+            }
+            value = byte == 1;
+            return true;
+        } else if constexpr (std::is_enum_v<T>) {
+            std::underlying_type_t<T> raw;
+            if (!get(raw)) {
+                return false;
+            }
+            value = static_cast<T>(raw);
+            return true;
+        } else if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T>) {
+            std::uint64_t raw;
+            if (!get_varint(raw) || raw > std::numeric_limits<T>::max()) {
+                return fail();
+            }
+            value = static_cast<T>(raw);
+            return true;
+        } else if constexpr (std::is_integral_v<T>) {
+            std::uint64_t raw;
+            if (!get_varint(raw)) {
+                return false;
+            }
+            auto v = static_cast<std::int64_t>(raw >> 1) ^ -static_cast<std::int64_t>(raw & 1);
+            if (v < std::numeric_limits<T>::min() || v > std::numeric_limits<T>::max()) {
+                return fail();
+            }
+            value = static_cast<T>(v);
+            return true;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            using bits_t = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+            std::uint8_t bytes[sizeof(bits_t)];
+            if (!get_bytes(bytes, sizeof(bytes))) {
+                return false;
+            }
+            bits_t bits = 0;
+            for (std::size_t i = 0; i < sizeof(bits); ++i) {
+                bits |= static_cast<bits_t>(bytes[i]) << (i * 8);
+            }
+            std::memcpy(&value, &bits, sizeof(bits));
+            return true;
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            std::uint64_t size;
+            if (!get_varint(size) || size > static_cast<std::uint64_t>(end - ptr)) {
+                return fail();
+            }
+            value.assign(reinterpret_cast<const char *>(ptr), static_cast<std::size_t>(size));
+            ptr += size;
+            return true;
+        } else if constexpr (std::is_same_v<T, address_ptr_t>) {
+            std::uint64_t id;
+            if (!get_varint(id)) {
+                return false;
+            }
+            value = addresses && id ? addresses->decode(id) : address_ptr_t{};
+            return true;
+        } else {
+            static_assert(is_serializable_v<T>, "the type should have serializer_t specialization");
+            return !failed && (serializer_t<T>::decode(*this, value) || fail());
+        }
+    }
+
+    /** \brief returns the amount of not yet read bytes */
+    inline std::size_t remaining() const noexcept { return static_cast<std::size_t>(end - ptr); }
+
+    /** \brief returns `true` if any read has failed */
+    inline bool has_failed() const noexcept { return failed; }
+
+    /** \brief the addresses mapping (optional) */
+    address_codec_t *addresses;
+
+  private:
+    inline bool fail() noexcept {
+        failed = true;
+        return false;
+    }
+
+    const std::uint8_t *ptr;
+    const std::uint8_t *end;
+    bool failed = false;
+};
+
+/** \brief requests are serializable, if the request payload is; the request id and addresses are kept */
+template <typename R> struct serializer_t<wrapped_request_t<R>, std::enable_if_t<is_serializable_v<R>>> {
+    /** \brief the request payload stable type id with `request_type_bit` */
+    static constexpr std::uint32_t type_id = serializer_t<R>::type_id | request_type_bit;
+
+    /** \brief encodes request id, reply and origin addresses and the payload */
+    static void encode(encoder_t &e, const wrapped_request_t<R> &p) noexcept {
+        e.put(static_cast<std::uint64_t>(p.id));
+        e.put(p.reply_to);
+        e.put(p.origin);
+        e.put(p.request_payload);
+    }
+
+    /** \brief decodes request id, reply and origin addresses and the payload */
+    static bool decode(decoder_t &d, wrapped_request_t<R> &p) noexcept {
+        std::uint64_t id;
+        auto ok = d.get(id) && d.get(p.reply_to) && d.get(p.origin) && d.get(p.request_payload);
+        p.id = static_cast<request_id_t>(id);
+        return ok;
+    }
+};
+
+namespace details {
+
+/** \brief constructs the message with the default-constructed payload and decodes it */
+template <typename T> struct message_decoder_t {
+    static message_ptr_t decode(decoder_t &decoder, const address_ptr_t &destination) noexcept {
+        auto message = intrusive_ptr_t<message_t<T>>(new message_t<T>(destination));
+        if (!decoder.get(message->payload)) {
+            return {};
+        }
+        return message_ptr_t(message.get());
+    }
+};
+
+/** \brief request payloads are not default-constructible, so the request is decoded field by field */
+template <typename R> struct message_decoder_t<wrapped_request_t<R>> {
+    static message_ptr_t decode(decoder_t &decoder, const address_ptr_t &destination) noexcept {
+        std::uint64_t id;
+        address_ptr_t reply_to;
+        address_ptr_t origin;
+        R payload{};
+        if (!(decoder.get(id) && decoder.get(reply_to) && decoder.get(origin) && decoder.get(payload))) {
+            return {};
+        }
+        auto request_id = static_cast<request_id_t>(id);
+        return make_message<wrapped_request_t<R>>(destination, request_id, reply_to, origin, std::move(payload));
+    }
+};
+
+} // namespace details
+
+/** \struct serialization_registry_t
+ *  \brief maps stable type ids to message types (`message_t<T>::message_type`) and back
+ *
+ * The registry is filled upfront (e.g. upon transport construction) and it is
+ * used read-only then, i.e. it can be shared between threads.
+ *
+ * The serialized message is the varint stable type id followed by the payload;
+ * the destination address is not serialized (it is transport-specific).
+ *
+ * Responses are not registered: the response is meaningful only along with the
+ * original request message, which is known to the transport, i.e. the transport
+ * should serialize `ec` and the response payload (`R::response_t`) itself.
+ */
+struct serialization_registry_t {
+    /** \brief serializes the message payload */
+    using encode_fn_t = void (*)(encoder_t &encoder, const message_base_t &message) noexcept;
+
+    /** \brief deserializes the message payload and makes the message */
+    using decode_fn_t = message_ptr_t (*)(decoder_t &decoder, const address_ptr_t &destination) noexcept;
+
+    /** \struct entry_t
+     *  \brief serializable message type record */
+    struct entry_t {
+        /** \brief the stable payload type id */
+        std::uint32_t type_id;
+
+        /** \brief `message_t<T>::message_type` */
+        const void *message_type;
+
+        /** \brief payload serializer */
+        encode_fn_t encode;
+
+        /** \brief payload deserializer */
+        decode_fn_t decode;
+    };
+
+    /** \brief registers `message_t<T>`, returns `false` if the stable type id is already taken */
+    template <typename T> bool add() noexcept {
+        static_assert(is_serializable_v<T>, "the payload should have serializer_t specialization");
+        auto encode = [](encoder_t &encoder, const message_base_t &message) noexcept {
+            encoder.put(static_cast<const message_t<T> &>(message).payload);
+        };
+        return add(entry_t{serializer_t<T>::type_id, message_t<T>::message_type, encode,
+                           &details::message_decoder_t<T>::decode});
+    }
+
+    /** \brief registers `message_t<wrapped_request_t<R>>`, i.e. the request with the payload `R` */
+    template <typename R> bool add_request() noexcept { return add<wrapped_request_t<R>>(); }
+
+    /** \brief registers rotor messages and requests, which can cross process boundaries
+     *
+     * Messages, which refer to in-process entities (actors, handlers, subscriptions)
+     * are not serializable.
+     */
+    void add_builtin() noexcept;
+
+    /** \brief returns the record by the stable type id, or `nullptr` */
+    const entry_t *find(std::uint32_t type_id) const noexcept;
+
+    /** \brief returns the record by the message type, or `nullptr` */
+    const entry_t *find(const void *message_type) const noexcept;
+
+    /** \brief writes the stable type id and the payload, returns `false` if the message type is unknown */
+    bool encode(encoder_t &encoder, const message_base_t &message) const noexcept;
+
+    /** \brief reads the stable type id and the payload, returns null pointer on failure */
+    message_ptr_t decode(decoder_t &decoder, const address_ptr_t &destination) const noexcept;
+
+  private:
+    bool add(const entry_t &entry) noexcept;
+
+    std::vector<entry_t> entries;
+    std::unordered_map<std::uint32_t, std::size_t> by_id;
+    std::unordered_map<const void *, std::size_t> by_type;
+};
+
+/** \brief declares the stable type id, the encoder and the decoder of rotor payload */
+#define ROTOR_SERIALIZER(PAYLOAD, ID, ENCODE, DECODE)                                                                \
+    template <> struct serializer_t<payload::PAYLOAD> {                                                                \
+        /** \brief the stable payload type id */                                                                     \
+        static constexpr std::uint32_t type_id = ID;                                                                   \
+        /** \brief encodes the payload */                                                                            \
+        static void encode([[maybe_unused]] encoder_t &e, [[maybe_unused]] const payload::PAYLOAD &p) noexcept {       \
+            ENCODE;                                                                                                    \
+        }                                                                                                              \
+        /** \brief decodes the payload */                                                                            \
+        static bool decode([[maybe_unused]] decoder_t &d, [[maybe_unused]] payload::PAYLOAD &p) noexcept {             \
+            return DECODE;                                                                                             \
+        }                                                                                                              \
+    };
+
+ROTOR_SERIALIZER(initialize_confirmation_t, 1, , true)
+ROTOR_SERIALIZER(initialize_actor_t, 2, , true)
+ROTOR_SERIALIZER(start_actor_t, 3, , true)
+ROTOR_SERIALIZER(shutdown_trigger_t, 4, e.put(p.actor_address), d.get(p.actor_address))
+ROTOR_SERIALIZER(shutdown_confirmation_t, 5, , true)
+ROTOR_SERIALIZER(shutdown_request_t, 6, , true)
+ROTOR_SERIALIZER(state_response_t, 7, e.put(p.state), d.get(p.state))
+ROTOR_SERIALIZER(state_request_t, 8, e.put(p.subject_addr), d.get(p.subject_addr))
+ROTOR_SERIALIZER(registration_response_t, 9, , true)
+ROTOR_SERIALIZER(registration_request_t, 10, (e.put(p.service_name), e.put(p.service_addr)),
+                 d.get(p.service_name) && d.get(p.service_addr))
+ROTOR_SERIALIZER(deregistration_notify_t, 11, e.put(p.service_addr), d.get(p.service_addr))
+ROTOR_SERIALIZER(deregistration_service_t, 12, e.put(p.service_name), d.get(p.service_name))
+ROTOR_SERIALIZER(discovery_reply_t, 13, e.put(p.service_addr), d.get(p.service_addr))
+ROTOR_SERIALIZER(discovery_request_t, 14, e.put(p.service_name), d.get(p.service_name))
+ROTOR_SERIALIZER(discovery_future_t, 15, e.put(p.service_addr), d.get(p.service_addr))
+ROTOR_SERIALIZER(discovery_promise_t, 16, e.put(p.service_name), d.get(p.service_name))
+ROTOR_SERIALIZER(discovery_cancel_t, 17, (e.put(p.client_addr), e.put(p.service_name)),
+                 d.get(p.client_addr) && d.get(p.service_name))
+ROTOR_SERIALIZER(link_response_t, 18, , true)
+ROTOR_SERIALIZER(link_request_t, 19, e.put(p.operational_only), d.get(p.operational_only))
+ROTOR_SERIALIZER(unlink_notify_t, 20, e.put(p.client_addr), d.get(p.client_addr))
+ROTOR_SERIALIZER(unlink_request_t, 21, e.put(p.server_addr), d.get(p.server_addr))
+ROTOR_SERIALIZER(backpressure_t, 22, (e.put(p.leader_addr), e.put(p.policy)), d.get(p.leader_addr) && d.get(p.policy))
+
+#undef ROTOR_SERIALIZER
+
+} // namespace rotor
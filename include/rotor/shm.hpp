@@ -0,0 +1,22 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+/** \file shm.hpp
+ * A convenience header to include rotor shared memory (inter-process) transport
+ */
+
+#include "rotor/shm/ring.h"
+#include "rotor/shm/segment.h"
+#include "rotor/shm/transport.h"
+
+namespace rotor {
+
+/// namespace for the shared memory inter-process transport for `rotor`
+namespace shm {}
+
+} // namespace rotor
@@ -0,0 +1,246 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace rotor {
+namespace shm {
+
+/** \brief the kind of the {@link frame_t} */
+enum class frame_kind_t : std::uint16_t {
+    /** \brief the unused tail of the ring, the next frame starts at the ring beginning */
+    padding = 0,
+
+    /** \brief plain message */
+    message,
+
+    /** \brief request message, the `request` field holds the request sequence */
+    request,
+
+    /** \brief response message, the `request` field holds the original request sequence */
+    response,
+};
+
+/** \brief the category of the error code of the response frame */
+enum class error_category_t : std::uint16_t {
+    /** \brief no error */
+    none = 0,
+
+    /** \brief `rotor::error_code_category()` */
+    rotor,
+
+    /** \brief `std::system_category()` */
+    system,
+};
+
+/** \struct frame_t
+ *  \brief the header of the message in the {@link ring_t}, followed by the payload
+ *
+ * The frames are 8-bytes aligned, i.e. the payload is 8-bytes aligned too.
+ */
+struct frame_t {
+    /** \brief the whole (aligned) frame size, including the header */
+    std::uint32_t size;
+
+    /** \brief the frame kind, see {@link frame_kind_t} */
+    std::uint16_t kind;
+
+    /** \brief the error code category of the response, see {@link error_category_t} */
+    std::uint16_t category;
+
+    /** \brief the stable payload type identity */
+    std::uint32_t type;
+
+    /** \brief the payload length in bytes */
+    std::uint32_t length;
+
+    /** \brief the destination address identity on the receiving side */
+    std::uint64_t address;
+
+    /** \brief the request sequence (for requests and responses) */
+    std::uint64_t request;
+
+    /** \brief the error code value of the response */
+    std::int32_t ec;
+
+    /** \brief unused */
+    std::uint32_t reserved;
+};
+
+/** \brief the frames alignment */
+constexpr std::size_t frame_alignment = 8;
+
+/** \struct ring_header_t
+ *  \brief the shared state of {@link ring_t}, which is placed into shared memory
+ *
+ * The `head` and `tail` are monotonic byte offsets, the actual position in
+ * the ring is `offset & (capacity - 1)`.
+ */
+struct ring_header_t {
+    /** \brief the producer position (written by the producer only) */
+    alignas(64) std::atomic<std::uint64_t> tail;
+
+    /** \brief the consumer position (written by the consumer only) */
+    alignas(64) std::atomic<std::uint64_t> head;
+
+    /** \brief futex word, it is changed when a waiting consumer should be woken up */
+    alignas(64) std::atomic<std::uint32_t> signal;
+
+    /** \brief the amount of consumer threads waiting on `signal` */
+    std::atomic<std::uint32_t> waiters;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "lock-free 64-bit atomics are required");
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "lock-free 32-bit atomics are required");
+
+/** \struct ring_t
+ *  \brief single-producer single-consumer lock-free ring of variable-size frames
+ *
+ * The ring operates over the memory, which can be shared between processes
+ * (i.e. it does not contain any pointers). A frame is never split: if there
+ * is no enough contiguous space till the ring end, the padding frame is
+ * written and the frame is placed at the ring beginning.
+ *
+ * The consumer can sleep on the futex (see `wait`), and it is woken up
+ * by the producer, when it pushes into the empty ring.
+ *
+ */
+struct ring_t {
+    /** \brief constructs the ring view, the `capacity` must be power of 2 */
+    ring_t(ring_header_t *header_, std::uint8_t *data_, std::size_t capacity_) noexcept
+        : header{header_}, data{data_}, capacity{capacity_}, mask{capacity_ - 1} {}
+
+    /** \brief returns the frame size for the payload length (including header and alignment) */
+    static inline std::size_t frame_size(std::size_t length) noexcept {
+        auto size = sizeof(frame_t) + length;
+        return (size + frame_alignment - 1) & ~(frame_alignment - 1);
+    }
+
+    /** \brief writes the frame, the payload is written by `fill(void *)`
+     *
+     * Returns `false` if there is no free space in the ring (or the frame is too large).
+     * The `size` and `length` fields of the frame are set by the method.
+     */
+    template <typename Fill> bool push(frame_t frame, std::size_t length, Fill &&fill) noexcept {
+        auto size = frame_size(length);
+        if (size > capacity) {
+            return false;
+        }
+        auto start = header->tail.load(std::memory_order_relaxed);
+        auto head = header->head.load(std::memory_order_acquire);
+        auto tail = start;
+        auto contiguous = capacity - (tail & mask);
+        auto padding = contiguous < size ? contiguous : 0;
+        if (tail + padding + size - head > capacity) {
+            return false;
+        }
+        if (padding) {
+            auto pad = frame_at(tail);
+            pad->size = static_cast<std::uint32_t>(padding);
+            pad->kind = static_cast<std::uint16_t>(frame_kind_t::padding);
+            tail += padding;
+        }
+        frame.size = static_cast<std::uint32_t>(size);
+        frame.length = static_cast<std::uint32_t>(length);
+        auto target = frame_at(tail);
+        *target = frame;
+        fill(static_cast<void *>(target + 1));
+        header->tail.store(tail + size, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // the consumer might have drained everything and went sleeping
+        if (header->head.load(std::memory_order_relaxed) == start) {
+            notify();
+        }
+        return true;
+    }
+
+    /** \brief invokes `fn(const frame_t &, const void *payload)` for up to `max` frames
+     *
+     * Returns the amount of consumed frames.
+     *
+     * The frames are written by the other process, so their sizes are validated
+     * before the frame is used. The consumption stops at the first malformed frame,
+     * and the ring is marked as corrupted (see `corrupted`), i.e. nothing is consumed
+     * from it anymore.
+     */
+    template <typename Fn> std::size_t consume(Fn &&fn, std::size_t max) noexcept {
+        std::size_t count = 0;
+        if (broken) {
+            return count;
+        }
+        auto head = header->head.load(std::memory_order_relaxed);
+        auto tail = header->tail.load(std::memory_order_acquire);
+        if (tail - head > capacity) {
+            broken = true;
+            return count;
+        }
+        while (head != tail && count < max) {
+            auto frame = frame_at(head);
+            std::uint64_t size = frame->size;
+            bool valid = size && !(size & (frame_alignment - 1)) && size <= tail - head &&
+                         size <= capacity - (head & mask);
+            auto padding = frame->kind == static_cast<std::uint16_t>(frame_kind_t::padding);
+            if (valid && !padding) {
+                valid = size >= sizeof(frame_t) + std::uint64_t{frame->length};
+            }
+            if (!valid) {
+                broken = true;
+                break;
+            }
+            if (!padding) {
+                fn(*frame, static_cast<const void *>(frame + 1));
+                ++count;
+            }
+            head += size;
+        }
+        header->head.store(head, std::memory_order_release);
+        return count;
+    }
+
+    /** \brief returns `true` if a malformed frame has been met by `consume` (consumer side) */
+    inline bool corrupted() const noexcept { return broken; }
+
+    /** \brief returns `true` if there are no frames in the ring (consumer side) */
+    inline bool empty() const noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return header->head.load(std::memory_order_relaxed) == header->tail.load(std::memory_order_acquire);
+    }
+
+    /** \brief registers the calling thread as the waiter, returns the current signal value
+     *
+     * The frames availability should be checked after the method, and then the
+     * thread might `wait` with the returned value.
+     */
+    std::uint32_t prepare_wait() noexcept;
+
+    /** \brief sleeps until the signal differs from `value` or the timeout expires; unregisters the waiter */
+    void wait(std::uint32_t value, std::chrono::milliseconds timeout) noexcept;
+
+    /** \brief unregisters the waiter without sleeping (i.e. when frames are available) */
+    inline void cancel_wait() noexcept { header->waiters.fetch_sub(1, std::memory_order_seq_cst); }
+
+    /** \brief wakes up the waiting consumer, if any */
+    void notify() noexcept;
+
+  private:
+    inline frame_t *frame_at(std::uint64_t offset) noexcept {
+        return reinterpret_cast<frame_t *>(data + (offset & mask));
+    }
+
+    ring_header_t *header;
+    std::uint8_t *data;
+    std::size_t capacity;
+    std::size_t mask;
+    bool broken = false;
+};
+
+} // namespace shm
+} // namespace rotor
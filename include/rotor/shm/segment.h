@@ -0,0 +1,66 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/shm/ring.h"
+#include <memory>
+#include <string>
+#include <system_error>
+
+namespace rotor {
+namespace shm {
+
+struct segment_t;
+
+/** \brief unique pointer to {@link segment_t} */
+using segment_ptr_t = std::unique_ptr<segment_t>;
+
+/** \struct segment_t
+ *  \brief named shared memory segment (`shm_open`) with a pair of {@link ring_t}
+ *
+ * One side creates the segment, the other side opens it by name. The
+ * `outbound` ring of the one side is the `inbound` ring of the other side.
+ * The creator removes the segment name upon destruction.
+ *
+ */
+struct segment_t {
+    /** \brief the version of the segment layout */
+    static constexpr std::uint32_t version = 1;
+
+    /** \brief creates new segment, the stale segment with the same name is replaced
+     *
+     * The `capacity` is the size of each ring, it should be power of 2.
+     */
+    static segment_ptr_t create(const std::string &name, std::size_t capacity, std::error_code &ec) noexcept;
+
+    /** \brief opens the segment, previously created by the other side */
+    static segment_ptr_t open(const std::string &name, std::error_code &ec) noexcept;
+
+    ~segment_t();
+
+    /** \brief returns the ring to be written by this side */
+    inline ring_t &outbound() noexcept { return rings[owner ? 0 : 1]; }
+
+    /** \brief returns the ring to be read by this side */
+    inline ring_t &inbound() noexcept { return rings[owner ? 1 : 0]; }
+
+    /** \brief returns the size of each ring */
+    inline std::size_t get_capacity() const noexcept { return capacity; }
+
+  private:
+    segment_t(const std::string &name, void *memory, std::size_t size, std::size_t capacity, bool owner) noexcept;
+
+    std::string name;
+    void *memory;
+    std::size_t size;
+    std::size_t capacity;
+    bool owner;
+    ring_t rings[2];
+};
+
+} // namespace shm
+} // namespace rotor
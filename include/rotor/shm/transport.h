@@ -0,0 +1,387 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/shm/segment.h"
+#include "rotor/serialization.h"
+#include "rotor/transport_base.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace rotor {
+namespace shm {
+
+/** \struct transport_config_t
+ *  \brief shared memory transport configuration
+ */
+struct transport_config_t : transport_base_config_t {
+    /** \brief the shared memory segment name, e.g. `/my-app` */
+    std::string name;
+
+    /** \brief whether the segment should be created (by one side) or opened (by the other side) */
+    bool create = false;
+
+    /** \brief the size of each ring in bytes (power of 2, at least 4096), used by the creator only */
+    std::size_t capacity = 1 << 20;
+
+    /** \brief the maximum amount of frames decoded in a row, before the transport yields */
+    std::size_t batch = 64;
+
+    using transport_base_config_t::transport_base_config_t;
+};
+
+/** \brief CRTP shared memory transport config builder */
+template <typename Actor> struct transport_config_builder_t : transport_base_config_builder_t<Actor> {
+    /** \brief final builder class */
+    using builder_t = typename Actor::template config_builder_t<Actor>;
+
+    /** \brief parent config builder */
+    using parent_t = transport_base_config_builder_t<Actor>;
+    using parent_t::parent_t;
+
+    /** \brief sets the shared memory segment name */
+    builder_t &&name(const std::string &value) &&noexcept {
+        parent_t::config.name = value;
+        return std::move(*static_cast<builder_t *>(this));
+    }
+
+    /** \brief the segment will be created by the transport (instead of being opened) */
+    builder_t &&create(bool value = true) &&noexcept {
+        parent_t::config.create = value;
+        return std::move(*static_cast<builder_t *>(this));
+    }
+
+    /** \brief sets the size of each ring in bytes */
+    builder_t &&capacity(std::size_t value) &&noexcept {
+        parent_t::config.capacity = value;
+        return std::move(*static_cast<builder_t *>(this));
+    }
+
+    /** \brief sets the maximum amount of frames decoded in a row */
+    builder_t &&batch(std::size_t value) &&noexcept {
+        parent_t::config.batch = value;
+        return std::move(*static_cast<builder_t *>(this));
+    }
+
+    /** \brief checks that the segment name is set and the capacity is valid */
+    bool validate() noexcept override {
+        auto &c = parent_t::config;
+        auto capacity_ok = c.capacity >= 4096 && !(c.capacity & (c.capacity - 1));
+        return !c.name.empty() && capacity_ok && c.batch && parent_t::validate();
+    }
+};
+
+/** \struct transport_t
+ *  \brief bridges rotor messages between processes via the shared memory segment
+ *
+ * The transport pair shares the {@link segment_t}, i.e. the pair of lock-free
+ * rings. The addresses are identified on the wire by the user-supplied stable
+ * ids (see {@link transport_base_t}). The messages, sent to a proxy address,
+ * are written into the ring and delivered by the other side transport to the
+ * exported address.
+ *
+ * The payload types are identified by the stable type ids of {@link serializer_t},
+ * i.e. the payload is registered the same way for any transport. The trivially
+ * copyable payloads are copied into the ring as is, and they are copied out of
+ * the ring into the new message on the other side, without any (de)serialization;
+ * other payloads are serialized via {@link rotor::encoder_t}. The addresses inside
+ * payloads are not translated, i.e. they arrive as null addresses.
+ *
+ * Requests and responses are supported: the request is remembered until the
+ * response arrives from the other side, and then the response is delivered to
+ * the original requester as if the request were local. The request to the
+ * address, which is not exported by the other side, is replied with
+ * `transport_unknown_address` error. The pending requests are replied with
+ * `transport_disconnected` error, when the transport shuts down.
+ *
+ * The inbound frames are validated, as the other side might be broken; the
+ * malformed frame is counted as dropped, and the transport shuts down.
+ *
+ * The message types, exported and imported addresses should be registered
+ * before the transport initialization.
+ *
+ * The inbound ring is watched by the background thread, which sleeps on
+ * the futex while the ring is empty, and notifies the transport via the
+ * supervisor `enqueue`, i.e. the supervisor should support thread-safe
+ * messages enqueueing (it is true for all supervisors but wx).
+ *
+ */
+struct transport_t : public transport_base_t {
+    /** \brief injects an alias for transport_config_t */
+    using config_t = transport_config_t;
+
+    /** \brief injects templated transport_config_builder_t */
+    template <typename Actor> using config_builder_t = transport_config_builder_t<Actor>;
+
+    /** \brief the notification that the inbound ring has frames */
+    struct notify_t {};
+
+    /** \brief message with {@link notify_t} payload */
+    using notify_message_t = message_t<notify_t>;
+
+    /** \brief constructs the transport from the config */
+    explicit transport_t(config_t &config);
+
+    ~transport_t();
+
+    /** \brief registers serializable plain message payload type `T` */
+    template <typename T> void register_message() noexcept {
+        static_assert(is_serializable_v<T>, "payload should be serializable");
+        codecs.emplace(serializer_t<T>::type_id, codec_t{&transport_t::template decode_message<T>,
+                                                         &transport_t::template subscribe_message<T>});
+    }
+
+    /** \brief registers serializable request payload type `R` (and its response) */
+    template <typename R> void register_request() noexcept {
+        using response_t = typename request_traits_t<R>::response::wrapped_t::response_t;
+        static_assert(is_serializable_v<R>, "request payload should be serializable");
+        static_assert(is_serializable_v<response_t>, "response payload should be serializable");
+        codecs.emplace(serializer_t<R>::type_id, codec_t{&transport_t::template decode_request<R>,
+                                                         &transport_t::template subscribe_request<R>});
+    }
+
+    void configure(plugin::plugin_base_t &plugin) noexcept override;
+    void init_finish() noexcept override;
+    void on_start() noexcept override;
+    void shutdown_start() noexcept override;
+    void shutdown_finish() noexcept override;
+
+    /** \brief decodes up to `batch` inbound frames */
+    virtual void on_notify(notify_message_t &message) noexcept;
+
+  protected:
+    /** \brief decodes the frame into the message and puts it into the supervisor */
+    using decoder_t = void (*)(transport_t &transport, const frame_t &frame, const void *data) noexcept;
+
+    /** \brief subscribes the encoding handlers of the registered type */
+    using subscriber_t = void (*)(transport_t &transport, plugin::starter_plugin_t &plugin,
+                                  std::uint32_t type_id) noexcept;
+
+    /** \struct codec_t
+     *  \brief the registered payload type handlers */
+    struct codec_t {
+        /** \brief inbound frames decoder */
+        decoder_t decoder;
+
+        /** \brief outbound messages handlers subscriber */
+        subscriber_t subscriber;
+    };
+
+    /** \brief stable type id to codec mapping (type) */
+    using codecs_t = std::unordered_map<std::uint32_t, codec_t>;
+
+    /** \brief writes the frame with the payload into the outbound ring */
+    bool push(frame_t frame, const void *data, std::size_t length) noexcept;
+
+    /** \brief writes the frame with the trivially copyable (as is) or serialized payload into the outbound ring */
+    template <typename T> bool push_payload(frame_t frame, const T &payload) noexcept {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            return push(frame, &payload, sizeof(T));
+        } else {
+            buffer.clear();
+            rotor::encoder_t encoder(buffer);
+            encoder.put(payload);
+            return push(frame, buffer.data(), buffer.size());
+        }
+    }
+
+    /** \brief replies to the other side request with the error instead of the response */
+    void refuse(const frame_t &frame, const std::error_code &ec) noexcept;
+
+    /** \brief sends the notification to self, unless it is already sent */
+    void notify() noexcept;
+
+    /** \brief the background thread routine, which watches the inbound ring */
+    void watch() noexcept;
+
+    /** \brief stops and joins the background thread */
+    void stop_watching() noexcept;
+
+    /** \brief copies trivially copyable or deserializes `T` out of the ring, returns `false` on mismatch */
+    template <typename T> static bool load(const frame_t &frame, const void *data, T &payload) noexcept {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (frame.length != sizeof(T)) {
+                return false;
+            }
+            std::memcpy(&payload, data, sizeof(T));
+            return true;
+        } else {
+            rotor::decoder_t decoder(data, frame.length);
+            return decoder.get(payload) && !decoder.remaining();
+        }
+    }
+
+    /** \brief creates frame header */
+    static frame_t make_frame(frame_kind_t kind, std::uint32_t type_id, std::uint64_t address) noexcept {
+        frame_t frame{};
+        frame.kind = static_cast<std::uint16_t>(kind);
+        frame.type = type_id;
+        frame.address = address;
+        return frame;
+    }
+
+    /** \brief the plain message decoder */
+    template <typename T>
+    static void decode_message(transport_t &self, const frame_t &frame, const void *data) noexcept {
+        auto dest = self.find_export(frame.address);
+        T payload{};
+        if (!dest || !load(frame, data, payload)) {
+            ++self.dropped;
+            return;
+        }
+        self.supervisor->put(make_message<T>(*dest, std::move(payload)));
+    }
+
+    /** \brief the request or response decoder */
+    template <typename R>
+    static void decode_request(transport_t &self, const frame_t &frame, const void *data) noexcept {
+        using traits_t = request_traits_t<R>;
+        using response_wrapped_t = typename traits_t::response::wrapped_t;
+        using response_t = typename response_wrapped_t::response_t;
+
+        if (frame.kind == static_cast<std::uint16_t>(frame_kind_t::request)) {
+            auto dest = self.find_export(frame.address);
+            R payload{};
+            if (!dest || !load(frame, data, payload)) {
+                // the requester should not wait for the response, which will never come
+                auto ec = !dest ? error_code_t::transport_unknown_address : error_code_t::transport_mismatch;
+                self.refuse(frame, make_error_code(ec));
+                ++self.dropped;
+                return;
+            }
+            auto id = static_cast<request_id_t>(frame.request);
+            auto &addr = self.address;
+            self.supervisor->put(make_message<typename traits_t::request::wrapped_t>(*dest, id, addr, addr,
+                                                                                     std::move(payload)));
+            return;
+        }
+
+        auto req = self.take_pending<R>(frame.request);
+        if (!req) {
+            // the transport has been restarted, just drop it
+            ++self.dropped;
+            return;
+        }
+        auto &reply_to = req->payload.reply_to;
+        auto ec = decode_error(frame);
+        response_t res{};
+        if (!ec && !load(frame, data, res)) {
+            ec = make_error_code(error_code_t::transport_mismatch);
+        }
+        if (ec) {
+            self.supervisor->put(make_message<response_wrapped_t>(reply_to, ec, std::move(req)));
+        } else {
+            self.supervisor->put(make_message<response_wrapped_t>(reply_to, std::move(req), std::move(res)));
+        }
+    }
+
+    /** \brief subscribes plain message encoders on all proxy addresses */
+    template <typename T>
+    static void subscribe_message(transport_t &self, plugin::starter_plugin_t &plugin,
+                                  std::uint32_t type_id) noexcept {
+        using message_t = rotor::message_t<T>;
+        for (auto &it : self.imported) {
+            auto remote = it.first;
+            auto encoder = [&self, type_id, remote](message_t &message) noexcept {
+                auto frame = make_frame(frame_kind_t::message, type_id, remote);
+                if (!self.push_payload(frame, message.payload)) {
+                    ++self.dropped;
+                }
+            };
+            plugin.subscribe_actor(lambda<message_t>(std::move(encoder)), it.second);
+        }
+    }
+
+    /** \brief subscribes request encoders on all proxy addresses and response encoder on the own address */
+    template <typename R>
+    static void subscribe_request(transport_t &self, plugin::starter_plugin_t &plugin,
+                                  std::uint32_t type_id) noexcept {
+        using traits_t = request_traits_t<R>;
+        using request_message_t = typename traits_t::request::message_t;
+        using response_message_t = typename traits_t::response::message_t;
+
+        for (auto &it : self.imported) {
+            auto remote = it.first;
+            auto encoder = [&self, type_id, remote](request_message_t &message) noexcept {
+                auto frame = make_frame(frame_kind_t::request, type_id, remote);
+                frame.request = ++self.last_request;
+                if (self.push_payload(frame, message.payload.request_payload)) {
+                    auto fail = &transport_t::template fail_request<R>;
+                    self.remember(frame.request, message_ptr_t(&message), fail, message.payload.origin);
+                } else {
+                    self.reply_with_error(message, make_error_code(error_code_t::transport_overflow));
+                }
+            };
+            plugin.subscribe_actor(lambda<request_message_t>(std::move(encoder)), it.second);
+        }
+
+        auto encoder = [&self, type_id](response_message_t &message) noexcept {
+            auto frame = make_frame(frame_kind_t::response, type_id, 0);
+            frame.request = static_cast<std::uint64_t>(message.payload.req->payload.id);
+            auto &ec = message.payload.ec;
+            encode_error(frame, ec);
+            auto ok = ec ? self.push(frame, nullptr, 0) : self.push_payload(frame, message.payload.res);
+            if (!ok) {
+                // the requester will get timeout
+                ++self.dropped;
+            }
+        };
+        plugin.subscribe_actor(lambda<response_message_t>(std::move(encoder)));
+    }
+
+    /** \brief records the error code into the frame */
+    static void encode_error(frame_t &frame, const std::error_code &ec) noexcept;
+
+    /** \brief restores the error code from the frame */
+    static std::error_code decode_error(const frame_t &frame) noexcept;
+
+    /** \brief the shared memory segment name */
+    std::string name;
+
+    /** \brief whether the segment should be created */
+    bool create;
+
+    /** \brief the size of each ring (creator only) */
+    std::size_t capacity;
+
+    /** \brief the maximum amount of frames decoded in a row */
+    std::size_t batch;
+
+    /** \brief the shared memory segment, available after initialization */
+    segment_ptr_t segment;
+
+    /** \brief the registered payload types */
+    codecs_t codecs;
+
+    /** \brief the serialized outbound payload */
+    serialization_buffer_t buffer;
+
+    /** \brief the inbound ring watcher */
+    std::thread watcher;
+
+    /** \brief the watcher should exit */
+    std::atomic<bool> stopping{false};
+
+    /** \brief the notification has been sent and the inbound frames are not consumed yet */
+    std::atomic<bool> notified{false};
+
+    /** \brief guards the watcher sleep on `notified` */
+    std::mutex watch_mutex;
+
+    /** \brief wakes the watcher, when the inbound frames are consumed or it should stop */
+    std::condition_variable watch_condition;
+};
+
+} // namespace shm
+} // namespace rotor
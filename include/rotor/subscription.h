@@ -10,7 +10,10 @@
 #include "rotor/address.hpp"
 #include "rotor/subscription_point.h"
 #include "rotor/message.h"
+#include <boost/container/small_vector.hpp>
+#include <deque>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 namespace rotor {
@@ -26,17 +29,34 @@ struct subscription_t {
     /** \brief alias for message type (i.e. stringized typeid) */
     using message_type_t = const void *;
 
-    /** \brief vector of handler pointers */
-    using handlers_t = std::vector<handler_base_t *>;
+    /** \brief vector of handler pointers
+     *
+     * The single handler (the most common case) is stored inline, i.e. without
+     * additional memory allocation and indirection.
+     */
+    using handlers_t = boost::container::small_vector<handler_base_t *, 1>;
 
     /** \struct joint_handlers_t
      *  \brief pair internal and external {@link handler_t}
      */
     struct joint_handlers_t {
+        /** \brief direct invoker of the single internal handler
+         *
+         * It is set only when the internal handler is the sole recipient
+         * (the most common case), and it supports direct invocation; then
+         * the delivery does not need virtual call nor iteration over
+         * handlers.
+         */
+        handler_fn_t direct_call = nullptr;
+        /** \brief the sole internal handler, i.e. the argument for `direct_call` */
+        handler_base_t *direct_handler = nullptr;
         /** \brief internal handlers, i.e. those which belong to actors of the supervisor */
         handlers_t internal;
-        /** \brief external handlers, i.e. those which belong to actors of other supervisor */
+        /** \brief external handlers, i.e. those which belong to actors of other supervisor (grouped by supervisor) */
         handlers_t external;
+
+        /** \brief recalculates `direct_call` and `direct_handler` after handlers change */
+        void refresh() noexcept;
     };
 
     /** \brief ctor from supervisor reference */
@@ -69,13 +89,51 @@ struct subscription_t {
         }
     };
 
-    struct subscrption_key_hash_t {
-        inline std::size_t operator()(const subscrption_key_t &k) const noexcept {
-            return std::size_t(k.address) + 0x9e3779b9 + (size_t(k.message_type) << 6) + (size_t(k.message_type) >> 2);
-        }
-    };
+    /** \brief open-addressing hash map from subscription key to joint handlers
+     *
+     * The keys are kept in the flat array of slots (linear probing, backward
+     * shift deletion, i.e. no tombstones), so the lookup is usually resolved
+     * by the first probed slot.
+     *
+     * The joint handlers are kept outside of the slots array, in the storage
+     * with stable addresses, because the returned recipients might be
+     * iterated while new subscriptions are materialized (which might cause
+     * rehashing) or the old ones are forgotten.
+     */
+    struct addressed_handlers_t {
+        addressed_handlers_t() noexcept;
 
-    using addressed_handlers_t = std::unordered_map<subscrption_key_t, joint_handlers_t, subscrption_key_hash_t>;
+        /** \brief returns joint handlers for the key, inserting empty ones if there are no such */
+        joint_handlers_t &emplace(const subscrption_key_t &key) noexcept;
+
+        /** \brief returns joint handlers for the key or `nullptr` */
+        joint_handlers_t *find(const subscrption_key_t &key) const noexcept;
+
+        /** \brief removes the key with its joint handlers */
+        void erase(const subscrption_key_t &key) noexcept;
+
+        /** \brief amount of keys in the map */
+        inline std::size_t size() const noexcept { return count; }
+
+        /** \brief returns `true` if there are no keys in the map */
+        inline bool empty() const noexcept { return count == 0; }
+
+      private:
+        struct slot_t {
+            subscrption_key_t key;
+            joint_handlers_t *handlers;
+        };
+        using slots_t = std::vector<slot_t>;
+
+        std::size_t index_of(const subscrption_key_t &key) const noexcept;
+        void rehash(std::size_t capacity) noexcept;
+
+        slots_t slots;
+        std::size_t mask;
+        std::size_t count;
+        std::deque<joint_handlers_t> storage;
+        std::vector<joint_handlers_t *> spare;
+    };
 
     using info_container_t = std::unordered_map<address_ptr_t, std::vector<subscription_info_ptr_t>>;
     supervisor_t &supervisor;
@@ -10,12 +10,20 @@
 #include "handler.hpp"
 #include "message.h"
 #include "messages.hpp"
+#include "messages_queue.h"
 #include "subscription.h"
 #include "system_context.h"
 #include "supervisor_config.h"
 #include "address_mapping.h"
+#include "delivery_meter.h"
+#include "inbound_queue.hpp"
+#include "request_map.hpp"
+#include "timer_wheel.h"
 
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <memory>
 #include <unordered_map>
 
 namespace rotor {
@@ -113,9 +121,34 @@ struct supervisor_t : public actor_base_t {
      *
      * The method should be invoked in event-loop context only.
      *
+     * If the processing budget is set (see `supervisor_config_t::process_budget`),
+     * the method might return before the queue becomes empty; the processing
+     * is re-scheduled via `yield_process` then.
+     *
      */
     inline void do_process() noexcept { delivery->process(); }
 
+    /** \brief re-schedules `do_process` after the processing budget is exhausted
+     *
+     * The method is invoked on the locality leader in the event-loop context,
+     * the default implementation invokes `start`, i.e. the processing is resumed
+     * after the already pending loop events.
+     *
+     */
+    virtual void yield_process() noexcept { start(); }
+
+    /** \brief returns the address of the locality leader
+     *
+     * The {@link payload::backpressure_t} notifications of the locality are sent to
+     * that address, i.e. an actor (possibly from other locality) subscribes to them
+     * on the address of the destination supervisor leader, e.g.
+     * `subscribe(&my_actor_t::on_backpressure, dest_addr->supervisor.get_leader_address())`.
+     */
+    inline const address_ptr_t &get_leader_address() const noexcept { return locality_leader->get_address(); }
+
+    /** \brief returns the locality queue processing counters (see {@link process_stats_t}) */
+    inline const process_stats_t &get_process_stats() const noexcept { return locality_leader->process_stats; }
+
     /** \brief creates new {@link address_t} linked with the supervisor */
     virtual address_ptr_t make_address() noexcept;
 
@@ -138,11 +171,39 @@ struct supervisor_t : public actor_base_t {
 
     /** \brief triggers an action associated with the timer
      *
-     * Currently it just delivers response timeout, if any.
+     * Currently it just delivers response timeout, if any, or advances
+     * the requests timer wheel.
      *
      */
     virtual void on_timer_trigger(request_id_t timer_id);
 
+    /** \brief starts the request timeout timer
+     *
+     * If the timer wheel is enabled (see `supervisor_config_t::timer_resolution`),
+     * the timer is armed in the wheel and the handle is recorded in the `curry`;
+     * otherwise the backend timer is started via `start_timer`.
+     *
+     */
+    void start_request_timer(const pt::time_duration &timeout, request_id_t request_id,
+                             request_curry_t &curry) noexcept;
+
+    /** \brief cancels the request timeout timer, started via `start_request_timer` */
+    void cancel_request_timer(request_id_t request_id, request_curry_t &curry) noexcept;
+
+    /** \brief forgets the request and cancels its timeout timer, i.e. the late response is dropped */
+    void forget_request(request_id_t request_id) noexcept;
+
+    /** \brief starts the shared timeout timer for a group of requests
+     *
+     * The requests join the group via `request_builder_t::send_within`. The
+     * timer is cancelled once all of them are replied; otherwise, when it triggers,
+     * all still pending requests of the group are timed out at once.
+     *
+     * The group id is returned.
+     *
+     */
+    request_id_t create_request_group(const pt::time_duration &timeout) noexcept;
+
     /** \brief thread-safe version of `do_process`
      *
      * Starts supervisor to processing messages queue in safe thread/loop
@@ -155,6 +216,7 @@ struct supervisor_t : public actor_base_t {
     virtual void shutdown() noexcept = 0;
 
     void do_shutdown() noexcept override;
+    void shutdown_finish() noexcept override;
 
     /** \brief supervisor hook for reaction on child actor init */
     virtual void on_child_init(actor_base_t *actor, const std::error_code &ec) noexcept;
@@ -170,7 +232,8 @@ struct supervisor_t : public actor_base_t {
      * The thread-safety should be guaranteed by derived class and/or used event-loop.
      *
      * This method is used for messaging between supervisors with different
-     * localities, event loops or threads.
+     * localities, event loops or threads. The messages from other localities
+     * are already marked as shared (see `message_base_t::share`) by `rotor`.
      *
      */
     virtual void enqueue(message_ptr_t message) noexcept = 0;
@@ -180,8 +243,26 @@ struct supervisor_t : public actor_base_t {
      * This is thread-unsafe method. The `enqueue` method should be used to put
      * a new message from external context in thread-safe way.
      *
+     * The message is stamped with the current time, if {@link delivery_meter_t}
+     * is enabled.
+     *
+     * If the locality queue is bounded (see `supervisor_config_t::queue_capacity`)
+     * and it is full, the overflow policy of the locality leader is applied.
+     *
      */
-    inline void put(message_ptr_t message) { locality_leader->queue.emplace_back(std::move(message)); }
+    inline void put(message_ptr_t message) {
+        if (delivery_meter_t::enabled()) {
+            message->stamp = delivery_meter_t::now();
+        }
+        auto leader = locality_leader;
+        if (!leader->queue_capacity) {
+            leader->queue.emplace_back(std::move(message));
+        } else if (leader->queue.size() < leader->queue_capacity) {
+            accept(std::move(message));
+        } else {
+            overflow(std::move(message));
+        }
+    }
 
     /** \brief templated version of `subscribe_actor` */
     template <typename Handler> void subscribe(actor_base_t &actor, Handler &&handler) {
@@ -198,7 +279,9 @@ struct supervisor_t : public actor_base_t {
     template <typename Actor> auto create_actor() {
         using builder_t = typename Actor::template config_builder_t<Actor>;
         assert(manager && "child_manager_plugin_t should be already initialized");
-        return builder_t([this](auto &actor) { manager->create_child(actor); }, this);
+        auto builder = builder_t([this](auto &actor) { manager->create_child(actor); }, this);
+        builder.group_action = [this](auto &&actors) { manager->create_children(std::move(actors)); };
+        return builder;
     }
 
     /** \brief convenient method for request building
@@ -211,6 +294,19 @@ struct supervisor_t : public actor_base_t {
                                     Args &&... args) noexcept {
         return request_builder_t<T>(*this, actor, dest_addr, reply_to, std::forward<Args>(args)...);
     }
+
+    /** \brief returns the (imaginary) address, where responses to the requests of type `T` arrive
+     *
+     * The address and the response handler are created once per supervisor and per
+     * response type, and then they are reused by all requests of all child actors,
+     * i.e. there is no subscription round-trip on the first request of the type.
+     *
+     * The core requests types are pre-warmed in `do_initialize`; the method can be
+     * invoked in advance for the user-defined requests too.
+     *
+     */
+    template <typename T> address_ptr_t reply_address() noexcept;
+
     /**
      * \brief main subscription implementation
      *
@@ -228,11 +324,42 @@ struct supervisor_t : public actor_base_t {
     subscription_info_ptr_t subscribe(const handler_ptr_t &handler, const address_ptr_t &addr,
                                       const actor_base_t *owner_ptr, owner_tag_t owner_tag) noexcept;
 
+    /**
+     * \brief subscribes the handlers of the same (local) actor on the internal address at once
+     *
+     * All subscription points are materialized immediately and recorded into `infos`,
+     * but only the last one is confirmed via {@link payload::subscription_confirmation_t}:
+     * as the messages are delivered in order, its confirmation implies that all the
+     * handlers are subscribed.
+     *
+     * The subscription points are not recorded in the actor's lifetime plugin, i.e.
+     * they are not meant to be unsubscribed individually.
+     *
+     * The materialized subscription info of the last handler is returned.
+     *
+     */
+    subscription_info_ptr_t subscribe(const handler_ptr_t *handlers, std::size_t count, const address_ptr_t &addr,
+                                      const actor_base_t *owner_ptr, owner_tag_t owner_tag,
+                                      subscription_container_t &infos) noexcept;
+
     using actor_base_t::subscribe;
 
     /** \brief returns registry actor address (if it was defined or registry actor was created) */
     inline const address_ptr_t &get_registry_address() const noexcept { return registry_address; }
 
+    /** \brief returns registry actor address, which serves the name
+     *
+     * If the registry is sharded, the shard is selected by the name hash;
+     * otherwise it is the same as `get_registry_address()`.
+     */
+    const address_ptr_t &get_registry_address(const std::string &name) const noexcept;
+
+    /** \brief returns all registry actors addresses (shards) */
+    inline const std::vector<address_ptr_t> &get_registry_shards() const noexcept { return registry_shards; }
+
+    /** \brief returns `true` if the discovered addresses are cached by the supervisor */
+    inline bool has_discovery_cache() const noexcept { return discovery_cache; }
+
     /** \brief generic non-public fields accessor */
     template <typename T> auto &access() noexcept;
 
@@ -245,8 +372,8 @@ struct supervisor_t : public actor_base_t {
 
     /* \brief address-to-subscription map type */
 
-    /** \brief timer to response with timeout procuder type */
-    using request_map_t = std::unordered_map<request_id_t, request_curry_t>;
+    /** \brief in-flight requests (timer to response with timeout procuder) type */
+    using request_map_t = rotor::request_map_t;
 
     /** \brief non-owning pointer to system context. */
     system_context_t *context;
@@ -254,9 +381,6 @@ struct supervisor_t : public actor_base_t {
     /** \brief queue of unprocessed messages */
     messages_queue_t queue;
 
-    /** \brief counter for request/timer ids */
-    request_id_t last_req_id;
-
     /** \brief timer to response with timeout procuder */
     request_map_t request_map;
 
@@ -275,28 +399,145 @@ struct supervisor_t : public actor_base_t {
     /** \brief root supervisor for the locality */
     supervisor_t *locality_leader;
 
+    /** \brief reserves the room for the message in the inbound queue of the locality leader
+     *
+     * It is thread-safe, and it should be invoked by `enqueue` before the message is
+     * pushed into the inbound queue, i.e. in the producer thread. If the locality queue
+     * is bounded and the inbound queue already holds `queue_capacity` bounded messages,
+     * the message is not admitted: it is dropped (`drop_newest` and `drop_oldest`
+     * policies, as the oldest inbound messages are not accessible to the producer) or
+     * the error response is sent to the requestor (`reject` policy). The backpressure
+     * is notified by the leader upon the next drain then.
+     *
+     * Returns `true` if the message should be pushed into the inbound queue.
+     */
+    bool admit_inbound(message_base_t &message) noexcept;
+
+    /** \brief moves messages from the inbound queue into the locality queue
+     *
+     * Should be invoked on the locality leader; the queue capacity and the
+     * overflow policy are applied to the moved messages.
+     */
+    void drain(inbound_queue_t &inbound) noexcept;
+
+    /** \brief puts the single message, admitted via `admit_inbound`, into the locality queue
+     *
+     * It is intended for the backends without the inbound queue, which deliver each
+     * message separately in the event-loop context.
+     */
+    void put_inbound(message_ptr_t message) noexcept;
+
   private:
     bool create_registry;
     bool synchronize_start;
     address_ptr_t registry_address;
+    std::vector<address_ptr_t> registry_shards;
+    bool discovery_cache;
 
     supervisor_policy_t policy;
 
-    /** \brief per-actor and per-message request tracking support */
+    /** \brief the maximum amount of messages in the locality queue, zero means unbounded */
+    std::size_t queue_capacity;
+
+    /** \brief what to do with a new message, when the locality queue is full */
+    overflow_policy_t overflow_policy;
+
+    /** \brief whether {@link payload::backpressure_t} was sent in the current overflow episode
+     *
+     * The flag is meaningful only for the locality leader.
+     */
+    bool backpressure_notified;
+
+    /** \brief the amount of the bounded messages, admitted into the inbound queue, but not yet drained
+     *
+     * The counter is meaningful only for the locality leader.
+     */
+    std::atomic<std::size_t> inbound_load;
+
+    /** \brief whether inbound messages have been dropped since the last drain
+     *
+     * The flag is meaningful only for the locality leader.
+     */
+    std::atomic<bool> inbound_overflow;
+
+    /** \brief the limits of the single locality queue processing run */
+    process_budget_t process_budget;
+
+    /** \brief the locality queue processing counters */
+    process_stats_t process_stats;
+
+    /** \brief per-response type reply addresses (imaginary addresses) */
     address_mapping_t address_mapping;
 
+    using timer_wheel_ptr_t = std::unique_ptr<timer_wheel_t>;
+    using wheel_clock_t = std::chrono::steady_clock;
+
+    /** \brief requests timer wheel, if it is enabled */
+    timer_wheel_ptr_t timer_wheel;
+
+    /** \brief timer wheel tick in microseconds */
+    std::int64_t timer_resolution;
+
+    /** \brief start point of timer wheel ticks */
+    wheel_clock_t::time_point timer_epoch;
+
+    /** \brief the id of the backend timer, which drives the wheel (`0` if it is not started) */
+    request_id_t timer_wheel_timer;
+
+    /** \brief the wheel tick, when the backend timer fires */
+    timer_wheel_t::tick_t timer_wheel_deadline;
+
+    /** \struct request_group_t
+     *  \brief requests, guarded by the single shared timer */
+    struct request_group_t {
+        /** \brief ids of all requests of the group */
+        std::vector<request_id_t> requests;
+
+        /** \brief amount of not yet replied requests */
+        std::size_t pending = 0;
+
+        /** \brief the shared timer handle, if the supervisor uses timer wheel */
+        timer_wheel_t::handle_t timer_handle = timer_wheel_t::invalid_handle;
+    };
+
+    /** \brief group id to requests group mapping (type) */
+    using request_groups_t = std::unordered_map<request_id_t, request_group_t>;
+
+    /** \brief requests groups with active shared timers */
+    request_groups_t request_groups;
+
+    void start_request_timer(const pt::time_duration &timeout, request_id_t timer_id,
+                             timer_wheel_t::handle_t &handle) noexcept;
+    void cancel_request_timer(request_id_t timer_id, timer_wheel_t::handle_t &handle) noexcept;
+    void join_request_group(request_id_t group_id, request_id_t request_id) noexcept;
+    void leave_request_group(request_id_t group_id) noexcept;
+    void expire_request_group(request_groups_t::iterator it) noexcept;
+    void on_timer_wheel_tick() noexcept;
+    void drive_timer_wheel(timer_wheel_t::tick_t now, timer_wheel_t::tick_t deadline) noexcept;
+    void stop_timer_wheel() noexcept;
+    timer_wheel_t::tick_t timer_wheel_now() const noexcept;
+    void expire_request(request_id_t request_id) noexcept;
+    void overflow(message_ptr_t message) noexcept;
+    void notify_backpressure() noexcept;
+
+    /* enqueues the message into the bounded locality queue, which has room for it */
+    inline void accept(message_ptr_t &&message) noexcept {
+        auto leader = locality_leader;
+        leader->queue.emplace_back(std::move(message));
+        /* the overflow episode is over only when the queue is drained down to the low-water mark */
+        if (leader->backpressure_notified && leader->queue.size() <= leader->queue_capacity / 2) {
+            leader->backpressure_notified = false;
+        }
+    }
+    void resume_request(request_id_t request_id, message_ptr_t response) noexcept;
+
     template <typename T> friend struct request_builder_t;
+    template <typename T> friend struct request_awaiter_t;
     template <typename Supervisor> friend struct actor_config_builder_t;
     friend struct plugin::delivery_plugin_base_t;
     template <typename T> friend struct plugin::delivery_plugin_t;
 
-    inline request_id_t next_request_id() noexcept {
-        request_map_t::iterator it;
-        do {
-            it = request_map.find(++last_req_id);
-        } while (it != request_map.end());
-        return last_req_id;
-    }
+    inline request_id_t next_request_id() noexcept { return request_map.reserve(); }
 };
 
 using supervisor_ptr_t = intrusive_ptr_t<supervisor_t>;
@@ -357,6 +598,14 @@ template <typename Handler> subscription_info_ptr_t plugin_base_t::subscribe(Han
 
 template <> inline auto &plugin_base_t::access<plugin::starter_plugin_t>() noexcept { return own_subscriptions; }
 
+template <auto... Handlers> void starter_plugin_t::subscribe_actor(handlers_table_t<Handlers...>) noexcept {
+    handler_ptr_t handlers[] = {wrap_handler(*actor, Handlers)...};
+    auto &own_subscriptions = access<starter_plugin_t>();
+    auto info = actor->get_supervisor().subscribe(handlers, sizeof...(Handlers), actor->get_address(), actor,
+                                                  owner_tag_t::PLUGIN, own_subscriptions);
+    tracked.emplace_back(std::move(info));
+}
+
 template <typename Handler> handler_ptr_t starter_plugin_t::subscribe_actor(Handler &&handler) noexcept {
     auto &address = actor->get_address();
     return subscribe_actor(std::forward<Handler>(handler), address);
@@ -374,8 +623,24 @@ handler_ptr_t starter_plugin_t::subscribe_actor(Handler &&handler, const address
 }
 
 template <typename LocalDelivery> void delivery_plugin_t<LocalDelivery>::process() noexcept {
+    using clock_t = std::chrono::steady_clock;
+    auto &budget = leader->process_budget;
+    auto limited = budget.limited();
+    auto timed = budget.time.count() != 0;
+    auto deadline = timed ? clock_t::now() + budget.time : clock_t::time_point::max();
+    std::uint64_t processed = 0;
     while (queue->size()) {
-        auto message = queue->front();
+        if (limited && processed) {
+            auto exhausted = (budget.messages && processed >= budget.messages) || (timed && clock_t::now() >= deadline);
+            if (exhausted) {
+                leader->process_stats.record(processed, true);
+                leader->yield_process();
+                return;
+            }
+        }
+        ++processed;
+        // the message is moved out, i.e. the reference counter is not touched
+        auto message = std::move(queue->front());
         auto &dest = message->address;
         queue->pop_front();
         auto &dest_sup = dest->supervisor;
@@ -391,9 +656,12 @@ template <typename LocalDelivery> void delivery_plugin_t<LocalDelivery>::process
                 LocalDelivery::delivery(message, *local_recipients);
             }
         } else {
+            // the message crosses locality boundary
+            message->share();
             dest_sup.enqueue(std::move(message));
         }
     }
+    leader->process_stats.record(processed, false);
 }
 
 } // namespace plugin
@@ -407,55 +675,76 @@ void actor_base_t::unsubscribe(Handler &&h, address_ptr_t &addr) noexcept {
     supervisor->unsubscribe_actor(addr, wrap_handler(*this, std::move(h)));
 }
 
+template <typename T> address_ptr_t supervisor_t::reply_address() noexcept {
+    using traits_t = request_traits_t<T>;
+    using response_message_t = typename traits_t::response::message_t;
+    using wrapped_res_t = typename traits_t::response::wrapped_t;
+
+    auto addr = address_mapping.get_mapped_address(*this, response_message_t::message_type);
+    if (addr) {
+        return addr;
+    }
+
+    // subscribe to imaginary address instead of real one because of
+    // 1. faster dispatching
+    // 2. need to distinguish between "timeout guarded responses" and "responses to own requests"
+    addr = make_address();
+    auto handler = lambda<response_message_t>([supervisor = this](response_message_t &msg) {
+        auto request_id = msg.payload.request_id();
+        auto curry = supervisor->request_map.find(request_id);
+        if (curry) {
+            supervisor->cancel_request_timer(request_id, *curry);
+            if (curry->continuation) {
+                supervisor->resume_request(request_id, message_ptr_t(&msg));
+            } else {
+                // the imaginary address has no other subscribers, so the payload can be stolen
+                // if the message is not referenced elsewhere
+                if (msg.use_count() == 1) {
+                    supervisor->template send<wrapped_res_t>(curry->origin, std::move(msg.payload));
+                } else {
+                    supervisor->template send<wrapped_res_t>(curry->origin, msg.payload);
+                }
+                supervisor->request_map.erase(request_id);
+            }
+        }
+        // if a response to request has arrived and no timer can be found
+        // that means that either timeout timer already triggered
+        // and error-message already delivered or response is not expected.
+        // just silently drop it anyway
+    });
+    auto wrapped_handler = wrap_handler(*this, std::move(handler));
+    auto info = subscribe(wrapped_handler, addr, this, owner_tag_t::SUPERVISOR);
+    address_mapping.set(*this, info);
+    return addr;
+}
+
 template <typename T>
 template <typename... Args>
 request_builder_t<T>::request_builder_t(supervisor_t &sup_, actor_base_t &actor_, const address_ptr_t &destination_,
                                         const address_ptr_t &reply_to_, Args &&... args)
     : sup{sup_}, actor{actor_}, request_id{sup.next_request_id()}, destination{destination_}, reply_to{reply_to_},
-      do_install_handler{false} {
-    auto addr = sup.address_mapping.get_mapped_address(actor_, response_message_t::message_type);
-    if (addr) {
-        imaginary_address = addr;
-    } else {
-        // subscribe to imaginary address instead of real one because of
-        // 1. faster dispatching
-        // 2. need to distinguish between "timeout guarded responses" and "responses to own requests"
-        imaginary_address = sup.make_address();
-        do_install_handler = true;
-    }
+      imaginary_address{sup.template reply_address<T>()} {
     req.reset(
         new request_message_t{destination, request_id, imaginary_address, reply_to_, std::forward<Args>(args)...});
 }
 
+template <typename T> request_builder_t<T>::~request_builder_t() { sup.request_map.discard(request_id); }
+
 template <typename T> request_id_t request_builder_t<T>::send(pt::time_duration timeout) noexcept {
-    if (do_install_handler) {
-        install_handler();
-    }
     auto fn = &request_traits_t<T>::make_error_response;
-    sup.request_map.emplace(request_id, request_curry_t{fn, reply_to, req});
-    sup.put(req);
-    sup.start_timer(timeout, request_id);
+    auto &curry = sup.request_map.emplace(request_id, request_curry_t{fn, reply_to, req});
+    sup.put(std::move(req));
+    sup.start_request_timer(timeout, request_id, curry);
     return request_id;
 }
 
-template <typename T> void request_builder_t<T>::install_handler() noexcept {
-    auto handler = lambda<response_message_t>([supervisor = &sup](response_message_t &msg) {
-        auto request_id = msg.payload.request_id();
-        auto it = supervisor->request_map.find(request_id);
-        if (it != supervisor->request_map.end()) {
-            supervisor->cancel_timer(request_id);
-            auto &orig_addr = it->second.origin;
-            supervisor->template send<wrapped_res_t>(orig_addr, msg.payload);
-            supervisor->request_map.erase(it);
-        }
-        // if a response to request has arrived and no timer can be found
-        // that means that either timeout timer already triggered
-        // and error-message already delivered or response is not expected.
-        // just silently drop it anyway
-    });
-    auto wrapped_handler = wrap_handler(sup, std::move(handler));
-    auto info = sup.subscribe(wrapped_handler, imaginary_address, &actor, owner_tag_t::SUPERVISOR);
-    sup.address_mapping.set(actor, info);
+template <typename T> request_id_t request_builder_t<T>::send_within(request_id_t group_id) noexcept {
+    auto fn = &request_traits_t<T>::make_error_response;
+    auto &curry = sup.request_map.emplace(request_id, request_curry_t{fn, reply_to, req});
+    curry.group = group_id;
+    sup.join_request_group(group_id, request_id);
+    sup.put(std::move(req));
+    return request_id;
 }
 
 /** \brief makes an reqest to the destination address with the message constructed from `args`
@@ -520,4 +809,36 @@ template <typename Actor> intrusive_ptr_t<Actor> actor_config_builder_t<Actor>::
     return actor_ptr;
 }
 
+template <typename Actor>
+std::vector<intrusive_ptr_t<Actor>> actor_config_builder_t<Actor>::finish(std::size_t count) && {
+    actors_t actors;
+    if (!validate()) {
+        auto ec = make_error_code(error_code_t::actor_misconfigured);
+        system_context.on_error(ec);
+        return actors;
+    }
+
+    auto &cfg = static_cast<typename builder_t::config_t &>(config);
+    // the untyped list is handed over to the group action as is, i.e. without copying
+    std::vector<rotor::actor_ptr_t> group;
+    actors.reserve(count);
+    if (group_action) {
+        group.reserve(count);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        auto &actor = actors.emplace_back(new Actor(cfg));
+        if (group_action) {
+            group.emplace_back(actor);
+        }
+    }
+    if (group_action) {
+        group_action(std::move(group));
+    } else {
+        for (auto &actor_ptr : actors) {
+            install_action(actor_ptr);
+        }
+    }
+    return actors;
+}
+
 } // namespace rotor
@@ -8,6 +8,9 @@
 
 #include "policy.h"
 #include "actor_config.h"
+#include "messages_queue.h"
+#include "process_budget.h"
+#include <vector>
 
 namespace rotor {
 
@@ -34,6 +37,67 @@ struct supervisor_config_t : actor_config_t {
      * hierarchy
      */
     address_ptr_t registry_address;
+
+    /** \brief use the specified registries as shards, the name is served by
+     * the shard selected by the name hash
+     *
+     * The registries might be created on the different supervisors (threads),
+     * so the registration and discovery requests do not contend on a single
+     * registry actor.
+     */
+    std::vector<address_ptr_t> registry_shards;
+
+    /** \brief whether the successfully discovered addresses should be cached
+     * by the supervisor, so that subsequent discoveries of the same name by
+     * its child actors do not involve the registry
+     *
+     * The cache entries are invalidated, when the registry receives
+     * deregistration messages.
+     */
+    bool discovery_cache = false;
+
+    /** \brief the tick of the requests timer wheel
+     *
+     * When it is non-zero, the requests timeouts are tracked by the
+     * supervisor-internal {@link timer_wheel_t}, which is driven by a single
+     * backend timer; otherwise (default), every request starts its own
+     * backend timer. The backend timer is armed for the earliest request
+     * deadline, i.e. the idle ticks do not wake the supervisor up.
+     *
+     * The requests timeouts are rounded up to the resolution.
+     */
+    pt::time_duration timer_resolution;
+
+    /** \brief the maximum amount of messages in the locality queue
+     *
+     * Zero (default) means unbounded queue. The setting of the locality
+     * leader is applied for the whole locality. The rotor-internal messages
+     * and responses are always enqueued, and only user messages and requests
+     * are subject of the `overflow_policy`.
+     */
+    std::size_t queue_capacity = 0;
+
+    /** \brief what to do with a new message, when the queue is full */
+    overflow_policy_t overflow_policy = overflow_policy_t::drop_newest;
+
+    /** \brief the weights of `high`, `normal` and `bulk` lanes of the locality queue
+     *
+     * The `system` lane (rotor lifecycle messages) is always drained first, the
+     * other lanes are drained in weighted round-robin manner. All-zeroes weights
+     * (default) disable the lanes, i.e. the locality queue is plain FIFO. The
+     * setting of the locality leader is applied for the whole locality.
+     *
+     * The `messages_queue_t::default_weights` are the reasonable starting point.
+     */
+    lane_weights_t lane_weights = {0, 0, 0};
+
+    /** \brief the limits of the single messages processing run (unlimited by default)
+     *
+     * When the budget is exhausted, the supervisor yields back to the event loop
+     * and re-schedules the processing, see `supervisor_t::yield_process`. The
+     * setting of the locality leader is applied for the whole locality.
+     */
+    process_budget_t process_budget;
 };
 
 /** \brief CRTP supervisor config builder */
@@ -70,11 +134,69 @@ template <typename Supervisor> struct supervisor_config_builder_t : actor_config
         return std::move(*static_cast<typename parent_t::builder_t *>(this));
     }
 
+    /** \brief injects external registry addresses, which shard names by hash */
+    builder_t &&registry_shards(const std::vector<address_ptr_t> &value) &&noexcept {
+        parent_t::config.registry_shards = value;
+        return std::move(*static_cast<typename parent_t::builder_t *>(this));
+    }
+
+    /** \brief instructs supervisor to cache discovered addresses */
+    builder_t &&discovery_cache(bool value = true) &&noexcept {
+        parent_t::config.discovery_cache = value;
+        return std::move(*static_cast<typename parent_t::builder_t *>(this));
+    }
+
+    /** \brief enables requests timer wheel with the specified tick */
+    builder_t &&timer_resolution(const pt::time_duration &value) &&noexcept {
+        parent_t::config.timer_resolution = value;
+        return std::move(*static_cast<typename parent_t::builder_t *>(this));
+    }
+
+    /** \brief limits the locality queue size (zero means unbounded) */
+    builder_t &&queue_capacity(std::size_t value) &&noexcept {
+        parent_t::config.queue_capacity = value;
+        return std::move(*static_cast<typename parent_t::builder_t *>(this));
+    }
+
+    /** \brief defines what to do with a new message, when the queue is full */
+    builder_t &&overflow_policy(overflow_policy_t value) &&noexcept {
+        parent_t::config.overflow_policy = value;
+        return std::move(*static_cast<typename parent_t::builder_t *>(this));
+    }
+
+    /** \brief defines the weights of `high`, `normal` and `bulk` queue lanes (all-zeroes disables lanes) */
+    builder_t &&lane_weights(const lane_weights_t &value) &&noexcept {
+        parent_t::config.lane_weights = value;
+        return std::move(*static_cast<typename parent_t::builder_t *>(this));
+    }
+
+    /** \brief limits the amount of messages processed in a row (zero means unlimited) */
+    builder_t &&process_budget(std::size_t messages) &&noexcept {
+        parent_t::config.process_budget.messages = messages;
+        return std::move(*static_cast<typename parent_t::builder_t *>(this));
+    }
+
+    /** \brief limits the time of the messages processing in a row (zero means unlimited) */
+    builder_t &&process_time_budget(const pt::time_duration &value) &&noexcept {
+        parent_t::config.process_budget.time = std::chrono::nanoseconds(value.total_nanoseconds());
+        return std::move(*static_cast<typename parent_t::builder_t *>(this));
+    }
+
     virtual bool validate() noexcept {
         bool r = parent_t::validate();
         if (r) {
             r = !(parent_t::config.registry_address && parent_t::config.create_registry);
         }
+        if (r) {
+            auto &config = parent_t::config;
+            r = config.registry_shards.empty() || !(config.registry_address || config.create_registry);
+        }
+        if (r) {
+            r = !parent_t::config.timer_resolution.is_negative();
+        }
+        if (r) {
+            r = parent_t::config.process_budget.time.count() >= 0;
+        }
         return r;
     }
 };
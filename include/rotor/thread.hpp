@@ -0,0 +1,22 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+/** \file thread.hpp
+ * A convenience header to include rotor support for the plain threads backend
+ */
+
+#include "rotor/thread/supervisor_config_thread.h"
+#include "rotor/thread/supervisor_thread.h"
+#include "rotor/thread/system_context_thread.h"
+
+namespace rotor {
+
+/// namespace for the plain threads (work-stealing pool) adapters for `rotor`
+namespace thread {}
+
+} // namespace rotor
@@ -0,0 +1,36 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/supervisor_config.h"
+
+namespace rotor {
+namespace thread {
+
+/** \struct supervisor_config_thread_t
+ *  \brief plain threads supervisor config
+ *
+ * The only difference from the base config is that the requests timer wheel
+ * is enabled by default (with 1ms resolution), as the thread backend timers
+ * are relatively expensive.
+ */
+struct supervisor_config_thread_t : public supervisor_config_t {
+    /** \brief constructs config from raw supervisor pointer and enables the timer wheel */
+    supervisor_config_thread_t(supervisor_t *supervisor_) : supervisor_config_t(supervisor_) {
+        timer_resolution = pt::milliseconds{1};
+    }
+};
+
+/** \brief CRTP supervisor thread config builder */
+template <typename Supervisor> struct supervisor_config_thread_builder_t : supervisor_config_builder_t<Supervisor> {
+    /** \brief parent config builder */
+    using parent_t = supervisor_config_builder_t<Supervisor>;
+    using parent_t::parent_t;
+};
+
+} // namespace thread
+} // namespace rotor
@@ -0,0 +1,101 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/supervisor.h"
+#include "rotor/inbound_queue.hpp"
+#include "rotor/thread/supervisor_config_thread.h"
+#include "rotor/thread/system_context_thread.h"
+#include <atomic>
+#include <map>
+#include <unordered_map>
+
+namespace rotor {
+namespace thread {
+
+/** \struct supervisor_thread_t
+ *  \brief delivers rotor-messages on top of the worker threads pool of
+ * {@link system_context_thread_t}
+ *
+ * Each supervisor is a separate locality, i.e. it (and its non-supervisor
+ * children actors) is processed sequentially, while different supervisors
+ * are processed concurrently by the different workers. There is no
+ * affinity of a supervisor to a worker thread: an idle worker steals
+ * ready supervisors from the busy ones.
+ *
+ * Messages from other supervisors are collected in the lock-free inbound
+ * queue; the supervisor is scheduled to a worker only once per burst.
+ *
+ * The timers are kept by supervisor itself, the system context only tracks
+ * the nearest deadline to wake the supervisor up.
+ *
+ */
+struct supervisor_thread_t : public supervisor_t {
+    /** \brief injects an alias for supervisor_config_thread_t */
+    using config_t = supervisor_config_thread_t;
+
+    /** \brief injects templated supervisor_config_thread_builder_t */
+    template <typename Supervisor> using config_builder_t = supervisor_config_thread_builder_t<Supervisor>;
+
+    /** \brief constructs new supervisor from thread supervisor config */
+    supervisor_thread_t(supervisor_config_thread_t &config);
+
+    address_ptr_t make_address() noexcept override;
+    void start() noexcept override;
+    void shutdown() noexcept override;
+    void enqueue(message_ptr_t message) noexcept override;
+    void start_timer(const pt::time_duration &send, request_id_t timer_id) noexcept override;
+    void cancel_timer(request_id_t timer_id) noexcept override;
+    void shutdown_finish() noexcept override;
+
+    /** \brief returns pointer to the thread system context */
+    inline system_context_thread_t *get_context() noexcept { return static_cast<system_context_thread_t *>(context); }
+
+  protected:
+    /** \brief an alias for the timers clock */
+    using clock_t = system_context_thread_t::clock_t;
+
+    /** \brief ordered timers deadlines, i.e. deadline to timer id mapping */
+    using deadlines_t = std::multimap<clock_t::time_point, request_id_t>;
+
+    /** \brief timer id to deadline mapping */
+    using timers_map_t = std::unordered_map<request_id_t, deadlines_t::iterator>;
+
+    /** \brief schedules the supervisor in the system context, unless it is already scheduled */
+    void wake() noexcept;
+
+    /** \brief drains inbound queue, triggers expired timers and processes messages
+     *
+     * Invoked by a worker of the system context.
+     */
+    virtual void on_run() noexcept;
+
+    /** \brief triggers all timers, which are expired at the `now` */
+    void trigger_timers(clock_t::time_point now) noexcept;
+
+    /** \brief inbound messages queue, i.e. the structure to hold messages
+     * received from other supervisors / threads
+     */
+    inbound_queue_t inbound;
+
+    /** \brief whether the supervisor is in a ready queue or is being processed */
+    std::atomic<bool> scheduled;
+
+    /** \brief ordered timers deadlines */
+    deadlines_t deadlines;
+
+    /** \brief timer_id to deadline map */
+    timers_map_t timers_map;
+
+    /** \brief the deadline known to system context (protected by its mutex) */
+    clock_t::time_point armed_deadline;
+
+    friend struct system_context_thread_t;
+};
+
+} // namespace thread
+} // namespace rotor
@@ -0,0 +1,120 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/arc.hpp"
+#include "rotor/thread/supervisor_config_thread.h"
+#include "rotor/system_context.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rotor {
+namespace thread {
+
+struct supervisor_thread_t;
+
+/** \brief intrusive pointer for thread supervisor */
+using supervisor_ptr_t = intrusive_ptr_t<supervisor_thread_t>;
+
+/** \struct system_context_thread_t
+ *  \brief The system context, which owns a pool of worker threads
+ *
+ * Every {@link supervisor_thread_t} is a separate locality, i.e. a unit of
+ * scheduling: when a locality has something to do (inbound messages or
+ * expired timers), it is put into the ready queue of some worker, which
+ * then processes the whole locality queue. A locality is never processed
+ * by more than one worker at a time.
+ *
+ * Each worker has its own ready queue. The locality, scheduled from the
+ * worker thread, is put into the worker's own queue; the idle workers
+ * steal localities from the other workers queues.
+ *
+ * The context also tracks the nearest timer deadline of each locality
+ * and schedules the locality when the deadline comes. The deadlines are
+ * checked by every worker before taking the next locality, i.e. they
+ * expire even if the workers are never idle.
+ *
+ * The `run` method blocks until the root supervisor is shut down.
+ *
+ */
+struct system_context_thread_t : public system_context_t {
+    /** \brief intrusive pointer type for thread system context */
+    using ptr_t = rotor::intrusive_ptr_t<system_context_thread_t>;
+
+    /** \brief the clock used for the timers */
+    using clock_t = std::chrono::steady_clock;
+
+    /** \brief constructs context with the specified amount of workers
+     *
+     * If `workers_count` is zero, the hardware concurrency is used.
+     */
+    system_context_thread_t(std::size_t workers_count = 0);
+    ~system_context_thread_t();
+
+    /** \brief runs the workers, the current thread becomes one of them
+     *
+     * The method returns when the root supervisor has been shut down
+     * (or `stop` has been invoked).
+     */
+    void run() noexcept;
+
+    /** \brief thread-safe workers stop request */
+    void stop() noexcept;
+
+    /** \brief returns the amount of workers */
+    inline std::size_t get_workers_count() const noexcept { return workers.size(); }
+
+  protected:
+    friend struct supervisor_thread_t;
+
+    /** \brief puts the locality leader into a ready queue (thread-safe) */
+    void schedule(supervisor_thread_t *leader) noexcept;
+
+    /** \brief registers the locality leader to be scheduled at the `deadline` (thread-safe) */
+    void schedule_at(supervisor_thread_t *leader, clock_t::time_point deadline) noexcept;
+
+  private:
+    struct worker_t {
+        std::mutex mutex;
+        std::deque<supervisor_ptr_t> ready;
+    };
+    using worker_ptr_t = std::unique_ptr<worker_t>;
+    using workers_t = std::vector<worker_ptr_t>;
+    using deadlines_t = std::multimap<clock_t::time_point, supervisor_ptr_t>;
+
+    void work(std::size_t index) noexcept;
+    supervisor_ptr_t take(std::size_t index) noexcept;
+    void expire() noexcept;
+    void idle() noexcept;
+    void update_nearest() noexcept;
+
+    workers_t workers;
+    std::atomic<std::size_t> next_worker;
+    std::atomic<std::size_t> ready_count;
+    std::atomic<std::size_t> idle_count;
+    std::atomic<bool> stopped;
+
+    /* the earliest deadline (since clock epoch), so the workers check it without lock */
+    std::atomic<clock_t::rep> nearest;
+
+    /* protects deadlines, the leaders armed deadlines and the sleeping workers */
+    std::mutex mutex;
+    std::condition_variable condition;
+    deadlines_t deadlines;
+};
+
+/** \brief intrusive pointer type for thread system context */
+using system_context_ptr_t = typename system_context_thread_t::ptr_t;
+
+} // namespace thread
+} // namespace rotor
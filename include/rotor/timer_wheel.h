@@ -0,0 +1,128 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "forward.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace rotor {
+
+/** \struct timer_wheel_t
+ *  \brief hashed timing wheel for request timeouts
+ *
+ * Time is measured in abstract ticks. The timer expiring at tick `T` is
+ * placed into the slot `T % slots_count`, i.e. the wheel revolution does
+ * not limit the maximum timeout: the timers for the next revolutions just
+ * wait in their slots.
+ *
+ * Timers are kept in the intrusive doubly-linked lists of nodes, which are
+ * stored in the single array and recycled via free-list, so arming and
+ * cancelling timer is O(1) and does not allocate (once the array has grown
+ * enough).
+ *
+ */
+struct timer_wheel_t {
+    /** \brief timer handle, i.e. node index */
+    using handle_t = std::uint32_t;
+
+    /** \brief abstract time unit */
+    using tick_t = std::uint64_t;
+
+    /** \brief the handle value, which does not refer any timer */
+    static constexpr handle_t invalid_handle = static_cast<handle_t>(-1);
+
+    /** \brief the default amount of slots */
+    static constexpr std::size_t default_slots = 512;
+
+    /** \brief constructs wheel; the amount of slots is rounded up to the power of 2 */
+    timer_wheel_t(std::size_t slots_count = default_slots) noexcept;
+
+    /** \brief starts timer, which expires at the `tick` (should be greater than current one) */
+    handle_t arm(tick_t tick, request_id_t timer_id) noexcept;
+
+    /** \brief cancels previously armed timer
+     *
+     * The timer is identified by handle and the timer id; if there is no
+     * such timer (i.e. it is already expired), the method does nothing.
+     *
+     */
+    void cancel(handle_t handle, request_id_t timer_id) noexcept;
+
+    /** \brief moves current tick up to the `tick` and invokes `fn(timer_id)` for each expired timer
+     *
+     * The expired timers are removed from the wheel before `fn` is invoked, so
+     * it is safe to arm or cancel timers from the callback.
+     */
+    template <typename Fn> void advance(tick_t tick, Fn &&fn) noexcept {
+        collect(tick);
+        for (auto timer_id : expired) {
+            fn(timer_id);
+        }
+        expired.clear();
+    }
+
+    /** \brief drops all active timers without invoking anything, the current tick is kept */
+    void clear() noexcept;
+
+    /** \brief removes all active timers and invokes `fn(timer_id)` for each of them, as if they expired
+     *
+     * The timers are removed before `fn` is invoked, i.e. the timers, armed from the callback,
+     * stay in the wheel.
+     */
+    template <typename Fn> void drain(Fn &&fn) noexcept {
+        expired_t drained;
+        for (auto &node : nodes) {
+            if (node.armed) {
+                drained.emplace_back(node.timer_id);
+            }
+        }
+        clear();
+        for (auto timer_id : drained) {
+            fn(timer_id);
+        }
+    }
+
+    /** \brief returns the tick of the earliest active timer (the wheel should not be empty) */
+    tick_t next_expiry() const noexcept;
+
+    /** \brief returns current tick, i.e. the last processed one */
+    inline tick_t current() const noexcept { return now; }
+
+    /** \brief returns amount of active timers */
+    inline std::size_t size() const noexcept { return count; }
+
+    /** \brief returns `true` if there are no active timers */
+    inline bool empty() const noexcept { return count == 0; }
+
+  private:
+    struct node_t {
+        request_id_t timer_id;
+        tick_t expires;
+        handle_t prev;
+        handle_t next;
+        bool armed;
+    };
+    using nodes_t = std::vector<node_t>;
+    using slots_t = std::vector<handle_t>;
+    using expired_t = std::vector<request_id_t>;
+
+    void collect(tick_t tick) noexcept;
+    void link(handle_t handle) noexcept;
+    void unlink(handle_t handle) noexcept;
+    void release(handle_t handle) noexcept;
+
+    nodes_t nodes;
+    slots_t slots;
+    expired_t expired;
+    handle_t spare;
+    std::size_t mask;
+    std::size_t count;
+    tick_t now;
+};
+
+} // namespace rotor
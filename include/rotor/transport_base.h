@@ -0,0 +1,199 @@
+#pragma once
+
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "actor_base.h"
+#include "supervisor.h"
+#include <chrono>
+#include <map>
+#include <optional>
+#include <unordered_map>
+
+namespace rotor {
+
+/** \struct transport_base_config_t
+ *  \brief the configuration, common for the inter-process transports
+ */
+struct transport_base_config_t : actor_config_t {
+    /** \brief how long the request, sent to the other side, is remembered while there is no response */
+    pt::time_duration pending_timeout = pt::seconds{60};
+
+    using actor_config_t::actor_config_t;
+};
+
+/** \brief CRTP inter-process transport config builder */
+template <typename Actor> struct transport_base_config_builder_t : actor_config_builder_t<Actor> {
+    /** \brief final builder class */
+    using builder_t = typename Actor::template config_builder_t<Actor>;
+
+    /** \brief parent config builder */
+    using parent_t = actor_config_builder_t<Actor>;
+    using parent_t::parent_t;
+
+    /** \brief sets how long the unanswered request is remembered, should not be less than requests timeouts */
+    builder_t &&pending_timeout(const pt::time_duration &value) &&noexcept {
+        parent_t::config.pending_timeout = value;
+        return std::move(*static_cast<builder_t *>(this));
+    }
+};
+
+/** \struct transport_base_t
+ *  \brief the addresses and requests bookkeeping, common for the inter-process transports
+ *
+ * The addresses are identified on the wire by the stable ids: the actor
+ * addresses are *exported* by the one side, while the other side *imports*
+ * them as the local proxy addresses.
+ *
+ * The request, sent to the other side, is remembered under the monotonically
+ * growing sequence until the response arrives; the unanswered request is
+ * forgotten after `pending_timeout` (the request timeout is tracked, as usual,
+ * by the requester supervisor). The expiration is driven by the supervisor
+ * timer, which is armed while there are pending requests.
+ *
+ * The wire format, the payloads (de)serialization and the proxy addresses
+ * handlers are up to the descendants, e.g. {@link shm::transport_t} or
+ * {@link asio::bridge_t}.
+ *
+ */
+struct transport_base_t : public actor_base_t {
+    /** \brief injects an alias for transport_base_config_t */
+    using config_t = transport_base_config_t;
+
+    /** \brief injects templated transport_base_config_builder_t */
+    template <typename Actor> using config_builder_t = transport_base_config_builder_t<Actor>;
+
+    /** \brief constructs the transport from the config */
+    explicit transport_base_t(config_t &config);
+
+    /** \brief makes the local address available to the other side under the stable `id` */
+    virtual void export_address(std::uint64_t id, const address_ptr_t &addr) noexcept;
+
+    /** \brief returns the local proxy address for the address, exported by other side under the `id` */
+    virtual address_ptr_t import_address(std::uint64_t id) noexcept;
+
+    /** \brief returns the amount of messages, which were not delivered */
+    inline std::size_t get_dropped() const noexcept { return dropped; }
+
+    void configure(plugin::plugin_base_t &plugin) noexcept override;
+    void shutdown_finish() noexcept override;
+
+  protected:
+    /** \brief replies to the request, which has been sent to the other side, when it cannot be answered */
+    using failer_t = void (*)(transport_base_t &transport, message_base_t &request, const std::error_code &ec) noexcept;
+
+    /** \brief stable id to address mapping (type) */
+    using addresses_map_t = std::unordered_map<std::uint64_t, address_ptr_t>;
+
+    /** \brief monotonic clock for the pending requests expiration */
+    using clock_t = std::chrono::steady_clock;
+
+    /** \struct pending_request_t
+     *  \brief the request, sent to the other side and awaiting the response */
+    struct pending_request_t {
+        /** \brief the original request message */
+        message_ptr_t message;
+
+        /** \brief the replier of the request type */
+        failer_t fail;
+
+        /** \brief the request origin, which is retained while the request is pending */
+        address_ptr_t origin;
+
+        /** \brief the request is forgotten after that time */
+        clock_t::time_point deadline;
+    };
+
+    /** \brief request sequence to the pending request mapping, the oldest requests go first (type) */
+    using pending_t = std::map<std::uint64_t, pending_request_t>;
+
+    /** \brief the response of the {@link expiry_request_t}, it carries nothing */
+    struct expiry_tick_t {};
+
+    /** \brief the request, which is never answered, i.e. its timeout response drives the expiration */
+    struct expiry_request_t {
+        /** \brief the response type */
+        using response_t = expiry_tick_t;
+    };
+
+    /** \brief the timeout response of the expiry request (type) */
+    using expiry_response_t = typename request_traits_t<expiry_request_t>::response::message_t;
+
+    /** \brief returns the exported address by the stable id, or `nullptr` */
+    const address_ptr_t *find_export(std::uint64_t id) const noexcept;
+
+    /** \brief remembers the sent request until the response arrives, and forgets the expired ones */
+    void remember(std::uint64_t sequence, message_ptr_t message, failer_t fail, const address_ptr_t &origin) noexcept;
+
+    /** \brief forgets and returns the pending request of the type `R`, or `nullptr` if there is no such one
+     *
+     * The request origin is not released, it is up to the caller.
+     */
+    template <typename R>
+    typename request_traits_t<R>::request::message_ptr_t take_pending(std::uint64_t sequence) noexcept {
+        using request_message_t = typename request_traits_t<R>::request::message_t;
+        using request_ptr_t = typename request_traits_t<R>::request::message_ptr_t;
+        auto it = pending.find(sequence);
+        if (it == pending.end() || it->second.message->type_index != request_message_t::message_type) {
+            return {};
+        }
+        auto req = request_ptr_t(static_cast<request_message_t *>(it->second.message.get()));
+        pending.erase(it);
+        return req;
+    }
+
+    /** \brief replies with the error to all pending requests and forgets them */
+    void fail_pending(const std::error_code &ec) noexcept;
+
+    /** \brief makes sure, that `on_expiry` is invoked not later than at the `deadline` */
+    void schedule_expiry(clock_t::time_point deadline) noexcept;
+
+    /** \brief forgets the expired pending requests, and schedules the next expiration if needed */
+    virtual void on_expiry() noexcept;
+
+    /** \brief the address is used by one more pending request, does nothing by default */
+    virtual void retain(const address_ptr_t &address) noexcept;
+
+    /** \brief the address is not used by the pending request anymore, does nothing by default */
+    virtual void release(const address_ptr_t &address) noexcept;
+
+    /** \brief replies with the error to the pending request */
+    template <typename R>
+    static void fail_request(transport_base_t &self, message_base_t &message, const std::error_code &ec) noexcept {
+        using request_message_t = typename request_traits_t<R>::request::message_t;
+        self.reply_with_error(static_cast<request_message_t &>(message), ec);
+    }
+
+    /** \brief how long the unanswered request is remembered */
+    clock_t::duration pending_timeout;
+
+    /** \brief the local addresses, available to the other side */
+    addresses_map_t exported;
+
+    /** \brief the proxy addresses of the other side addresses */
+    addresses_map_t imported;
+
+    /** \brief the requests, sent to the other side and awaiting responses */
+    pending_t pending;
+
+    /** \brief the last request sequence */
+    std::uint64_t last_request = 0;
+
+    /** \brief the request, which timeout is the next `on_expiry` invocation */
+    std::optional<request_id_t> expiry_request;
+
+    /** \brief when the `expiry_request` times out */
+    clock_t::time_point expiry_deadline;
+
+    /** \brief the amount of undelivered messages */
+    std::size_t dropped = 0;
+
+  private:
+    void on_expiry_timeout(expiry_response_t &message) noexcept;
+    void expire_pending(clock_t::time_point now) noexcept;
+};
+
+} // namespace rotor
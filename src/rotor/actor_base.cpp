@@ -24,7 +24,10 @@ actor_base_t::actor_base_t(actor_config_t &cfg)
     }
 }
 
-actor_base_t::~actor_base_t() { assert(deactivating_plugins.empty()); }
+actor_base_t::~actor_base_t() {
+    assert(deactivating_plugins.empty());
+    delivery_meter_t::forget(this);
+}
 
 void actor_base_t::do_initialize(system_context_t *) noexcept { activate_plugins(); }
 
@@ -139,15 +142,16 @@ void actor_base_t::shutdown_continue() noexcept {
     }
 }
 
-template <typename Fn, typename Message> static void poll(plugins_t &plugins, Message &message, Fn &&fn) {
+template <typename Fn, typename Message> static bool poll(plugins_t &plugins, Message &message, Fn &&fn) {
     for (auto rit = plugins.rbegin(); rit != plugins.rend();) {
         auto it = --rit.base();
         auto plugin = *it;
         auto result = fn(plugin, message);
         if (result)
-            break;
+            return true;
         ++rit;
     }
+    return false;
 }
 
 void actor_base_t::on_subscription(message::subscription_t &message) noexcept {
@@ -186,8 +190,11 @@ void actor_base_t::on_unsubscription_external(message::unsubscription_external_t
               << boost::core::demangle((const char*)point.handler->message_type)
               << " at " << (void*)point.address.get() << "\n";
     */
-    poll(plugins, message,
-         [](auto &plugin, auto &message) { return plugin->handle_unsubscription(message.payload.point, true); });
+    auto handled = poll(plugins, message, [](auto &plugin, auto &message) {
+        return plugin->handle_unsubscription(message.payload.point, true);
+    });
+    assert(handled && "unsubscription handled");
+    (void)handled;
 }
 
 address_ptr_t actor_base_t::create_address() noexcept { return address_maker->create_address(); }
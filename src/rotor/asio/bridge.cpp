@@ -0,0 +1,484 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/asio/bridge.h"
+#include "rotor/asio/forwarder.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+using namespace rotor;
+using namespace rotor::asio;
+
+namespace {
+namespace resource {
+static const constexpr plugin::resource_id_t read = 0;
+static const constexpr plugin::resource_id_t write = 1;
+} // namespace resource
+
+/* the frame length prefix (little-endian) */
+constexpr std::size_t prefix_size = sizeof(std::uint32_t);
+
+/* the minimal free space for the socket read */
+constexpr std::size_t read_chunk = 16 * 1024;
+
+/* the ids of automatically exported addresses do not clash with user-supplied ones */
+constexpr std::uint64_t auto_export_base = std::uint64_t{1} << 32;
+
+/* the amount of written frame buffers, kept for reuse */
+constexpr std::size_t max_spare = 64;
+
+} // namespace
+
+std::uint64_t bridge_t::addresses_t::encode(const address_ptr_t &address) noexcept {
+    auto key = address.get();
+    auto it = bridge.imported_ids.find(key);
+    if (it != bridge.imported_ids.end()) {
+        bridge.touch(address);
+        return (it->second << 1) | 1;
+    }
+    std::uint64_t id;
+    auto ie = bridge.exported_ids.find(key);
+    if (ie != bridge.exported_ids.end()) {
+        id = ie->second;
+    } else {
+        id = ++bridge.last_export;
+        bridge.export_address(id, address);
+        bridge.leases.emplace(key, lease_t{});
+    }
+    // the other side holds the address until it releases it
+    auto il = bridge.leases.find(key);
+    if (il != bridge.leases.end()) {
+        ++il->second.refs;
+        referred.emplace_back(address);
+    }
+    return id << 1;
+}
+
+address_ptr_t bridge_t::addresses_t::decode(std::uint64_t id) noexcept {
+    // the other side proxy refers to the local address, and vice versa
+    if (id & 1) {
+        auto addr = bridge.find_export(id >> 1);
+        return addr ? *addr : address_ptr_t{};
+    }
+    address_ptr_t addr;
+    auto it = bridge.imported.find(id >> 1);
+    if (it != bridge.imported.end()) {
+        addr = it->second;
+    } else {
+        addr = bridge.import_address(id >> 1);
+        bridge.leases.emplace(addr.get(), lease_t{});
+    }
+    auto il = bridge.leases.find(addr.get());
+    if (il != bridge.leases.end()) {
+        ++il->second.refs;
+        il->second.touched = clock_t::now();
+    }
+    return addr;
+}
+
+bridge_t::bridge_t(config_t &config)
+    : transport_base_t{config}, socket{config.socket}, max_frame{config.max_frame},
+      lease_timeout{std::chrono::microseconds{config.lease_timeout.total_microseconds()}},
+      reply_address{supervisor->make_address()}, addresses{*this}, last_export{auto_export_base} {
+    register_request<payload::link_request_t>();
+    register_request<payload::unlink_request_t>();
+    register_message<payload::unlink_notify_t>();
+}
+
+void bridge_t::export_address(std::uint64_t id, const address_ptr_t &addr) noexcept {
+    transport_base_t::export_address(id, addr);
+    exported_ids[addr.get()] = id;
+    leases.erase(addr.get());
+}
+
+address_ptr_t bridge_t::import_address(std::uint64_t id) noexcept {
+    auto it = imported.find(id);
+    if (it != imported.end()) {
+        leases.erase(it->second.get());
+        return it->second;
+    }
+    auto addr = transport_base_t::import_address(id);
+    imported_ids.emplace(addr.get(), id);
+    if (configured) {
+        for (auto subscriber : subscribers) {
+            subscriber(*this, nullptr, addr, id);
+        }
+    }
+    return addr;
+}
+
+void bridge_t::configure(plugin::plugin_base_t &plugin) noexcept {
+    transport_base_t::configure(plugin);
+    plugin.with_casted<plugin::starter_plugin_t>([this](auto &p) {
+        for (auto responder : responders) {
+            responder(*this, p);
+        }
+        for (auto &it : imported) {
+            for (auto subscriber : subscribers) {
+                subscriber(*this, &p, it.second, it.first);
+            }
+        }
+        configured = true;
+    });
+}
+
+void bridge_t::on_start() noexcept {
+    transport_base_t::on_start();
+    read();
+}
+
+void bridge_t::shutdown_start() noexcept {
+    disconnect();
+    transport_base_t::shutdown_start();
+}
+
+void bridge_t::shutdown_finish() noexcept {
+    exported_ids.clear();
+    imported_ids.clear();
+    leases.clear();
+    addresses.referred.clear();
+    proxy_subscriptions.clear();
+    outbox.clear();
+    inflight.clear();
+    spare.clear();
+    transport_base_t::shutdown_finish();
+}
+
+void bridge_t::on_read(std::size_t bytes) noexcept {
+    if (connected) {
+        rx_size += bytes;
+        std::size_t offset = 0;
+        bool complete = true;
+        while (connected && complete && rx_size - offset >= prefix_size) {
+            auto ptr = rx.data() + offset;
+            std::uint32_t length = 0;
+            for (std::size_t i = 0; i < prefix_size; ++i) {
+                length |= static_cast<std::uint32_t>(ptr[i]) << (i * 8);
+            }
+            if (length > max_frame) {
+                // the other side is broken, there is no way to find the next frame
+                disconnect();
+                do_shutdown();
+                break;
+            }
+            complete = rx_size - offset - prefix_size >= length;
+            if (complete) {
+                decode_frame(ptr + prefix_size, length);
+                offset += prefix_size + length;
+            }
+        }
+        if (connected) {
+            if (offset) {
+                std::memmove(rx.data(), rx.data() + offset, rx_size - offset);
+                rx_size -= offset;
+            }
+            expire_leases();
+            read();
+        }
+    }
+    resources->release(resource::read);
+}
+
+void bridge_t::on_read_error(const sys::error_code &) noexcept {
+    if (connected) {
+        disconnect();
+        do_shutdown();
+    }
+    resources->release(resource::read);
+}
+
+void bridge_t::on_write(std::size_t) noexcept {
+    writing = false;
+    for (auto &frame : inflight) {
+        if (spare.size() < max_spare) {
+            frame.clear();
+            spare.emplace_back(std::move(frame));
+        }
+    }
+    inflight.clear();
+    if (connected) {
+        expire_leases();
+    }
+    flush();
+    if (!writing && !connected) {
+        close();
+    }
+    resources->release(resource::write);
+}
+
+void bridge_t::on_write_error(const sys::error_code &) noexcept {
+    writing = false;
+    inflight.clear();
+    outbox.clear();
+    if (connected) {
+        disconnect();
+        do_shutdown();
+    }
+    close();
+    resources->release(resource::write);
+}
+
+serialization_buffer_t bridge_t::make_frame() noexcept {
+    serialization_buffer_t frame;
+    if (!spare.empty()) {
+        frame = std::move(spare.back());
+        spare.pop_back();
+    }
+    frame.resize(prefix_size);
+    return frame;
+}
+
+bool bridge_t::queue_frame(serialization_buffer_t &&frame) noexcept {
+    auto length = frame.size() - prefix_size;
+    if (length > max_frame) {
+        // the other side will not get the addresses
+        for (auto &address : addresses.referred) {
+            auto it = leases.find(address.get());
+            if (it != leases.end() && it->second.refs) {
+                --it->second.refs;
+                forget_unused(address);
+            }
+        }
+        addresses.referred.clear();
+        return false;
+    }
+    for (std::size_t i = 0; i < prefix_size; ++i) {
+        frame[i] = static_cast<std::uint8_t>(length >> (i * 8));
+    }
+    outbox.emplace_back(std::move(frame));
+    flush();
+    return true;
+}
+
+void bridge_t::flush() noexcept {
+    if (writing || outbox.empty() || !socket->is_open()) {
+        return;
+    }
+    std::swap(inflight, outbox);
+    gather.clear();
+    for (auto &frame : inflight) {
+        gather.emplace_back(asio::buffer(frame));
+    }
+    writing = true;
+    resources->acquire(resource::write);
+    asio::async_write(*socket, gather, forwarder_t(*this, &bridge_t::on_write, &bridge_t::on_write_error));
+}
+
+void bridge_t::read() noexcept {
+    if (rx.size() - rx_size < read_chunk) {
+        rx.resize(rx_size + read_chunk);
+    }
+    resources->acquire(resource::read);
+    auto buffer = asio::buffer(rx.data() + rx_size, rx.size() - rx_size);
+    socket->async_read_some(buffer, forwarder_t(*this, &bridge_t::on_read, &bridge_t::on_read_error));
+}
+
+void bridge_t::decode_frame(const std::uint8_t *data, std::size_t size) noexcept {
+    decoder_t decoder(data, size, &addresses);
+    frame_kind_t kind;
+    if (!decoder.get(kind)) {
+        ++dropped;
+        return;
+    }
+
+    bool ok = false;
+    if (kind == frame_kind_t::message) {
+        std::uint64_t dest_id;
+        if (decoder.get(dest_id)) {
+            // the payload of undeliverable message is decoded too, as its addresses are counted by the other side
+            auto dest = find_export(dest_id);
+            auto message = registry.decode(decoder, dest ? *dest : reply_address);
+            ok = message && dest;
+            if (ok) {
+                if (message->type_index == message::unlink_notify_t::message_type) {
+                    auto &client = static_cast<message::unlink_notify_t &>(*message).payload.client_addr;
+                    forget_link(links_in, client, *dest);
+                }
+                supervisor->put(std::move(message));
+            }
+        }
+    } else if (kind == frame_kind_t::request || kind == frame_kind_t::response) {
+        std::uint32_t type_id;
+        if (decoder.get(type_id)) {
+            auto it = request_codecs.find(type_id);
+            if (it != request_codecs.end()) {
+                auto &codec = it->second;
+                auto decode = kind == frame_kind_t::request ? codec.decode_request : codec.decode_response;
+                ok = decode(*this, decoder);
+            }
+        }
+    } else if (kind == frame_kind_t::release) {
+        std::uint64_t id;
+        std::uint64_t refs;
+        ok = decoder.get(id) && decoder.get(refs);
+        if (ok) {
+            unrefer(id, refs);
+        }
+    }
+    if (!ok) {
+        // the frame boundaries are known, so the malformed (or unknown) frame is just skipped
+        ++dropped;
+    }
+}
+
+void bridge_t::disconnect() noexcept {
+    if (!connected) {
+        return;
+    }
+    connected = false;
+    if (!writing) {
+        close();
+    }
+
+    // the pending unlink requests are completed here too, so the links are forgotten
+    fail_pending(make_error_code(error_code_t::transport_disconnected));
+
+    // the servers should forget the clients on the other side, as if they were shutting down
+    for (auto &link : links_in) {
+        send<payload::unlink_notify_t>(link.server, link.client);
+    }
+    links_in.clear();
+
+    // the clients should forget the servers on the other side, as if they were shutting down
+    using unlink_t = request_traits_t<payload::unlink_request_t>::request::wrapped_t;
+    for (auto &link : links_out) {
+        send<unlink_t>(link.client, request_id_t{0}, reply_address, link.server, link.server);
+    }
+    links_out.clear();
+}
+
+void bridge_t::close() noexcept {
+    sys::error_code ec;
+    socket->close(ec);
+}
+
+void bridge_t::retain(const address_ptr_t &address) noexcept {
+    auto it = leases.find(address.get());
+    if (it != leases.end()) {
+        ++it->second.users;
+    }
+}
+
+void bridge_t::release(const address_ptr_t &address) noexcept {
+    auto it = leases.find(address.get());
+    if (it == leases.end()) {
+        return;
+    }
+    auto &lease = it->second;
+    if (lease.users) {
+        --lease.users;
+    }
+    // the imported address is forgotten when it expires
+    lease.touched = clock_t::now();
+    forget_unused(address);
+}
+
+void bridge_t::touch(const address_ptr_t &address) noexcept {
+    auto it = leases.find(address.get());
+    if (it != leases.end()) {
+        it->second.touched = clock_t::now();
+    }
+}
+
+void bridge_t::unrefer(std::uint64_t id, std::uint64_t refs) noexcept {
+    auto addr = find_export(id);
+    if (!addr) {
+        return;
+    }
+    auto it = leases.find(addr->get());
+    if (it != leases.end()) {
+        auto &lease = it->second;
+        lease.refs -= std::min(lease.refs, refs);
+        forget_unused(*addr);
+    }
+}
+
+void bridge_t::forget_unused(const address_ptr_t &address) noexcept {
+    auto it = leases.find(address.get());
+    if (it == leases.end() || it->second.users || it->second.refs || !exported_ids.count(address.get())) {
+        return;
+    }
+    leases.erase(it);
+    forget_address(address);
+}
+
+void bridge_t::on_expiry() noexcept {
+    transport_base_t::on_expiry();
+    if (connected) {
+        expire_leases();
+    }
+}
+
+void bridge_t::expire_leases() noexcept {
+    auto now = clock_t::now();
+    if (now >= next_expiry) {
+        next_expiry = now + lease_timeout;
+        std::vector<std::uint64_t> expired;
+        for (auto &it : imported) {
+            auto il = leases.find(it.second.get());
+            if (il != leases.end() && !il->second.users && il->second.touched + lease_timeout <= now) {
+                expired.emplace_back(it.first);
+            }
+        }
+        for (auto id : expired) {
+            auto addr = imported[id];
+            auto it = leases.find(addr.get());
+            auto refs = it->second.refs;
+            leases.erase(it);
+            forget_address(addr);
+            write_frame(frame_kind_t::release, [&](encoder_t &e) {
+                e.put(id);
+                e.put(refs);
+            });
+        }
+    }
+    // the leases expire even if the socket is idle
+    if (!leases.empty()) {
+        schedule_expiry(next_expiry);
+    }
+}
+
+void bridge_t::forget_address(const address_ptr_t &address) noexcept {
+    auto addr = address; // the reference might point to the erased entry
+    auto ii = imported_ids.find(addr.get());
+    if (ii != imported_ids.end()) {
+        imported.erase(ii->second);
+        imported_ids.erase(ii);
+        auto is = proxy_subscriptions.find(addr.get());
+        if (is != proxy_subscriptions.end()) {
+            if (lifetime) {
+                for (auto &info : is->second) {
+                    lifetime->unsubscribe(info);
+                }
+            }
+            proxy_subscriptions.erase(is);
+        }
+        return;
+    }
+    auto ie = exported_ids.find(addr.get());
+    if (ie != exported_ids.end()) {
+        exported.erase(ie->second);
+        exported_ids.erase(ie);
+    }
+}
+
+void bridge_t::remember_link(links_t &links, const address_ptr_t &client, const address_ptr_t &server) noexcept {
+    links.emplace_back(link_t{client, server});
+    retain(client);
+    retain(server);
+}
+
+void bridge_t::forget_link(links_t &links, const address_ptr_t &client, const address_ptr_t &server) noexcept {
+    auto predicate = [&](const link_t &link) { return link.client != client || link.server != server; };
+    auto it = std::partition(links.begin(), links.end(), predicate);
+    auto forgotten = links_t(std::make_move_iterator(it), std::make_move_iterator(links.end()));
+    links.erase(it, links.end());
+    for (auto &link : forgotten) {
+        release(link.client);
+        release(link.server);
+    }
+}
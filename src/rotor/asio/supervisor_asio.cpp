@@ -40,8 +40,8 @@ void supervisor_asio_t::start_timer(const rotor::pt::time_duration &timeout, req
         } else {
             asio::defer(strand, [self = std::move(self), timer_id = timer_id]() {
                 auto &sup = *self;
-                sup.on_timer_trigger(timer_id);
                 sup.timers_map.erase(timer_id);
+                sup.on_timer_trigger(timer_id);
                 sup.do_process();
             });
         }
@@ -66,15 +66,19 @@ void supervisor_asio_t::on_timer_error(request_id_t, const boost::system::error_
 }
 
 void supervisor_asio_t::enqueue(rotor::message_ptr_t message) noexcept {
-    auto actor_ptr = supervisor_ptr_t(this);
-    // std::cout << "deferring on " << this << ", stopped : " << strand.get_io_context().stopped() << "\n";
-    asio::defer(get_strand(), [actor = std::move(actor_ptr), message = std::move(message)]() mutable {
-        auto &sup = *actor;
-        // std::cout << "deferred processing on" << &sup << "\n";
-        // sup.enqueue(std::move(message));
-        sup.put(std::move(message));
-        sup.do_process();
-    });
+    auto leader = static_cast<supervisor_asio_t *>(locality_leader);
+    if (!admit_inbound(*message)) {
+        return;
+    }
+    if (leader->inbound.push(std::move(message))) {
+        // the queue was empty, i.e. there is no scheduled drain yet
+        auto leader_ptr = intrusive_ptr_t<supervisor_asio_t>(leader);
+        asio::defer(leader->get_strand(), [leader = std::move(leader_ptr)]() {
+            auto &sup = *leader;
+            sup.drain(sup.inbound);
+            sup.do_process();
+        });
+    }
 }
 
 void supervisor_asio_t::shutdown_finish() noexcept {
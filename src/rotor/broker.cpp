@@ -0,0 +1,295 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/broker.h"
+#include "rotor/supervisor.h"
+#include <algorithm>
+
+using namespace rotor;
+
+namespace {
+
+using segments_t = std::vector<std::string>;
+
+const std::string any_segment = "*";
+const std::string rest_segments = "#";
+
+/* splits the dot-separated name; returns false on empty segments */
+bool split(const std::string &name, segments_t &segments) noexcept {
+    std::size_t start = 0;
+    while (true) {
+        auto end = name.find('.', start);
+        auto segment = name.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (segment.empty()) {
+            return false;
+        }
+        segments.emplace_back(std::move(segment));
+        if (end == std::string::npos) {
+            return true;
+        }
+        start = end + 1;
+    }
+}
+
+bool parse_topic(const std::string &topic, segments_t &segments) noexcept {
+    if (!split(topic, segments)) {
+        return false;
+    }
+    return std::none_of(segments.begin(), segments.end(), [](auto &s) {
+        return s.find_first_of("*#") != std::string::npos;
+    });
+}
+
+bool parse_pattern(const std::string &pattern, segments_t &segments) noexcept {
+    if (!split(pattern, segments)) {
+        return false;
+    }
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        auto &s = segments[i];
+        auto wildcard = s == any_segment || (s == rest_segments && i + 1 == segments.size());
+        if (!wildcard && s.find_first_of("*#") != std::string::npos) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool matches(const segments_t &pattern, const segments_t &topic) noexcept {
+    std::size_t i = 0;
+    for (; i < pattern.size(); ++i) {
+        auto &p = pattern[i];
+        if (p == rest_segments) {
+            return i < topic.size();
+        }
+        if (i >= topic.size() || (p != any_segment && p != topic[i])) {
+            return false;
+        }
+    }
+    return i == topic.size();
+}
+
+} // namespace
+
+void broker_t::configure(plugin::plugin_base_t &plug) noexcept {
+    actor_base_t::configure(plug);
+    plug.with_casted<plugin::starter_plugin_t>(
+        [](auto &p) {
+            p.subscribe_actor(&broker_t::on_topic);
+            p.subscribe_actor(&broker_t::on_subscription);
+            p.subscribe_actor(&broker_t::on_unsubscription);
+        },
+        plugin::config_phase_t::PREINIT);
+    plug.with_casted<plugin::link_client_plugin_t>([this](auto &p) {
+        // the broker just tracks the subscribers lifetime, i.e. it is not shut down with them
+        p.on_unlink([this, &p](message::unlink_request_t &message) {
+            forget_origin(message.payload.request_payload.server_addr);
+            p.detach_link(message);
+            return true;
+        });
+    });
+}
+
+void broker_t::on_topic(message::topic_request_t &request) noexcept {
+    auto &topic = request.payload.request_payload.topic;
+    auto it = topics_map.find(topic);
+    if (it != topics_map.end()) {
+        reply_to(request, it->second);
+        return;
+    }
+
+    segments_t segments;
+    if (!parse_topic(topic, segments)) {
+        reply_with_error(request, make_error_code(error_code_t::invalid_topic));
+        return;
+    }
+
+    if (topics_map.size() >= topics_threshold) {
+        forget_topics();
+    }
+    auto topic_addr = create_address();
+    topics_map.emplace(topic, topic_addr);
+    reply_to(request, topic_addr);
+
+    // walk the patterns trie, the `*` child matches any segment
+    auto visit = [&](auto &self, node_t &node, std::size_t index) -> void {
+        if (index == segments.size()) {
+            for (auto &entry : node.exact) {
+                announce(entry.subscriber_addr, topic, topic_addr);
+            }
+            return;
+        }
+        for (auto &entry : node.rest) {
+            announce(entry.subscriber_addr, topic, topic_addr);
+        }
+        auto descend = [&](const std::string &key) {
+            auto child = node.children.find(key);
+            if (child != node.children.end()) {
+                self(self, *child->second, index + 1);
+            }
+        };
+        descend(segments[index]);
+        descend(any_segment);
+    };
+    visit(visit, root, 0);
+}
+
+void broker_t::on_subscription(message::topic_subscription_request_t &request) noexcept {
+    auto &pattern = request.payload.request_payload.pattern;
+    auto &subscriber_addr = request.payload.request_payload.subscriber_addr;
+    segments_t segments;
+    if (!parse_pattern(pattern, segments) || !subscriber_addr) {
+        reply_with_error(request, make_error_code(error_code_t::invalid_topic));
+        return;
+    }
+
+    auto &origin = request.payload.origin;
+    auto fresh_origin = origins_map.count(origin) == 0;
+    auto &patterns = origins_map[origin];
+    auto same = [&](auto &it) { return it.pattern == pattern && it.subscriber_addr == subscriber_addr; };
+    if (std::none_of(patterns.begin(), patterns.end(), same)) {
+        patterns.emplace_back(origin_pattern_t{pattern, subscriber_addr});
+        acquire(pattern, subscriber_addr);
+    }
+    reply_to(request);
+    if (fresh_origin && state <= state_t::OPERATIONAL) {
+        track(origin);
+    }
+
+    // new patterns are rare, so the existing topics are just scanned
+    for (auto &it : topics_map) {
+        segments_t topic_segments;
+        split(it.first, topic_segments);
+        if (matches(segments, topic_segments)) {
+            announce(subscriber_addr, it.first, it.second);
+        }
+    }
+}
+
+void broker_t::on_unsubscription(message::topic_unsubscription_t &message) noexcept {
+    auto &pattern = message.payload.pattern;
+    auto &subscriber_addr = message.payload.subscriber_addr;
+    segments_t segments;
+    if (!parse_pattern(pattern, segments)) {
+        return;
+    }
+
+    // the pattern is cancelled for the subscriber, no matter which actor subscribed it
+    release(pattern, subscriber_addr, true);
+    auto same = [&](auto &it) { return it.pattern == pattern && it.subscriber_addr == subscriber_addr; };
+    for (auto &it : origins_map) {
+        auto &patterns = it.second;
+        patterns.erase(std::remove_if(patterns.begin(), patterns.end(), same), patterns.end());
+    }
+}
+
+void broker_t::acquire(const std::string &pattern, const address_ptr_t &subscriber_addr) noexcept {
+    segments_t segments;
+    parse_pattern(pattern, segments);
+
+    auto node = &root;
+    auto rest = segments.back() == rest_segments;
+    auto depth = rest ? segments.size() - 1 : segments.size();
+    for (std::size_t i = 0; i < depth; ++i) {
+        auto &child = node->children[segments[i]];
+        if (!child) {
+            child.reset(new node_t());
+        }
+        node = child.get();
+    }
+    auto &entries = rest ? node->rest : node->exact;
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [&](auto &entry) { return entry.subscriber_addr == subscriber_addr; });
+    if (it != entries.end()) {
+        ++it->refs;
+        return;
+    }
+    entries.emplace_back(entry_t{subscriber_addr, 1});
+    ++subscribers_map[subscriber_addr].patterns;
+}
+
+void broker_t::release(const std::string &pattern, const address_ptr_t &subscriber_addr, bool all) noexcept {
+    segments_t segments;
+    parse_pattern(pattern, segments);
+
+    auto node = &root;
+    auto rest = segments.back() == rest_segments;
+    auto depth = rest ? segments.size() - 1 : segments.size();
+    std::vector<node_t *> path;
+    for (std::size_t i = 0; i < depth; ++i) {
+        auto child = node->children.find(segments[i]);
+        if (child == node->children.end()) {
+            return;
+        }
+        path.emplace_back(node);
+        node = child->second.get();
+    }
+
+    auto &entries = rest ? node->rest : node->exact;
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [&](auto &entry) { return entry.subscriber_addr == subscriber_addr; });
+    if (it == entries.end() || (!all && --it->refs)) {
+        return;
+    }
+    entries.erase(it);
+
+    // the nodes without patterns are dropped bottom-up
+    for (auto i = path.size(); i > 0 && node->exact.empty() && node->rest.empty() && node->children.empty(); --i) {
+        node = path[i - 1];
+        node->children.erase(segments[i - 1]);
+    }
+
+    auto subscriber_it = subscribers_map.find(subscriber_addr);
+    if (--subscriber_it->second.patterns == 0) {
+        subscribers_map.erase(subscriber_it);
+    }
+}
+
+void broker_t::forget_topics() noexcept {
+    for (auto it = topics_map.begin(); it != topics_map.end();) {
+        if (it->second->use_count() > 1) {
+            ++it;
+            continue;
+        }
+        // the topic might be created again, then it should be announced again
+        for (auto &subscriber : subscribers_map) {
+            subscriber.second.announced.erase(it->first);
+        }
+        it = topics_map.erase(it);
+    }
+    topics_threshold = std::max<std::size_t>(min_topics_threshold, topics_map.size() * 2);
+}
+
+void broker_t::track(const address_ptr_t &origin) noexcept {
+    using link_client_t = plugin::link_client_plugin_t;
+    auto plugin = static_cast<link_client_t *>(get_plugin(link_client_t::class_identity));
+    bool operational_only = false;
+    plugin->link(origin, operational_only, [this, origin](auto &ec) {
+        // the origin is already gone (or it is not linkable), so its patterns are not tracked
+        if (ec) {
+            forget_origin(origin);
+        }
+    });
+}
+
+void broker_t::forget_origin(const address_ptr_t &origin) noexcept {
+    auto it = origins_map.find(origin);
+    if (it == origins_map.end()) {
+        return;
+    }
+    auto patterns = std::move(it->second);
+    origins_map.erase(it);
+    for (auto &item : patterns) {
+        release(item.pattern, item.subscriber_addr, false);
+    }
+}
+
+void broker_t::announce(const address_ptr_t &subscriber_addr, const std::string &topic,
+                        const address_ptr_t &topic_addr) noexcept {
+    auto &subscriber = subscribers_map[subscriber_addr];
+    if (subscriber.announced.insert(topic).second) {
+        send<payload::topic_announcement_t>(subscriber_addr, topic, topic_addr);
+    }
+}
@@ -0,0 +1,279 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/delivery_meter.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace rotor;
+
+namespace {
+
+/* single-writer counter: only the owning thread increments it, others just read it */
+struct counter_t {
+    std::atomic<std::uint64_t> value{0};
+
+    inline void add(std::uint64_t delta) noexcept {
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+    inline std::uint64_t get() const noexcept { return value.load(std::memory_order_relaxed); }
+    inline void reset() noexcept { value.store(0, std::memory_order_relaxed); }
+};
+
+struct histogram_counters_t {
+    std::array<counter_t, histogram_t::buckets_count> buckets;
+    counter_t sum_ns;
+
+    void record(std::uint64_t ns) noexcept {
+        buckets[histogram_t::bucket_of(ns)].add(1);
+        sum_ns.add(ns);
+    }
+
+    void collect(histogram_t &histogram) const noexcept {
+        for (std::size_t i = 0; i < buckets.size(); ++i) {
+            histogram.buckets[i] += buckets[i].get();
+        }
+        histogram.sum_ns += sum_ns.get();
+    }
+
+    void reset() noexcept {
+        for (auto &b : buckets) {
+            b.reset();
+        }
+        sum_ns.reset();
+    }
+};
+
+struct entry_t {
+    counter_t count;
+    histogram_counters_t handler_time;
+    histogram_counters_t queue_wait;
+
+    void record(std::uint64_t handler_ns, std::uint64_t wait_ns, bool has_wait) noexcept {
+        count.add(1);
+        handler_time.record(handler_ns);
+        if (has_wait) {
+            queue_wait.record(wait_ns);
+        }
+    }
+
+    void collect(delivery_stats_t &stats) const noexcept {
+        stats.count += count.get();
+        handler_time.collect(stats.handler_time);
+        queue_wait.collect(stats.queue_wait);
+    }
+
+    void reset() noexcept {
+        count.reset();
+        handler_time.reset();
+        queue_wait.reset();
+    }
+};
+
+/* The nodes of unordered_map are stable, so the owning thread looks the entries
+ * up without lock; the mutex guards only insertions and removals against concurrent
+ * snapshot iterations. The entries of the destroyed actors are removed by the owning
+ * thread itself (see `purge`), as other threads can only mark them as retired. */
+struct shard_t {
+    using by_type_t = std::unordered_map<const void *, entry_t>;
+    using by_actor_t = std::unordered_map<const actor_base_t *, entry_t>;
+    using retired_t = std::vector<const actor_base_t *>;
+
+    std::mutex mutex;
+    by_type_t by_type;
+    by_actor_t by_actor;
+    retired_t retired;
+    std::atomic<bool> has_retired{false};
+    bool in_use = false;
+
+    /* the mutex should be locked */
+    bool is_retired(const actor_base_t *actor) const noexcept {
+        return std::find(retired.begin(), retired.end(), actor) != retired.end();
+    }
+
+    /* the mutex should be locked, and the shard should not be used by other thread */
+    void erase_retired() noexcept {
+        for (auto actor : retired) {
+            by_actor.erase(actor);
+        }
+        retired.clear();
+        has_retired.store(false, std::memory_order_relaxed);
+    }
+
+    /* the retired entries are removed before the lookup, as the actor address might be reused */
+    void purge() noexcept {
+        if (has_retired.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            erase_retired();
+        }
+    }
+
+    template <typename Map, typename Key> entry_t &get(Map &map, Key key) noexcept {
+        auto it = map.find(key);
+        if (it != map.end()) {
+            return it->second;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        return map.try_emplace(key).first->second;
+    }
+};
+
+using shard_ptr_t = std::unique_ptr<shard_t>;
+
+/* shards outlive their threads, so the statistics are not lost; the shard
+ * of the finished thread is reused by the next one */
+struct registry_t {
+    std::mutex mutex;
+    std::vector<shard_ptr_t> shards;
+
+    shard_t *acquire() noexcept {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &shard : shards) {
+            if (!shard->in_use) {
+                std::lock_guard<std::mutex> shard_lock(shard->mutex);
+                shard->erase_retired();
+                shard->in_use = true;
+                return shard.get();
+            }
+        }
+        shards.emplace_back(new shard_t());
+        shards.back()->in_use = true;
+        return shards.back().get();
+    }
+
+    void release(shard_t *shard) noexcept {
+        std::lock_guard<std::mutex> lock(mutex);
+        shard->in_use = false;
+    }
+};
+
+/* whether the metering has ever been enabled, i.e. there might be entries to forget */
+std::atomic<bool> engaged{false};
+
+registry_t &get_registry() noexcept {
+    static registry_t registry;
+    return registry;
+}
+
+struct shard_holder_t {
+    shard_t *shard;
+    shard_holder_t() noexcept : shard{get_registry().acquire()} {}
+    ~shard_holder_t() { get_registry().release(shard); }
+};
+
+shard_t &local_shard() noexcept {
+    thread_local shard_holder_t holder;
+    return *holder.shard;
+}
+
+} // namespace
+
+std::size_t histogram_t::bucket_of(std::uint64_t ns) noexcept {
+    std::size_t index = 0;
+    while (ns && index < buckets_count - 1) {
+        ns >>= 1;
+        ++index;
+    }
+    return index;
+}
+
+std::uint64_t histogram_t::count() const noexcept {
+    std::uint64_t r = 0;
+    for (auto b : buckets) {
+        r += b;
+    }
+    return r;
+}
+
+std::uint64_t histogram_t::percentile(double p) const noexcept {
+    auto total = count();
+    if (!total) {
+        return 0;
+    }
+    auto threshold = static_cast<std::uint64_t>(p * static_cast<double>(total));
+    std::uint64_t accumulated = 0;
+    for (std::size_t i = 0; i < buckets_count; ++i) {
+        accumulated += buckets[i];
+        if (accumulated > threshold || accumulated == total) {
+            return i ? (std::uint64_t(1) << i) - 1 : 0;
+        }
+    }
+    return (std::uint64_t(1) << (buckets_count - 1)) - 1;
+}
+
+void delivery_meter_t::enable(bool value) noexcept {
+    if (value) {
+        engaged.store(true, std::memory_order_relaxed);
+    }
+    active.store(value, std::memory_order_relaxed);
+}
+
+void delivery_meter_t::record_message(const void *type_index, std::uint64_t handler_ns, std::uint64_t wait_ns,
+                                      bool has_wait) noexcept {
+    auto &shard = local_shard();
+    shard.get(shard.by_type, type_index).record(handler_ns, wait_ns, has_wait);
+}
+
+void delivery_meter_t::record_handler(const actor_base_t *actor, std::uint64_t handler_ns, std::uint64_t wait_ns,
+                                      bool has_wait) noexcept {
+    auto &shard = local_shard();
+    shard.purge();
+    shard.get(shard.by_actor, actor).record(handler_ns, wait_ns, has_wait);
+}
+
+void delivery_meter_t::forget(const actor_base_t *actor) noexcept {
+    if (!engaged.load(std::memory_order_relaxed)) {
+        return;
+    }
+    auto &registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto &shard : registry.shards) {
+        std::lock_guard<std::mutex> shard_lock(shard->mutex);
+        if (!shard->by_actor.count(actor)) {
+            continue;
+        }
+        if (!shard->in_use) {
+            shard->by_actor.erase(actor);
+        } else {
+            shard->retired.emplace_back(actor);
+            shard->has_retired.store(true, std::memory_order_release);
+        }
+    }
+}
+
+delivery_snapshot_t delivery_meter_t::snapshot() noexcept {
+    delivery_snapshot_t r;
+    auto &registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto &shard : registry.shards) {
+        std::lock_guard<std::mutex> shard_lock(shard->mutex);
+        for (auto &it : shard->by_type) {
+            it.second.collect(r.by_type[it.first]);
+        }
+        for (auto &it : shard->by_actor) {
+            if (!shard->is_retired(it.first)) {
+                it.second.collect(r.by_actor[it.first]);
+            }
+        }
+    }
+    return r;
+}
+
+void delivery_meter_t::reset() noexcept {
+    auto &registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto &shard : registry.shards) {
+        std::lock_guard<std::mutex> shard_lock(shard->mutex);
+        for (auto &it : shard->by_type) {
+            it.second.reset();
+        }
+        for (auto &it : shard->by_actor) {
+            it.second.reset();
+        }
+    }
+}
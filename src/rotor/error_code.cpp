@@ -29,6 +29,18 @@ std::string error_code_category::message(int c) const {
         return "already linked";
     case error_code_t::unknown_service:
         return "the requested service name is not registered";
+    case error_code_t::queue_overflow:
+        return "supervisor queue overflow";
+    case error_code_t::invalid_topic:
+        return "invalid topic name or pattern";
+    case error_code_t::transport_overflow:
+        return "transport buffer overflow";
+    case error_code_t::transport_mismatch:
+        return "transport segment layout mismatch";
+    case error_code_t::transport_disconnected:
+        return "transport connection has been lost";
+    case error_code_t::transport_unknown_address:
+        return "the address is not exported by the other side of transport";
     }
     return "unknown";
 }
@@ -35,46 +35,27 @@ void supervisor_ev_t::do_initialize(system_context_t *ctx) noexcept {
     supervisor_t::do_initialize(ctx);
 }
 
-void supervisor_ev_t::enqueue(rotor::message_ptr_t message) noexcept {
-    bool ok{false};
-    try {
-        auto leader = static_cast<supervisor_ev_t *>(locality_leader);
-        auto &inbound = leader->inbound;
-        std::lock_guard<std::mutex> lock(leader->inbound_mutex);
-        if (!leader->pending) {
-            // async events are "compressed" by EV. Need to do only once
-            intrusive_ptr_add_ref(this);
-        }
-        inbound.emplace_back(std::move(message));
-        ok = true;
-    } catch (const std::system_error &err) {
-        context->on_error(err.code());
-    }
-
-    if (ok) {
-        ev_async_send(loop, &async_watcher);
+void supervisor_ev_t::notify_leader() noexcept {
+    auto leader = static_cast<supervisor_ev_t *>(locality_leader);
+    if (!leader->pending.exchange(true, std::memory_order_acq_rel)) {
+        // async events are "compressed" by EV. Need to do only once
+        intrusive_ptr_add_ref(leader);
+        ev_async_send(leader->loop, &leader->async_watcher);
     }
 }
 
-void supervisor_ev_t::start() noexcept {
-    bool ok{false};
-    try {
-        auto leader = static_cast<supervisor_ev_t *>(locality_leader);
-        std::lock_guard<std::mutex> lock(leader->inbound_mutex);
-        if (!leader->pending) {
-            leader->pending = true;
-            intrusive_ptr_add_ref(leader);
-        }
-        ok = true;
-    } catch (const std::system_error &err) {
-        context->on_error(err.code());
+void supervisor_ev_t::enqueue(rotor::message_ptr_t message) noexcept {
+    auto leader = static_cast<supervisor_ev_t *>(locality_leader);
+    if (!admit_inbound(*message)) {
+        return;
     }
-
-    if (ok) {
-        ev_async_send(loop, &async_watcher);
+    if (leader->inbound.push(std::move(message))) {
+        notify_leader();
     }
 }
 
+void supervisor_ev_t::start() noexcept { notify_leader(); }
+
 void supervisor_ev_t::shutdown_finish() noexcept {
     supervisor_t::shutdown_finish();
     ev_async_stop(loop, &async_watcher);
@@ -112,23 +93,13 @@ void supervisor_ev_t::on_timer_trigger(request_id_t timer_id) noexcept {
 }
 
 void supervisor_ev_t::on_async() noexcept {
-    bool ok{false};
-    try {
-        auto leader = static_cast<supervisor_ev_t *>(locality_leader);
-        auto &inbound = leader->inbound;
-        auto &queue = leader->queue;
-        std::lock_guard<std::mutex> lock(leader->inbound_mutex);
-        std::move(inbound.begin(), inbound.end(), std::back_inserter(queue));
-        inbound.clear();
-        leader->pending = false;
+    auto leader = static_cast<supervisor_ev_t *>(locality_leader);
+    // reset the flag before draining, so that messages pushed after drain will notify again
+    bool notified = leader->pending.exchange(false, std::memory_order_acq_rel);
+    leader->drain(leader->inbound);
+    do_process();
+    if (notified) {
         intrusive_ptr_release(leader);
-        ok = true;
-    } catch (const std::system_error &err) {
-        context->on_error(err.code());
-    }
-
-    if (ok) {
-        do_process();
     }
 }
 
@@ -0,0 +1,88 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/message_pool.h"
+#include <atomic>
+#include <new>
+
+using namespace rotor;
+
+namespace {
+
+constexpr std::size_t classes_count = message_pool_t::max_block_size / message_pool_t::granularity;
+
+std::atomic<std::size_t> capacity{message_pool_t::default_capacity};
+
+struct free_block_t {
+    free_block_t *next;
+};
+
+struct thread_cache_t {
+    struct bucket_t {
+        free_block_t *head = nullptr;
+        std::size_t count = 0;
+    };
+
+    bucket_t buckets[classes_count];
+
+    ~thread_cache_t();
+};
+
+/* trivially destructible, i.e. it is still accessible during thread-locals destruction */
+thread_local bool cache_destroyed = false;
+thread_local thread_cache_t cache;
+
+thread_cache_t::~thread_cache_t() {
+    cache_destroyed = true;
+    for (auto &bucket : buckets) {
+        while (bucket.head) {
+            auto block = bucket.head;
+            bucket.head = block->next;
+            ::operator delete(static_cast<void *>(block));
+        }
+        bucket.count = 0;
+    }
+}
+
+inline std::size_t class_of(std::size_t size) noexcept { return (size - 1) / message_pool_t::granularity; }
+
+inline std::size_t block_size_of(std::size_t size) noexcept {
+    return (class_of(size) + 1) * message_pool_t::granularity;
+}
+
+} // namespace
+
+void *message_pool_t::allocate(std::size_t size) {
+    if (size && size <= max_block_size && !cache_destroyed) {
+        auto &bucket = cache.buckets[class_of(size)];
+        if (bucket.head) {
+            auto block = bucket.head;
+            bucket.head = block->next;
+            --bucket.count;
+            return static_cast<void *>(block);
+        }
+        return ::operator new(block_size_of(size));
+    }
+    return ::operator new(size);
+}
+
+void message_pool_t::deallocate(void *ptr, std::size_t size) noexcept {
+    if (size && size <= max_block_size && !cache_destroyed) {
+        auto &bucket = cache.buckets[class_of(size)];
+        if (bucket.count < capacity.load(std::memory_order_relaxed)) {
+            auto block = static_cast<free_block_t *>(ptr);
+            block->next = bucket.head;
+            bucket.head = block;
+            ++bucket.count;
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
+
+void message_pool_t::set_capacity(std::size_t value) noexcept { capacity.store(value, std::memory_order_relaxed); }
+
+std::size_t message_pool_t::get_capacity() noexcept { return capacity.load(std::memory_order_relaxed); }
@@ -23,6 +23,7 @@ struct system_context {};
 struct policy {};
 struct parent {};
 struct synchronize_start {};
+struct init_request {};
 } // namespace to
 } // namespace
 
@@ -30,6 +31,7 @@ template <> auto &actor_base_t::access<to::state>() noexcept { return state; }
 template <> auto &actor_base_t::access<to::init_timeout>() noexcept { return init_timeout; }
 template <> auto &actor_base_t::access<to::shutdown_timeout>() noexcept { return shutdown_timeout; }
 template <> auto &actor_base_t::access<to::lifetime>() noexcept { return lifetime; }
+template <> auto &actor_base_t::access<to::init_request>() noexcept { return init_request; }
 template <> auto &supervisor_t::access<to::manager>() noexcept { return manager; }
 template <> auto &supervisor_t::access<to::address_mapping>() noexcept { return address_mapping; }
 template <> auto &supervisor_t::access<to::system_context>() noexcept { return context; }
@@ -45,6 +47,7 @@ void child_manager_plugin_t::activate(actor_base_t *actor_) noexcept {
     plugin_base_t::activate(actor_);
     static_cast<supervisor_t &>(*actor_).access<to::manager>() = this;
     subscribe(&child_manager_plugin_t::on_create);
+    subscribe(&child_manager_plugin_t::on_create_group);
     subscribe(&child_manager_plugin_t::on_init);
     subscribe(&child_manager_plugin_t::on_shutdown_trigger);
     subscribe(&child_manager_plugin_t::on_shutdown_confirm);
@@ -69,6 +72,9 @@ void child_manager_plugin_t::remove_child(const actor_base_t &child) noexcept {
     auto it_actor = actors_map.find(child.get_address());
     assert(it_actor != actors_map.end());
     bool child_started = it_actor->second.strated;
+    if (!it_actor->second.initialized && &child != actor) {
+        --uninitialized;
+    }
     actors_map.erase(it_actor);
     auto &state = actor->access<to::state>();
 
@@ -98,7 +104,7 @@ void child_manager_plugin_t::remove_child(const actor_base_t &child) noexcept {
         }
     }
 
-    if (init_self && (state == state_t::INITIALIZING)) {
+    if (init_self && (state == state_t::INITIALIZING) && actor->access<to::init_request>()) {
         actor->init_continue();
     }
 }
@@ -109,11 +115,31 @@ void child_manager_plugin_t::create_child(const actor_ptr_t &child) noexcept {
     auto &timeout = child->access<to::init_timeout>();
     sup.send<payload::create_actor_t>(actor->get_address(), child, timeout);
     actors_map.emplace(child->get_address(), actor_state_t(child));
+    ++uninitialized;
     if (static_cast<actor_base_t &>(sup).access<to::state>() == state_t::INITIALIZING) {
         postponed_init = true;
     }
 }
 
+void child_manager_plugin_t::create_children(std::vector<actor_ptr_t> &&children) noexcept {
+    if (children.empty()) {
+        return;
+    }
+    auto &sup = static_cast<supervisor_t &>(*actor);
+    auto context = sup.access<to::system_context>();
+    actors_map.reserve(actors_map.size() + children.size());
+    for (auto &child : children) {
+        child->do_initialize(context);
+        actors_map.emplace(child->get_address(), actor_state_t(child));
+    }
+    uninitialized += children.size();
+    if (static_cast<actor_base_t &>(sup).access<to::state>() == state_t::INITIALIZING) {
+        postponed_init = true;
+    }
+    auto timeout = children.front()->access<to::init_timeout>();
+    sup.send<payload::create_actors_t>(actor->get_address(), std::move(children), timeout);
+}
+
 void child_manager_plugin_t::on_create(message::create_actor_t &message) noexcept {
     auto &sup = static_cast<supervisor_t &>(*actor);
     auto &actor = message.payload.actor;
@@ -122,13 +148,22 @@ void child_manager_plugin_t::on_create(message::create_actor_t &message) noexcep
     sup.template request<payload::initialize_actor_t>(actor_address).send(message.payload.timeout);
 }
 
+void child_manager_plugin_t::on_create_group(message::create_actors_t &message) noexcept {
+    auto &sup = static_cast<supervisor_t &>(*actor);
+    auto group_id = sup.create_request_group(message.payload.timeout);
+    for (auto &child : message.payload.actors) {
+        auto &child_address = child->get_address();
+        assert(actors_map.count(child_address) == 1);
+        sup.template request<payload::initialize_actor_t>(child_address).send_within(group_id);
+    }
+}
+
 void child_manager_plugin_t::on_init(message::init_response_t &message) noexcept {
     auto &address = message.payload.req->address;
     auto &ec = message.payload.ec;
 
     auto &sup = static_cast<supervisor_t &>(*actor);
-    bool continue_init = false;
-    continue_init = !ec && !has_initializing();
+    bool continue_init = !ec;
     auto it_actor = actors_map.find(address);
     bool actor_found = it_actor != actors_map.end();
 
@@ -147,6 +182,9 @@ void child_manager_plugin_t::on_init(message::init_response_t &message) noexcept
         /* the if is needed for the very rare case when supervisor was immediately shut down
            right after creation */
         if (actor_found) {
+            if (!it_actor->second.initialized && address != actor->get_address()) {
+                --uninitialized;
+            }
             it_actor->second.initialized = true;
             if (!sup.access<to::synchronize_start>() || address == actor->get_address()) {
                 sup.template send<payload::start_actor_t>(address);
@@ -154,7 +192,10 @@ void child_manager_plugin_t::on_init(message::init_response_t &message) noexcept
             }
         }
     }
-    if (continue_init && postponed_init && actor->access<to::state>() < state_t::INITIALIZED) {
+    /* the supervisor own init request might not arrive yet, if it is in the different locality
+       than the parent and the children are initialized by "foreign" messages */
+    if (continue_init && postponed_init && actor->access<to::state>() < state_t::INITIALIZED &&
+        actor->access<to::init_request>() && !has_initializing()) {
         actor->init_continue();
     }
     // no need of treating self as a child
@@ -294,6 +335,10 @@ void child_manager_plugin_t::handle_start(message::start_trigger_t *trigger) noe
 }
 
 bool child_manager_plugin_t::has_initializing() const noexcept {
+    /* all children confirmed initialization, no need to scan them */
+    if (!uninitialized) {
+        return false;
+    }
     auto init_predicate = [&](auto &it) {
         auto &state = it.second.actor->template access<to::state>();
         bool still_initializing =
@@ -21,6 +21,7 @@ void delivery_plugin_base_t::activate(actor_base_t *actor_) noexcept {
     plugin_base_t::activate(actor_);
     auto sup = static_cast<supervisor_t *>(actor_);
     queue = &sup->locality_leader->queue;
+    leader = sup->locality_leader;
     address = sup->address.get();
     subscription_map = &sup->subscription_map;
     sup->delivery = this;
@@ -28,17 +29,73 @@ void delivery_plugin_base_t::activate(actor_base_t *actor_) noexcept {
 
 void local_delivery_t::delivery(message_ptr_t &message,
                                 const subscription_t::joint_handlers_t &local_recipients) noexcept {
-    for (auto handler : local_recipients.external) {
-        auto &sup = handler->actor_ptr->get_supervisor();
-        auto &address = sup.get_address();
-        auto wrapped_message = make_message<payload::handler_call_t>(address, message, handler);
-        sup.enqueue(std::move(wrapped_message));
+    if (local_recipients.direct_call) {
+        local_recipients.direct_call(*local_recipients.direct_handler, *message);
+        return;
+    }
+    if (!local_recipients.external.empty()) {
+        forward(message, local_recipients.external);
     }
     for (auto handler : local_recipients.internal) {
         handler->call(message);
     }
 }
 
+void local_delivery_t::forward(message_ptr_t &message, const subscription_t::handlers_t &external) noexcept {
+    auto it = external.begin();
+    auto end = external.end();
+    while (it != end) {
+        auto &sup = (*it)->actor_ptr->get_supervisor();
+        // the envelope keeps the lane of the original message
+        auto wrapped_message = make_message<payload::handler_call_t>(message->lane, sup.get_address(), message);
+        auto &handlers = static_cast<message::handler_call_t &>(*wrapped_message).payload.handlers;
+        for (; it != end && &(*it)->actor_ptr->get_supervisor() == &sup; ++it) {
+            handlers.emplace_back(*it);
+        }
+        // the supervisors of the same locality share the queue, no atomics are needed
+        if (sup.get_address()->same_locality(*message->address)) {
+            sup.put(std::move(wrapped_message));
+        } else {
+            wrapped_message->share();
+            sup.enqueue(std::move(wrapped_message));
+        }
+    }
+}
+
+void metered_local_delivery_t::delivery(message_ptr_t &message,
+                                        const subscription_t::joint_handlers_t &local_recipients) noexcept {
+    if (!delivery_meter_t::enabled()) {
+        local_delivery_t::delivery(message, local_recipients);
+        return;
+    }
+
+    auto start = delivery_meter_t::now();
+    auto has_wait = message->stamp && message->stamp <= start;
+    auto wait = has_wait ? start - message->stamp : 0;
+    auto call = [&](handler_base_t *handler, auto &&fn) {
+        // the handler might be released during the call, so the actor is held, i.e. it
+        // is not destroyed (and forgotten by the meter) before its call is recorded
+        actor_ptr_t actor = handler->actor_ptr;
+        auto handler_start = delivery_meter_t::now();
+        fn();
+        auto handler_ns = delivery_meter_t::now() - handler_start;
+        delivery_meter_t::record_handler(actor.get(), handler_ns, wait, has_wait);
+    };
+
+    if (local_recipients.direct_call) {
+        auto handler = local_recipients.direct_handler;
+        call(handler, [&]() { local_recipients.direct_call(*handler, *message); });
+    } else {
+        if (!local_recipients.external.empty()) {
+            local_delivery_t::forward(message, local_recipients.external);
+        }
+        for (auto handler : local_recipients.internal) {
+            call(handler, [&]() { handler->call(message); });
+        }
+    }
+    delivery_meter_t::record_message(message->type_index, delivery_meter_t::now() - start, wait, has_wait);
+}
+
 std::string inspected_local_delivery_t::identify(message_base_t *message, std::int32_t threshold) noexcept {
     using boost::core::demangle;
     using T = owner_tag_t;
@@ -44,9 +44,10 @@ void foreigners_support_plugin_t::deactivate() noexcept {
 }
 
 void foreigners_support_plugin_t::on_call(message::handler_call_t &message) noexcept {
-    auto &handler = message.payload.handler;
     auto &orig_message = message.payload.orig_message;
-    handler->call(orig_message);
+    for (auto &handler : message.payload.handlers) {
+        handler->call(orig_message);
+    }
 }
 
 void foreigners_support_plugin_t::on_subscription_external(message::external_subscription_t &message) noexcept {
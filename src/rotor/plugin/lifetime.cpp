@@ -109,6 +109,10 @@ bool lifetime_plugin_t::handle_unsubscription(const subscription_point_t &point,
         auto it = points.find(point);
         plugin_base_t::forget_subscription(*it);
         points.erase(it);
+        if (external) {
+            auto &sup_addr = static_cast<actor_base_t &>(point.address->supervisor).get_address();
+            actor->send<payload::commit_unsubscription_t>(sup_addr, point);
+        }
         result = true;
         if (points.empty()) {
             plugin_base_t::deactivate();
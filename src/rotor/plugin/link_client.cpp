@@ -51,7 +51,11 @@ void link_client_plugin_t::on_link_response(message::link_response_t &message) n
     auto &address = message.payload.req->address;
     auto &ec = message.payload.ec;
     auto it = servers_map.find(address);
-    assert(it != servers_map.end());
+    if (it == servers_map.end()) {
+        // the link has been already forgotten, i.e. the actor is shutting down
+        assert(actor->access<to::state>() >= state_t::SHUTTING_DOWN);
+        return;
+    }
 
     auto &callback = it->second.callback;
     if (callback)
@@ -84,6 +88,16 @@ void link_client_plugin_t::forget_link(message::unlink_request_t &message) noexc
     try_forget_links(true);
 }
 
+void link_client_plugin_t::detach_link(message::unlink_request_t &message) noexcept {
+    auto &server_addr = message.payload.request_payload.server_addr;
+    auto it = servers_map.find(server_addr);
+    if (it == servers_map.end())
+        return;
+
+    servers_map.erase(it);
+    actor->reply_to(message, actor->get_address());
+}
+
 void link_client_plugin_t::try_forget_links(bool attempt_shutdown) noexcept {
     if (!actor->access<to::link_server>()->has_clients()) {
         bool unlink_requested = !unlink_queue.empty();
@@ -76,7 +76,7 @@ void link_server_plugin_t::on_unlink_notify(message::unlink_notify_t &message) n
 
     auto &unlink_request = it->second.unlink_request;
     if (unlink_request) {
-        actor->get_supervisor().cancel_timer(*unlink_request);
+        actor->get_supervisor().forget_request(*unlink_request);
     }
     linked_clients.erase(it);
 
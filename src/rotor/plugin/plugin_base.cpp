@@ -83,7 +83,10 @@ bool plugin_base_t::handle_unsubscription(const subscription_point_t &point, boo
     if (external) {
         auto act = actor; /* backup */
         auto ok = forget_subscription(point);
-        assert(ok && "unsubscription handled");
+        if (!ok) {
+            /* not mine, the plugin-owner will handle it */
+            return false;
+        }
         auto &sup_addr = static_cast<actor_base_t &>(point.address->supervisor).get_address();
         act->send<payload::commit_unsubscription_t>(sup_addr, point);
         return ok;
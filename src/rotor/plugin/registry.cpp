@@ -40,14 +40,14 @@ void registry_plugin_t::activate(actor_base_t *actor_) noexcept {
 
 void registry_plugin_t::register_name(const std::string &name, const address_ptr_t &address) noexcept {
     assert(register_map.count(name) == 0 && "name is already registering");
-    assert(actor->get_supervisor().get_registry_address());
+    assert(actor->get_supervisor().get_registry_address(name));
 
     assert(!(plugin_state & LINKED));
-    if (!(plugin_state & LINKING)) {
+    register_map.emplace(name, register_info_t{address, state_t::REGISTERING});
+    /* during configuration the linking is postponed till the all names are known */
+    if (plugin_state & CONFIGURED) {
         link_registry();
     }
-
-    register_map.emplace(name, register_info_t{address, state_t::REGISTERING});
 }
 
 registry_plugin_t::discovery_task_t &registry_plugin_t::discover_name(const std::string &name, address_ptr_t &address,
@@ -55,11 +55,10 @@ registry_plugin_t::discovery_task_t &registry_plugin_t::discover_name(const std:
     assert(discovery_map.count(name) == 0 && "name is already discovering");
 
     assert(!(plugin_state & LINKED));
-    if (!(plugin_state & LINKING)) {
+    auto r = discovery_map.emplace(name, discovery_task_t(*this, &address, name, delayed));
+    if (plugin_state & CONFIGURED) {
         link_registry();
     }
-
-    auto r = discovery_map.emplace(name, discovery_task_t(*this, &address, name, delayed));
     return r.first->second;
 }
 
@@ -83,6 +82,21 @@ void registry_plugin_t::on_discovery(message::discovery_response_t &message) noe
 
 void registry_plugin_t::on_future(message::discovery_future_t &message) noexcept { process_discovery(message); }
 
+void registry_plugin_t::on_cache_dereg(message::deregistration_notify_t &message) noexcept {
+    auto &service_addr = message.payload.service_addr;
+    for (auto it = cache.begin(); it != cache.end();) {
+        if (it->second == service_addr) {
+            it = cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void registry_plugin_t::on_cache_dereg_service(message::deregistration_service_t &message) noexcept {
+    cache.erase(message.payload.service_name);
+}
+
 void registry_plugin_t::continue_init(const std::error_code &ec) noexcept {
     auto &init_request = actor->access<to::init_request>();
     assert(init_request);
@@ -94,27 +108,51 @@ void registry_plugin_t::continue_init(const std::error_code &ec) noexcept {
 }
 
 void registry_plugin_t::link_registry() noexcept {
-    plugin_state = plugin_state | LINKING;
+    auto &sup = actor->get_supervisor();
     auto plugin = actor->access<to::get_plugin>(link_client_plugin_t::class_identity);
     auto p = static_cast<link_client_plugin_t *>(plugin);
-    auto &registry_addr = actor->get_supervisor().get_registry_address();
-    assert(registry_addr && "supervisor has registry address");
-    /* we know that registry actor has no I/O, so it is safe to work with it in pre-operational state */
-    bool operational_only = false;
-    p->link(registry_addr, operational_only, [this](auto &ec) { on_link(ec); });
+    auto link = [&](const std::string &name) {
+        auto &registry_addr = sup.get_registry_address(name);
+        assert(registry_addr && "supervisor has registry address");
+        if (registries.count(registry_addr)) {
+            return;
+        }
+        registries.emplace(registry_addr);
+        ++pending_links;
+        plugin_state = plugin_state | LINKING;
+        /* we know that registry actor has no I/O, so it is safe to work with it in pre-operational state */
+        bool operational_only = false;
+        p->link(registry_addr, operational_only, [this, registry_addr](auto &ec) { on_link(registry_addr, ec); });
+    };
+    for (auto &it : register_map) {
+        link(it.first);
+    }
+    for (auto &it : discovery_map) {
+        if (!it.second.cached) {
+            link(it.first);
+        }
+    }
 }
 
-void registry_plugin_t::on_link(const std::error_code &ec) noexcept {
-    plugin_state = plugin_state | LINKED;
-    plugin_state = plugin_state & ~LINKING;
+void registry_plugin_t::on_link(const address_ptr_t &registry_addr, const std::error_code &ec) noexcept {
+    if (--pending_links == 0) {
+        plugin_state = plugin_state | LINKED;
+        plugin_state = plugin_state & ~LINKING;
+    }
     if (!ec) {
-        auto &registry_addr = actor->get_supervisor().get_registry_address();
+        auto &sup = actor->get_supervisor();
         auto timeout = actor->access<to::init_timeout>();
         for (auto &it : register_map) {
-            actor->request<payload::registration_request_t>(registry_addr, it.first, it.second.address).send(timeout);
+            if (sup.get_registry_address(it.first) == registry_addr) {
+                actor->request<payload::registration_request_t>(registry_addr, it.first, it.second.address)
+                    .send(timeout);
+            }
         }
         for (auto &it : discovery_map) {
             auto &task = it.second;
+            if (task.cached || sup.get_registry_address(task.service_name) != registry_addr) {
+                continue;
+            }
             task.requested = true;
             if (!task.delayed) {
                 actor->request<payload::discovery_request_t>(registry_addr, task.service_name).send(timeout);
@@ -127,19 +165,70 @@ void registry_plugin_t::on_link(const std::error_code &ec) noexcept {
     }
 }
 
+registry_plugin_t *registry_plugin_t::cache_owner() noexcept {
+    auto &sup = actor->get_supervisor();
+    if (!sup.has_discovery_cache()) {
+        return nullptr;
+    }
+    auto plugin = static_cast<actor_base_t &>(sup).access<to::get_plugin>(class_identity);
+    return static_cast<registry_plugin_t *>(plugin);
+}
+
+void registry_plugin_t::resolve_cached() noexcept {
+    auto owner = cache_owner();
+    if (!owner) {
+        return;
+    }
+    for (auto &it : discovery_map) {
+        auto cached = owner->cache.find(it.first);
+        if (cached != owner->cache.end()) {
+            *it.second.address = cached->second;
+            it.second.cached = true;
+        }
+    }
+}
+
+void registry_plugin_t::watch_registries() noexcept {
+    auto &sup = actor->get_supervisor();
+    if (static_cast<actor_base_t *>(&sup) != actor || !sup.has_discovery_cache()) {
+        return;
+    }
+    auto watch = [&](const address_ptr_t &registry_addr) {
+        subscribe(&registry_plugin_t::on_cache_dereg, registry_addr);
+        subscribe(&registry_plugin_t::on_cache_dereg_service, registry_addr);
+    };
+    auto &shards = sup.get_registry_shards();
+    if (!shards.empty()) {
+        for (auto &registry_addr : shards) {
+            watch(registry_addr);
+        }
+    } else if (auto &registry_addr = sup.get_registry_address(); registry_addr) {
+        watch(registry_addr);
+    }
+}
+
 bool registry_plugin_t::handle_init(message::init_request_t *) noexcept {
     if (!(plugin_state & CONFIGURED)) {
         actor->configure(*this);
         plugin_state = plugin_state | CONFIGURED;
+        watch_registries();
+        resolve_cached();
+        link_registry();
+        for (auto &it : discovery_map) {
+            if (it.second.cached) {
+                it.second.on_discovery({});
+            }
+        }
     }
     return discovery_map.empty() && !has_registering();
 }
 
 bool registry_plugin_t::handle_shutdown(message::shutdown_request_t *req) noexcept {
+    auto &sup = actor->get_supervisor();
     if (!register_map.empty()) {
-        auto &registry_addr = actor->get_supervisor().get_registry_address();
         for (auto &it : register_map) {
             if (it.second.state == state_t::OPERATIONAL) {
+                auto &registry_addr = sup.get_registry_address(it.first);
                 actor->send<payload::deregistration_service_t>(registry_addr, it.first);
                 it.second.state = state_t::UNREGISTERING;
             }
@@ -148,10 +237,10 @@ bool registry_plugin_t::handle_shutdown(message::shutdown_request_t *req) noexce
     }
 
     if (!discovery_map.empty()) {
-        auto &registry_addr = actor->get_supervisor().get_registry_address();
         for (auto it = discovery_map.begin(); it != discovery_map.end(); ++it) {
             auto &task = it->second;
             if (task.delayed && task.requested) {
+                auto &registry_addr = sup.get_registry_address(task.service_name);
                 actor->send<payload::discovery_cancel_t>(registry_addr, actor->get_address(), task.service_name);
             }
         }
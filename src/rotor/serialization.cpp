@@ -0,0 +1,125 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/serialization.h"
+
+using namespace rotor;
+
+namespace {
+
+/* the categories of the serialized error codes */
+enum class category_t : std::uint8_t { none = 0, rotor, system, generic };
+
+} // namespace
+
+void encoder_t::put(const std::error_code &ec) noexcept {
+    auto &category = ec.category();
+    if (!ec) {
+        put(category_t::none);
+        return;
+    } else if (category == error_code_category()) {
+        put(category_t::rotor);
+    } else if (category == std::system_category()) {
+        put(category_t::system);
+    } else if (category == std::generic_category()) {
+        put(category_t::generic);
+    } else {
+        // other categories cannot be identified on the other side
+        put(category_t::generic);
+        put(static_cast<int>(std::errc::not_supported));
+        return;
+    }
+    put(ec.value());
+}
+
+bool decoder_t::get(std::error_code &ec) noexcept {
+    category_t category;
+    if (!get(category)) {
+        return false;
+    }
+    if (category == category_t::none) {
+        ec = {};
+        return true;
+    }
+    int value;
+    if (!get(value)) {
+        return false;
+    }
+    switch (category) {
+    case category_t::rotor:
+        ec = make_error_code(static_cast<error_code_t>(value));
+        return true;
+    case category_t::system:
+        ec = std::error_code(value, std::system_category());
+        return true;
+    case category_t::generic:
+        ec = std::error_code(value, std::generic_category());
+        return true;
+    default:
+        return fail();
+    }
+}
+
+bool serialization_registry_t::add(const entry_t &entry) noexcept {
+    auto it = by_id.find(entry.type_id);
+    if (it != by_id.end()) {
+        return entries[it->second].message_type == entry.message_type;
+    }
+    by_id.emplace(entry.type_id, entries.size());
+    by_type.emplace(entry.message_type, entries.size());
+    entries.emplace_back(entry);
+    return true;
+}
+
+void serialization_registry_t::add_builtin() noexcept {
+    add<payload::start_actor_t>();
+    add<payload::shutdown_trigger_t>();
+    add<payload::deregistration_notify_t>();
+    add<payload::deregistration_service_t>();
+    add<payload::discovery_cancel_t>();
+    add<payload::unlink_notify_t>();
+    add<payload::backpressure_t>();
+    add_request<payload::initialize_actor_t>();
+    add_request<payload::shutdown_request_t>();
+    add_request<payload::state_request_t>();
+    add_request<payload::registration_request_t>();
+    add_request<payload::discovery_request_t>();
+    add_request<payload::discovery_promise_t>();
+    add_request<payload::link_request_t>();
+    add_request<payload::unlink_request_t>();
+}
+
+auto serialization_registry_t::find(std::uint32_t type_id) const noexcept -> const entry_t * {
+    auto it = by_id.find(type_id);
+    return it != by_id.end() ? &entries[it->second] : nullptr;
+}
+
+auto serialization_registry_t::find(const void *message_type) const noexcept -> const entry_t * {
+    auto it = by_type.find(message_type);
+    return it != by_type.end() ? &entries[it->second] : nullptr;
+}
+
+bool serialization_registry_t::encode(encoder_t &encoder, const message_base_t &message) const noexcept {
+    auto entry = find(message.type_index);
+    if (!entry) {
+        return false;
+    }
+    encoder.put(entry->type_id);
+    entry->encode(encoder, message);
+    return true;
+}
+
+message_ptr_t serialization_registry_t::decode(decoder_t &decoder, const address_ptr_t &destination) const noexcept {
+    std::uint32_t type_id;
+    if (!decoder.get(type_id)) {
+        return {};
+    }
+    auto entry = find(type_id);
+    if (!entry) {
+        return {};
+    }
+    return entry->decode(decoder, destination);
+}
@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/shm/ring.h"
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace rotor::shm;
+
+namespace {
+
+/* the futex is not private, as the ring is shared between processes */
+long futex(std::atomic<std::uint32_t> *word, int op, std::uint32_t value, const timespec *timeout) noexcept {
+    return syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(word), op, value, timeout, nullptr, 0);
+}
+
+} // namespace
+
+std::uint32_t ring_t::prepare_wait() noexcept {
+    header->waiters.fetch_add(1, std::memory_order_seq_cst);
+    return header->signal.load(std::memory_order_seq_cst);
+}
+
+void ring_t::wait(std::uint32_t value, std::chrono::milliseconds timeout) noexcept {
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(seconds.count());
+    ts.tv_nsec = static_cast<long>(std::chrono::nanoseconds(timeout - seconds).count());
+    futex(&header->signal, FUTEX_WAIT, value, &ts);
+    header->waiters.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void ring_t::notify() noexcept {
+    if (header->waiters.load(std::memory_order_seq_cst)) {
+        header->signal.fetch_add(1, std::memory_order_seq_cst);
+        futex(&header->signal, FUTEX_WAKE, INT_MAX, nullptr);
+    }
+}
@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/shm/segment.h"
+#include "rotor/error_code.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace rotor;
+using namespace rotor::shm;
+
+namespace {
+
+constexpr std::uint64_t magic = 0x726f746f72736d31ull; // "rotorsm1"
+
+struct segment_header_t {
+    /** the `magic` is written last by the creator, i.e. it marks the segment as ready */
+    std::atomic<std::uint64_t> magic;
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t capacity;
+    ring_header_t rings[2];
+};
+
+constexpr std::size_t header_size = (sizeof(segment_header_t) + 63) & ~std::size_t{63};
+
+/** the ring offsets are masked, i.e. the capacity should be power of 2 */
+bool valid_capacity(std::uint64_t capacity) noexcept { return capacity >= 4096 && !(capacity & (capacity - 1)); }
+
+std::error_code last_error() noexcept { return std::error_code(errno, std::system_category()); }
+
+} // namespace
+
+segment_t::segment_t(const std::string &name_, void *memory_, std::size_t size_, std::size_t capacity_,
+                     bool owner_) noexcept
+    : name{name_}, memory{memory_}, size{size_}, capacity{capacity_}, owner{owner_},
+      rings{{&static_cast<segment_header_t *>(memory)->rings[0], static_cast<std::uint8_t *>(memory) + header_size,
+             capacity},
+            {&static_cast<segment_header_t *>(memory)->rings[1],
+             static_cast<std::uint8_t *>(memory) + header_size + capacity, capacity}} {}
+
+segment_t::~segment_t() {
+    munmap(memory, size);
+    if (owner) {
+        shm_unlink(name.c_str());
+    }
+}
+
+segment_ptr_t segment_t::create(const std::string &name, std::size_t capacity, std::error_code &ec) noexcept {
+    if (!valid_capacity(capacity)) {
+        ec = make_error_code(error_code_t::transport_mismatch);
+        return {};
+    }
+    shm_unlink(name.c_str());
+    auto fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        ec = last_error();
+        return {};
+    }
+    auto size = header_size + 2 * capacity;
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ec = last_error();
+        close(fd);
+        shm_unlink(name.c_str());
+        return {};
+    }
+    auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        ec = last_error();
+        shm_unlink(name.c_str());
+        return {};
+    }
+
+    // the memory is zero-filled by ftruncate
+    auto header = new (memory) segment_header_t{};
+    header->version = version;
+    header->capacity = capacity;
+    header->magic.store(magic, std::memory_order_release);
+    return segment_ptr_t(new segment_t(name, memory, size, capacity, true));
+}
+
+segment_ptr_t segment_t::open(const std::string &name, std::error_code &ec) noexcept {
+    auto fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        ec = last_error();
+        return {};
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ec = last_error();
+        close(fd);
+        return {};
+    }
+    auto size = static_cast<std::size_t>(st.st_size);
+    if (size < header_size) {
+        ec = make_error_code(error_code_t::transport_mismatch);
+        close(fd);
+        return {};
+    }
+    auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        ec = last_error();
+        return {};
+    }
+
+    // the header is written by the other side, i.e. the capacity is checked before it is used
+    auto header = static_cast<segment_header_t *>(memory);
+    auto valid = header->magic.load(std::memory_order_acquire) == magic && header->version == version &&
+                 valid_capacity(header->capacity) && header->capacity == (size - header_size) / 2 &&
+                 size == header_size + 2 * header->capacity;
+    auto capacity = static_cast<std::size_t>(header->capacity);
+    if (!valid) {
+        ec = make_error_code(error_code_t::transport_mismatch);
+        munmap(memory, size);
+        return {};
+    }
+    return segment_ptr_t(new segment_t(name, memory, size, capacity, false));
+}
@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/shm/transport.h"
+
+using namespace rotor;
+using namespace rotor::shm;
+
+namespace {
+
+/* the watcher re-checks the stop flag at least that often */
+constexpr std::chrono::milliseconds watch_timeout{100};
+
+} // namespace
+
+transport_t::transport_t(config_t &config)
+    : transport_base_t{config}, name{config.name}, create{config.create}, capacity{config.capacity},
+      batch{config.batch} {}
+
+transport_t::~transport_t() { stop_watching(); }
+
+void transport_t::configure(plugin::plugin_base_t &plugin) noexcept {
+    transport_base_t::configure(plugin);
+    plugin.with_casted<plugin::starter_plugin_t>([this](auto &p) {
+        p.subscribe_actor(&transport_t::on_notify);
+        for (auto &it : codecs) {
+            it.second.subscriber(*this, p, it.first);
+        }
+    });
+}
+
+void transport_t::init_finish() noexcept {
+    std::error_code ec;
+    segment = create ? segment_t::create(name, capacity, ec) : segment_t::open(name, ec);
+    if (!segment) {
+        reply_with_error(*init_request, ec);
+        init_request.reset();
+        return;
+    }
+    transport_base_t::init_finish();
+}
+
+void transport_t::on_start() noexcept {
+    transport_base_t::on_start();
+    watcher = std::thread([this]() { watch(); });
+}
+
+void transport_t::shutdown_start() noexcept {
+    stop_watching();
+    // the responses will not be received anymore
+    fail_pending(make_error_code(error_code_t::transport_disconnected));
+    transport_base_t::shutdown_start();
+}
+
+void transport_t::shutdown_finish() noexcept {
+    segment.reset();
+    transport_base_t::shutdown_finish();
+}
+
+void transport_t::on_notify(notify_message_t &) noexcept {
+    if (segment) {
+        auto &ring = segment->inbound();
+        ring.consume(
+            [this](const frame_t &frame, const void *data) {
+                auto it = codecs.find(frame.type);
+                if (it == codecs.end()) {
+                    ++dropped;
+                    return;
+                }
+                it->second.decoder(*this, frame, data);
+            },
+            batch);
+        if (ring.corrupted()) {
+            // the other side is broken, there is no way to find the next frame
+            ++dropped;
+            do_shutdown();
+            return;
+        }
+        // the rest is decoded later, to let other messages to be processed; the watcher keeps waiting
+        if (!ring.empty()) {
+            supervisor->enqueue(make_message<notify_t>(address));
+            return;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(watch_mutex);
+        notified.store(false, std::memory_order_release);
+    }
+    watch_condition.notify_one();
+}
+
+bool transport_t::push(frame_t frame, const void *data, std::size_t length) noexcept {
+    if (!segment) {
+        return false;
+    }
+    return segment->outbound().push(frame, length, [&](void *target) {
+        if (length) {
+            std::memcpy(target, data, length);
+        }
+    });
+}
+
+void transport_t::refuse(const frame_t &frame, const std::error_code &ec) noexcept {
+    auto reply = make_frame(frame_kind_t::response, frame.type, 0);
+    reply.request = frame.request;
+    encode_error(reply, ec);
+    push(reply, nullptr, 0);
+}
+
+void transport_t::notify() noexcept {
+    if (!notified.exchange(true, std::memory_order_acq_rel)) {
+        supervisor->enqueue(make_message<notify_t>(address));
+    }
+}
+
+void transport_t::watch() noexcept {
+    auto &ring = segment->inbound();
+    while (!stopping.load(std::memory_order_acquire)) {
+        if (notified.load(std::memory_order_acquire)) {
+            // the frames are not consumed yet, there is no need to look at the ring
+            std::unique_lock<std::mutex> lock(watch_mutex);
+            watch_condition.wait_for(lock, watch_timeout, [this]() {
+                return stopping.load(std::memory_order_acquire) || !notified.load(std::memory_order_acquire);
+            });
+            continue;
+        }
+        auto value = ring.prepare_wait();
+        if (stopping.load(std::memory_order_acquire) || !ring.empty()) {
+            ring.cancel_wait();
+        } else {
+            ring.wait(value, watch_timeout);
+        }
+        if (!ring.empty()) {
+            notify();
+        }
+    }
+}
+
+void transport_t::stop_watching() noexcept {
+    if (watcher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(watch_mutex);
+            stopping.store(true, std::memory_order_release);
+        }
+        watch_condition.notify_one();
+        segment->inbound().notify();
+        watcher.join();
+    }
+}
+
+void transport_t::encode_error(frame_t &frame, const std::error_code &ec) noexcept {
+    if (!ec) {
+        frame.category = static_cast<std::uint16_t>(error_category_t::none);
+        frame.ec = 0;
+    } else if (ec.category() == error_code_category()) {
+        frame.category = static_cast<std::uint16_t>(error_category_t::rotor);
+        frame.ec = ec.value();
+    } else if (ec.category() == std::system_category()) {
+        frame.category = static_cast<std::uint16_t>(error_category_t::system);
+        frame.ec = ec.value();
+    } else {
+        // other categories cannot be identified on the other side
+        frame.category = static_cast<std::uint16_t>(error_category_t::rotor);
+        frame.ec = static_cast<std::int32_t>(error_code_t::transport_mismatch);
+    }
+}
+
+std::error_code transport_t::decode_error(const frame_t &frame) noexcept {
+    switch (static_cast<error_category_t>(frame.category)) {
+    case error_category_t::none:
+        return {};
+    case error_category_t::rotor:
+        return make_error_code(static_cast<error_code_t>(frame.ec));
+    case error_category_t::system:
+        return std::error_code(frame.ec, std::system_category());
+    }
+    return make_error_code(error_code_t::transport_mismatch);
+}
@@ -10,8 +10,116 @@
 
 using namespace rotor;
 
+namespace {
+constexpr std::size_t initial_capacity = 16;
+}
+
 subscription_info_t::~subscription_info_t() {}
 
+void subscription_t::joint_handlers_t::refresh() noexcept {
+    if (internal.size() == 1 && external.empty() && internal.front()->direct_call) {
+        direct_handler = internal.front();
+        direct_call = direct_handler->direct_call;
+    } else {
+        direct_handler = nullptr;
+        direct_call = nullptr;
+    }
+}
+
+subscription_t::addressed_handlers_t::addressed_handlers_t() noexcept : mask{0}, count{0} {}
+
+std::size_t subscription_t::addressed_handlers_t::index_of(const subscrption_key_t &key) const noexcept {
+    auto h1 = reinterpret_cast<std::size_t>(key.address) * std::size_t(0x9E3779B97F4A7C15ull);
+    auto h2 = reinterpret_cast<std::size_t>(key.message_type) * std::size_t(0xC2B2AE3D27D4EB4Full);
+    auto h = h1 ^ h2;
+    return (h ^ (h >> 29)) & mask;
+}
+
+void subscription_t::addressed_handlers_t::rehash(std::size_t capacity) noexcept {
+    slots_t prev(capacity, slot_t{{nullptr, nullptr}, nullptr});
+    std::swap(prev, slots);
+    mask = capacity - 1;
+    for (auto &slot : prev) {
+        if (slot.key.address) {
+            auto i = index_of(slot.key);
+            while (slots[i].key.address) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = slot;
+        }
+    }
+}
+
+subscription_t::joint_handlers_t &subscription_t::addressed_handlers_t::emplace(const subscrption_key_t &key) noexcept {
+    if ((count + 1) * 2 > slots.size()) {
+        rehash(slots.empty() ? initial_capacity : slots.size() * 2);
+    }
+    for (auto i = index_of(key);; i = (i + 1) & mask) {
+        auto &slot = slots[i];
+        if (!slot.key.address) {
+            joint_handlers_t *handlers;
+            if (spare.empty()) {
+                handlers = &storage.emplace_back();
+            } else {
+                handlers = spare.back();
+                spare.pop_back();
+            }
+            slot = slot_t{key, handlers};
+            ++count;
+            return *handlers;
+        }
+        if (slot.key == key) {
+            return *slot.handlers;
+        }
+    }
+}
+
+subscription_t::joint_handlers_t *subscription_t::addressed_handlers_t::find(const subscrption_key_t &key) const
+    noexcept {
+    if (!count) {
+        return nullptr;
+    }
+    for (auto i = index_of(key);; i = (i + 1) & mask) {
+        auto &slot = slots[i];
+        if (slot.key == key) {
+            return slot.handlers;
+        }
+        if (!slot.key.address) {
+            return nullptr;
+        }
+    }
+}
+
+void subscription_t::addressed_handlers_t::erase(const subscrption_key_t &key) noexcept {
+    if (!count) {
+        return;
+    }
+    auto i = index_of(key);
+    while (!(slots[i].key == key)) {
+        if (!slots[i].key.address) {
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    auto handlers = slots[i].handlers;
+    handlers->internal.clear();
+    handlers->external.clear();
+    handlers->refresh();
+    spare.emplace_back(handlers);
+
+    // backward shift: move the following entries of the probing chain into the hole
+    for (auto j = (i + 1) & mask; slots[j].key.address; j = (j + 1) & mask) {
+        auto home = index_of(slots[j].key);
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            slots[i] = slots[j];
+            i = j;
+        }
+    }
+    slots[i] = slot_t{{nullptr, nullptr}, nullptr};
+    --count;
+}
+
 subscription_t::subscription_t(supervisor_t &sup_) noexcept : supervisor{sup_} {}
 
 subscription_info_ptr_t subscription_t::materialize(const subscription_point_t &point) noexcept {
@@ -28,10 +136,19 @@ subscription_info_ptr_t subscription_t::materialize(const subscription_point_t &
         auto &info_list = internal_infos[address];
         info_list.emplace_back(info);
 
-        auto insert_result = mine_handlers.try_emplace({address.get(), handler->message_type});
-        auto &joint_handlers = insert_result.first->second;
-        auto &handlers = internal_handler ? joint_handlers.internal : joint_handlers.external;
-        handlers.emplace_back(handler.get());
+        auto &joint_handlers = mine_handlers.emplace({address.get(), handler->message_type});
+        if (internal_handler) {
+            joint_handlers.internal.emplace_back(handler.get());
+        } else {
+            // keep external handlers grouped by supervisor, so that they are called via single envelope
+            auto &external = joint_handlers.external;
+            auto &handler_sup = handler->actor_ptr->get_supervisor();
+            auto it = std::find_if(external.rbegin(), external.rend(),
+                                   [&](auto &item) { return &item->actor_ptr->get_supervisor() == &handler_sup; });
+            auto position = it == external.rend() ? external.end() : it.base();
+            external.insert(position, handler.get());
+        }
+        joint_handlers.refresh();
     }
 
     return info;
@@ -40,11 +157,7 @@ subscription_info_ptr_t subscription_t::materialize(const subscription_point_t &
 const subscription_t::joint_handlers_t *subscription_t::get_recipients(const message_base_t &message) const noexcept {
     auto address = message.address.get();
     auto message_type = message.type_index;
-    auto it = mine_handlers.find({address, message_type});
-    if (it == mine_handlers.end()) {
-        return nullptr;
-    }
-    return &it->second;
+    return mine_handlers.find({address, message_type});
 }
 
 void subscription_t::forget(const subscription_info_ptr_t &info) noexcept {
@@ -64,14 +177,16 @@ void subscription_t::forget(const subscription_info_ptr_t &info) noexcept {
     }
 
     auto handler_ptr = info->handler.get();
-    auto it = mine_handlers.find({info->address.get(), handler_ptr->message_type});
-    auto &joint_handlers = it->second;
+    subscrption_key_t key{info->address.get(), handler_ptr->message_type};
+    auto &joint_handlers = *mine_handlers.find(key);
     auto &handlers = info->internal_handler ? joint_handlers.internal : joint_handlers.external;
     auto &misc_handlers = !info->internal_handler ? joint_handlers.internal : joint_handlers.external;
     auto handler_it =
         std::find_if(handlers.begin(), handlers.end(), [&handler_ptr](auto &item) { return item == handler_ptr; });
     handlers.erase(handler_it);
     if (handlers.empty() && misc_handlers.empty()) {
-        mine_handlers.erase(it);
+        mine_handlers.erase(key);
+    } else {
+        joint_handlers.refresh();
     }
 }
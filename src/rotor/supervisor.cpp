@@ -6,13 +6,23 @@
 
 #include "rotor/supervisor.h"
 #include "rotor/registry.h"
+#include <algorithm>
 #include <assert.h>
 using namespace rotor;
 
 supervisor_t::supervisor_t(supervisor_config_t &config)
-    : actor_base_t(config), last_req_id{1}, subscription_map(*this), parent{config.supervisor}, manager{nullptr},
+    : actor_base_t(config), subscription_map(*this), parent{config.supervisor}, manager{nullptr},
       create_registry(config.create_registry), synchronize_start(config.synchronize_start),
-      registry_address(config.registry_address), policy{config.policy} {
+      registry_address(config.registry_address), registry_shards(config.registry_shards),
+      discovery_cache{config.discovery_cache}, policy{config.policy},
+      queue_capacity{config.queue_capacity}, overflow_policy{config.overflow_policy}, backpressure_notified{false},
+      inbound_load{0}, inbound_overflow{false}, process_budget{config.process_budget},
+      timer_resolution{config.timer_resolution.total_microseconds()}, timer_wheel_timer{0}, timer_wheel_deadline{0} {
+    queue.set_weights(config.lane_weights);
+    if (timer_resolution > 0) {
+        timer_wheel = std::make_unique<timer_wheel_t>();
+        timer_epoch = wheel_clock_t::now();
+    }
     if (!supervisor) {
         supervisor = this;
     }
@@ -34,6 +44,11 @@ address_ptr_t supervisor_t::instantiate_address(const void *locality) noexcept {
 void supervisor_t::do_initialize(system_context_t *ctx) noexcept {
     context = ctx;
     actor_base_t::do_initialize(ctx);
+    // pre-warm reply addresses of the core requests
+    reply_address<payload::initialize_actor_t>();
+    reply_address<payload::shutdown_request_t>();
+    reply_address<payload::link_request_t>();
+    reply_address<payload::unlink_request_t>();
     // do self-bootstrap
     if (!parent) {
         request<payload::initialize_actor_t>(address).send(init_timeout);
@@ -42,9 +57,21 @@ void supervisor_t::do_initialize(system_context_t *ctx) noexcept {
         auto actor = create_actor<registry_t>().init_timeout(init_timeout).shutdown_timeout(shutdown_timeout).finish();
         registry_address = actor->address;
     }
-    if (parent && !registry_address) {
+    if (parent && !registry_address && registry_shards.empty()) {
         registry_address = parent->registry_address;
+        registry_shards = parent->registry_shards;
+    }
+    if (!registry_address && !registry_shards.empty()) {
+        registry_address = registry_shards.front();
+    }
+}
+
+const address_ptr_t &supervisor_t::get_registry_address(const std::string &name) const noexcept {
+    if (registry_shards.empty()) {
+        return registry_address;
     }
+    auto index = std::hash<std::string>()(name) % registry_shards.size();
+    return registry_shards[index];
 }
 
 void supervisor_t::do_shutdown() noexcept {
@@ -72,6 +99,21 @@ subscription_info_ptr_t supervisor_t::subscribe(const handler_ptr_t &handler, co
     return sub_info;
 }
 
+subscription_info_ptr_t supervisor_t::subscribe(const handler_ptr_t *handlers, std::size_t count,
+                                                const address_ptr_t &addr, const actor_base_t *owner_ptr,
+                                                owner_tag_t owner_tag, subscription_container_t &infos) noexcept {
+    assert(count && &addr->supervisor == this);
+    subscription_info_ptr_t sub_info;
+    for (std::size_t i = 0; i < count; ++i) {
+        sub_info = subscription_map.materialize(subscription_point_t(handlers[i], addr, owner_ptr, owner_tag));
+        assert(sub_info->internal_address && sub_info->internal_handler);
+        infos.emplace_back(sub_info);
+    }
+    auto &last = handlers[count - 1];
+    send<payload::subscription_confirmation_t>(last->actor_ptr->address, subscription_point_t(*sub_info));
+    return sub_info;
+}
+
 void supervisor_t::commit_unsubscription(const subscription_info_ptr_t &info) noexcept {
     subscription_map.forget(info);
 }
@@ -84,13 +126,297 @@ void supervisor_t::on_child_shutdown(actor_base_t *, const std::error_code &) no
 }
 
 void supervisor_t::on_timer_trigger(request_id_t timer_id) {
-    auto it = request_map.find(timer_id);
-    if (it != request_map.end()) {
-        auto &request_curry = it->second;
-        message_ptr_t &request = request_curry.request_message;
+    if (timer_wheel && timer_id == timer_wheel_timer) {
+        on_timer_wheel_tick();
+    } else {
+        expire_request(timer_id);
+    }
+}
+
+void supervisor_t::expire_request(request_id_t request_id) noexcept {
+    if (!request_groups.empty()) {
+        auto it = request_groups.find(request_id);
+        if (it != request_groups.end()) {
+            expire_request_group(it);
+            return;
+        }
+    }
+    auto request_curry = request_map.find(request_id);
+    if (request_curry) {
+        message_ptr_t &request = request_curry->request_message;
         auto ec = make_error_code(error_code_t::request_timeout);
-        auto timeout_message = request_curry.fn(request_curry.origin, *request, std::move(ec));
-        put(std::move(timeout_message));
-        request_map.erase(it);
+        auto timeout_message = request_curry->fn(request_curry->origin, *request, std::move(ec));
+        if (request_curry->continuation) {
+            resume_request(request_id, std::move(timeout_message));
+        } else {
+            put(std::move(timeout_message));
+            request_map.erase(request_id);
+        }
+    }
+}
+
+void supervisor_t::resume_request(request_id_t request_id, message_ptr_t response) noexcept {
+    // the continuation might make new requests, so the curry is released before
+    auto curry = request_map.find(request_id);
+    auto continuation = curry->continuation;
+    auto context = curry->continuation_context;
+    request_map.erase(request_id);
+    continuation(context, response);
+}
+
+void supervisor_t::overflow(message_ptr_t message) noexcept {
+    auto leader = locality_leader;
+    auto &leader_queue = leader->queue;
+    if (!message->is_bounded()) {
+        leader_queue.emplace_back(std::move(message));
+        return;
+    }
+
+    switch (leader->overflow_policy) {
+    case overflow_policy_t::drop_oldest: {
+        // the oldest message of the lowest priority lane is dropped; if the queue is
+        // full of unbounded messages, the new one is dropped instead
+        if (leader_queue.erase_first([](auto &m) { return m->is_bounded(); })) {
+            leader_queue.emplace_back(std::move(message));
+        }
+        break;
+    }
+    case overflow_policy_t::reject: {
+        // the error response is not bounded, i.e. it takes the place of the rejected request
+        auto ec = make_error_code(error_code_t::queue_overflow);
+        auto response = message->make_overflow_response(ec);
+        if (response) {
+            leader_queue.emplace_back(std::move(response));
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    leader->notify_backpressure();
+}
+
+void supervisor_t::notify_backpressure() noexcept {
+    auto leader = locality_leader;
+    if (!leader->backpressure_notified) {
+        leader->backpressure_notified = true;
+        auto &leader_addr = leader->address;
+        auto notification = make_message<payload::backpressure_t>(leader_addr, leader_addr, leader->overflow_policy);
+        leader->queue.emplace_back(std::move(notification));
+    }
+}
+
+bool supervisor_t::admit_inbound(message_base_t &message) noexcept {
+    auto leader = locality_leader;
+    if (!leader->queue_capacity || !message.is_bounded()) {
+        return true;
+    }
+    if (leader->inbound_load.fetch_add(1, std::memory_order_relaxed) < leader->queue_capacity) {
+        return true;
+    }
+    leader->inbound_load.fetch_sub(1, std::memory_order_relaxed);
+
+    if (leader->overflow_policy == overflow_policy_t::reject) {
+        auto ec = make_error_code(error_code_t::queue_overflow);
+        auto response = message.make_overflow_response(ec);
+        if (response) {
+            // the requestor supervisor might be in any locality
+            auto &destination = response->address->supervisor;
+            response->share();
+            destination.enqueue(std::move(response));
+        }
+    }
+    leader->inbound_overflow.store(true, std::memory_order_relaxed);
+    return false;
+}
+
+void supervisor_t::drain(inbound_queue_t &inbound) noexcept {
+    if (!queue_capacity) {
+        inbound.drain(queue);
+        return;
+    }
+
+    struct sink_t {
+        supervisor_t &sup;
+        std::size_t bounded;
+        void emplace_back(message_ptr_t &&message) noexcept {
+            if (message->is_bounded()) {
+                ++bounded;
+            }
+            if (sup.queue.size() < sup.queue_capacity) {
+                sup.accept(std::move(message));
+            } else {
+                sup.overflow(std::move(message));
+            }
+        }
+    };
+    sink_t sink{*this, 0};
+    inbound.drain(sink);
+    if (sink.bounded) {
+        inbound_load.fetch_sub(sink.bounded, std::memory_order_relaxed);
+    }
+    if (inbound_overflow.load(std::memory_order_relaxed) && inbound_overflow.exchange(false)) {
+        notify_backpressure();
+    }
+}
+
+void supervisor_t::put_inbound(message_ptr_t message) noexcept {
+    auto leader = locality_leader;
+    if (leader->queue_capacity && message->is_bounded()) {
+        leader->inbound_load.fetch_sub(1, std::memory_order_relaxed);
+    }
+    put(std::move(message));
+    if (leader->inbound_overflow.load(std::memory_order_relaxed) && leader->inbound_overflow.exchange(false)) {
+        notify_backpressure();
+    }
+}
+
+timer_wheel_t::tick_t supervisor_t::timer_wheel_now() const noexcept {
+    using namespace std::chrono;
+    auto passed = duration_cast<microseconds>(wheel_clock_t::now() - timer_epoch).count();
+    return static_cast<timer_wheel_t::tick_t>(passed / timer_resolution);
+}
+
+void supervisor_t::start_request_timer(const pt::time_duration &timeout, request_id_t request_id,
+                                       request_curry_t &curry) noexcept {
+    start_request_timer(timeout, request_id, curry.timer_handle);
+}
+
+void supervisor_t::start_request_timer(const pt::time_duration &timeout, request_id_t timer_id,
+                                       timer_wheel_t::handle_t &handle) noexcept {
+    if (!timer_wheel) {
+        start_timer(timeout, timer_id);
+        return;
+    }
+
+    auto now = timer_wheel_now();
+    if (timer_wheel->empty()) {
+        /* fast-forward idle wheel */
+        timer_wheel->advance(now, [](request_id_t) {});
+    }
+    auto ticks = (timeout.total_microseconds() + timer_resolution - 1) / timer_resolution;
+    auto deadline = std::max(now + static_cast<timer_wheel_t::tick_t>(ticks), timer_wheel->current() + 1);
+    handle = timer_wheel->arm(deadline, timer_id);
+    /* the backend timer is re-armed only for the earlier deadline */
+    if (!timer_wheel_timer || deadline < timer_wheel_deadline) {
+        drive_timer_wheel(now, deadline);
+    }
+}
+
+void supervisor_t::cancel_request_timer(request_id_t request_id, request_curry_t &curry) noexcept {
+    if (curry.group) {
+        /* the request has no own timer */
+        leave_request_group(curry.group);
+        curry.group = 0;
+        return;
+    }
+    cancel_request_timer(request_id, curry.timer_handle);
+}
+
+void supervisor_t::cancel_request_timer(request_id_t timer_id, timer_wheel_t::handle_t &handle) noexcept {
+    if (!timer_wheel) {
+        cancel_timer(timer_id);
+        return;
+    }
+    timer_wheel->cancel(handle, timer_id);
+    handle = timer_wheel_t::invalid_handle;
+}
+
+void supervisor_t::forget_request(request_id_t request_id) noexcept {
+    // the completed (or expired) request has no timer
+    auto curry = request_map.find(request_id);
+    if (curry) {
+        cancel_request_timer(request_id, *curry);
+        request_map.erase(request_id);
+    }
+}
+
+request_id_t supervisor_t::create_request_group(const pt::time_duration &timeout) noexcept {
+    /* the id is just reserved, i.e. it is never found among active requests */
+    auto group_id = next_request_id();
+    auto &group = request_groups[group_id];
+    start_request_timer(timeout, group_id, group.timer_handle);
+    return group_id;
+}
+
+void supervisor_t::join_request_group(request_id_t group_id, request_id_t request_id) noexcept {
+    auto &group = request_groups.at(group_id);
+    group.requests.emplace_back(request_id);
+    ++group.pending;
+}
+
+void supervisor_t::leave_request_group(request_id_t group_id) noexcept {
+    auto it = request_groups.find(group_id);
+    if (it != request_groups.end() && --it->second.pending == 0) {
+        cancel_request_timer(group_id, it->second.timer_handle);
+        request_groups.erase(it);
+        request_map.discard(group_id);
+    }
+}
+
+void supervisor_t::expire_request_group(request_groups_t::iterator it) noexcept {
+    auto group_id = it->first;
+    auto requests = std::move(it->second.requests);
+    request_groups.erase(it);
+    request_map.discard(group_id);
+    for (auto request_id : requests) {
+        /* already replied requests are not found (or have different generation) */
+        expire_request(request_id);
+    }
+}
+
+void supervisor_t::on_timer_wheel_tick() noexcept {
+    request_map.discard(timer_wheel_timer);
+    timer_wheel_timer = 0;
+    auto now = timer_wheel_now();
+    timer_wheel->advance(now, [this](request_id_t request_id) { expire_request(request_id); });
+    if (!timer_wheel->empty()) {
+        /* the empty ticks are skipped, i.e. the supervisor sleeps till the next timer */
+        auto deadline = timer_wheel->next_expiry();
+        if (!timer_wheel_timer || deadline < timer_wheel_deadline) {
+            drive_timer_wheel(now, deadline);
+        }
+    }
+}
+
+void supervisor_t::drive_timer_wheel(timer_wheel_t::tick_t now, timer_wheel_t::tick_t deadline) noexcept {
+    stop_timer_wheel();
+    /* the fresh id is used, so the late trigger of the cancelled backend timer is ignored */
+    timer_wheel_timer = next_request_id();
+    timer_wheel_deadline = deadline;
+    auto ticks = deadline > now ? deadline - now : 1;
+    start_timer(pt::microseconds{static_cast<std::int64_t>(ticks) * timer_resolution}, timer_wheel_timer);
+}
+
+void supervisor_t::stop_timer_wheel() noexcept {
+    if (timer_wheel_timer) {
+        cancel_timer(timer_wheel_timer);
+        request_map.discard(timer_wheel_timer);
+        timer_wheel_timer = 0;
+    }
+}
+
+void supervisor_t::shutdown_finish() noexcept {
+    /* nobody will resume the suspended coroutines later, so they are resumed with timeout right now;
+     * otherwise their frames (and the awaiting actors) leak */
+    std::vector<request_id_t> suspended;
+    request_map.for_each([&](request_id_t request_id, request_curry_t &curry) {
+        if (curry.continuation) {
+            suspended.emplace_back(request_id);
+        }
+    });
+    for (auto request_id : suspended) {
+        auto curry = request_map.find(request_id);
+        if (curry) {
+            cancel_request_timer(request_id, *curry);
+            expire_request(request_id);
+        }
+    }
+    stop_timer_wheel();
+    if (timer_wheel) {
+        /* the left timers belong to the requests, which will never be replied, i.e. they time out
+         * right now, as there will be no wheel driver to expire them later */
+        timer_wheel->drain([this](request_id_t request_id) { expire_request(request_id); });
     }
+    actor_base_t::shutdown_finish();
 }
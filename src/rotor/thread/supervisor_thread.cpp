@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/thread/supervisor_thread.h"
+
+using namespace rotor::thread;
+using namespace rotor;
+
+supervisor_thread_t::supervisor_thread_t(supervisor_config_thread_t &config_)
+    : supervisor_t{config_}, scheduled{false}, armed_deadline{clock_t::time_point::max()} {}
+
+address_ptr_t supervisor_thread_t::make_address() noexcept { return instantiate_address(this); }
+
+void supervisor_thread_t::start() noexcept { wake(); }
+
+void supervisor_thread_t::shutdown() noexcept {
+    auto &sup_addr = supervisor->get_address();
+    supervisor->enqueue(make_message<payload::shutdown_trigger_t>(sup_addr, address));
+}
+
+void supervisor_thread_t::enqueue(message_ptr_t message) noexcept {
+    auto leader = static_cast<supervisor_thread_t *>(locality_leader);
+    if (!admit_inbound(*message)) {
+        return;
+    }
+    if (leader->inbound.push(std::move(message))) {
+        // pairs with the fence in on_run, so either the message is seen there or the leader is re-scheduled
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        leader->wake();
+    }
+}
+
+void supervisor_thread_t::wake() noexcept {
+    if (!scheduled.exchange(true, std::memory_order_acq_rel)) {
+        get_context()->schedule(this);
+    }
+}
+
+void supervisor_thread_t::start_timer(const pt::time_duration &timeout, request_id_t timer_id) noexcept {
+    auto deadline = clock_t::now() + std::chrono::microseconds(timeout.total_microseconds());
+    auto it = deadlines.emplace(deadline, timer_id);
+    timers_map.emplace(timer_id, it);
+}
+
+void supervisor_thread_t::cancel_timer(request_id_t timer_id) noexcept {
+    auto it = timers_map.find(timer_id);
+    assert(it != timers_map.end());
+    deadlines.erase(it->second);
+    timers_map.erase(it);
+}
+
+void supervisor_thread_t::trigger_timers(clock_t::time_point now) noexcept {
+    while (!deadlines.empty() && deadlines.begin()->first <= now) {
+        auto timer_id = deadlines.begin()->second;
+        deadlines.erase(deadlines.begin());
+        timers_map.erase(timer_id);
+        on_timer_trigger(timer_id);
+    }
+}
+
+void supervisor_thread_t::on_run() noexcept {
+    drain(inbound);
+    trigger_timers(clock_t::now());
+    do_process();
+
+    // timers are touched only by the supervisor, so read them while it is still owned by this worker
+    auto deadline = deadlines.empty() ? clock_t::time_point::max() : deadlines.begin()->first;
+    if (deadline != clock_t::time_point::max()) {
+        get_context()->schedule_at(this, deadline);
+    }
+    // the processing budget is exhausted, let other supervisors of the worker run first
+    auto yielded = !queue.empty();
+
+    scheduled.store(false, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (yielded || !inbound.empty() || deadline <= clock_t::now()) {
+        wake();
+    }
+}
+
+void supervisor_thread_t::shutdown_finish() noexcept {
+    supervisor_t::shutdown_finish();
+    if (!parent) {
+        get_context()->stop();
+    }
+}
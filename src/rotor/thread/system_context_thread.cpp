@@ -0,0 +1,170 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/thread/system_context_thread.h"
+#include "rotor/thread/supervisor_thread.h"
+#include <algorithm>
+#include <thread>
+
+using namespace rotor::thread;
+
+namespace {
+/* the index of the worker, which is executed by the current thread */
+thread_local std::size_t current_worker = static_cast<std::size_t>(-1);
+
+/* there is no deadline */
+using time_point_t = system_context_thread_t::clock_t::time_point;
+constexpr auto never = time_point_t::max().time_since_epoch().count();
+} // namespace
+
+system_context_thread_t::system_context_thread_t(std::size_t workers_count)
+    : next_worker{0}, ready_count{0}, idle_count{0}, stopped{false}, nearest{never} {
+    if (!workers_count) {
+        workers_count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (std::size_t i = 0; i < workers_count; ++i) {
+        workers.emplace_back(std::make_unique<worker_t>());
+    }
+}
+
+system_context_thread_t::~system_context_thread_t() {
+    for (auto &worker : workers) {
+        worker->ready.clear();
+    }
+    deadlines.clear();
+}
+
+void system_context_thread_t::run() noexcept {
+    stopped.store(false);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < workers.size(); ++i) {
+        threads.emplace_back([this, i]() { work(i); });
+    }
+    work(0);
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+void system_context_thread_t::stop() noexcept {
+    stopped.store(true);
+    std::lock_guard<std::mutex> lock(mutex);
+    condition.notify_all();
+}
+
+void system_context_thread_t::schedule(supervisor_thread_t *leader) noexcept {
+    auto index = current_worker;
+    if (index >= workers.size()) {
+        index = next_worker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    }
+    auto &worker = *workers[index];
+    ready_count.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.ready.emplace_back(leader);
+    }
+    if (idle_count.load()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        condition.notify_one();
+    }
+}
+
+void system_context_thread_t::schedule_at(supervisor_thread_t *leader, clock_t::time_point deadline) noexcept {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (deadline < leader->armed_deadline) {
+        bool earliest = deadlines.empty() || deadline < deadlines.begin()->first;
+        leader->armed_deadline = deadline;
+        deadlines.emplace(deadline, leader);
+        update_nearest();
+        if (earliest && idle_count.load()) {
+            // let a sleeping worker re-calculate its wake up time
+            condition.notify_one();
+        }
+    }
+}
+
+rotor::thread::supervisor_ptr_t system_context_thread_t::take(std::size_t index) noexcept {
+    supervisor_ptr_t leader;
+    if (!ready_count.load()) {
+        return leader;
+    }
+    auto count = workers.size();
+    for (std::size_t i = 0; i < count && !leader; ++i) {
+        auto &worker = *workers[(index + i) % count];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.ready.empty()) {
+            if (i == 0) {
+                leader = std::move(worker.ready.front());
+                worker.ready.pop_front();
+            } else {
+                // steal from the opposite end
+                leader = std::move(worker.ready.back());
+                worker.ready.pop_back();
+            }
+        }
+    }
+    if (leader) {
+        ready_count.fetch_sub(1);
+    }
+    return leader;
+}
+
+void system_context_thread_t::expire() noexcept {
+    std::vector<supervisor_ptr_t> expired;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto now = clock_t::now();
+        while (!deadlines.empty() && deadlines.begin()->first <= now) {
+            auto &leader = deadlines.begin()->second;
+            if (leader->armed_deadline == deadlines.begin()->first) {
+                leader->armed_deadline = clock_t::time_point::max();
+            }
+            expired.emplace_back(std::move(leader));
+            deadlines.erase(deadlines.begin());
+        }
+        update_nearest();
+    }
+    for (auto &leader : expired) {
+        leader->wake();
+    }
+}
+
+void system_context_thread_t::idle() noexcept {
+    std::unique_lock<std::mutex> lock(mutex);
+    // the due deadlines are expired by the caller on the next iteration
+    auto ready = [this]() { return stopped.load() || ready_count.load(); };
+    idle_count.fetch_add(1);
+    if (deadlines.empty()) {
+        condition.wait(lock, ready);
+    } else {
+        condition.wait_until(lock, deadlines.begin()->first, ready);
+    }
+    idle_count.fetch_sub(1);
+}
+
+void system_context_thread_t::update_nearest() noexcept {
+    auto value = deadlines.empty() ? never : deadlines.begin()->first.time_since_epoch().count();
+    nearest.store(value, std::memory_order_relaxed);
+}
+
+void system_context_thread_t::work(std::size_t index) noexcept {
+    current_worker = index;
+    while (!stopped.load()) {
+        // the busy workers expire deadlines too, otherwise a locality, which keeps
+        // itself ready, would starve the timers of all other localities
+        auto deadline = nearest.load(std::memory_order_relaxed);
+        if (deadline != never && deadline <= clock_t::now().time_since_epoch().count()) {
+            expire();
+        }
+        auto leader = take(index);
+        if (leader) {
+            leader->on_run();
+        } else {
+            idle();
+        }
+    }
+    current_worker = static_cast<std::size_t>(-1);
+}
@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/timer_wheel.h"
+#include <algorithm>
+#include <limits>
+
+using namespace rotor;
+
+timer_wheel_t::timer_wheel_t(std::size_t slots_count) noexcept
+    : spare{invalid_handle}, mask{0}, count{0}, now{0} {
+    std::size_t size = 1;
+    while (size < slots_count) {
+        size <<= 1;
+    }
+    slots.resize(size, invalid_handle);
+    mask = size - 1;
+}
+
+timer_wheel_t::handle_t timer_wheel_t::arm(tick_t tick, request_id_t timer_id) noexcept {
+    handle_t handle;
+    if (spare != invalid_handle) {
+        handle = spare;
+        spare = nodes[handle].next;
+    } else {
+        handle = static_cast<handle_t>(nodes.size());
+        nodes.emplace_back();
+    }
+    auto &node = nodes[handle];
+    node.timer_id = timer_id;
+    node.expires = std::max(tick, now + 1);
+    node.armed = true;
+    link(handle);
+    ++count;
+    return handle;
+}
+
+void timer_wheel_t::cancel(handle_t handle, request_id_t timer_id) noexcept {
+    if (handle >= nodes.size()) {
+        return;
+    }
+    auto &node = nodes[handle];
+    if (!node.armed || node.timer_id != timer_id) {
+        return;
+    }
+    unlink(handle);
+    release(handle);
+}
+
+void timer_wheel_t::clear() noexcept {
+    nodes.clear();
+    expired.clear();
+    std::fill(slots.begin(), slots.end(), invalid_handle);
+    spare = invalid_handle;
+    count = 0;
+}
+
+void timer_wheel_t::collect(tick_t tick) noexcept {
+    if (tick <= now) {
+        return;
+    }
+    if (!count) {
+        now = tick;
+        return;
+    }
+    // there is no need to visit the same slot twice
+    auto steps = std::min<tick_t>(tick - now, slots.size());
+    for (tick_t i = 1; i <= steps; ++i) {
+        auto handle = slots[(now + i) & mask];
+        while (handle != invalid_handle) {
+            auto &node = nodes[handle];
+            auto next = node.next;
+            if (node.expires <= tick) {
+                expired.emplace_back(node.timer_id);
+                unlink(handle);
+                release(handle);
+            }
+            handle = next;
+        }
+    }
+    now = tick;
+}
+
+timer_wheel_t::tick_t timer_wheel_t::next_expiry() const noexcept {
+    // the timers of the current revolution are met in the slots order
+    for (tick_t tick = now + 1; tick <= now + slots.size(); ++tick) {
+        for (auto handle = slots[tick & mask]; handle != invalid_handle; handle = nodes[handle].next) {
+            if (nodes[handle].expires <= tick) {
+                return nodes[handle].expires;
+            }
+        }
+    }
+    // all timers are beyond the revolution
+    auto earliest = std::numeric_limits<tick_t>::max();
+    for (auto &node : nodes) {
+        if (node.armed) {
+            earliest = std::min(earliest, node.expires);
+        }
+    }
+    return earliest;
+}
+
+void timer_wheel_t::link(handle_t handle) noexcept {
+    auto &node = nodes[handle];
+    auto &head = slots[node.expires & mask];
+    node.prev = invalid_handle;
+    node.next = head;
+    if (head != invalid_handle) {
+        nodes[head].prev = handle;
+    }
+    head = handle;
+}
+
+void timer_wheel_t::unlink(handle_t handle) noexcept {
+    auto &node = nodes[handle];
+    if (node.prev != invalid_handle) {
+        nodes[node.prev].next = node.next;
+    } else {
+        slots[node.expires & mask] = node.next;
+    }
+    if (node.next != invalid_handle) {
+        nodes[node.next].prev = node.prev;
+    }
+}
+
+void timer_wheel_t::release(handle_t handle) noexcept {
+    auto &node = nodes[handle];
+    node.armed = false;
+    node.prev = invalid_handle;
+    node.next = spare;
+    spare = handle;
+    --count;
+}
@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "rotor/transport_base.h"
+#include "rotor/plugin/starter.h"
+#include <algorithm>
+
+using namespace rotor;
+
+transport_base_t::transport_base_t(config_t &config)
+    : actor_base_t{config},
+      pending_timeout{std::chrono::microseconds{config.pending_timeout.total_microseconds()}} {}
+
+void transport_base_t::export_address(std::uint64_t id, const address_ptr_t &addr) noexcept { exported[id] = addr; }
+
+address_ptr_t transport_base_t::import_address(std::uint64_t id) noexcept {
+    auto it = imported.find(id);
+    if (it != imported.end()) {
+        return it->second;
+    }
+    auto addr = supervisor->make_address();
+    imported.emplace(id, addr);
+    return addr;
+}
+
+void transport_base_t::configure(plugin::plugin_base_t &plugin) noexcept {
+    actor_base_t::configure(plugin);
+    plugin.with_casted<plugin::starter_plugin_t>(
+        [](auto &p) { p.subscribe_actor(&transport_base_t::on_expiry_timeout); });
+}
+
+void transport_base_t::shutdown_finish() noexcept {
+    if (expiry_request) {
+        supervisor->forget_request(*expiry_request);
+        expiry_request.reset();
+    }
+    pending.clear();
+    exported.clear();
+    imported.clear();
+    actor_base_t::shutdown_finish();
+}
+
+const address_ptr_t *transport_base_t::find_export(std::uint64_t id) const noexcept {
+    auto it = exported.find(id);
+    return it != exported.end() ? &it->second : nullptr;
+}
+
+void transport_base_t::remember(std::uint64_t sequence, message_ptr_t message, failer_t fail,
+                                const address_ptr_t &origin) noexcept {
+    auto now = clock_t::now();
+    expire_pending(now);
+    pending.emplace(sequence, pending_request_t{std::move(message), fail, origin, now + pending_timeout});
+    retain(origin);
+    schedule_expiry(pending.begin()->second.deadline);
+}
+
+void transport_base_t::expire_pending(clock_t::time_point now) noexcept {
+    // the sequence grows monotonically, i.e. the expired requests are at the beginning
+    while (!pending.empty() && pending.begin()->second.deadline <= now) {
+        auto expired = std::move(pending.begin()->second);
+        pending.erase(pending.begin());
+        release(expired.origin);
+    }
+}
+
+void transport_base_t::schedule_expiry(clock_t::time_point deadline) noexcept {
+    if (expiry_request) {
+        if (expiry_deadline <= deadline) {
+            return;
+        }
+        supervisor->forget_request(*expiry_request);
+    }
+    using namespace std::chrono;
+    auto timeout = std::max<std::int64_t>(duration_cast<microseconds>(deadline - clock_t::now()).count(), 0);
+    expiry_deadline = deadline;
+    // nobody is subscribed to the request, i.e. it always times out
+    expiry_request = request<expiry_request_t>(address).send(pt::microseconds{timeout});
+}
+
+void transport_base_t::on_expiry() noexcept {
+    expire_pending(clock_t::now());
+    if (!pending.empty()) {
+        schedule_expiry(pending.begin()->second.deadline);
+    }
+}
+
+void transport_base_t::on_expiry_timeout(expiry_response_t &message) noexcept {
+    if (!expiry_request || *expiry_request != message.payload.req->payload.id) {
+        return;
+    }
+    expiry_request.reset();
+    on_expiry();
+}
+
+void transport_base_t::fail_pending(const std::error_code &ec) noexcept {
+    for (auto &it : pending) {
+        auto &request = it.second;
+        request.fail(*this, *request.message, ec);
+    }
+    pending.clear();
+}
+
+void transport_base_t::retain(const address_ptr_t &) noexcept {}
+
+void transport_base_t::release(const address_ptr_t &) noexcept {}
@@ -35,10 +35,13 @@ void supervisor_wx_t::shutdown() noexcept {
 }
 
 void supervisor_wx_t::enqueue(message_ptr_t message) noexcept {
+    if (!admit_inbound(*message)) {
+        return;
+    }
     supervisor_ptr_t self{this};
     handler->CallAfter([self = std::move(self), message = std::move(message)]() {
         auto &sup = *self;
-        sup.put(std::move(message));
+        sup.put_inbound(std::move(message));
         sup.do_process();
     });
 }
@@ -250,12 +250,8 @@ TEST_CASE("start/shutdown 1 child & 1 supervisor", "[supervisor]") {
     auto sup = system_context->create_supervisor<sample_sup2_t>().timeout(rt::default_timeout).finish();
     auto act = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
 
-    /* for better coverage */
-    auto &last = sup->access<rt::to::last_req_id>();
-    sup->access<rt::to::request_map>()[last + 1] = r::request_curry_t();
     sup->do_process();
-
-    CHECK(sup->access<rt::to::last_req_id>() > 1);
+    CHECK(sup->access<rt::to::request_map>().empty());
 
     CHECK(sup->get_state() == r::state_t::OPERATIONAL);
     CHECK(act->access<rt::to::state>() == r::state_t::OPERATIONAL);
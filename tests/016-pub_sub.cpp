@@ -77,6 +77,12 @@ TEST_CASE("ping-pong", "[supervisor]") {
     REQUIRE(sub1->received == 1);
     REQUIRE(sub2->received == 1);
 
+    r::message_t<payload_t> probe(pub_addr);
+    auto recipients = sup->get_subscription().get_recipients(probe);
+    REQUIRE(recipients);
+    CHECK(recipients->internal.size() == 2);
+    CHECK(!recipients->direct_call);
+
     sup->do_shutdown();
     sup->do_process();
     REQUIRE(sup->get_state() == r::state_t::SHUT_DOWN);
@@ -84,3 +90,172 @@ TEST_CASE("ping-pong", "[supervisor]") {
     REQUIRE(sup->get_points().size() == 0);
     CHECK(rt::empty(sup->get_subscription()));
 }
+
+struct multi_sub_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        for (auto &addr : addresses) {
+            infos.emplace_back(subscribe(&multi_sub_t::on_payload, addr));
+        }
+    }
+
+    void drop(std::size_t index) noexcept { lifetime->unsubscribe(infos[index]); }
+
+    void on_payload(r::message_t<payload_t> &) noexcept { ++received; }
+
+    std::vector<r::address_ptr_t> addresses;
+    std::vector<r::subscription_info_ptr_t> infos;
+    std::size_t received = 0;
+};
+
+TEST_CASE("many addresses", "[supervisor]") {
+    constexpr std::size_t count = 257;
+    r::system_context_t system_context;
+
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    std::vector<r::address_ptr_t> addresses;
+    for (std::size_t i = 0; i < count; ++i) {
+        addresses.emplace_back(sup->create_address());
+    }
+    auto act = sup->create_actor<multi_sub_t>().timeout(rt::default_timeout).finish();
+    act->addresses = addresses;
+    sup->do_process();
+    REQUIRE(act->access<rt::to::state>() == r::state_t::OPERATIONAL);
+
+    for (auto &addr : addresses) {
+        sup->send<payload_t>(addr);
+    }
+    sup->do_process();
+    CHECK(act->received == count);
+
+    r::message_t<payload_t> probe(addresses[0]);
+    auto recipients = sup->get_subscription().get_recipients(probe);
+    REQUIRE(recipients);
+    CHECK(recipients->direct_call);
+    CHECK(recipients->direct_handler == recipients->internal.front());
+
+    for (std::size_t i = 0; i < count; i += 2) {
+        act->drop(i);
+    }
+    sup->do_process();
+
+    act->received = 0;
+    for (auto &addr : addresses) {
+        sup->send<payload_t>(addr);
+    }
+    sup->do_process();
+    CHECK(act->received == count / 2);
+
+    sup->do_shutdown();
+    sup->do_process();
+    REQUIRE(sup->get_state() == r::state_t::SHUT_DOWN);
+    REQUIRE(sup->get_leader_queue().size() == 0);
+    CHECK(rt::empty(sup->get_subscription()));
+}
+
+TEST_CASE("fan-out to external supervisors", "[supervisor]") {
+    r::system_context_t system_context;
+
+    const char locality1[] = "abc";
+    const char locality2[] = "def";
+    const char locality3[] = "ghi";
+    auto sup1 = system_context.create_supervisor<rt::supervisor_test_t>()
+                    .locality(locality1)
+                    .timeout(rt::default_timeout)
+                    .finish();
+    auto sup2 = sup1->create_actor<rt::supervisor_test_t>().locality(locality2).timeout(rt::default_timeout).finish();
+    auto sup3 = sup1->create_actor<rt::supervisor_test_t>().locality(locality3).timeout(rt::default_timeout).finish();
+    auto pub_addr = sup1->create_address();
+
+    auto process = [&]() {
+        for (int i = 0; i < 5; ++i) {
+            sup1->do_process();
+            sup2->do_process();
+            sup3->do_process();
+        }
+    };
+    process();
+
+    auto sub1 = sup2->create_actor<sub_t>().timeout(rt::default_timeout).pub_addr(pub_addr).finish();
+    auto sub2 = sup3->create_actor<sub_t>().timeout(rt::default_timeout).pub_addr(pub_addr).finish();
+    auto sub3 = sup2->create_actor<sub_t>().timeout(rt::default_timeout).pub_addr(pub_addr).finish();
+    process();
+    REQUIRE(sub1->access<rt::to::state>() == r::state_t::OPERATIONAL);
+    REQUIRE(sub2->access<rt::to::state>() == r::state_t::OPERATIONAL);
+    REQUIRE(sub3->access<rt::to::state>() == r::state_t::OPERATIONAL);
+
+    sup1->send<payload_t>(pub_addr);
+    sup1->do_process();
+
+    // a single call envelope per supervisor
+    REQUIRE(sup2->get_leader_queue().size() == 1);
+    REQUIRE(sup3->get_leader_queue().size() == 1);
+    auto call = dynamic_cast<r::message::handler_call_t *>(sup2->get_leader_queue().front().get());
+    REQUIRE(call);
+    CHECK(call->payload.handlers.size() == 2);
+    // the test backend does not mark messages as shared, rotor does
+    CHECK(call->is_shared());
+    CHECK(call->payload.orig_message->is_shared());
+
+    process();
+    CHECK(sub1->received == 1);
+    CHECK(sub2->received == 1);
+    CHECK(sub3->received == 1);
+
+    sup1->send<payload_t>(sub2->get_address());
+    sup1->do_process();
+    REQUIRE(sup3->get_leader_queue().size() == 1);
+    CHECK(sup3->get_leader_queue().front()->is_shared());
+
+    sup1->do_shutdown();
+    process();
+    CHECK(sup1->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(sup2->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(sup3->get_state() == r::state_t::SHUT_DOWN);
+}
+
+TEST_CASE("actor's own subscription to external address", "[supervisor]") {
+    r::system_context_t system_context;
+
+    const char locality1[] = "abc";
+    const char locality2[] = "def";
+    auto sup1 = system_context.create_supervisor<rt::supervisor_test_t>()
+                    .locality(locality1)
+                    .timeout(rt::default_timeout)
+                    .finish();
+    auto sup2 = sup1->create_actor<rt::supervisor_test_t>().locality(locality2).timeout(rt::default_timeout).finish();
+    auto process = [&]() {
+        while (!sup1->get_leader_queue().empty() || !sup2->get_leader_queue().empty()) {
+            sup1->do_process();
+            sup2->do_process();
+        }
+    };
+
+    auto act = sup2->create_actor<multi_sub_t>().timeout(rt::default_timeout).finish();
+    act->addresses = {sup1->create_address(), sup1->create_address()};
+    process();
+    REQUIRE(act->access<rt::to::state>() == r::state_t::OPERATIONAL);
+
+    // the foreign supervisor is notified on the unsubscription
+    act->drop(0);
+    process();
+    r::message_t<payload_t> probe(act->addresses[0]);
+    CHECK(!sup1->get_subscription().get_recipients(probe));
+
+    sup1->send<payload_t>(act->addresses[0]);
+    sup1->send<payload_t>(act->addresses[1]);
+    process();
+    CHECK(act->received == 1);
+
+    sup2->do_shutdown();
+    process();
+    CHECK(sup2->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(rt::empty(sup2->get_subscription()));
+
+    sup1->do_shutdown();
+    process();
+    CHECK(sup1->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(rt::empty(sup1->get_subscription()));
+}
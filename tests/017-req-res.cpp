@@ -647,3 +647,80 @@ TEST_CASE("intrusive pointer request/responce", "[actor]") {
     REQUIRE(sup->get_requests().size() == 0);
     REQUIRE(sup->active_timers.size() == 0);
 }
+
+TEST_CASE("request map: stale ids and reservations", "[supervisor]") {
+    r::request_map_t map;
+
+    auto id_1 = map.reserve();
+    CHECK(id_1 != 0);
+    CHECK(map.empty());
+    CHECK(map.find(id_1) == nullptr);
+
+    map.emplace(id_1, r::request_curry_t{});
+    CHECK(map.size() == 1);
+    CHECK(map.find(id_1) != nullptr);
+    map.erase(id_1);
+    CHECK(map.empty());
+
+    /* slot is reused, but the late response to the 1st request is rejected */
+    auto id_2 = map.reserve();
+    CHECK(id_2 != id_1);
+    map.emplace(id_2, r::request_curry_t{});
+    CHECK(map.find(id_1) == nullptr);
+    CHECK(map.find(id_2) != nullptr);
+
+    /* discard does not touch active requests */
+    map.discard(id_2);
+    CHECK(map.find(id_2) != nullptr);
+
+    /* reserved, but not sent request frees slot */
+    auto id_3 = map.reserve();
+    map.discard(id_3);
+    auto id_4 = map.reserve();
+    CHECK(id_4 != id_3);
+    CHECK(map.find(id_3) == nullptr);
+    CHECK(map.size() == 1);
+    map.discard(id_4);
+
+    map.erase(id_2);
+    CHECK(map.empty());
+    CHECK(map.find(0) == nullptr);
+    CHECK(map.find(~r::request_id_t{0}) == nullptr);
+}
+
+TEST_CASE("reply addresses are shared by actors and pre-warmed", "[supervisor]") {
+    r::system_context_t system_context;
+
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto &mapping = sup->access<rt::to::address_mapping>();
+    using shutdown_traits_t = r::request_traits_t<r::payload::shutdown_request_t>;
+    auto shutdown_addr = mapping.get_mapped_address(*sup, shutdown_traits_t::response::message_t::message_type);
+    CHECK(shutdown_addr);
+    CHECK(shutdown_addr == sup->reply_address<r::payload::shutdown_request_t>());
+
+    auto act1 = sup->create_actor<good_actor_t>().timeout(rt::default_timeout).finish();
+    auto act2 = sup->create_actor<good_actor_t>().timeout(rt::default_timeout).finish();
+    sup->do_process();
+
+    REQUIRE(act1->res_val == 5);
+    REQUIRE(act2->res_val == 5);
+    CHECK(!mapping.has_subscriptions(*act1));
+    CHECK(!mapping.has_subscriptions(*act2));
+    auto reply_addr = sup->reply_address<request_sample_t>();
+    CHECK(reply_addr == mapping.get_mapped_address(*sup, traits_t::response::message_t::message_type));
+
+    /* the reply address survives child actor shutdown */
+    act1->do_shutdown();
+    sup->do_process();
+    CHECK(act1->access<rt::to::state>() == r::state_t::SHUT_DOWN);
+    CHECK(reply_addr == sup->reply_address<request_sample_t>());
+
+    sup->do_shutdown();
+    sup->do_process();
+
+    REQUIRE(sup->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(mapping.empty());
+    CHECK(rt::empty(sup->get_subscription()));
+    REQUIRE(sup->get_requests().size() == 0);
+    REQUIRE(sup->active_timers.size() == 0);
+}
@@ -0,0 +1,152 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "rotor/inbound_queue.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace r = rotor;
+
+struct sample_t {
+    std::size_t producer;
+    std::size_t seq;
+};
+
+using sample_msg_t = r::message_t<sample_t>;
+
+struct envelope_t {
+    std::string tag;
+    r::message_ptr_t inner;
+};
+
+struct opaque_envelope_t {
+    opaque_envelope_t(r::message_ptr_t inner_) : inner{std::move(inner_)} {}
+    r::message_ptr_t inner;
+};
+
+namespace rotor {
+template <> struct payload_sharing_t<envelope_t> {
+    static void share(envelope_t &payload) noexcept { payload.inner->share(); }
+};
+} // namespace rotor
+
+static_assert(r::payload_references_messages_v<envelope_t>, "message member is detected");
+static_assert(!r::payload_references_messages_v<sample_t>, "no message members");
+static_assert(!r::payload_references_messages_v<opaque_envelope_t>, "non-aggregates are not inspected");
+
+TEST_CASE("single thread push & drain", "[inbound_queue]") {
+    r::inbound_queue_t queue;
+    r::messages_queue_t target;
+    REQUIRE(queue.empty());
+
+    CHECK(queue.push(r::make_message<sample_t>(nullptr, 0u, 1u)));
+    CHECK(!queue.push(r::make_message<sample_t>(nullptr, 0u, 2u)));
+    CHECK(!queue.push(r::make_message<sample_t>(nullptr, 0u, 3u)));
+    REQUIRE(!queue.empty());
+
+    REQUIRE(queue.drain(target) == 3);
+    REQUIRE(queue.empty());
+    REQUIRE(target.size() == 3);
+    for (std::size_t i = 1; i <= 3; ++i) {
+        auto &msg = static_cast<sample_msg_t &>(*target.front());
+        CHECK(msg.payload.seq == i);
+        CHECK(msg.use_count() == 1);
+        target.pop_front();
+    }
+
+    SECTION("queue is reusable after drain") {
+        CHECK(queue.push(r::make_message<sample_t>(nullptr, 0u, 4u)));
+        REQUIRE(queue.drain(target) == 1);
+        REQUIRE(queue.drain(target) == 0);
+    }
+}
+
+TEST_CASE("not drained messages are released", "[inbound_queue]") {
+    auto msg = r::message_ptr_t(new sample_msg_t(nullptr, 0u, 0u));
+    {
+        r::inbound_queue_t queue;
+        queue.push(msg);
+        CHECK(msg->use_count() == 2);
+    }
+    CHECK(msg->use_count() == 1);
+}
+
+TEST_CASE("multiple producers", "[inbound_queue]") {
+    constexpr std::size_t producers = 4;
+    constexpr std::size_t count = 10000;
+    r::inbound_queue_t queue;
+    r::messages_queue_t target;
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < producers; ++i) {
+        threads.emplace_back([&queue, i]() {
+            for (std::size_t j = 0; j < count; ++j) {
+                queue.push(r::make_message<sample_t>(nullptr, i, j));
+            }
+        });
+    }
+
+    std::vector<std::size_t> next(producers, 0);
+    std::size_t received = 0;
+    bool ordered = true;
+    while (received < producers * count) {
+        queue.drain(target);
+        while (!target.empty()) {
+            auto &msg = static_cast<sample_msg_t &>(*target.front());
+            auto &expected = next[msg.payload.producer];
+            ordered = ordered && (msg.payload.seq == expected);
+            ++expected;
+            ++received;
+            target.pop_front();
+        }
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    CHECK(ordered);
+    CHECK(received == producers * count);
+    CHECK(queue.empty());
+}
+
+TEST_CASE("pushed messages are shared", "[inbound_queue]") {
+    r::inbound_queue_t queue;
+    r::messages_queue_t target;
+    auto msg = r::make_message<sample_t>(nullptr, 0u, 0u);
+    auto copy = msg;
+    CHECK(!msg->is_shared());
+    CHECK(msg->use_count() == 2);
+
+    auto call = r::make_message<r::payload::handler_call_t>(nullptr, msg);
+    CHECK(msg->use_count() == 3);
+    queue.push(call);
+    CHECK(call->is_shared());
+    CHECK(msg->is_shared());
+
+    queue.drain(target);
+    target.clear();
+    call.reset();
+    copy.reset();
+    CHECK(msg->use_count() == 1);
+}
+
+TEST_CASE("messages, referenced by custom payload, are shared", "[inbound_queue]") {
+    r::inbound_queue_t queue;
+    r::messages_queue_t target;
+    auto msg = r::make_message<sample_t>(nullptr, 0u, 0u);
+    auto envelope = r::make_message<envelope_t>(nullptr, "tag", msg);
+    queue.push(envelope);
+    CHECK(envelope->is_shared());
+    CHECK(msg->is_shared());
+
+    queue.drain(target);
+    target.clear();
+    envelope.reset();
+    CHECK(msg->use_count() == 1);
+}
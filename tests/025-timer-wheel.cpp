@@ -0,0 +1,324 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "rotor/timer_wheel.h"
+#include "supervisor_test.h"
+#include "access.h"
+#include <thread>
+
+namespace r = rotor;
+namespace rt = r::test;
+
+struct response_sample_t {
+    int value;
+};
+
+struct request_sample_t {
+    using response_t = response_sample_t;
+    int value;
+};
+
+using traits_t = r::request_traits_t<request_sample_t>;
+
+struct sample_actor_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    bool reply = true;
+    int res_val = 0;
+    std::error_code ec;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) {
+            p.subscribe_actor(&sample_actor_t::on_request);
+            p.subscribe_actor(&sample_actor_t::on_response);
+        });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        request<request_sample_t>(address, 4).send(rt::default_timeout);
+    }
+
+    void on_request(traits_t::request::message_t &msg) noexcept {
+        if (reply) {
+            reply_to(msg, 5);
+        }
+    }
+
+    void on_response(traits_t::response::message_t &msg) noexcept {
+        ec = msg.payload.ec;
+        if (!ec) {
+            res_val = msg.payload.res.value;
+        }
+    }
+};
+
+TEST_CASE("timer wheel", "[timer_wheel]") {
+    using handles_t = std::vector<r::request_id_t>;
+    r::timer_wheel_t wheel(8);
+    handles_t fired;
+    auto collect = [&](r::request_id_t timer_id) { fired.emplace_back(timer_id); };
+
+    REQUIRE(wheel.empty());
+    wheel.arm(3, 10);
+    auto h2 = wheel.arm(5, 20);
+    wheel.arm(5, 21);
+    wheel.arm(5 + 8, 30); /* next revolution, same slot */
+    REQUIRE(wheel.size() == 4);
+
+    SECTION("expiration in order") {
+        wheel.advance(2, collect);
+        CHECK(fired.empty());
+
+        wheel.advance(4, collect);
+        CHECK(fired == handles_t{10});
+
+        fired.clear();
+        wheel.advance(5, collect);
+        std::sort(fired.begin(), fired.end());
+        CHECK(fired == handles_t{20, 21});
+        CHECK(wheel.size() == 1);
+
+        fired.clear();
+        wheel.advance(100, collect);
+        CHECK(fired == handles_t{30});
+        CHECK(wheel.empty());
+        CHECK(wheel.current() == 100);
+    }
+
+    SECTION("cancellation") {
+        wheel.cancel(h2, 20);
+        CHECK(wheel.size() == 3);
+        wheel.advance(5, collect);
+        CHECK(fired == handles_t{10, 21});
+    }
+
+    SECTION("stale handle does not cancel recycled timer") {
+        wheel.advance(5, collect);
+        auto h = wheel.arm(7, 40);
+        CHECK(h == h2);
+        wheel.cancel(h2, 20);
+        CHECK(wheel.size() == 2);
+        wheel.cancel(h, 40);
+        CHECK(wheel.size() == 1);
+    }
+
+    SECTION("arming in the past expires on the next tick") {
+        wheel.advance(4, collect);
+        fired.clear();
+        wheel.arm(1, 50);
+        wheel.advance(5, collect);
+        std::sort(fired.begin(), fired.end());
+        CHECK(fired == handles_t{20, 21, 50});
+    }
+
+    SECTION("drain") {
+        wheel.cancel(h2, 20);
+        wheel.drain(collect);
+        CHECK(wheel.empty());
+        std::sort(fired.begin(), fired.end());
+        CHECK(fired == handles_t{10, 21, 30});
+        fired.clear();
+        wheel.advance(100, collect);
+        CHECK(fired.empty());
+    }
+
+    SECTION("clear") {
+        wheel.clear();
+        CHECK(wheel.empty());
+        wheel.advance(100, collect);
+        CHECK(fired.empty());
+        auto h = wheel.arm(101, 60);
+        CHECK(h == 0);
+        wheel.advance(101, collect);
+        CHECK(fired == handles_t{60});
+    }
+}
+
+TEST_CASE("timer wheel next expiry", "[timer_wheel]") {
+    r::timer_wheel_t wheel(8);
+    wheel.arm(5 + 8, 30);
+    CHECK(wheel.next_expiry() == 13);
+
+    auto h = wheel.arm(7, 20);
+    CHECK(wheel.next_expiry() == 7);
+
+    wheel.arm(6 + 16, 40);
+    CHECK(wheel.next_expiry() == 7);
+
+    wheel.cancel(h, 20);
+    CHECK(wheel.next_expiry() == 13);
+
+    wheel.advance(13, [](r::request_id_t) {});
+    CHECK(wheel.next_expiry() == 22);
+}
+
+/* remembers the timeout of the last started backend timer */
+struct supervisor_timeouts_t : public rt::supervisor_test_t {
+    using rt::supervisor_test_t::supervisor_test_t;
+
+    void start_timer(const r::pt::time_duration &timeout, r::request_id_t timer_id) noexcept override {
+        last_timeout = timeout;
+        rt::supervisor_test_t::start_timer(timeout, timer_id);
+    }
+
+    r::pt::time_duration last_timeout;
+};
+
+TEST_CASE("timer wheel driver sleeps till the earliest deadline", "[timer_wheel]") {
+    r::system_context_t system_context;
+
+    auto sup = system_context.create_supervisor<supervisor_timeouts_t>()
+                   .timeout(rt::default_timeout)
+                   .timer_resolution(r::pt::milliseconds{1})
+                   .finish();
+    auto actor = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    sup->do_process();
+    REQUIRE(actor->res_val == 5);
+    REQUIRE(sup->active_timers.size() == 1);
+    sup->on_timer_trigger(sup->get_timer(0));
+    sup->active_timers.clear();
+    REQUIRE(sup->get_requests().size() == 0);
+
+    actor->reply = false;
+    auto &address = actor->get_address();
+    actor->request<request_sample_t>(address, 1).send(r::pt::seconds{30});
+    sup->do_process();
+    REQUIRE(sup->active_timers.size() == 1);
+    auto driver = sup->get_timer(0);
+    /* not a single resolution tick, but the whole timeout */
+    CHECK(sup->last_timeout >= r::pt::seconds{29});
+
+    /* the later deadline does not touch the backend timer */
+    actor->request<request_sample_t>(address, 2).send(r::pt::seconds{60});
+    sup->do_process();
+    REQUIRE(sup->active_timers.size() == 1);
+    CHECK(sup->get_timer(0) == driver);
+
+    /* the earlier deadline re-arms it */
+    actor->request<request_sample_t>(address, 3).send(r::pt::milliseconds{10});
+    sup->do_process();
+    REQUIRE(sup->active_timers.size() == 1);
+    CHECK(sup->get_timer(0) != driver);
+    CHECK(sup->last_timeout <= r::pt::milliseconds{11});
+
+    /* the late trigger of the cancelled backend timer is ignored */
+    sup->on_timer_trigger(driver);
+    CHECK(sup->get_requests().size() == 3);
+
+    /* the earliest request expires, the driver sleeps till the next one */
+    std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    driver = sup->get_timer(0);
+    sup->active_timers.clear();
+    sup->on_timer_trigger(driver);
+    sup->do_process();
+    CHECK(actor->ec == r::error_code_t::request_timeout);
+    CHECK(sup->get_requests().size() == 2);
+    REQUIRE(sup->active_timers.size() == 1);
+    CHECK(sup->last_timeout >= r::pt::seconds{29});
+
+    sup->do_shutdown();
+    sup->do_process();
+    REQUIRE(sup->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(sup->active_timers.size() == 0);
+    CHECK(sup->get_requests().empty());
+}
+
+TEST_CASE("request response via timer wheel", "[timer_wheel]") {
+    r::system_context_t system_context;
+
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>()
+                   .timeout(rt::default_timeout)
+                   .timer_resolution(r::pt::milliseconds{1})
+                   .finish();
+    auto actor = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    sup->do_process();
+
+    REQUIRE(actor->res_val == 5);
+    REQUIRE(!actor->ec);
+    /* the only backend timer is the wheel driver */
+    REQUIRE(sup->active_timers.size() == 1);
+    auto driver = sup->get_timer(0);
+    CHECK(sup->get_requests().size() == 0);
+
+    /* no more timers, the driver is not restarted */
+    sup->active_timers.clear();
+    sup->on_timer_trigger(driver);
+    CHECK(sup->active_timers.size() == 0);
+
+    sup->do_shutdown();
+    sup->do_process();
+    REQUIRE(sup->get_state() == r::state_t::SHUT_DOWN);
+    REQUIRE(sup->get_leader_queue().size() == 0);
+    CHECK(rt::empty(sup->get_subscription()));
+    REQUIRE(sup->get_requests().size() == 0);
+    REQUIRE(sup->active_timers.size() == 0);
+}
+
+TEST_CASE("request timeout via timer wheel", "[timer_wheel]") {
+    r::system_context_t system_context;
+
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>()
+                   .timeout(rt::default_timeout)
+                   .timer_resolution(r::pt::milliseconds{1})
+                   .finish();
+    auto actor = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    actor->reply = false;
+    sup->do_process();
+
+    REQUIRE(!actor->ec);
+    REQUIRE(sup->active_timers.size() == 1);
+    REQUIRE(sup->get_requests().size() == 1);
+
+    /* premature tick: nothing expires, the driver is restarted */
+    auto driver = sup->get_timer(0);
+    sup->active_timers.clear();
+    sup->on_timer_trigger(driver);
+    sup->do_process();
+    if (sup->get_requests().size() == 1) {
+        CHECK(!actor->ec);
+        REQUIRE(sup->active_timers.size() == 1);
+        driver = sup->get_timer(0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        sup->active_timers.clear();
+        sup->on_timer_trigger(driver);
+        sup->do_process();
+    }
+
+    REQUIRE(actor->ec == r::error_code_t::request_timeout);
+    CHECK(sup->get_requests().size() == 0);
+    CHECK(sup->active_timers.size() == 0);
+
+    sup->do_shutdown();
+    sup->do_process();
+    REQUIRE(sup->get_state() == r::state_t::SHUT_DOWN);
+    REQUIRE(sup->get_requests().size() == 0);
+}
+
+TEST_CASE("shutdown with armed timer wheel", "[timer_wheel]") {
+    r::system_context_t system_context;
+
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>()
+                   .timeout(rt::default_timeout)
+                   .timer_resolution(r::pt::milliseconds{1})
+                   .finish();
+    auto actor = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    actor->reply = false;
+    sup->do_process();
+
+    REQUIRE(sup->get_requests().size() == 1);
+    REQUIRE(sup->active_timers.size() == 1);
+
+    /* the request is still pending, but the wheel driver should not outlive the supervisor */
+    sup->do_shutdown();
+    sup->do_process();
+    REQUIRE(sup->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(sup->active_timers.size() == 0);
+    /* the request has timed out, as it would with the backend timer */
+    CHECK(sup->get_requests().empty());
+}
@@ -0,0 +1,175 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "supervisor_test.h"
+#include "actor_test.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace r = rotor;
+namespace rt = rotor::test;
+
+namespace payload {
+struct sample_t {};
+} // namespace payload
+
+namespace message {
+using sample_t = r::message_t<payload::sample_t>;
+}
+
+struct metered_sup_t : public rt::supervisor_test_t {
+    using plugins_list_t =
+        std::tuple<r::plugin::address_maker_plugin_t, r::plugin::locality_plugin_t,
+                   r::plugin::delivery_plugin_t<r::plugin::metered_local_delivery_t>, r::plugin::lifetime_plugin_t,
+                   r::plugin::init_shutdown_plugin_t, r::plugin::foreigners_support_plugin_t,
+                   r::plugin::child_manager_plugin_t, r::plugin::link_server_plugin_t,
+                   r::plugin::link_client_plugin_t, r::plugin::registry_plugin_t, r::plugin::starter_plugin_t>;
+    using rt::supervisor_test_t::supervisor_test_t;
+};
+
+struct receiver_t : public rt::actor_test_t {
+    using rt::actor_test_t::actor_test_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        rt::actor_test_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&receiver_t::on_sample); });
+    }
+
+    void on_sample(message::sample_t &) noexcept { ++received; }
+
+    std::size_t received = 0;
+};
+
+TEST_CASE("histogram", "[delivery_meter]") {
+    using histogram_t = r::histogram_t;
+    CHECK(histogram_t::bucket_of(0) == 0);
+    CHECK(histogram_t::bucket_of(1) == 1);
+    CHECK(histogram_t::bucket_of(2) == 2);
+    CHECK(histogram_t::bucket_of(3) == 2);
+    CHECK(histogram_t::bucket_of(1024) == 11);
+    CHECK(histogram_t::bucket_of(std::uint64_t(-1)) == histogram_t::buckets_count - 1);
+
+    histogram_t h;
+    CHECK(h.percentile(0.5) == 0);
+    h.buckets[histogram_t::bucket_of(100)] += 9;
+    h.buckets[histogram_t::bucket_of(5000)] += 1;
+    CHECK(h.count() == 10);
+    CHECK(h.percentile(0.5) == 127);
+    CHECK(h.percentile(0.99) == 8191);
+}
+
+TEST_CASE("metered delivery", "[delivery_meter]") {
+    r::delivery_meter_t::reset();
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<metered_sup_t>().timeout(rt::default_timeout).finish();
+    auto act = sup->create_actor<receiver_t>().timeout(rt::default_timeout).finish();
+    sup->do_process();
+    REQUIRE(act->get_state() == r::state_t::OPERATIONAL);
+
+    SECTION("disabled") {
+        sup->send<payload::sample_t>(act->get_address());
+        sup->do_process();
+        CHECK(act->received == 1);
+        auto snapshot = r::delivery_meter_t::snapshot();
+        CHECK(snapshot.by_type[message::sample_t::message_type].count == 0);
+        CHECK(snapshot.by_actor[act.get()].count == 0);
+    }
+
+    SECTION("enabled") {
+        r::delivery_meter_t::enable(true);
+        for (int i = 0; i < 3; ++i) {
+            sup->send<payload::sample_t>(act->get_address());
+        }
+        sup->do_process();
+        r::delivery_meter_t::enable(false);
+        CHECK(act->received == 3);
+
+        auto snapshot = r::delivery_meter_t::snapshot();
+        auto &by_type = snapshot.by_type[message::sample_t::message_type];
+        CHECK(by_type.count == 3);
+        CHECK(by_type.handler_time.count() == 3);
+        CHECK(by_type.queue_wait.count() == 3);
+        CHECK(snapshot.by_actor[act.get()].count == 3);
+        CHECK(snapshot.by_actor[act.get()].queue_wait.count() == 3);
+
+        /* statistics of other threads are summed up */
+        std::thread([&]() { r::delivery_meter_t::record_handler(act.get(), 10, 0, false); }).join();
+        snapshot = r::delivery_meter_t::snapshot();
+        CHECK(snapshot.by_actor[act.get()].count == 4);
+        CHECK(snapshot.by_actor[act.get()].queue_wait.count() == 3);
+
+        r::delivery_meter_t::reset();
+        snapshot = r::delivery_meter_t::snapshot();
+        CHECK(snapshot.by_type[message::sample_t::message_type].count == 0);
+        CHECK(snapshot.by_actor[act.get()].count == 0);
+    }
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(act->get_state() == r::state_t::SHUT_DOWN);
+}
+
+TEST_CASE("destroyed actors are forgotten", "[delivery_meter]") {
+    r::delivery_meter_t::reset();
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<metered_sup_t>().timeout(rt::default_timeout).finish();
+    auto act = sup->create_actor<receiver_t>().timeout(rt::default_timeout).finish();
+    sup->do_process();
+    REQUIRE(act->get_state() == r::state_t::OPERATIONAL);
+    r::delivery_meter_t::enable(true);
+    sup->send<payload::sample_t>(act->get_address());
+    sup->do_process();
+    /* the shard of the finished thread */
+    std::thread([&]() { r::delivery_meter_t::record_handler(act.get(), 10, 0, false); }).join();
+
+    const r::actor_base_t *key = act.get();
+    CHECK(r::delivery_meter_t::snapshot().by_actor[key].count == 2);
+
+    act->do_shutdown();
+    sup->do_process();
+    REQUIRE(act->get_state() == r::state_t::SHUT_DOWN);
+    act.reset();
+    CHECK(r::delivery_meter_t::snapshot().by_actor.count(key) == 0);
+
+    SECTION("retired entry of the busy thread is not reused") {
+        std::mutex mutex;
+        std::condition_variable cv;
+        int step = 0;
+        auto wait_for = [&](int value) {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return step == value; });
+        };
+        auto advance = [&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++step;
+            cv.notify_all();
+        };
+        std::thread thread([&]() {
+            r::delivery_meter_t::record_handler(key, 10, 0, false);
+            advance();
+            wait_for(2);
+            /* the same address is taken by a new actor */
+            r::delivery_meter_t::record_handler(key, 10, 0, false);
+            advance();
+        });
+        wait_for(1);
+        CHECK(r::delivery_meter_t::snapshot().by_actor[key].count == 1);
+        r::delivery_meter_t::forget(key);
+        CHECK(r::delivery_meter_t::snapshot().by_actor.count(key) == 0);
+        advance();
+        wait_for(3);
+        thread.join();
+        CHECK(r::delivery_meter_t::snapshot().by_actor[key].count == 1);
+    }
+
+    r::delivery_meter_t::enable(false);
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+}
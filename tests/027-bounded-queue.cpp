@@ -0,0 +1,284 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "supervisor_test.h"
+#include "actor_test.h"
+#include <vector>
+
+namespace r = rotor;
+namespace rt = rotor::test;
+
+namespace payload {
+struct sample_t {
+    int value;
+};
+
+struct sample_res_t {};
+struct sample_req_t {
+    using response_t = sample_res_t;
+};
+
+struct control_t {
+    int value;
+};
+} // namespace payload
+
+template <> struct rotor::bounded_payload_t<payload::control_t> : std::false_type {};
+
+namespace message {
+using sample_t = r::message_t<payload::sample_t>;
+using control_t = r::message_t<payload::control_t>;
+using sample_req_t = r::request_traits_t<payload::sample_req_t>::request::message_t;
+using sample_res_t = r::request_traits_t<payload::sample_req_t>::response::message_t;
+} // namespace message
+
+struct bounded_sup_t : public rt::supervisor_test_t {
+    using rt::supervisor_test_t::supervisor_test_t;
+    using rt::supervisor_test_t::admit_inbound;
+    using rt::supervisor_test_t::drain;
+};
+
+struct sample_actor_t : public rt::actor_test_t {
+    using rt::actor_test_t::actor_test_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        rt::actor_test_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([&](auto &p) {
+            p.subscribe_actor(&sample_actor_t::on_sample);
+            p.subscribe_actor(&sample_actor_t::on_control);
+            p.subscribe_actor(&sample_actor_t::on_request);
+            p.subscribe_actor(&sample_actor_t::on_response);
+            p.subscribe_actor(&sample_actor_t::on_backpressure, supervisor->get_address());
+        });
+    }
+
+    void make_request() noexcept { request<payload::sample_req_t>(address).send(rt::default_timeout); }
+
+    void on_sample(message::sample_t &msg) noexcept { received.push_back(msg.payload.value); }
+    void on_control(message::control_t &msg) noexcept { received.push_back(msg.payload.value); }
+    void on_request(message::sample_req_t &req) noexcept {
+        ++requests;
+        reply_to(req);
+    }
+    void on_response(message::sample_res_t &res) noexcept { ec = res.payload.ec; }
+    void on_backpressure(r::message::backpressure_t &msg) noexcept {
+        ++backpressures;
+        policy = msg.payload.policy;
+    }
+
+    std::vector<int> received;
+    std::size_t requests = 0;
+    std::error_code ec;
+    std::size_t backpressures = 0;
+    r::overflow_policy_t policy = r::overflow_policy_t::drop_newest;
+};
+
+struct fixture_t {
+    fixture_t(r::overflow_policy_t policy) {
+        sup = ctx.create_supervisor<bounded_sup_t>()
+                  .timeout(rt::default_timeout)
+                  .queue_capacity(3)
+                  .overflow_policy(policy)
+                  .finish();
+        act = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+        sup->do_process();
+        REQUIRE(act->get_state() == r::state_t::OPERATIONAL);
+        REQUIRE(sup->get_leader_queue().empty());
+    }
+
+    ~fixture_t() {
+        sup->do_shutdown();
+        sup->do_process();
+        CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+    }
+
+    void send(int from, int to) {
+        for (int i = from; i < to; ++i) {
+            sup->send<payload::sample_t>(act->get_address(), i);
+        }
+    }
+
+    r::system_context_t ctx;
+    r::intrusive_ptr_t<bounded_sup_t> sup;
+    r::intrusive_ptr_t<sample_actor_t> act;
+};
+
+TEST_CASE("unbounded queue", "[bounded_queue]") {
+    r::system_context_t ctx;
+    auto sup = ctx.create_supervisor<bounded_sup_t>().timeout(rt::default_timeout).finish();
+    auto act = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    sup->do_process();
+    for (int i = 0; i < 100; ++i) {
+        sup->send<payload::sample_t>(act->get_address(), i);
+    }
+    sup->do_process();
+    CHECK(act->received.size() == 100);
+    CHECK(act->backpressures == 0);
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+}
+
+TEST_CASE("drop newest", "[bounded_queue]") {
+    fixture_t f(r::overflow_policy_t::drop_newest);
+    f.send(0, 5);
+    f.sup->do_process();
+    CHECK(f.act->received == std::vector<int>{0, 1, 2});
+    CHECK(f.act->backpressures == 1);
+    CHECK(f.act->policy == r::overflow_policy_t::drop_newest);
+
+    // the new overflow episode is notified again
+    f.send(5, 10);
+    f.sup->do_process();
+    CHECK(f.act->received == std::vector<int>{0, 1, 2, 5, 6, 7});
+    CHECK(f.act->backpressures == 2);
+}
+
+TEST_CASE("drop oldest", "[bounded_queue]") {
+    fixture_t f(r::overflow_policy_t::drop_oldest);
+    f.send(0, 5);
+    f.sup->do_process();
+    CHECK(f.act->received == std::vector<int>{2, 3, 4});
+    CHECK(f.act->backpressures == 1);
+    CHECK(f.act->policy == r::overflow_policy_t::drop_oldest);
+}
+
+TEST_CASE("drop oldest, when there is nothing to evict", "[bounded_queue]") {
+    fixture_t f(r::overflow_policy_t::drop_oldest);
+    for (int i = 0; i < 3; ++i) {
+        f.sup->send<payload::control_t>(f.act->get_address(), i);
+    }
+    f.send(3, 5);
+    CHECK(f.sup->get_leader_queue().size() == 4);
+    f.sup->do_process();
+    CHECK(f.act->received == std::vector<int>{0, 1, 2});
+    CHECK(f.act->backpressures == 1);
+}
+
+TEST_CASE("overflow episode ends at low-water mark", "[bounded_queue]") {
+    r::system_context_t ctx;
+    auto sup = ctx.create_supervisor<bounded_sup_t>()
+                   .timeout(rt::default_timeout)
+                   .queue_capacity(6)
+                   .process_budget(3)
+                   .finish();
+    auto child = sup->create_actor<bounded_sup_t>().timeout(rt::default_timeout).finish();
+    auto act = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    auto send = [&](r::supervisor_t &sender, int from, int to) {
+        for (int i = from; i < to; ++i) {
+            sender.send<payload::sample_t>(act->get_address(), i);
+        }
+    };
+    while (!sup->get_leader_queue().empty()) {
+        sup->do_process();
+    }
+    REQUIRE(act->get_state() == r::state_t::OPERATIONAL);
+
+    send(*sup, 0, 7);
+    // the same episode for the whole locality
+    send(*child, 7, 8);
+    CHECK(sup->get_leader_queue().size() == 7);
+
+    // 0, 1, 2 are processed, the queue is still above the low-water mark
+    sup->do_process();
+    send(*child, 8, 11);
+    while (!sup->get_leader_queue().empty()) {
+        sup->do_process();
+    }
+    CHECK(act->received == std::vector<int>{0, 1, 2, 3, 4, 5, 8, 9});
+    CHECK(act->backpressures == 1);
+
+    // the queue has been drained, so the new episode is notified
+    send(*child, 11, 18);
+    while (!sup->get_leader_queue().empty()) {
+        sup->do_process();
+    }
+    CHECK(act->backpressures == 2);
+
+    sup->do_shutdown();
+    while (!sup->get_leader_queue().empty()) {
+        sup->do_process();
+    }
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+}
+
+TEST_CASE("reject", "[bounded_queue]") {
+    fixture_t f(r::overflow_policy_t::reject);
+
+    SECTION("plain messages are dropped") {
+        f.send(0, 5);
+        f.sup->do_process();
+        CHECK(f.act->received == std::vector<int>{0, 1, 2});
+        CHECK(f.act->backpressures == 1);
+    }
+
+    SECTION("request is replied with error") {
+        f.send(0, 3);
+        f.act->make_request();
+        CHECK(f.sup->active_timers.size() == 1);
+        f.sup->do_process();
+        CHECK(f.act->received == std::vector<int>{0, 1, 2});
+        CHECK(f.act->requests == 0);
+        CHECK(f.act->ec == r::make_error_code(r::error_code_t::queue_overflow));
+        CHECK(f.act->ec.message() == "supervisor queue overflow");
+        CHECK(f.act->backpressures == 1);
+        CHECK(f.sup->active_timers.empty());
+    }
+
+    SECTION("request is accepted when there is a room") {
+        f.act->make_request();
+        f.sup->do_process();
+        CHECK(f.act->requests == 1);
+        CHECK(!f.act->ec);
+        CHECK(f.act->backpressures == 0);
+    }
+}
+
+TEST_CASE("inbound messages are bounded too", "[bounded_queue]") {
+    fixture_t f(r::overflow_policy_t::drop_newest);
+    r::inbound_queue_t inbound;
+    for (int i = 0; i < 5; ++i) {
+        inbound.push(r::make_message<payload::sample_t>(f.act->get_address(), i));
+    }
+    f.sup->drain(inbound);
+    CHECK(inbound.empty());
+    f.sup->do_process();
+    CHECK(f.act->received == std::vector<int>{0, 1, 2});
+    CHECK(f.act->backpressures == 1);
+}
+
+TEST_CASE("inbound queue is bounded on push", "[bounded_queue]") {
+    fixture_t f(r::overflow_policy_t::drop_oldest);
+    r::inbound_queue_t inbound;
+    auto push = [&](int from, int to) {
+        for (int i = from; i < to; ++i) {
+            auto message = r::make_message<payload::sample_t>(f.act->get_address(), i);
+            if (f.sup->admit_inbound(*message)) {
+                inbound.push(std::move(message));
+            }
+        }
+    };
+
+    // the producer cannot evict the oldest inbound messages, so the newest ones are dropped
+    push(0, 5);
+    auto control = r::make_message<payload::control_t>(f.act->get_address(), 100);
+    CHECK(f.sup->admit_inbound(*control));
+    inbound.push(std::move(control));
+    CHECK(f.act->backpressures == 0);
+
+    f.sup->drain(inbound);
+    f.sup->do_process();
+    CHECK(f.act->received == std::vector<int>{0, 1, 2, 100});
+    CHECK(f.act->backpressures == 1);
+
+    // there is a room again, when the inbound messages are drained
+    push(5, 7);
+    f.sup->drain(inbound);
+    f.sup->do_process();
+    CHECK(f.act->received == std::vector<int>{0, 1, 2, 100, 5, 6});
+}
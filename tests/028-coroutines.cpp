@@ -0,0 +1,199 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "rotor/coroutine.hpp"
+#include "supervisor_test.h"
+#include "actor_test.h"
+
+namespace r = rotor;
+namespace rt = rotor::test;
+
+namespace payload {
+struct sample_res_t {
+    int value;
+};
+struct sample_req_t {
+    using response_t = sample_res_t;
+    int value;
+};
+} // namespace payload
+
+namespace message {
+using sample_req_t = r::request_traits_t<payload::sample_req_t>::request::message_t;
+using sample_res_t = r::request_traits_t<payload::sample_req_t>::response::message_t;
+} // namespace message
+
+struct server_t : public rt::actor_test_t {
+    using rt::actor_test_t::actor_test_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        rt::actor_test_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&server_t::on_request); });
+    }
+
+    void on_request(message::sample_req_t &req) noexcept {
+        ++requests;
+        auto value = req.payload.request_payload.value;
+        if (value >= 0) {
+            reply_to(req, value * 2);
+        }
+    }
+
+    std::size_t requests = 0;
+};
+
+static std::size_t destroyed = 0;
+
+struct client_t : public rt::actor_test_t {
+    using rt::actor_test_t::actor_test_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        rt::actor_test_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&client_t::on_response); });
+    }
+
+    r::task_t flow(int first) noexcept {
+        ++steps;
+        auto res = co_await request<payload::sample_req_t>(server_addr, first).await(rt::default_timeout);
+        ec = res->payload.ec;
+        if (ec) {
+            co_return;
+        }
+        ++steps;
+        res = co_await request<payload::sample_req_t>(server_addr, res->payload.res.value).await(rt::default_timeout);
+        ec = res->payload.ec;
+        result = res->payload.res.value;
+        ++steps;
+    }
+
+    ~client_t() { ++destroyed; }
+
+    void on_response(message::sample_res_t &) noexcept { ++responses; }
+
+    r::address_ptr_t server_addr;
+    std::size_t steps = 0;
+    std::size_t responses = 0;
+    int result = 0;
+    std::error_code ec;
+};
+
+TEST_CASE("await requests sequentially", "[coroutines]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto server = sup->create_actor<server_t>().timeout(rt::default_timeout).finish();
+    auto client = sup->create_actor<client_t>().timeout(rt::default_timeout).finish();
+    client->server_addr = server->get_address();
+    sup->do_process();
+    REQUIRE(client->get_state() == r::state_t::OPERATIONAL);
+
+    client->flow(3);
+    CHECK(client->steps == 1);
+    CHECK(sup->active_timers.size() == 1);
+
+    sup->do_process();
+    CHECK(client->steps == 3);
+    CHECK(client->result == 12);
+    CHECK(!client->ec);
+    CHECK(server->requests == 2);
+    CHECK(client->responses == 0);
+    CHECK(sup->active_timers.empty());
+    CHECK(sup->get_requests().size() == 0);
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+}
+
+TEST_CASE("awaited request timeout", "[coroutines]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto server = sup->create_actor<server_t>().timeout(rt::default_timeout).finish();
+    auto client = sup->create_actor<client_t>().timeout(rt::default_timeout).finish();
+    client->server_addr = server->get_address();
+    sup->do_process();
+
+    client->flow(-1);
+    sup->do_process();
+    CHECK(server->requests == 1);
+    CHECK(client->steps == 1);
+    REQUIRE(sup->active_timers.size() == 1);
+
+    auto timer_id = *(sup->active_timers.begin());
+    sup->active_timers.clear();
+    sup->on_timer_trigger(timer_id);
+    CHECK(client->steps == 1);
+    CHECK(client->ec == r::error_code_t::request_timeout);
+    CHECK(client->responses == 0);
+    CHECK(sup->get_requests().size() == 0);
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+}
+
+TEST_CASE("actor is kept alive while awaiting", "[coroutines]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto server = sup->create_actor<server_t>().timeout(rt::default_timeout).finish();
+    auto client = sup->create_actor<client_t>().timeout(rt::default_timeout).finish();
+    client->server_addr = server->get_address();
+    sup->do_process();
+
+    client->flow(-1);
+    sup->do_process();
+    REQUIRE(sup->active_timers.size() == 1);
+    auto timer_id = *(sup->active_timers.begin());
+    sup->active_timers.clear();
+
+    destroyed = 0;
+    client->do_shutdown();
+    client.reset();
+    sup->do_process();
+    CHECK(destroyed == 0);
+
+    sup->on_timer_trigger(timer_id);
+    CHECK(destroyed == 1);
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+}
+
+TEST_CASE("supervisor shutdown resumes awaiting coroutine", "[coroutines]") {
+    r::system_context_t system_context;
+    r::pt::time_duration resolution;
+    SECTION("backend timers") {}
+    SECTION("timer wheel") { resolution = r::pt::milliseconds{1}; }
+
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>()
+                   .timeout(rt::default_timeout)
+                   .timer_resolution(resolution)
+                   .finish();
+    auto server = sup->create_actor<server_t>().timeout(rt::default_timeout).finish();
+    auto client = sup->create_actor<client_t>().timeout(rt::default_timeout).finish();
+    client->server_addr = server->get_address();
+    sup->do_process();
+
+    client->flow(-1);
+    sup->do_process();
+    CHECK(server->requests == 1);
+    REQUIRE(sup->active_timers.size() == 1);
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(client->steps == 1);
+    CHECK(client->ec == r::error_code_t::request_timeout);
+    CHECK(sup->get_requests().size() == 0);
+    CHECK(sup->active_timers.empty());
+
+    // the coroutine frame is gone, i.e. the actor is not kept alive anymore
+    destroyed = 0;
+    client.reset();
+    CHECK(destroyed == 1);
+}
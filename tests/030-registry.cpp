@@ -430,3 +430,145 @@ TEST_CASE("no problems when supervisor registers self in a registry", "[registry
     sup->do_process();
     CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
 }
+
+struct counting_registry_t : r::registry_t {
+    using r::registry_t::registry_t;
+
+    void on_reg(r::message::registration_request_t &request) noexcept override {
+        ++registrations;
+        r::registry_t::on_reg(request);
+    }
+
+    void on_discovery(r::message::discovery_request_t &request) noexcept override {
+        ++discoveries;
+        r::registry_t::on_discovery(request);
+    }
+
+    std::size_t registrations = 0;
+    std::size_t discoveries = 0;
+};
+
+TEST_CASE("discovery cache", "[registry][supervisor]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto reg = sup->create_actor<counting_registry_t>().timeout(rt::default_timeout).finish();
+    auto sup2 = sup->create_actor<rt::supervisor_test_t>()
+                    .timeout(rt::default_timeout)
+                    .registry_address(reg->get_address())
+                    .discovery_cache(true)
+                    .finish();
+    auto process = [&]() {
+        while (!sup->get_leader_queue().empty()) {
+            sup->do_process();
+        }
+    };
+    auto register_service = [](auto &actor, r::plugin::plugin_base_t &plugin) {
+        plugin.with_casted<r::plugin::registry_plugin_t>(
+            [&actor](auto &p) { p.register_name("service-name", actor.get_address()); });
+    };
+    auto discover_service = [](auto &actor, r::plugin::plugin_base_t &plugin) {
+        plugin.with_casted<r::plugin::registry_plugin_t>([&actor](auto &p) {
+            p.discover_name("service-name", static_cast<sample_actor_t &>(actor).service_addr);
+        });
+    };
+
+    auto act_s = sup2->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    act_s->configurer = register_service;
+    process();
+    REQUIRE(sup2->get_state() == r::state_t::OPERATIONAL);
+
+    auto act_c1 = sup2->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    act_c1->configurer = discover_service;
+    process();
+    CHECK(act_c1->get_state() == r::state_t::OPERATIONAL);
+    CHECK(act_c1->service_addr == act_s->get_address());
+    CHECK(reg->discoveries == 1);
+
+    // resolved from the cache
+    auto act_c2 = sup2->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    act_c2->configurer = discover_service;
+    process();
+    CHECK(act_c2->get_state() == r::state_t::OPERATIONAL);
+    CHECK(act_c2->service_addr == act_s->get_address());
+    CHECK(reg->discoveries == 1);
+
+    // deregistration invalidates the cache
+    sup->send<r::payload::deregistration_service_t>(reg->get_address(), "service-name");
+    auto act_s2 = sup2->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    act_s2->configurer = register_service;
+    process();
+    REQUIRE(act_s2->get_state() == r::state_t::OPERATIONAL);
+
+    auto act_c3 = sup2->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    act_c3->configurer = discover_service;
+    process();
+    CHECK(act_c3->get_state() == r::state_t::OPERATIONAL);
+    CHECK(act_c3->service_addr == act_s2->get_address());
+    CHECK(reg->discoveries == 2);
+
+    sup->do_shutdown();
+    process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(sup2->get_state() == r::state_t::SHUT_DOWN);
+}
+
+TEST_CASE("sharded registry", "[registry][supervisor]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto reg1 = sup->create_actor<counting_registry_t>().timeout(rt::default_timeout).finish();
+    auto reg2 = sup->create_actor<counting_registry_t>().timeout(rt::default_timeout).finish();
+    auto shards = std::vector<r::address_ptr_t>{reg1->get_address(), reg2->get_address()};
+    auto sup2 =
+        sup->create_actor<rt::supervisor_test_t>().timeout(rt::default_timeout).registry_shards(shards).finish();
+    auto process = [&]() {
+        while (!sup->get_leader_queue().empty()) {
+            sup->do_process();
+        }
+    };
+    process();
+    REQUIRE(sup2->get_state() == r::state_t::OPERATIONAL);
+    CHECK(sup2->get_registry_address() == reg1->get_address());
+
+    constexpr std::size_t count = 4;
+    std::vector<std::string> names;
+    std::vector<r::intrusive_ptr_t<sample_actor_t>> services;
+    std::size_t expected1 = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        auto name = std::string("service-") + std::to_string(i);
+        if (sup2->get_registry_address(name) == reg1->get_address()) {
+            ++expected1;
+        } else {
+            CHECK(sup2->get_registry_address(name) == reg2->get_address());
+        }
+        auto act_s = sup2->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+        act_s->configurer = [name](auto &actor, r::plugin::plugin_base_t &plugin) {
+            plugin.with_casted<r::plugin::registry_plugin_t>(
+                [&](auto &p) { p.register_name(name, actor.get_address()); });
+        };
+        names.emplace_back(std::move(name));
+        services.emplace_back(std::move(act_s));
+    }
+    process();
+    CHECK(reg1->registrations == expected1);
+    CHECK(reg2->registrations == count - expected1);
+
+    std::vector<r::address_ptr_t> addresses(count);
+    auto act_c = sup2->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    act_c->configurer = [&](auto &, r::plugin::plugin_base_t &plugin) {
+        plugin.with_casted<r::plugin::registry_plugin_t>([&](auto &p) {
+            for (std::size_t i = 0; i < count; ++i) {
+                p.discover_name(names[i], addresses[i]);
+            }
+        });
+    };
+    process();
+    CHECK(act_c->get_state() == r::state_t::OPERATIONAL);
+    CHECK(reg1->discoveries + reg2->discoveries == count);
+    for (std::size_t i = 0; i < count; ++i) {
+        CHECK(addresses[i] == services[i]->get_address());
+    }
+
+    sup->do_shutdown();
+    process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+}
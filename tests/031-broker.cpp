@@ -0,0 +1,364 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "supervisor_test.h"
+#include "actor_test.h"
+#include "access.h"
+
+namespace r = rotor;
+namespace rt = r::test;
+
+namespace payload {
+struct quote_t {
+    int price;
+};
+} // namespace payload
+
+namespace message {
+using quote_t = r::message_t<payload::quote_t>;
+}
+
+struct subscriber_t : public rt::actor_test_t {
+    using rt::actor_test_t::actor_test_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        rt::actor_test_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) {
+            p.subscribe_actor(&subscriber_t::on_announcement);
+            p.subscribe_actor(&subscriber_t::on_subscription);
+        });
+    }
+
+    void watch(const std::string &pattern) noexcept { watch(pattern, address); }
+
+    void watch(const std::string &pattern, const r::address_ptr_t &subscriber_addr) noexcept {
+        request<r::payload::topic_subscription_request_t>(broker_addr, pattern, subscriber_addr)
+            .send(rt::default_timeout);
+    }
+
+    void unwatch(const std::string &pattern) noexcept {
+        send<r::payload::topic_unsubscription_t>(broker_addr, pattern, address);
+    }
+
+    void on_subscription(r::message::topic_subscription_response_t &res) noexcept { ec = res.payload.ec; }
+
+    void on_announcement(r::message::topic_announcement_t &msg) noexcept {
+        topics.emplace_back(msg.payload.topic);
+        subscribe(&subscriber_t::on_quote, msg.payload.topic_addr);
+    }
+
+    void on_quote(message::quote_t &msg) noexcept { prices.emplace_back(msg.payload.price); }
+
+    r::address_ptr_t broker_addr;
+    std::vector<std::string> topics;
+    std::vector<int> prices;
+    std::error_code ec;
+};
+
+struct publisher_t : public rt::actor_test_t {
+    using rt::actor_test_t::actor_test_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        rt::actor_test_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&publisher_t::on_topic); });
+    }
+
+    void resolve(const std::string &topic) noexcept {
+        request<r::payload::topic_request_t>(broker_addr, topic).send(rt::default_timeout);
+    }
+
+    void on_topic(r::message::topic_response_t &res) noexcept {
+        ec = res.payload.ec;
+        topic_addr = res.payload.res.topic_addr;
+    }
+
+    void publish(int price) noexcept { send<payload::quote_t>(topic_addr, price); }
+
+    r::address_ptr_t broker_addr;
+    r::address_ptr_t topic_addr;
+    std::error_code ec;
+};
+
+struct broker_test_t : public r::broker_t {
+    using r::broker_t::broker_t;
+    using r::broker_t::min_topics_threshold;
+    using r::broker_t::origins_map;
+    using r::broker_t::root;
+    using r::broker_t::subscribers_map;
+    using r::broker_t::topics_map;
+};
+
+TEST_CASE("topics pub/sub", "[broker]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto broker = sup->create_actor<r::broker_t>().timeout(rt::default_timeout).finish();
+    auto sub_eq = sup->create_actor<subscriber_t>().timeout(rt::default_timeout).finish();
+    auto sub_all = sup->create_actor<subscriber_t>().timeout(rt::default_timeout).finish();
+    auto pub = sup->create_actor<publisher_t>().timeout(rt::default_timeout).finish();
+    sub_eq->broker_addr = sub_all->broker_addr = pub->broker_addr = broker->get_address();
+    sup->do_process();
+    REQUIRE(sup->get_state() == r::state_t::OPERATIONAL);
+
+    pub->resolve("feed.eq.AAPL");
+    sup->do_process();
+    REQUIRE(!pub->ec);
+    auto aapl_addr = pub->topic_addr;
+    REQUIRE(aapl_addr);
+
+    // existing topics are announced on subscription
+    sub_eq->watch("feed.eq.*");
+    sub_all->watch("feed.#");
+    sup->do_process();
+    CHECK(!sub_eq->ec);
+    CHECK(!sub_all->ec);
+    CHECK(sub_eq->topics == std::vector<std::string>{"feed.eq.AAPL"});
+    CHECK(sub_all->topics == std::vector<std::string>{"feed.eq.AAPL"});
+
+    pub->publish(10);
+    sup->do_process();
+    CHECK(sub_eq->prices == std::vector<int>{10});
+    CHECK(sub_all->prices == std::vector<int>{10});
+
+    // new topics are announced upon creation
+    pub->resolve("feed.fx.EUR");
+    sup->do_process();
+    CHECK(sub_eq->topics.size() == 1);
+    CHECK(sub_all->topics == std::vector<std::string>{"feed.eq.AAPL", "feed.fx.EUR"});
+    pub->publish(20);
+    sup->do_process();
+    CHECK(sub_eq->prices == std::vector<int>{10});
+    CHECK(sub_all->prices == std::vector<int>{10, 20});
+
+    // the same topic is resolved to the same address and announced only once
+    sub_all->watch("feed.eq.AAPL");
+    pub->resolve("feed.eq.AAPL");
+    sup->do_process();
+    CHECK(pub->topic_addr == aapl_addr);
+    CHECK(sub_all->topics.size() == 2);
+
+    // unsubscribed pattern is no longer announced
+    sub_eq->unwatch("feed.eq.*");
+    pub->resolve("feed.eq.MSFT");
+    sup->do_process();
+    CHECK(sub_eq->topics.size() == 1);
+    CHECK(sub_all->topics.size() == 3);
+
+    // invalid names are rejected
+    pub->resolve("feed..x");
+    sup->do_process();
+    CHECK(pub->ec == r::error_code_t::invalid_topic);
+    pub->resolve("feed.*");
+    sup->do_process();
+    CHECK(pub->ec == r::error_code_t::invalid_topic);
+    sub_eq->watch("feed.#.x");
+    sup->do_process();
+    CHECK(sub_eq->ec == r::error_code_t::invalid_topic);
+
+    // topics subscriptions are regular ones, i.e. they are cleaned up on shutdown
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(sup->get_leader_queue().size() == 0);
+    CHECK(rt::empty(sup->get_subscription()));
+}
+
+TEST_CASE("topics pub/sub across supervisors", "[broker]") {
+    r::system_context_t system_context;
+    const char locality1[] = "abc";
+    const char locality2[] = "def";
+    auto sup1 = system_context.create_supervisor<rt::supervisor_test_t>()
+                    .locality(locality1)
+                    .timeout(rt::default_timeout)
+                    .finish();
+    auto sup2 = sup1->create_actor<rt::supervisor_test_t>().locality(locality2).timeout(rt::default_timeout).finish();
+    auto broker = sup1->create_actor<r::broker_t>().timeout(rt::default_timeout).finish();
+    auto sub = sup2->create_actor<subscriber_t>().timeout(rt::default_timeout).finish();
+    auto pub = sup1->create_actor<publisher_t>().timeout(rt::default_timeout).finish();
+    sub->broker_addr = pub->broker_addr = broker->get_address();
+
+    auto process = [&]() {
+        while (!sup1->get_leader_queue().empty() || !sup2->get_leader_queue().empty()) {
+            sup1->do_process();
+            sup2->do_process();
+        }
+    };
+    process();
+    REQUIRE(sub->get_state() == r::state_t::OPERATIONAL);
+
+    sub->watch("feed.*.*");
+    pub->resolve("feed.eq.AAPL");
+    process();
+    CHECK(sub->topics == std::vector<std::string>{"feed.eq.AAPL"});
+
+    pub->publish(5);
+    process();
+    CHECK(sub->prices == std::vector<int>{5});
+
+    sup2->do_shutdown();
+    process();
+    CHECK(sup2->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(rt::empty(sup2->get_subscription()));
+
+    // no more subscribers
+    pub->publish(6);
+    process();
+    CHECK(sub->prices == std::vector<int>{5});
+
+    sup1->do_shutdown();
+    process();
+    CHECK(sup1->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(rt::empty(sup1->get_subscription()));
+}
+
+TEST_CASE("subscriber shutdown drops its patterns", "[broker]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto broker = sup->create_actor<broker_test_t>().timeout(rt::default_timeout).finish();
+    auto sub1 = sup->create_actor<subscriber_t>().timeout(rt::default_timeout).finish();
+    auto sub2 = sup->create_actor<subscriber_t>().timeout(rt::default_timeout).finish();
+    auto pub = sup->create_actor<publisher_t>().timeout(rt::default_timeout).finish();
+    sub1->broker_addr = sub2->broker_addr = pub->broker_addr = broker->get_address();
+    sup->do_process();
+    REQUIRE(sup->get_state() == r::state_t::OPERATIONAL);
+
+    sub1->watch("feed.#");
+    sub1->watch("feed.eq.*");
+    sub2->watch("feed.#");
+    pub->resolve("feed.eq.AAPL");
+    sup->do_process();
+    CHECK(sub1->topics == std::vector<std::string>{"feed.eq.AAPL"});
+    CHECK(broker->subscribers_map.size() == 2);
+    CHECK(broker->origins_map.size() == 2);
+
+    // the subscriber does not unsubscribe its patterns
+    sub1->do_shutdown();
+    sup->do_process();
+    CHECK(sub1->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(broker->access<rt::to::state>() == r::state_t::OPERATIONAL);
+    CHECK(broker->subscribers_map.size() == 1);
+    CHECK(broker->origins_map.size() == 1);
+
+    pub->resolve("feed.eq.MSFT");
+    sup->do_process();
+    CHECK(sub1->topics.size() == 1);
+    CHECK(sub2->topics == std::vector<std::string>{"feed.eq.AAPL", "feed.eq.MSFT"});
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(sup->get_leader_queue().size() == 0);
+    CHECK(rt::empty(sup->get_subscription()));
+    CHECK(sup->active_timers.size() == 0);
+}
+
+TEST_CASE("patterns of the same subscriber address from different origins", "[broker]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto broker = sup->create_actor<broker_test_t>().timeout(rt::default_timeout).finish();
+    auto sub1 = sup->create_actor<subscriber_t>().timeout(rt::default_timeout).finish();
+    auto sub2 = sup->create_actor<subscriber_t>().timeout(rt::default_timeout).finish();
+    auto pub = sup->create_actor<publisher_t>().timeout(rt::default_timeout).finish();
+    sub1->broker_addr = sub2->broker_addr = pub->broker_addr = broker->get_address();
+    sup->do_process();
+    REQUIRE(sup->get_state() == r::state_t::OPERATIONAL);
+
+    // both actors subscribe the same pattern on behalf of sub2
+    sub1->watch("feed.#", sub2->get_address());
+    sub2->watch("feed.#");
+    sub2->watch("feed.eq.*");
+    sup->do_process();
+    CHECK(broker->subscribers_map.size() == 1);
+    CHECK(broker->origins_map.size() == 2);
+
+    // the patterns of sub2 are still alive
+    sub1->do_shutdown();
+    sup->do_process();
+    CHECK(sub1->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(broker->subscribers_map.size() == 1);
+    CHECK(broker->origins_map.size() == 1);
+
+    pub->resolve("feed.fx.EUR");
+    sup->do_process();
+    CHECK(sub2->topics == std::vector<std::string>{"feed.fx.EUR"});
+    pub->publish(5);
+    sup->do_process();
+    CHECK(sub2->prices == std::vector<int>{5});
+
+    // explicit unsubscription removes the pattern of sub2
+    sub2->unwatch("feed.#");
+    sup->do_process();
+    pub->resolve("feed.fx.USD");
+    sup->do_process();
+    CHECK(sub2->topics.size() == 1);
+    CHECK(broker->subscribers_map.size() == 1);
+
+    sub2->unwatch("feed.eq.*");
+    sup->do_process();
+    CHECK(broker->subscribers_map.size() == 0);
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(sup->get_leader_queue().size() == 0);
+    CHECK(rt::empty(sup->get_subscription()));
+    CHECK(sup->active_timers.size() == 0);
+}
+
+TEST_CASE("unused patterns and topics are forgotten", "[broker]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto broker = sup->create_actor<broker_test_t>().timeout(rt::default_timeout).finish();
+    auto sub = sup->create_actor<subscriber_t>().timeout(rt::default_timeout).finish();
+    auto pub = sup->create_actor<publisher_t>().timeout(rt::default_timeout).finish();
+    sub->broker_addr = pub->broker_addr = broker->get_address();
+    sup->do_process();
+    REQUIRE(sup->get_state() == r::state_t::OPERATIONAL);
+
+    sub->watch("feed.eq.*");
+    sub->watch("feed.#");
+    sup->do_process();
+    REQUIRE(broker->root.children.size() == 1);
+    CHECK(broker->root.children.begin()->second->children.size() == 1);
+
+    // the node of `feed.#` is still in use
+    sub->unwatch("feed.eq.*");
+    sup->do_process();
+    REQUIRE(broker->root.children.size() == 1);
+    CHECK(broker->root.children.begin()->second->children.empty());
+
+    sub->unwatch("feed.#");
+    sup->do_process();
+    CHECK(broker->root.children.empty());
+    CHECK(broker->subscribers_map.empty());
+
+    // the publisher keeps the last topic only, the other ones are not referred by anything
+    auto count = broker_test_t::min_topics_threshold;
+    for (std::size_t i = 0; i < count; ++i) {
+        pub->resolve("feed.x" + std::to_string(i));
+        sup->do_process();
+    }
+    CHECK(broker->topics_map.size() == count);
+    pub->resolve("feed.last");
+    sup->do_process();
+    CHECK(broker->topics_map.size() == 2);
+    CHECK(broker->topics_map.count("feed.x" + std::to_string(count - 1)) == 1);
+    CHECK(broker->topics_map.count("feed.last") == 1);
+
+    // the forgotten topic is created (and announced) again
+    sub->watch("feed.*");
+    pub->resolve("feed.x0");
+    sup->do_process();
+    REQUIRE(sub->topics.size() == 3);
+    CHECK(sub->topics.back() == "feed.x0");
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(sup->get_leader_queue().size() == 0);
+    CHECK(rt::empty(sup->get_subscription()));
+}
@@ -0,0 +1,177 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "supervisor_test.h"
+#include "actor_test.h"
+
+namespace r = rotor;
+namespace rt = r::test;
+
+namespace payload {
+
+struct sample_t {
+    int value;
+};
+
+struct copy_counter_t {
+    static std::size_t copies;
+
+    copy_counter_t() = default;
+    copy_counter_t(copy_counter_t &&) = default;
+    copy_counter_t(const copy_counter_t &) { ++copies; }
+    copy_counter_t &operator=(copy_counter_t &&) = default;
+    copy_counter_t &operator=(const copy_counter_t &) {
+        ++copies;
+        return *this;
+    }
+};
+
+std::size_t copy_counter_t::copies = 0;
+
+struct sample_res_t {
+    copy_counter_t data;
+};
+
+struct sample_req_t {
+    using response_t = sample_res_t;
+};
+
+} // namespace payload
+
+namespace message {
+using sample_t = r::message_t<payload::sample_t>;
+using sample_req_t = r::request_traits_t<payload::sample_req_t>::request::message_t;
+using sample_res_t = r::request_traits_t<payload::sample_req_t>::response::message_t;
+} // namespace message
+
+struct sample_actor_t : public rt::actor_test_t {
+    using rt::actor_test_t::actor_test_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        rt::actor_test_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) {
+            p.subscribe_actor(&sample_actor_t::on_sample);
+            p.subscribe_actor(&sample_actor_t::on_request);
+            p.subscribe_actor(&sample_actor_t::on_response);
+        });
+    }
+
+    void on_sample(message::sample_t &msg) noexcept {
+        ++received;
+        shared = msg.is_shared();
+    }
+    void on_request(message::sample_req_t &req) noexcept { reply_to(req); }
+    void on_response(message::sample_res_t &res) noexcept {
+        ++received;
+        ec = res.payload.ec;
+    }
+
+    std::size_t received = 0;
+    bool shared = false;
+    std::error_code ec;
+};
+
+#if defined(ROTOR_DEBUG_REFCOUNT)
+TEST_CASE("refcount operations per delivered message", "[refcount]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto act1 = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    sup->do_process();
+    REQUIRE(act1->get_state() == r::state_t::OPERATIONAL);
+    auto &ops = r::message_base_t::refcount_ops;
+
+    SECTION("single subscriber, the message is only created and destroyed") {
+        ops = 0;
+        act1->send<payload::sample_t>(act1->get_address(), 1);
+        sup->do_process();
+        CHECK(act1->received == 1);
+        CHECK(ops == 2);
+    }
+
+    SECTION("multiple subscribers do not add refcount operations") {
+        auto act2 = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+        sup->do_process();
+        act2->subscribe(&sample_actor_t::on_sample, act1->get_address());
+        sup->do_process();
+
+        ops = 0;
+        act1->send<payload::sample_t>(act1->get_address(), 1);
+        sup->do_process();
+        CHECK(act1->received == 1);
+        CHECK(act2->received == 1);
+        CHECK(ops == 2);
+    }
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+}
+#endif
+
+/* marks the enqueued messages as shared, as the thread-safe backends do */
+struct sharing_supervisor_t : public rt::supervisor_test_t {
+    using rt::supervisor_test_t::supervisor_test_t;
+
+    void enqueue(r::message_ptr_t message) noexcept override {
+        message->share();
+        rt::supervisor_test_t::enqueue(std::move(message));
+    }
+};
+
+TEST_CASE("message is not shared within the locality", "[refcount]") {
+    r::system_context_t system_context;
+    auto sup_root = system_context.create_supervisor<sharing_supervisor_t>().timeout(rt::default_timeout).finish();
+    auto sup_1 = sup_root->create_actor<sharing_supervisor_t>().timeout(rt::default_timeout).finish();
+    auto sup_2 = sup_root->create_actor<sharing_supervisor_t>().timeout(rt::default_timeout).finish();
+    auto act = sup_2->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    sup_root->do_process();
+    REQUIRE(act->get_state() == r::state_t::OPERATIONAL);
+    REQUIRE(sup_1->get_address()->same_locality(*sup_root->get_address()));
+    REQUIRE(sup_2->get_address()->same_locality(*sup_root->get_address()));
+
+    SECTION("parent supervisor address") {
+        act->subscribe(&sample_actor_t::on_sample, sup_root->get_address());
+        sup_root->do_process();
+        sup_root->send<payload::sample_t>(sup_root->get_address(), 1);
+    }
+
+    SECTION("sibling supervisor address") {
+        act->subscribe(&sample_actor_t::on_sample, sup_1->get_address());
+        sup_root->do_process();
+        sup_1->send<payload::sample_t>(sup_1->get_address(), 1);
+    }
+
+    sup_root->do_process();
+    CHECK(act->received == 1);
+    CHECK(!act->shared);
+
+    act->do_shutdown();
+    sup_root->do_process();
+    sup_root->do_shutdown();
+    sup_root->do_process();
+    CHECK(sup_root->get_state() == r::state_t::SHUT_DOWN);
+}
+
+TEST_CASE("response payload is moved to the requestor", "[refcount]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto act = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    sup->do_process();
+    REQUIRE(act->get_state() == r::state_t::OPERATIONAL);
+
+    payload::copy_counter_t::copies = 0;
+    act->request<payload::sample_req_t>(act->get_address()).send(rt::default_timeout);
+    sup->do_process();
+    CHECK(act->received == 1);
+    CHECK(!act->ec);
+    CHECK(payload::copy_counter_t::copies == 0);
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+}
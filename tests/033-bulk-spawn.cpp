@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "supervisor_test.h"
+#include "system_context_test.h"
+#include "actor_test.h"
+#include "access.h"
+
+namespace r = rotor;
+namespace rt = r::test;
+
+struct sample_actor_t : public rt::actor_test_t {
+    using rt::actor_test_t::actor_test_t;
+
+    virtual void init_finish() noexcept override {}
+
+    void confirm_init() noexcept { r::actor_base_t::init_finish(); }
+};
+
+TEST_CASE("actors group is initialized under single timer", "[bulk-spawn]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    sup->do_process();
+    REQUIRE(sup->get_state() == r::state_t::OPERATIONAL);
+    REQUIRE(sup->active_timers.empty());
+
+    auto actors = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish(3);
+    static_assert(std::is_same_v<decltype(actors), std::vector<r::intrusive_ptr_t<sample_actor_t>>>);
+    REQUIRE(actors.size() == 3);
+    sup->do_process();
+    for (auto &act : actors) {
+        CHECK(act->get_state() == r::state_t::INITIALIZING);
+    }
+    CHECK(sup->active_timers.size() == 1);
+    CHECK(sup->get_requests().size() == 3);
+
+    actors[0]->confirm_init();
+    actors[2]->confirm_init();
+    sup->do_process();
+    CHECK(actors[0]->get_state() == r::state_t::OPERATIONAL);
+    CHECK(actors[1]->get_state() == r::state_t::INITIALIZING);
+    CHECK(actors[2]->get_state() == r::state_t::OPERATIONAL);
+    CHECK(sup->active_timers.size() == 1);
+    CHECK(sup->get_requests().size() == 1);
+
+    actors[1]->confirm_init();
+    sup->do_process();
+    CHECK(actors[1]->get_state() == r::state_t::OPERATIONAL);
+    CHECK(sup->active_timers.empty());
+    CHECK(sup->get_requests().size() == 0);
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+    for (auto &act : actors) {
+        CHECK(act->get_state() == r::state_t::SHUT_DOWN);
+    }
+}
+
+TEST_CASE("actors group init timeout", "[bulk-spawn]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    sup->do_process();
+
+    auto actors = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish(3);
+    sup->do_process();
+    actors[1]->confirm_init();
+    sup->do_process();
+    CHECK(actors[1]->get_state() == r::state_t::OPERATIONAL);
+    REQUIRE(sup->active_timers.size() == 1);
+
+    // all still pending requests of the group are timed out at once
+    auto group_timer = *sup->active_timers.begin();
+    sup->active_timers.clear();
+    sup->on_timer_trigger(group_timer);
+    sup->do_process();
+    CHECK(actors[0]->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(actors[1]->get_state() == r::state_t::OPERATIONAL);
+    CHECK(actors[2]->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(sup->get_state() == r::state_t::OPERATIONAL);
+    CHECK(sup->get_requests().size() == 0);
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(actors[1]->get_state() == r::state_t::SHUT_DOWN);
+}
+
+TEST_CASE("actors group is spawned during supervisor initialization", "[bulk-spawn]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto actors = sup->create_actor<rt::actor_test_t>().timeout(rt::default_timeout).finish(10);
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::OPERATIONAL);
+    for (auto &act : actors) {
+        CHECK(act->get_state() == r::state_t::OPERATIONAL);
+    }
+    CHECK(sup->active_timers.empty());
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(sup->get_leader_queue().size() == 0);
+    CHECK(rt::empty(sup->get_subscription()));
+}
+
+TEST_CASE("misconfigured actors group", "[bulk-spawn]") {
+    rt::system_context_test_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    sup->do_process();
+
+    auto actors = sup->create_actor<rt::actor_test_t>().finish(3);
+    CHECK(actors.empty());
+    CHECK(system_context.ec == r::error_code_t::actor_misconfigured);
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+}
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "supervisor_test.h"
+#include "actor_test.h"
+#include "access.h"
+
+namespace r = rotor;
+namespace rt = r::test;
+
+namespace payload {
+struct ping_t {};
+struct pong_t {};
+struct data_t {
+    int value;
+};
+} // namespace payload
+
+namespace message {
+using ping_t = r::message_t<payload::ping_t>;
+using pong_t = r::message_t<payload::pong_t>;
+using data_t = r::message_t<payload::data_t>;
+} // namespace message
+
+struct base_actor_t : public rt::actor_test_t {
+    using rt::actor_test_t::actor_test_t;
+
+    void on_ping(message::ping_t &) noexcept { ++pings; }
+    void on_pong(message::pong_t &) noexcept { ++pongs; }
+    void on_data(message::data_t &msg) noexcept { sum += msg.payload.value; }
+
+    std::size_t pings = 0;
+    std::size_t pongs = 0;
+    int sum = 0;
+};
+
+struct table_actor_t : public base_actor_t {
+    using base_actor_t::base_actor_t;
+    using handlers_table_t =
+        r::handlers_table_t<&base_actor_t::on_ping, &base_actor_t::on_pong, &base_actor_t::on_data>;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        base_actor_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(handlers_table_t{}); });
+    }
+};
+
+struct plain_actor_t : public base_actor_t {
+    using base_actor_t::base_actor_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        base_actor_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) {
+            p.subscribe_actor(&base_actor_t::on_ping);
+            p.subscribe_actor(&base_actor_t::on_pong);
+            p.subscribe_actor(&base_actor_t::on_data);
+        });
+    }
+};
+
+template <typename Actor>
+std::size_t count_confirmations(rt::supervisor_test_t &sup, r::intrusive_ptr_t<Actor> &act) {
+    std::size_t counter = 0;
+    act = sup.create_actor<Actor>().timeout(rt::default_timeout).finish();
+    act->subscribe(r::lambda<r::message::subscription_t>([&](auto &) { ++counter; }));
+    sup.do_process();
+    return counter;
+}
+
+TEST_CASE("handlers table", "[handlers-table]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    sup->do_process();
+
+    // the whole table is confirmed at once
+    r::intrusive_ptr_t<plain_actor_t> plain;
+    r::intrusive_ptr_t<table_actor_t> act;
+    auto plain_confirmations = count_confirmations(*sup, plain);
+    auto table_confirmations = count_confirmations(*sup, act);
+    CHECK(table_confirmations + 2 == plain_confirmations);
+
+    REQUIRE(act->get_state() == r::state_t::OPERATIONAL);
+    REQUIRE(plain->get_state() == r::state_t::OPERATIONAL);
+
+    auto &addr = act->get_address();
+    act->send<payload::ping_t>(addr);
+    act->send<payload::pong_t>(addr);
+    act->send<payload::data_t>(addr, 3);
+    act->send<payload::data_t>(addr, 4);
+    sup->do_process();
+    CHECK(act->pings == 1);
+    CHECK(act->pongs == 1);
+    CHECK(act->sum == 7);
+
+    act->do_shutdown();
+    sup->do_process();
+    CHECK(act->get_state() == r::state_t::SHUT_DOWN);
+
+    // no more handlers on the address
+    plain->send<payload::ping_t>(addr);
+    sup->do_process();
+    CHECK(act->pings == 1);
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(sup->get_leader_queue().size() == 0);
+    CHECK(rt::empty(sup->get_subscription()));
+}
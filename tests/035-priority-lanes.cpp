@@ -0,0 +1,213 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "supervisor_test.h"
+#include "actor_test.h"
+#include "access.h"
+#include <vector>
+
+namespace r = rotor;
+namespace rt = r::test;
+
+namespace payload {
+struct urgent_t {
+    int value;
+};
+struct regular_t {
+    int value;
+};
+struct bulky_t {
+    int value;
+};
+struct answer_t {
+    int value;
+};
+struct ask_t {
+    using response_t = answer_t;
+};
+} // namespace payload
+
+namespace message {
+using urgent_t = r::message_t<payload::urgent_t>;
+using regular_t = r::message_t<payload::regular_t>;
+using bulky_t = r::message_t<payload::bulky_t>;
+using ask_t = r::request_traits_t<payload::ask_t>::response::message_t;
+} // namespace message
+
+namespace rotor {
+template <> struct payload_lane_t<::payload::urgent_t> : lane_constant_t<message_lane_t::high> {};
+template <> struct payload_lane_t<::payload::bulky_t> : lane_constant_t<message_lane_t::bulk> {};
+template <> struct payload_lane_t<::payload::ask_t> : lane_constant_t<message_lane_t::bulk> {};
+} // namespace rotor
+
+struct sample_actor_t : public rt::actor_test_t {
+    using rt::actor_test_t::actor_test_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        rt::actor_test_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) {
+            p.subscribe_actor(&sample_actor_t::on_urgent);
+            p.subscribe_actor(&sample_actor_t::on_regular);
+            p.subscribe_actor(&sample_actor_t::on_bulky);
+            p.subscribe_actor(&sample_actor_t::on_answer);
+        });
+    }
+
+    void on_urgent(message::urgent_t &msg) noexcept { received.push_back(msg.payload.value); }
+    void on_regular(message::regular_t &msg) noexcept { received.push_back(msg.payload.value); }
+    void on_bulky(message::bulky_t &msg) noexcept { received.push_back(msg.payload.value); }
+    void on_answer(message::ask_t &msg) noexcept { received.push_back(msg.payload.ec ? -1 : msg.payload.res.value); }
+
+    std::vector<int> received;
+};
+
+struct fixture_t {
+    template <typename Builder> fixture_t(Builder &&builder) {
+        sup = std::forward<Builder>(builder).timeout(rt::default_timeout).finish();
+        act = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+        sup->do_process();
+        REQUIRE(act->get_state() == r::state_t::OPERATIONAL);
+        REQUIRE(sup->get_leader_queue().empty());
+    }
+
+    void send_all() {
+        auto &addr = act->get_address();
+        for (int i = 0; i < 3; ++i) {
+            sup->send<payload::bulky_t>(addr, 100 + i);
+            sup->send<payload::regular_t>(addr, 10 + i);
+            sup->send<payload::urgent_t>(addr, 20 + i);
+        }
+    }
+
+    void shutdown() {
+        sup->do_shutdown();
+        sup->do_process();
+        CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+        CHECK(sup->get_leader_queue().empty());
+        CHECK(rt::empty(sup->get_subscription()));
+    }
+
+    r::intrusive_ptr_t<rt::supervisor_test_t> sup;
+    r::intrusive_ptr_t<sample_actor_t> act;
+};
+
+TEST_CASE("lanes are disabled by default", "[lanes]") {
+    r::system_context_t ctx;
+    fixture_t f(ctx.create_supervisor<rt::supervisor_test_t>());
+    f.send_all();
+    CHECK(!f.sup->get_leader_queue().has_lanes());
+    f.sup->do_process();
+    CHECK(f.act->received == std::vector<int>{100, 10, 20, 101, 11, 21, 102, 12, 22});
+    f.shutdown();
+}
+
+TEST_CASE("weighted lanes draining", "[lanes]") {
+    r::system_context_t ctx;
+    fixture_t f(ctx.create_supervisor<rt::supervisor_test_t>().lane_weights({2, 1, 1}));
+    CHECK(f.sup->get_leader_queue().has_lanes());
+    f.send_all();
+    f.sup->do_process();
+    CHECK(f.act->received == std::vector<int>{20, 21, 10, 100, 22, 11, 101, 12, 102});
+    f.shutdown();
+}
+
+TEST_CASE("message lane is chosen upon construction", "[lanes]") {
+    r::system_context_t ctx;
+    fixture_t f(ctx.create_supervisor<rt::supervisor_test_t>().lane_weights({2, 1, 1}));
+    auto &addr = f.act->get_address();
+    f.sup->send<payload::regular_t>(addr, 10);
+    f.sup->put(r::make_message<payload::regular_t>(r::message_lane_t::high, addr, 11));
+    CHECK(f.sup->get_leader_queue().lane(r::message_lane_t::high).size() == 1);
+    f.sup->do_process();
+    CHECK(f.act->received == std::vector<int>{11, 10});
+    f.shutdown();
+}
+
+TEST_CASE("lifecycle messages are not stuck behind user messages", "[lanes]") {
+    r::system_context_t ctx;
+    fixture_t f(ctx.create_supervisor<rt::supervisor_test_t>().lane_weights(r::messages_queue_t::default_weights));
+    f.send_all();
+    f.act->do_shutdown();
+    auto &system_lane = f.sup->get_leader_queue().lane(r::message_lane_t::system);
+    REQUIRE(system_lane.size() == 1);
+
+    // the actor is shut down before the user messages, which are dropped then
+    f.sup->do_process();
+    CHECK(f.act->get_state() == r::state_t::SHUT_DOWN);
+    CHECK(f.act->received.empty());
+    f.shutdown();
+}
+
+TEST_CASE("the oldest message of the lowest lane is dropped on overflow", "[lanes]") {
+    r::system_context_t ctx;
+    fixture_t f(ctx.create_supervisor<rt::supervisor_test_t>()
+                    .lane_weights(r::messages_queue_t::default_weights)
+                    .queue_capacity(3)
+                    .overflow_policy(r::overflow_policy_t::drop_oldest));
+    auto &addr = f.act->get_address();
+    f.sup->send<payload::regular_t>(addr, 10);
+    f.sup->send<payload::bulky_t>(addr, 100);
+    f.sup->send<payload::regular_t>(addr, 11);
+    f.sup->send<payload::urgent_t>(addr, 20);
+    f.sup->do_process();
+    CHECK(f.act->received == std::vector<int>{20, 10, 11});
+    f.shutdown();
+}
+
+TEST_CASE("only the most recent message can be taken back", "[lanes]") {
+    r::system_context_t ctx;
+    fixture_t f(ctx.create_supervisor<rt::supervisor_test_t>().lane_weights(r::messages_queue_t::default_weights));
+    auto &addr = f.act->get_address();
+    auto value = [](r::message_ptr_t &message) {
+        if (message->type_index == message::urgent_t::message_type) {
+            return static_cast<message::urgent_t *>(message.get())->payload.value;
+        }
+        return static_cast<message::regular_t *>(message.get())->payload.value;
+    };
+
+    r::messages_queue_t queue;
+    queue.set_weights(r::messages_queue_t::default_weights);
+    queue.emplace_back(r::make_message<payload::regular_t>(addr, 10));
+    queue.emplace_back(r::make_message<payload::urgent_t>(addr, 20));
+    queue.emplace_back(r::make_message<payload::regular_t>(addr, 11));
+    CHECK(value(queue.back()) == 11);
+    queue.pop_back();
+    CHECK(queue.size() == 2);
+
+    queue.emplace_back(r::make_message<payload::regular_t>(addr, 12));
+    CHECK(value(queue.front()) == 20);
+    queue.pop_front();
+    CHECK(value(queue.back()) == 12);
+    queue.pop_back();
+    REQUIRE(queue.size() == 1);
+    CHECK(value(queue.front()) == 10);
+    queue.clear();
+    f.shutdown();
+}
+
+TEST_CASE("request timeout is not stuck behind user messages", "[lanes]") {
+    r::system_context_t ctx;
+    fixture_t f(ctx.create_supervisor<rt::supervisor_test_t>().lane_weights(r::messages_queue_t::default_weights));
+    CHECK(r::payload_lane_t<r::payload::state_request_t>::value == r::message_lane_t::system);
+    CHECK(r::payload_lane_t<r::payload::discovery_request_t>::value == r::message_lane_t::system);
+
+    // nobody answers the request
+    f.act->request<payload::ask_t>(f.sup->make_address()).send(rt::default_timeout);
+    f.sup->do_process();
+    REQUIRE(f.sup->active_timers.size() == 1);
+    f.send_all();
+    f.sup->on_timer_trigger(*f.sup->active_timers.begin());
+    auto &system_lane = f.sup->get_leader_queue().lane(r::message_lane_t::system);
+    REQUIRE(system_lane.size() == 1);
+
+    // the timeout response, i.e. the error, is delivered first
+    f.sup->do_process();
+    REQUIRE(f.act->received.size() == 10);
+    CHECK(f.act->received.front() == -1);
+    f.shutdown();
+}
@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "supervisor_test.h"
+#include "actor_test.h"
+#include "system_context_test.h"
+#include <chrono>
+#include <thread>
+
+namespace r = rotor;
+namespace rt = r::test;
+
+namespace payload {
+struct sample_t {};
+} // namespace payload
+
+namespace message {
+using sample_t = r::message_t<payload::sample_t>;
+}
+
+struct sample_actor_t : public rt::actor_test_t {
+    using rt::actor_test_t::actor_test_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        rt::actor_test_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&sample_actor_t::on_sample); });
+    }
+
+    void on_sample(message::sample_t &) noexcept {
+        ++received;
+        if (delay.count()) {
+            std::this_thread::sleep_for(delay);
+        }
+    }
+
+    std::size_t received = 0;
+    std::chrono::milliseconds delay{0};
+};
+
+TEST_CASE("messages budget", "[process-budget]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>()
+                   .timeout(rt::default_timeout)
+                   .process_budget(3)
+                   .finish();
+    auto act = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    while (!sup->get_leader_queue().empty()) {
+        sup->do_process();
+    }
+    REQUIRE(act->get_state() == r::state_t::OPERATIONAL);
+
+    auto &stats = sup->get_process_stats();
+    auto runs = stats.runs.load();
+    auto hits = stats.budget_hits.load();
+    auto messages = stats.messages.load();
+
+    for (int i = 0; i < 8; ++i) {
+        sup->send<payload::sample_t>(act->get_address());
+    }
+    sup->do_process();
+    CHECK(act->received == 3);
+    CHECK(sup->get_leader_queue().size() == 5);
+    sup->do_process();
+    CHECK(act->received == 6);
+    sup->do_process();
+    CHECK(act->received == 8);
+    CHECK(sup->get_leader_queue().empty());
+
+    CHECK(stats.runs == runs + 3);
+    CHECK(stats.budget_hits == hits + 2);
+    CHECK(stats.messages == messages + 8);
+
+    sup->do_shutdown();
+    while (!sup->get_leader_queue().empty()) {
+        sup->do_process();
+    }
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+}
+
+TEST_CASE("time budget", "[process-budget]") {
+    r::system_context_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>()
+                   .timeout(rt::default_timeout)
+                   .process_time_budget(r::pt::milliseconds{1})
+                   .finish();
+    auto act = sup->create_actor<sample_actor_t>().timeout(rt::default_timeout).finish();
+    while (!sup->get_leader_queue().empty()) {
+        sup->do_process();
+    }
+    REQUIRE(act->get_state() == r::state_t::OPERATIONAL);
+
+    // at least one message is processed per run
+    act->delay = std::chrono::milliseconds{2};
+    for (int i = 0; i < 3; ++i) {
+        sup->send<payload::sample_t>(act->get_address());
+    }
+    sup->do_process();
+    CHECK(act->received == 1);
+    sup->do_process();
+    CHECK(act->received == 2);
+    CHECK(sup->get_process_stats().budget_hits >= 2);
+
+    act->delay = std::chrono::milliseconds{0};
+    sup->do_shutdown();
+    while (!sup->get_leader_queue().empty()) {
+        sup->do_process();
+    }
+    CHECK(sup->get_state() == r::state_t::SHUT_DOWN);
+}
+
+TEST_CASE("negative time budget is invalid", "[process-budget]") {
+    rt::system_context_test_t system_context;
+    auto sup = system_context.create_supervisor<rt::supervisor_test_t>()
+                   .timeout(rt::default_timeout)
+                   .process_time_budget(r::pt::milliseconds{-1})
+                   .finish();
+    CHECK(!sup);
+    CHECK(system_context.ec == r::error_code_t::actor_misconfigured);
+}
@@ -0,0 +1,263 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "supervisor_test.h"
+#include "system_context_test.h"
+#include <unordered_map>
+
+namespace r = rotor;
+namespace rt = r::test;
+
+namespace payload {
+
+struct quote_t {
+    std::string symbol;
+    double price;
+    std::int32_t change;
+    std::uint64_t volume;
+};
+
+struct sum_response_t {
+    std::int64_t sum;
+};
+
+struct sum_request_t {
+    using response_t = sum_response_t;
+    std::int64_t a;
+    std::int64_t b;
+};
+
+} // namespace payload
+
+template <> struct rotor::serializer_t<payload::quote_t> {
+    static constexpr std::uint32_t type_id = 1000;
+    static void encode(encoder_t &e, const ::payload::quote_t &p) noexcept {
+        e.put(p.symbol);
+        e.put(p.price);
+        e.put(p.change);
+        e.put(p.volume);
+    }
+    static bool decode(decoder_t &d, ::payload::quote_t &p) noexcept {
+        return d.get(p.symbol) && d.get(p.price) && d.get(p.change) && d.get(p.volume);
+    }
+};
+
+template <> struct rotor::serializer_t<payload::sum_request_t> {
+    static constexpr std::uint32_t type_id = 1001;
+    static void encode(encoder_t &e, const ::payload::sum_request_t &p) noexcept {
+        e.put(p.a);
+        e.put(p.b);
+    }
+    static bool decode(decoder_t &d, ::payload::sum_request_t &p) noexcept { return d.get(p.a) && d.get(p.b); }
+};
+
+struct addresses_t : r::address_codec_t {
+    std::uint64_t encode(const r::address_ptr_t &address) noexcept override {
+        for (auto &it : map) {
+            if (it.second == address) {
+                return it.first;
+            }
+        }
+        return 0;
+    }
+
+    r::address_ptr_t decode(std::uint64_t id) noexcept override {
+        auto it = map.find(id);
+        return it != map.end() ? it->second : r::address_ptr_t{};
+    }
+
+    std::unordered_map<std::uint64_t, r::address_ptr_t> map;
+};
+
+TEST_CASE("primitives", "[serialization]") {
+    r::serialization_buffer_t buffer;
+    r::encoder_t encoder(buffer);
+    encoder.put(true);
+    encoder.put(std::uint8_t{200});
+    encoder.put(std::uint64_t{0});
+    encoder.put(std::numeric_limits<std::uint64_t>::max());
+    encoder.put(std::int32_t{-1});
+    encoder.put(std::numeric_limits<std::int64_t>::min());
+    encoder.put(3.25);
+    encoder.put(-0.5f);
+    encoder.put(std::string("hello"));
+    encoder.put(r::state_t::OPERATIONAL);
+    encoder.put(r::make_error_code(r::error_code_t::request_timeout));
+    encoder.put(std::error_code(EINVAL, std::system_category()));
+    encoder.put(std::error_code{});
+
+    // bool, then varint 200 in two bytes, then zero in single byte
+    CHECK(buffer[0] == 1);
+    CHECK(buffer[1] == 0xC8);
+    CHECK(buffer[2] == 0x01);
+    CHECK(buffer[3] == 0x00);
+
+    r::decoder_t decoder(buffer.data(), buffer.size());
+    bool b = false;
+    std::uint8_t u8 = 0;
+    std::uint64_t u64_zero = 1, u64_max = 0;
+    std::int32_t i32 = 0;
+    std::int64_t i64 = 0;
+    double d = 0;
+    float f = 0;
+    std::string s;
+    r::state_t state;
+    std::error_code ec1, ec2, ec3 = r::make_error_code(r::error_code_t::request_timeout);
+    CHECK(decoder.get(b));
+    CHECK(decoder.get(u8));
+    CHECK(decoder.get(u64_zero));
+    CHECK(decoder.get(u64_max));
+    CHECK(decoder.get(i32));
+    CHECK(decoder.get(i64));
+    CHECK(decoder.get(d));
+    CHECK(decoder.get(f));
+    CHECK(decoder.get(s));
+    CHECK(decoder.get(state));
+    CHECK(decoder.get(ec1));
+    CHECK(decoder.get(ec2));
+    CHECK(decoder.get(ec3));
+    CHECK(decoder.remaining() == 0);
+    CHECK(!decoder.has_failed());
+
+    CHECK(b);
+    CHECK(u8 == 200);
+    CHECK(u64_zero == 0);
+    CHECK(u64_max == std::numeric_limits<std::uint64_t>::max());
+    CHECK(i32 == -1);
+    CHECK(i64 == std::numeric_limits<std::int64_t>::min());
+    CHECK(d == 3.25);
+    CHECK(f == -0.5f);
+    CHECK(s == "hello");
+    CHECK(state == r::state_t::OPERATIONAL);
+    CHECK(ec1 == r::error_code_t::request_timeout);
+    CHECK(ec2 == std::error_code(EINVAL, std::system_category()));
+    CHECK(!ec3);
+}
+
+TEST_CASE("malformed input", "[serialization]") {
+    r::serialization_buffer_t buffer;
+    r::encoder_t encoder(buffer);
+    encoder.put(std::string("truncated string"));
+    encoder.put(std::uint32_t{300});
+
+    SECTION("truncated") {
+        r::decoder_t decoder(buffer.data(), 5);
+        std::string s;
+        CHECK(!decoder.get(s));
+        CHECK(decoder.has_failed());
+        std::uint8_t u8;
+        CHECK(!decoder.get(u8));
+    }
+
+    SECTION("out of range") {
+        r::decoder_t decoder(buffer.data(), buffer.size());
+        std::string s;
+        CHECK(decoder.get(s));
+        std::uint8_t u8;
+        CHECK(!decoder.get(u8));
+        CHECK(decoder.has_failed());
+    }
+
+    SECTION("too long varint") {
+        std::uint8_t bytes[11];
+        std::fill(std::begin(bytes), std::end(bytes), 0xFF);
+        r::decoder_t decoder(bytes, sizeof(bytes));
+        std::uint64_t value;
+        CHECK(!decoder.get(value));
+    }
+}
+
+TEST_CASE("registry", "[serialization]") {
+    r::system_context_ptr_t system_context = new rt::system_context_test_t();
+    auto sup = system_context->create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto addr_1 = sup->make_address();
+    auto addr_2 = sup->make_address();
+    addresses_t addresses;
+    addresses.map[1] = addr_1;
+    addresses.map[2] = addr_2;
+
+    r::serialization_registry_t registry;
+    registry.add_builtin();
+    CHECK(registry.add<payload::quote_t>());
+    CHECK(registry.add_request<payload::sum_request_t>());
+    CHECK(registry.add<payload::quote_t>());
+
+    using request_t = r::request_traits_t<payload::sum_request_t>::request::wrapped_t;
+    auto entry = registry.find(r::message_t<payload::quote_t>::message_type);
+    REQUIRE(entry);
+    CHECK(entry->type_id == 1000);
+    CHECK(registry.find(1001 | r::request_type_bit) == registry.find(r::message_t<request_t>::message_type));
+    CHECK(!registry.find(1001));
+    CHECK(!registry.find(r::message::create_actor_t::message_type));
+
+    SECTION("user message") {
+        r::serialization_buffer_t buffer;
+        r::encoder_t encoder(buffer, &addresses);
+        auto msg = r::make_message<payload::quote_t>(addr_1, "AAPL", 115.5, -3, 1000000u);
+        CHECK(registry.encode(encoder, *msg));
+
+        r::decoder_t decoder(buffer.data(), buffer.size(), &addresses);
+        auto copy = registry.decode(decoder, addr_2);
+        REQUIRE(copy);
+        CHECK(copy->type_index == r::message_t<payload::quote_t>::message_type);
+        CHECK(copy->address == addr_2);
+        auto &p = static_cast<r::message_t<payload::quote_t> &>(*copy).payload;
+        CHECK(p.symbol == "AAPL");
+        CHECK(p.price == 115.5);
+        CHECK(p.change == -3);
+        CHECK(p.volume == 1000000u);
+
+        r::decoder_t truncated(buffer.data(), buffer.size() - 1, &addresses);
+        CHECK(!registry.decode(truncated, addr_2));
+    }
+
+    SECTION("request") {
+        r::serialization_buffer_t buffer;
+        r::encoder_t encoder(buffer, &addresses);
+        auto msg = r::make_message<request_t>(addr_1, r::request_id_t{42}, addr_2, addr_1, -5, 7);
+        CHECK(registry.encode(encoder, *msg));
+
+        r::decoder_t decoder(buffer.data(), buffer.size(), &addresses);
+        auto copy = registry.decode(decoder, addr_1);
+        REQUIRE(copy);
+        auto &p = static_cast<r::message_t<request_t> &>(*copy).payload;
+        CHECK(p.id == 42);
+        CHECK(p.reply_to == addr_2);
+        CHECK(p.origin == addr_1);
+        CHECK(p.request_payload.a == -5);
+        CHECK(p.request_payload.b == 7);
+    }
+
+    SECTION("builtin") {
+        r::serialization_buffer_t buffer;
+        r::encoder_t encoder(buffer, &addresses);
+        auto msg = r::make_message<r::payload::discovery_cancel_t>(addr_1, addr_2, "service");
+        CHECK(registry.encode(encoder, *msg));
+        auto unknown = r::make_message<r::payload::deregistration_notify_t>(addr_1, sup->make_address());
+        CHECK(registry.encode(encoder, *unknown));
+        auto not_serializable = r::make_message<r::payload::create_actor_t>(addr_1);
+        CHECK(!registry.encode(encoder, *not_serializable));
+
+        r::decoder_t decoder(buffer.data(), buffer.size(), &addresses);
+        auto copy = registry.decode(decoder, addr_1);
+        REQUIRE(copy);
+        auto &p = static_cast<r::message::discovery_cancel_t &>(*copy).payload;
+        CHECK(p.client_addr == addr_2);
+        CHECK(p.service_name == "service");
+
+        // the address without mapping is decoded as null
+        auto copy_2 = registry.decode(decoder, addr_1);
+        REQUIRE(copy_2);
+        CHECK(!static_cast<r::message::deregistration_notify_t &>(*copy_2).payload.service_addr);
+        CHECK(decoder.remaining() == 0);
+    }
+
+    sup->do_process();
+    sup->do_shutdown();
+    sup->do_process();
+}
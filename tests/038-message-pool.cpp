@@ -0,0 +1,144 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+namespace r = rotor;
+
+/* the global heap usage is counted per thread, i.e. the pool misses are observable */
+static thread_local std::size_t heap_allocations = 0;
+static thread_local std::size_t heap_deallocations = 0;
+
+void *operator new(std::size_t size) {
+    ++heap_allocations;
+    if (auto ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    if (ptr) {
+        ++heap_deallocations;
+        std::free(ptr);
+    }
+}
+
+void operator delete(void *ptr, std::size_t) noexcept { ::operator delete(ptr); }
+
+struct sample_t {
+    int value;
+};
+
+using sample_msg_t = r::message_t<sample_t>;
+
+struct capacity_guard_t {
+    capacity_guard_t(std::size_t value) : saved{r::message_pool_t::get_capacity()} {
+        r::message_pool_t::set_capacity(value);
+    }
+    ~capacity_guard_t() { r::message_pool_t::set_capacity(saved); }
+    std::size_t saved;
+};
+
+TEST_CASE("block is reused within size class", "[message-pool]") {
+    capacity_guard_t guard(r::message_pool_t::default_capacity);
+    auto block = r::message_pool_t::allocate(40);
+    r::message_pool_t::deallocate(block, 40);
+
+    auto allocations = heap_allocations;
+    // 33..48 bytes are the same size class
+    auto same = r::message_pool_t::allocate(33);
+    CHECK(heap_allocations == allocations);
+    CHECK(same == block);
+
+    r::message_pool_t::deallocate(same, 33);
+    auto other = r::message_pool_t::allocate(50);
+    CHECK(heap_allocations == allocations + 1);
+    CHECK(other != block);
+
+    auto deallocations = heap_deallocations;
+    r::message_pool_t::deallocate(other, 50);
+    CHECK(heap_deallocations == deallocations);
+    CHECK(r::message_pool_t::allocate(48) == block);
+    r::message_pool_t::deallocate(block, 48);
+}
+
+TEST_CASE("zero capacity disables caching", "[message-pool]") {
+    capacity_guard_t guard(0);
+    auto block = r::message_pool_t::allocate(64);
+
+    auto deallocations = heap_deallocations;
+    r::message_pool_t::deallocate(block, 64);
+    CHECK(heap_deallocations == deallocations + 1);
+
+    auto allocations = heap_allocations;
+    auto msg = r::make_message<sample_t>(r::address_ptr_t{}, 5);
+    CHECK(heap_allocations == allocations + 1);
+    msg.reset();
+    CHECK(heap_deallocations == deallocations + 2);
+}
+
+TEST_CASE("large messages bypass the pool", "[message-pool]") {
+    capacity_guard_t guard(r::message_pool_t::default_capacity);
+    auto size = r::message_pool_t::max_block_size + 1;
+
+    auto allocations = heap_allocations;
+    auto block = r::message_pool_t::allocate(size);
+    CHECK(heap_allocations == allocations + 1);
+
+    auto deallocations = heap_deallocations;
+    r::message_pool_t::deallocate(block, size);
+    CHECK(heap_deallocations == deallocations + 1);
+
+    auto next = r::message_pool_t::allocate(size);
+    CHECK(heap_allocations == allocations + 2);
+    r::message_pool_t::deallocate(next, size);
+}
+
+TEST_CASE("message is freed on another thread", "[message-pool]") {
+    capacity_guard_t guard(r::message_pool_t::default_capacity);
+    constexpr auto size = sizeof(sample_msg_t);
+    static_assert(size <= r::message_pool_t::max_block_size, "sample message is pooled");
+
+    auto msg = r::make_message<sample_t>(r::address_ptr_t{}, 5);
+    auto raw = static_cast<void *>(msg.get());
+
+    // the cached block of this thread, it should survive the foreign deallocation
+    auto cached = r::message_pool_t::allocate(size);
+    r::message_pool_t::deallocate(cached, size);
+    CHECK(raw != cached);
+
+    void *reused = nullptr;
+    void *fresh = nullptr;
+    std::size_t foreign_allocations = 0;
+    std::size_t foreign_deallocations = 0;
+    std::thread thread([&]() {
+        msg.reset();
+        // the block has migrated into the free-list of this thread
+        reused = r::message_pool_t::allocate(size);
+        fresh = r::message_pool_t::allocate(size);
+        r::message_pool_t::deallocate(fresh, size);
+        r::message_pool_t::deallocate(reused, size);
+        foreign_allocations = heap_allocations;
+        foreign_deallocations = heap_deallocations;
+    });
+    thread.join();
+
+    CHECK(reused == raw);
+    CHECK(fresh != raw);
+    CHECK(foreign_allocations == 1);
+    CHECK(foreign_deallocations == 0);
+
+    auto allocations = heap_allocations;
+    auto mine = r::message_pool_t::allocate(size);
+    CHECK(heap_allocations == allocations);
+    CHECK(mine == cached);
+    r::message_pool_t::deallocate(mine, size);
+}
@@ -0,0 +1,75 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "rotor/asio.hpp"
+#include "supervisor_asio_test.h"
+#include "access.h"
+
+namespace r = rotor;
+namespace ra = rotor::asio;
+namespace rt = r::test;
+namespace asio = boost::asio;
+namespace pt = boost::posix_time;
+
+namespace payload {
+struct tick_t {};
+} // namespace payload
+
+namespace message {
+using tick_t = r::message_t<payload::tick_t>;
+}
+
+/* floods the queue with self-generated messages */
+struct storm_actor_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&storm_actor_t::on_tick); });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        send<payload::tick_t>(address);
+    }
+
+    void on_tick(message::tick_t &) noexcept {
+        ++ticks;
+        send<payload::tick_t>(address);
+    }
+
+    std::size_t ticks = 0;
+};
+
+TEST_CASE("messages storm does not starve I/O", "[supervisor][asio]") {
+    asio::io_context io_context{1};
+    auto timeout = r::pt::milliseconds{100};
+    auto system_context = ra::system_context_asio_t::ptr_t{new ra::system_context_asio_t(io_context)};
+    auto strand = std::make_shared<asio::io_context::strand>(io_context);
+
+    auto sup = system_context->create_supervisor<rt::supervisor_asio_test_t>()
+                   .strand(strand)
+                   .timeout(timeout)
+                   .process_budget(100)
+                   .finish();
+    auto actor = sup->create_actor<storm_actor_t>().timeout(timeout).finish();
+
+    // the plain asio timer (i.e. not the supervisor one) stops the storm
+    asio::deadline_timer timer(io_context);
+    timer.expires_from_now(pt::milliseconds{5});
+    timer.async_wait([&](const boost::system::error_code &) { sup->shutdown(); });
+
+    sup->start();
+    io_context.run();
+
+    CHECK(actor->ticks > 0);
+    CHECK(sup->get_process_stats().budget_hits > 0);
+    REQUIRE(sup->get_state() == r::state_t::SHUT_DOWN);
+    REQUIRE(sup->get_leader_queue().size() == 0);
+    CHECK(rt::empty(sup->get_subscription()));
+}
@@ -0,0 +1,512 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "rotor/asio.hpp"
+#include "supervisor_asio_test.h"
+#include "supervisor_test.h"
+#include "system_context_test.h"
+#include "access.h"
+#include <algorithm>
+
+namespace r = rotor;
+namespace ra = rotor::asio;
+namespace rt = r::test;
+namespace asio = boost::asio;
+
+namespace payload {
+
+struct ping_t {
+    std::string text;
+};
+
+struct hello_t {
+    rotor::address_ptr_t from;
+};
+
+struct sum_response_t {
+    std::uint64_t sum;
+};
+
+struct sum_request_t {
+    using response_t = sum_response_t;
+    std::uint32_t a;
+    std::uint32_t b;
+};
+
+} // namespace payload
+
+template <> struct rotor::serializer_t<payload::ping_t> {
+    static constexpr std::uint32_t type_id = 1000;
+    static void encode(encoder_t &e, const ::payload::ping_t &p) noexcept { e.put(p.text); }
+    static bool decode(decoder_t &d, ::payload::ping_t &p) noexcept { return d.get(p.text); }
+};
+
+template <> struct rotor::serializer_t<payload::hello_t> {
+    static constexpr std::uint32_t type_id = 1003;
+    static void encode(encoder_t &e, const ::payload::hello_t &p) noexcept { e.put(p.from); }
+    static bool decode(decoder_t &d, ::payload::hello_t &p) noexcept { return d.get(p.from); }
+};
+
+template <> struct rotor::serializer_t<payload::sum_request_t> {
+    static constexpr std::uint32_t type_id = 1001;
+    static void encode(encoder_t &e, const ::payload::sum_request_t &p) noexcept {
+        e.put(p.a);
+        e.put(p.b);
+    }
+    static bool decode(decoder_t &d, ::payload::sum_request_t &p) noexcept { return d.get(p.a) && d.get(p.b); }
+};
+
+template <> struct rotor::serializer_t<payload::sum_response_t> {
+    static constexpr std::uint32_t type_id = 1002;
+    static void encode(encoder_t &e, const ::payload::sum_response_t &p) noexcept { e.put(p.sum); }
+    static bool decode(decoder_t &d, ::payload::sum_response_t &p) noexcept { return d.get(p.sum); }
+};
+
+using sum_request_message_t = r::request_traits_t<payload::sum_request_t>::request::message_t;
+using sum_response_message_t = r::request_traits_t<payload::sum_request_t>::response::message_t;
+using sum_request_ptr_t = r::request_traits_t<payload::sum_request_t>::request::message_ptr_t;
+
+static constexpr std::uint64_t server_id = 1;
+
+static r::state_t state_of(r::actor_base_t *actor) { return actor->access<rt::to::state>(); }
+
+struct bridge_test_t : public ra::bridge_t {
+    using ra::bridge_t::bridge_t;
+
+    std::size_t get_exported() const noexcept { return exported.size(); }
+    std::size_t get_imported() const noexcept { return imported.size(); }
+    std::size_t get_pending() const noexcept { return pending.size(); }
+};
+
+struct client_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&client_t::on_sum); });
+        plugin.with_casted<r::plugin::link_client_plugin_t>([&](auto &p) {
+            p.link(server_addr, true, [&](auto &ec) mutable {
+                link_ec = ec;
+                linked = true;
+            });
+        });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        send<payload::ping_t>(server_addr, text);
+        request<payload::sum_request_t>(server_addr, 2u, 3u).send(r::pt::seconds{1});
+    }
+
+    void on_sum(sum_response_message_t &message) noexcept {
+        ec = message.payload.ec;
+        if (!ec) {
+            sum = message.payload.res.sum;
+        }
+    }
+
+    void shutdown_finish() noexcept override {
+        r::actor_base_t::shutdown_finish();
+        supervisor->do_shutdown();
+    }
+
+    r::address_ptr_t server_addr;
+    std::string text = "hello";
+    std::error_code link_ec;
+    bool linked = false;
+    std::error_code ec;
+    std::uint64_t sum = 0;
+};
+
+struct server_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) {
+            p.subscribe_actor(&server_t::on_ping);
+            p.subscribe_actor(&server_t::on_hello);
+            p.subscribe_actor(&server_t::on_sum);
+        });
+    }
+
+    void on_ping(r::message_t<payload::ping_t> &message) noexcept { ping_text = message.payload.text; }
+
+    void on_hello(r::message_t<payload::hello_t> &message) noexcept {
+        auto &from = message.payload.from;
+        if (from) {
+            ++hellos;
+            send<payload::ping_t>(from, "welcome");
+        }
+    }
+
+    void on_sum(sum_request_message_t &message) noexcept {
+        if (bridge) {
+            // hold the request, and break the connection
+            held_request.reset(&message);
+            bridge->do_shutdown();
+            return;
+        }
+        if (silent) {
+            return;
+        }
+        auto &payload = message.payload.request_payload;
+        reply_to(message, static_cast<std::uint64_t>(payload.a + payload.b));
+        if (!persistent) {
+            do_shutdown();
+        }
+    }
+
+    void shutdown_start() noexcept override {
+        had_clients = link_server->has_clients();
+        held_request.reset();
+        r::actor_base_t::shutdown_start();
+    }
+
+    r::actor_base_t *bridge = nullptr;
+    bool persistent = false;
+    bool silent = false;
+    sum_request_ptr_t held_request;
+    std::string ping_text;
+    std::size_t hellos = 0;
+    bool had_clients = true;
+};
+
+/* introduces itself to the server, i.e. its address is known to the other side only via plain message */
+struct greeter_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&greeter_t::on_ping); });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        send<payload::hello_t>(server_addr, get_address());
+    }
+
+    void on_ping(r::message_t<payload::ping_t> &message) noexcept {
+        reply_text = message.payload.text;
+        supervisor->do_shutdown();
+    }
+
+    r::address_ptr_t server_addr;
+    std::string reply_text;
+};
+
+struct spawner_t;
+
+/* short-lived requester, i.e. its address is exported automatically */
+struct asker_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&asker_t::on_sum); });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        // the scratch address is known to the other side only while the message is delivered
+        send<payload::hello_t>(server_addr, supervisor->make_address());
+        request<payload::sum_request_t>(server_addr, 1u, 2u).send(request_timeout);
+    }
+
+    void on_sum(sum_response_message_t &message) noexcept;
+
+    r::address_ptr_t server_addr;
+    r::pt::time_duration request_timeout;
+    spawner_t *spawner = nullptr;
+};
+
+struct spawner_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        spawn();
+    }
+
+    void spawn() noexcept {
+        auto asker = supervisor->create_actor<asker_t>().timeout(init_timeout).finish();
+        asker->server_addr = server_addr;
+        asker->request_timeout = request_timeout;
+        asker->spawner = this;
+    }
+
+    void on_answer(const std::error_code &ec_) noexcept {
+        ec = ec_;
+        max_exported = std::max(max_exported, bridge1->get_exported());
+        max_imported = std::max(max_imported, bridge2->get_imported());
+        max_pending = std::max(max_pending, bridge1->get_pending());
+        if (++answers < askers) {
+            spawn();
+        } else {
+            supervisor->do_shutdown();
+        }
+    }
+
+    r::address_ptr_t server_addr;
+    r::pt::time_duration request_timeout = r::pt::seconds{1};
+    bridge_test_t *bridge1 = nullptr;
+    bridge_test_t *bridge2 = nullptr;
+    std::size_t askers = 1;
+    std::size_t answers = 0;
+    std::size_t max_exported = 0;
+    std::size_t max_imported = 0;
+    std::size_t max_pending = 0;
+    std::error_code ec;
+};
+
+void asker_t::on_sum(sum_response_message_t &message) noexcept {
+    spawner->on_answer(message.payload.ec);
+    do_shutdown();
+}
+
+struct fixture_t {
+    fixture_t() {
+        sup1 = system_context->create_supervisor<rt::supervisor_asio_test_t>()
+                   .strand(strand1)
+                   .timeout(timeout)
+                   .finish();
+        sup2 = sup1->create_actor<rt::supervisor_asio_test_t>().strand(strand2).timeout(timeout).finish();
+    }
+
+    template <typename Socket> void setup(Socket &&socket1, Socket &&socket2, std::size_t max_frame = 1024) {
+        bridge1 = sup1->create_actor<bridge_test_t>()
+                      .socket(std::move(socket1))
+                      .pending_timeout(pending_timeout)
+                      .lease_timeout(lease_timeout)
+                      .timeout(timeout)
+                      .finish();
+        bridge2 = sup2->create_actor<bridge_test_t>()
+                      .socket(std::move(socket2))
+                      .max_frame(max_frame)
+                      .lease_timeout(lease_timeout)
+                      .timeout(timeout)
+                      .finish();
+        REQUIRE(bridge1);
+        REQUIRE(bridge2);
+        server = sup2->create_actor<server_t>().timeout(timeout).finish();
+        bridge2->export_address(server_id, server->get_address());
+        auto server_addr = bridge1->import_address(server_id);
+        client = sup1->create_actor<client_t>().timeout(timeout).finish();
+        client->server_addr = server_addr;
+        for (ra::bridge_t *bridge : {bridge1.get(), bridge2.get()}) {
+            bridge->register_message<payload::ping_t>();
+            bridge->register_message<payload::hello_t>();
+            bridge->register_request<payload::sum_request_t>();
+        }
+    }
+
+    void spawn(r::address_ptr_t server_addr, std::size_t askers) {
+        spawner = sup1->create_actor<spawner_t>().timeout(timeout).finish();
+        spawner->server_addr = std::move(server_addr);
+        spawner->bridge1 = bridge1.get();
+        spawner->bridge2 = bridge2.get();
+        spawner->askers = askers;
+        server->persistent = true;
+    }
+
+    void check_shutdown() {
+        CHECK(state_of(bridge1.get()) == r::state_t::SHUT_DOWN);
+        CHECK(state_of(bridge2.get()) == r::state_t::SHUT_DOWN);
+        CHECK(state_of(client.get()) == r::state_t::SHUT_DOWN);
+        CHECK(state_of(server.get()) == r::state_t::SHUT_DOWN);
+        REQUIRE(state_of(sup1.get()) == r::state_t::SHUT_DOWN);
+        REQUIRE(sup1->get_leader_queue().size() == 0);
+        CHECK(rt::empty(sup1->get_subscription()));
+        REQUIRE(state_of(sup2.get()) == r::state_t::SHUT_DOWN);
+        CHECK(rt::empty(sup2->get_subscription()));
+        // no request has been timed out or left unreplied
+        for (r::supervisor_t *sup : {sup1.get(), sup2.get()}) {
+            CHECK(sup->access<rt::to::request_map>().empty());
+        }
+    }
+
+    asio::io_context io_context{1};
+    ra::system_context_asio_t::ptr_t system_context{new ra::system_context_asio_t(io_context)};
+    ra::supervisor_config_asio_t::strand_ptr_t strand1 = std::make_shared<asio::io_context::strand>(io_context);
+    ra::supervisor_config_asio_t::strand_ptr_t strand2 = std::make_shared<asio::io_context::strand>(io_context);
+    r::pt::time_duration timeout = r::pt::milliseconds{500};
+    r::pt::time_duration pending_timeout = r::pt::seconds{60};
+    r::pt::time_duration lease_timeout = r::pt::seconds{60};
+    r::intrusive_ptr_t<rt::supervisor_asio_test_t> sup1;
+    r::intrusive_ptr_t<rt::supervisor_asio_test_t> sup2;
+    r::intrusive_ptr_t<bridge_test_t> bridge1;
+    r::intrusive_ptr_t<bridge_test_t> bridge2;
+    r::intrusive_ptr_t<client_t> client;
+    r::intrusive_ptr_t<spawner_t> spawner;
+    r::intrusive_ptr_t<server_t> server;
+};
+
+TEST_CASE("message, request and link via tcp", "[asio][bridge]") {
+    fixture_t f;
+    asio::ip::tcp::acceptor acceptor(f.io_context, {asio::ip::address_v4::loopback(), 0});
+    asio::ip::tcp::socket socket1(f.io_context);
+    asio::ip::tcp::socket socket2(f.io_context);
+    socket1.connect(acceptor.local_endpoint());
+    acceptor.accept(socket2);
+    f.setup(std::move(socket1), std::move(socket2));
+
+    f.sup1->start();
+    f.io_context.run();
+
+    CHECK(f.client->linked);
+    CHECK(!f.client->link_ec);
+    CHECK(f.server->ping_text == "hello");
+    CHECK(!f.client->ec);
+    CHECK(f.client->sum == 5);
+    // the server has unlinked the client on the other side upon its shutdown, and the
+    // client has shut down everything; i.e. there are no pending unlink requests
+    CHECK(f.bridge1->get_dropped() == 0);
+    CHECK(f.bridge2->get_dropped() == 0);
+    f.check_shutdown();
+}
+
+TEST_CASE("connection loss via unix socket", "[asio][bridge]") {
+    fixture_t f;
+    asio::local::stream_protocol::socket socket1(f.io_context);
+    asio::local::stream_protocol::socket socket2(f.io_context);
+    asio::local::connect_pair(socket1, socket2);
+    f.setup(std::move(socket1), std::move(socket2));
+    f.server->bridge = f.bridge2.get();
+
+    f.sup1->start();
+    f.io_context.run();
+
+    CHECK(f.client->linked);
+    CHECK(f.server->ping_text == "hello");
+    // the pending request is failed, the link is broken on both sides
+    CHECK(f.client->ec == r::error_code_t::transport_disconnected);
+    CHECK(!f.server->had_clients);
+    CHECK(f.bridge1->get_dropped() == 0);
+    f.check_shutdown();
+}
+
+TEST_CASE("too large frame", "[asio][bridge]") {
+    fixture_t f;
+    asio::local::stream_protocol::socket socket1(f.io_context);
+    asio::local::stream_protocol::socket socket2(f.io_context);
+    asio::local::connect_pair(socket1, socket2);
+    f.setup(std::move(socket1), std::move(socket2), 64);
+    f.client->text = std::string(100, 'x');
+
+    f.sup1->start();
+    f.io_context.run();
+
+    CHECK(f.client->linked);
+    CHECK(f.server->ping_text.empty());
+    CHECK(f.client->ec == r::error_code_t::transport_disconnected);
+    f.check_shutdown();
+}
+
+TEST_CASE("reply to the address from plain message", "[asio][bridge]") {
+    fixture_t f;
+    asio::local::stream_protocol::socket socket1(f.io_context);
+    asio::local::stream_protocol::socket socket2(f.io_context);
+    asio::local::connect_pair(socket1, socket2);
+    f.setup(std::move(socket1), std::move(socket2));
+    f.server->persistent = true;
+    auto greeter = f.sup1->create_actor<greeter_t>().timeout(f.timeout).finish();
+    greeter->server_addr = f.client->server_addr;
+
+    f.sup1->start();
+    f.io_context.run();
+
+    // the greeter address is still known by the bridges, when the server replies to it
+    CHECK(f.server->hellos == 1);
+    CHECK(greeter->reply_text == "welcome");
+    CHECK(f.bridge2->get_dropped() == 0);
+    CHECK(state_of(greeter.get()) == r::state_t::SHUT_DOWN);
+    f.check_shutdown();
+}
+
+TEST_CASE("short-lived requesters are forgotten", "[asio][bridge]") {
+    fixture_t f;
+    // the addresses are released by the other side as soon as they are not used
+    f.lease_timeout = r::pt::milliseconds{0};
+    asio::local::stream_protocol::socket socket1(f.io_context);
+    asio::local::stream_protocol::socket socket2(f.io_context);
+    asio::local::connect_pair(socket1, socket2);
+    f.setup(std::move(socket1), std::move(socket2));
+    f.spawn(f.client->server_addr, 5);
+
+    f.sup1->start();
+    f.io_context.run();
+
+    CHECK(f.spawner->answers == 5);
+    CHECK(!f.spawner->ec);
+    CHECK(f.server->hellos == 5);
+    // only the linked client address (and its proxy) might be still known
+    CHECK(f.spawner->max_exported <= 1);
+    CHECK(f.spawner->max_imported <= 1);
+    f.check_shutdown();
+}
+
+TEST_CASE("request to not exported address", "[asio][bridge]") {
+    fixture_t f;
+    f.lease_timeout = r::pt::milliseconds{0};
+    asio::local::stream_protocol::socket socket1(f.io_context);
+    asio::local::stream_protocol::socket socket2(f.io_context);
+    asio::local::connect_pair(socket1, socket2);
+    f.setup(std::move(socket1), std::move(socket2));
+    f.spawn(f.bridge1->import_address(server_id + 1), 1);
+
+    f.sup1->start();
+    f.io_context.run();
+
+    // the request is replied by the other side bridge, i.e. not timed out
+    CHECK(f.spawner->answers == 1);
+    CHECK(f.spawner->ec == r::error_code_t::transport_unknown_address);
+    CHECK(f.spawner->max_imported <= 1);
+    CHECK(f.server->hellos == 0);
+    CHECK(f.bridge2->get_dropped() == 2);
+    f.check_shutdown();
+}
+
+TEST_CASE("unanswered requests are forgotten", "[asio][bridge]") {
+    fixture_t f;
+    f.pending_timeout = r::pt::milliseconds{5};
+    f.lease_timeout = r::pt::milliseconds{0};
+    asio::local::stream_protocol::socket socket1(f.io_context);
+    asio::local::stream_protocol::socket socket2(f.io_context);
+    asio::local::connect_pair(socket1, socket2);
+    f.setup(std::move(socket1), std::move(socket2));
+    f.spawn(f.client->server_addr, 3);
+    f.spawner->request_timeout = r::pt::milliseconds{10};
+    f.server->silent = true;
+
+    f.sup1->start();
+    f.io_context.run();
+
+    CHECK(f.spawner->answers == 3);
+    CHECK(f.spawner->ec == r::error_code_t::request_timeout);
+    // the expired requests are forgotten by the timer, and their requester addresses are released;
+    // i.e. only the last request and, initially, the (silently ignored) client request might be pending
+    CHECK(f.spawner->max_pending <= 2);
+    // the client and the last requester addresses; the other side might not release them yet, as
+    // the request might time out before it has been even received
+    CHECK(f.spawner->max_exported <= 3);
+    f.check_shutdown();
+}
+
+TEST_CASE("bridge config validation", "[asio][bridge]") {
+    asio::io_context io_context{1};
+    r::system_context_ptr_t system_context{new rt::system_context_test_t()};
+    auto sup = system_context->create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    asio::ip::tcp::socket socket(io_context);
+    auto bridge = sup->create_actor<ra::bridge_t>().socket(std::move(socket)).timeout(rt::default_timeout).finish();
+    CHECK(!bridge);
+
+    sup->do_process();
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(state_of(sup.get()) == r::state_t::SHUT_DOWN);
+}
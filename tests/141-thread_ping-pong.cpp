@@ -0,0 +1,187 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "rotor/thread.hpp"
+#include "access.h"
+#include <atomic>
+
+namespace r = rotor;
+namespace rth = rotor::thread;
+namespace rt = r::test;
+
+static std::atomic<std::uint32_t> destroyed{0};
+
+struct supervisor_thread_test_t : public rth::supervisor_thread_t {
+    using rth::supervisor_thread_t::supervisor_thread_t;
+
+    ~supervisor_thread_test_t() { destroyed += 4; }
+
+    auto &get_leader_queue() { return access<rt::to::locality_leader>()->access<rt::to::queue>(); }
+    auto &get_subscription() noexcept { return subscription_map; }
+};
+
+struct ping_t {};
+struct pong_t {};
+struct go_t {};
+
+/* lets the pinger start only when the whole hierarchy is operational */
+struct root_supervisor_t : public supervisor_thread_test_t {
+    using supervisor_thread_test_t::supervisor_thread_test_t;
+
+    void on_start() noexcept override {
+        supervisor_thread_test_t::on_start();
+        send<go_t>(pinger_addr);
+    }
+
+    r::address_ptr_t pinger_addr;
+};
+
+struct pinger_t : public r::actor_base_t {
+    std::uint32_t pings_left = 1;
+    bool wait_go = false;
+    std::uint32_t ping_sent = 0;
+    std::uint32_t pong_received = 0;
+    rotor::address_ptr_t ponger_addr;
+
+    using r::actor_base_t::actor_base_t;
+    ~pinger_t() { destroyed += 1; }
+
+    void set_ponger_addr(const rotor::address_ptr_t &addr) { ponger_addr = addr; }
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) {
+            p.subscribe_actor(&pinger_t::on_pong);
+            p.subscribe_actor(&pinger_t::on_go);
+        });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        if (!wait_go) {
+            send_ping();
+        }
+    }
+
+    void on_go(rotor::message_t<go_t> &) noexcept { send_ping(); }
+
+    void on_pong(rotor::message_t<pong_t> &) noexcept {
+        ++pong_received;
+        if (pings_left) {
+            send_ping();
+        } else {
+            // root supervisor might be in the other locality
+            static_cast<rth::supervisor_thread_t *>(supervisor)->get_context()->get_supervisor()->shutdown();
+        }
+    }
+
+    void send_ping() noexcept {
+        send<ping_t>(ponger_addr);
+        ++ping_sent;
+        --pings_left;
+    }
+};
+
+struct ponger_t : public r::actor_base_t {
+    std::uint32_t pong_sent = 0;
+    std::uint32_t ping_received = 0;
+    rotor::address_ptr_t pinger_addr;
+
+    using r::actor_base_t::actor_base_t;
+    ~ponger_t() { destroyed += 2; }
+
+    void set_pinger_addr(const rotor::address_ptr_t &addr) { pinger_addr = addr; }
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&ponger_t::on_ping); });
+    }
+
+    void on_ping(rotor::message_t<ping_t> &) noexcept {
+        ++ping_received;
+        send<pong_t>(pinger_addr);
+        ++pong_sent;
+    }
+};
+
+TEST_CASE("ping/pong", "[supervisor][thread]") {
+    destroyed = 0;
+    auto system_context = rth::system_context_ptr_t{new rth::system_context_thread_t(2)};
+    auto timeout = r::pt::milliseconds{100};
+    auto sup = system_context->create_supervisor<supervisor_thread_test_t>().timeout(timeout).finish();
+
+    auto pinger = sup->create_actor<pinger_t>().timeout(timeout).finish();
+    auto ponger = sup->create_actor<ponger_t>().timeout(timeout).finish();
+    pinger->set_ponger_addr(static_cast<r::actor_base_t *>(ponger.get())->get_address());
+    ponger->set_pinger_addr(static_cast<r::actor_base_t *>(pinger.get())->get_address());
+
+    sup->start();
+    system_context->run();
+
+    REQUIRE(pinger->ping_sent == 1);
+    REQUIRE(pinger->pong_received == 1);
+    REQUIRE(ponger->pong_sent == 1);
+    REQUIRE(ponger->ping_received == 1);
+
+    pinger.reset();
+    ponger.reset();
+
+    REQUIRE(static_cast<r::actor_base_t *>(sup.get())->access<rt::to::state>() == r::state_t::SHUT_DOWN);
+    REQUIRE(sup->get_leader_queue().size() == 0);
+    CHECK(rt::empty(sup->get_subscription()));
+
+    sup.reset();
+    system_context.reset();
+
+    REQUIRE(destroyed == 1 + 2 + 4);
+}
+
+TEST_CASE("ping/pong in different localities", "[supervisor][thread]") {
+    destroyed = 0;
+    auto system_context = rth::system_context_ptr_t{new rth::system_context_thread_t(4)};
+    auto timeout = r::pt::milliseconds{100};
+    auto sup = system_context->create_supervisor<root_supervisor_t>().timeout(timeout).finish();
+    auto sup1 = sup->create_actor<supervisor_thread_test_t>().timeout(timeout).finish();
+    auto sup2 = sup->create_actor<supervisor_thread_test_t>().timeout(timeout).finish();
+
+    CHECK(sup1->access<rt::to::locality_leader>() == sup1.get());
+    CHECK(sup2->access<rt::to::locality_leader>() == sup2.get());
+
+    auto pinger = sup1->create_actor<pinger_t>().timeout(timeout).finish();
+    auto ponger = sup2->create_actor<ponger_t>().timeout(timeout).finish();
+    pinger->pings_left = 1000;
+    pinger->wait_go = true;
+    sup->pinger_addr = static_cast<r::actor_base_t *>(pinger.get())->get_address();
+    pinger->set_ponger_addr(static_cast<r::actor_base_t *>(ponger.get())->get_address());
+    ponger->set_pinger_addr(static_cast<r::actor_base_t *>(pinger.get())->get_address());
+
+    sup->start();
+    system_context->run();
+
+    REQUIRE(pinger->ping_sent == 1000);
+    REQUIRE(pinger->pong_received == 1000);
+    REQUIRE(ponger->pong_sent == 1000);
+    REQUIRE(ponger->ping_received == 1000);
+
+    pinger.reset();
+    ponger.reset();
+
+    REQUIRE(static_cast<r::actor_base_t *>(sup.get())->access<rt::to::state>() == r::state_t::SHUT_DOWN);
+    REQUIRE(static_cast<r::actor_base_t *>(sup1.get())->access<rt::to::state>() == r::state_t::SHUT_DOWN);
+    REQUIRE(static_cast<r::actor_base_t *>(sup2.get())->access<rt::to::state>() == r::state_t::SHUT_DOWN);
+    REQUIRE(sup->get_leader_queue().size() == 0);
+    CHECK(rt::empty(sup->get_subscription()));
+    CHECK(rt::empty(sup1->get_subscription()));
+    CHECK(rt::empty(sup2->get_subscription()));
+
+    sup1.reset();
+    sup2.reset();
+    sup.reset();
+    system_context.reset();
+
+    REQUIRE(destroyed == 1 + 2 + 4 * 3);
+}
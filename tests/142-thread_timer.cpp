@@ -0,0 +1,140 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "rotor/thread.hpp"
+#include "access.h"
+#include <atomic>
+#include <chrono>
+
+namespace r = rotor;
+namespace rth = rotor::thread;
+namespace pt = boost::posix_time;
+namespace rt = r::test;
+
+struct sample_res_t {};
+struct sample_req_t {
+    using response_t = sample_res_t;
+};
+
+using traits_t = r::request_traits_t<sample_req_t>;
+
+struct bad_actor_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+    std::error_code ec;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&bad_actor_t::on_response); });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        request<traits_t::request::type>(address).send(r::pt::milliseconds(1));
+    }
+
+    void on_response(traits_t::response::message_t &msg) noexcept {
+        ec = msg.payload.ec;
+        supervisor->do_shutdown();
+    }
+};
+
+TEST_CASE("timer (via timer wheel)", "[supervisor][thread]") {
+    auto system_context = rth::system_context_ptr_t{new rth::system_context_thread_t(2)};
+    auto timeout = r::pt::milliseconds{10};
+    auto sup = system_context->create_supervisor<rth::supervisor_thread_t>().timeout(timeout).finish();
+    auto actor = sup->create_actor<bad_actor_t>().timeout(timeout).finish();
+
+    sup->start();
+    system_context->run();
+
+    REQUIRE(actor->ec == r::error_code_t::request_timeout);
+    REQUIRE(static_cast<r::actor_base_t *>(sup.get())->access<rt::to::state>() == r::state_t::SHUT_DOWN);
+}
+
+TEST_CASE("timer (per-request timers)", "[supervisor][thread]") {
+    auto system_context = rth::system_context_ptr_t{new rth::system_context_thread_t(2)};
+    auto timeout = r::pt::milliseconds{10};
+    auto sup = system_context->create_supervisor<rth::supervisor_thread_t>()
+                   .timeout(timeout)
+                   .timer_resolution(r::pt::time_duration{})
+                   .finish();
+    auto actor = sup->create_actor<bad_actor_t>().timeout(timeout).finish();
+
+    sup->start();
+    system_context->run();
+
+    REQUIRE(actor->ec == r::error_code_t::request_timeout);
+    REQUIRE(static_cast<r::actor_base_t *>(sup.get())->access<rt::to::state>() == r::state_t::SHUT_DOWN);
+}
+
+namespace payload {
+struct flood_t {};
+} // namespace payload
+
+struct flooder_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+    std::atomic<bool> *done = nullptr;
+    std::chrono::steady_clock::time_point limit;
+    bool exhausted = false;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&flooder_t::on_flood); });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        limit = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        send<payload::flood_t>(address);
+    }
+
+    /* the locality is always ready, until the request of the other one is timed out */
+    void on_flood(r::message_t<payload::flood_t> &) noexcept {
+        exhausted = std::chrono::steady_clock::now() > limit;
+        if (!done->load() && !exhausted) {
+            send<payload::flood_t>(address);
+        }
+    }
+};
+
+struct waiter_t : public bad_actor_t {
+    using bad_actor_t::bad_actor_t;
+    std::atomic<bool> *done = nullptr;
+    r::supervisor_t *root = nullptr;
+
+    void on_response(traits_t::response::message_t &msg) noexcept {
+        ec = msg.payload.ec;
+        done->store(true);
+        root->shutdown();
+    }
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&waiter_t::on_response); });
+    }
+};
+
+TEST_CASE("timers expire, while the worker is busy", "[supervisor][thread]") {
+    auto system_context = rth::system_context_ptr_t{new rth::system_context_thread_t(1)};
+    auto timeout = r::pt::milliseconds{100};
+    std::atomic<bool> done{false};
+    auto sup = system_context->create_supervisor<rth::supervisor_thread_t>().timeout(timeout).finish();
+    auto sup1 = sup->create_actor<rth::supervisor_thread_t>().timeout(timeout).process_budget(10).finish();
+    auto sup2 = sup->create_actor<rth::supervisor_thread_t>().timeout(timeout).finish();
+    auto flooder = sup1->create_actor<flooder_t>().timeout(timeout).finish();
+    auto waiter = sup2->create_actor<waiter_t>().timeout(timeout).finish();
+    flooder->done = waiter->done = &done;
+    waiter->root = sup.get();
+
+    sup->start();
+    system_context->run();
+
+    CHECK(!flooder->exhausted);
+    REQUIRE(waiter->ec == r::error_code_t::request_timeout);
+    REQUIRE(static_cast<r::actor_base_t *>(sup.get())->access<rt::to::state>() == r::state_t::SHUT_DOWN);
+}
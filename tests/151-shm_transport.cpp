@@ -0,0 +1,368 @@
+//
+// Copyright (c) 2019-2020 Ivan Baidakou (basiliscos) (the dot dmol at gmail dot com)
+//
+// Distributed under the MIT Software License
+//
+
+#include "catch.hpp"
+#include "rotor.hpp"
+#include "rotor/asio.hpp"
+#include "rotor/shm.hpp"
+#include "supervisor_asio_test.h"
+#include "supervisor_test.h"
+#include "system_context_test.h"
+#include "access.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+namespace r = rotor;
+namespace ra = rotor::asio;
+namespace rs = rotor::shm;
+namespace rt = r::test;
+namespace asio = boost::asio;
+
+struct ping_t {
+    std::uint32_t value;
+};
+
+/* not trivially copyable, i.e. it is serialized */
+struct greeting_t {
+    std::string text;
+};
+
+struct sum_response_t {
+    std::uint64_t sum;
+};
+
+struct sum_request_t {
+    using response_t = sum_response_t;
+    std::uint32_t a;
+    std::uint32_t b;
+};
+
+template <> struct rotor::serializer_t<ping_t> {
+    static constexpr std::uint32_t type_id = 1000;
+    static void encode(encoder_t &e, const ::ping_t &p) noexcept { e.put(p.value); }
+    static bool decode(decoder_t &d, ::ping_t &p) noexcept { return d.get(p.value); }
+};
+
+template <> struct rotor::serializer_t<greeting_t> {
+    static constexpr std::uint32_t type_id = 1001;
+    static void encode(encoder_t &e, const ::greeting_t &p) noexcept { e.put(p.text); }
+    static bool decode(decoder_t &d, ::greeting_t &p) noexcept { return d.get(p.text); }
+};
+
+template <> struct rotor::serializer_t<sum_request_t> {
+    static constexpr std::uint32_t type_id = 1002;
+    static void encode(encoder_t &e, const ::sum_request_t &p) noexcept {
+        e.put(p.a);
+        e.put(p.b);
+    }
+    static bool decode(decoder_t &d, ::sum_request_t &p) noexcept { return d.get(p.a) && d.get(p.b); }
+};
+
+template <> struct rotor::serializer_t<sum_response_t> {
+    static constexpr std::uint32_t type_id = 1003;
+    static void encode(encoder_t &e, const ::sum_response_t &p) noexcept { e.put(p.sum); }
+    static bool decode(decoder_t &d, ::sum_response_t &p) noexcept { return d.get(p.sum); }
+};
+
+using sum_request_message_t = r::request_traits_t<sum_request_t>::request::message_t;
+using sum_response_message_t = r::request_traits_t<sum_request_t>::response::message_t;
+
+static constexpr std::uint64_t ponger_id = 7;
+
+static std::string segment_name(const char *suffix) {
+    return std::string("/rotor-test-151-") + std::to_string(getpid()) + suffix;
+}
+
+static r::state_t state_of(r::actor_base_t *actor) { return actor->access<rt::to::state>(); }
+
+struct transport_test_t : public rs::transport_t {
+    using rs::transport_t::transport_t;
+
+    std::size_t get_pending() const noexcept { return pending.size(); }
+};
+
+struct pinger_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) { p.subscribe_actor(&pinger_t::on_sum); });
+    }
+
+    void on_start() noexcept override {
+        r::actor_base_t::on_start();
+        send<ping_t>(ponger_addr, 5u);
+        send<greeting_t>(ponger_addr, "hello");
+        request<sum_request_t>(ponger_addr, 2u, 3u).send(request_timeout);
+    }
+
+    void on_sum(sum_response_message_t &message) noexcept {
+        ec = message.payload.ec;
+        if (!ec) {
+            sum = message.payload.res.sum;
+            request_a = message.payload.req->payload.request_payload.a;
+        }
+        if (--requests) {
+            request<sum_request_t>(ponger_addr, 2u, 3u).send(request_timeout);
+            return;
+        }
+        pending = transport->get_pending();
+        supervisor->shutdown();
+    }
+
+    r::address_ptr_t ponger_addr;
+    transport_test_t *transport = nullptr;
+    r::pt::time_duration request_timeout = r::pt::seconds{1};
+    int requests = 1;
+    std::error_code ec;
+    std::uint64_t sum = 0;
+    std::uint32_t request_a = 0;
+    std::size_t pending = 0;
+};
+
+struct ponger_t : public r::actor_base_t {
+    using r::actor_base_t::actor_base_t;
+
+    void configure(r::plugin::plugin_base_t &plugin) noexcept override {
+        r::actor_base_t::configure(plugin);
+        plugin.with_casted<r::plugin::starter_plugin_t>([](auto &p) {
+            p.subscribe_actor(&ponger_t::on_ping);
+            p.subscribe_actor(&ponger_t::on_greeting);
+            p.subscribe_actor(&ponger_t::on_sum);
+        });
+    }
+
+    void on_ping(r::message_t<ping_t> &message) noexcept { ping_value = message.payload.value; }
+
+    void on_greeting(r::message_t<greeting_t> &message) noexcept { greeting = message.payload.text; }
+
+    void on_sum(sum_request_message_t &message) noexcept {
+        if (silent) {
+            return;
+        }
+        auto &payload = message.payload.request_payload;
+        reply_to(message, static_cast<std::uint64_t>(payload.a + payload.b));
+    }
+
+    bool silent = false;
+    std::uint32_t ping_value = 0;
+    std::string greeting;
+};
+
+struct fixture_t {
+    fixture_t(const char *suffix, const r::pt::time_duration &pending_timeout = r::pt::seconds{60}) {
+        auto name = segment_name(suffix);
+        sup1 = system_context->create_supervisor<rt::supervisor_asio_test_t>()
+                   .strand(strand1)
+                   .timeout(timeout)
+                   .finish();
+        // the segment creator goes first
+        transport1 = sup1->create_actor<transport_test_t>()
+                         .name(name)
+                         .create()
+                         .capacity(4096)
+                         .pending_timeout(pending_timeout)
+                         .timeout(timeout)
+                         .finish();
+        sup2 = sup1->create_actor<rt::supervisor_asio_test_t>().strand(strand2).timeout(timeout).finish();
+        transport2 = sup2->create_actor<transport_test_t>().name(name).timeout(timeout).finish();
+
+        pinger = sup1->create_actor<pinger_t>().timeout(timeout).finish();
+        ponger = sup2->create_actor<ponger_t>().timeout(timeout).finish();
+        pinger->transport = transport1.get();
+
+        for (auto &t : {transport1, transport2}) {
+            t->register_message<ping_t>();
+            t->register_message<greeting_t>();
+            t->register_request<sum_request_t>();
+        }
+        transport2->export_address(ponger_id, ponger->get_address());
+    }
+
+    void run(std::uint64_t id = ponger_id) {
+        pinger->ponger_addr = transport1->import_address(id);
+        sup1->start();
+        io_context.run();
+    }
+
+    void check_shutdown() {
+        CHECK(state_of(transport1.get()) == r::state_t::SHUT_DOWN);
+        CHECK(state_of(transport2.get()) == r::state_t::SHUT_DOWN);
+        REQUIRE(state_of(sup1.get()) == r::state_t::SHUT_DOWN);
+        REQUIRE(sup1->get_leader_queue().size() == 0);
+        CHECK(rt::empty(sup1->get_subscription()));
+        REQUIRE(state_of(sup2.get()) == r::state_t::SHUT_DOWN);
+        CHECK(rt::empty(sup2->get_subscription()));
+    }
+
+    asio::io_context io_context{1};
+    ra::system_context_asio_t::ptr_t system_context{new ra::system_context_asio_t(io_context)};
+    ra::supervisor_config_asio_t::strand_ptr_t strand1 = std::make_shared<asio::io_context::strand>(io_context);
+    ra::supervisor_config_asio_t::strand_ptr_t strand2 = std::make_shared<asio::io_context::strand>(io_context);
+    r::pt::time_duration timeout = r::pt::milliseconds{500};
+    r::intrusive_ptr_t<rt::supervisor_asio_test_t> sup1;
+    r::intrusive_ptr_t<rt::supervisor_asio_test_t> sup2;
+    r::intrusive_ptr_t<transport_test_t> transport1;
+    r::intrusive_ptr_t<transport_test_t> transport2;
+    r::intrusive_ptr_t<pinger_t> pinger;
+    r::intrusive_ptr_t<ponger_t> ponger;
+};
+
+TEST_CASE("ring", "[shm]") {
+    rs::ring_header_t header{};
+    std::vector<std::uint8_t> data(256);
+    rs::ring_t ring(&header, data.data(), data.size());
+
+    rs::frame_t frame{};
+    frame.kind = static_cast<std::uint16_t>(rs::frame_kind_t::message);
+    std::uint64_t sent = 0;
+    std::uint64_t received = 0;
+    // frames of 40 + 24 bytes do not fit evenly, i.e. padding frames are written
+    for (int round = 0; round < 20; ++round) {
+        while (ring.push(frame, 24, [&](void *target) { std::memcpy(target, &sent, sizeof(sent)); })) {
+            ++sent;
+        }
+        CHECK(!ring.empty());
+        auto count = ring.consume(
+            [&](const rs::frame_t &frame, const void *payload) {
+                CHECK(frame.length == 24);
+                std::uint64_t value;
+                std::memcpy(&value, payload, sizeof(value));
+                CHECK(value == received);
+                ++received;
+            },
+            2);
+        CHECK(count == 2);
+    }
+    ring.consume([&](const rs::frame_t &, const void *) { ++received; }, 100);
+    CHECK(ring.empty());
+    CHECK(received == sent);
+    CHECK(sent > 20 * 2);
+    CHECK(!ring.push(frame, 1024, [](void *) {}));
+}
+
+TEST_CASE("malformed ring frames", "[shm]") {
+    rs::ring_header_t header{};
+    std::vector<std::uint8_t> data(256);
+    rs::ring_t ring(&header, data.data(), data.size());
+
+    rs::frame_t frame{};
+    frame.kind = static_cast<std::uint16_t>(rs::frame_kind_t::message);
+    REQUIRE(ring.push(frame, 8, [](void *) {}));
+    REQUIRE(ring.push(frame, 8, [](void *) {}));
+    auto first = reinterpret_cast<rs::frame_t *>(data.data());
+
+    SECTION("zero-sized padding frame") {
+        first->kind = static_cast<std::uint16_t>(rs::frame_kind_t::padding);
+        first->size = 0;
+    }
+    SECTION("zero-sized message frame") { first->size = 0; }
+    SECTION("not aligned frame") { first->size += 1; }
+    SECTION("frame beyond the tail") { first->size = 128; }
+    SECTION("frame shorter than the payload") { first->length = 64; }
+
+    std::size_t received = 0;
+    CHECK(ring.consume([&](const rs::frame_t &, const void *) { ++received; }, 10) == 0);
+    CHECK(ring.corrupted());
+    CHECK(ring.consume([&](const rs::frame_t &, const void *) { ++received; }, 10) == 0);
+    CHECK(received == 0);
+}
+
+TEST_CASE("message and request via shared memory", "[shm][asio]") {
+    fixture_t f("-asio");
+    f.run();
+
+    CHECK(!f.pinger->ec);
+    CHECK(f.pinger->sum == 5);
+    CHECK(f.pinger->request_a == 2);
+    CHECK(f.pinger->pending == 0);
+    CHECK(f.ponger->ping_value == 5);
+    CHECK(f.ponger->greeting == "hello");
+    CHECK(f.transport1->get_dropped() == 0);
+    CHECK(f.transport2->get_dropped() == 0);
+    f.check_shutdown();
+}
+
+TEST_CASE("request to not exported address", "[shm][asio]") {
+    fixture_t f("-unknown");
+    f.run(ponger_id + 1);
+
+    // the request is replied by the other side transport, i.e. not timed out
+    CHECK(f.pinger->ec == r::error_code_t::transport_unknown_address);
+    CHECK(f.pinger->pending == 0);
+    CHECK(f.ponger->ping_value == 0);
+    CHECK(f.transport2->get_dropped() == 3);
+    f.check_shutdown();
+}
+
+TEST_CASE("unanswered requests are forgotten", "[shm][asio]") {
+    fixture_t f("-pending", r::pt::milliseconds{1});
+    f.ponger->silent = true;
+    f.pinger->request_timeout = r::pt::milliseconds{10};
+    f.pinger->requests = 3;
+    f.run();
+
+    CHECK(f.pinger->ec == r::error_code_t::request_timeout);
+    // the last request is forgotten by the timer, without waiting for the next one
+    CHECK(f.pinger->pending == 0);
+    CHECK(f.transport1->get_dropped() == 0);
+    f.check_shutdown();
+}
+
+TEST_CASE("missing segment", "[shm]") {
+    r::system_context_ptr_t system_context{new rt::system_context_test_t()};
+    auto sup = system_context->create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto name = segment_name("-missing");
+    auto transport = sup->create_actor<rs::transport_t>().name(name).timeout(rt::default_timeout).finish();
+    sup->do_process();
+    CHECK(state_of(transport.get()) == r::state_t::SHUT_DOWN);
+
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(state_of(sup.get()) == r::state_t::SHUT_DOWN);
+}
+
+TEST_CASE("segment with invalid capacity", "[shm]") {
+    auto name = segment_name("-capacity");
+    // the segment size is consistent with the capacity, written by the (misbehaving) other side
+    for (std::uint64_t capacity : {3000u, 2048u}) {
+        std::error_code ec;
+        auto segment = rs::segment_t::create(name, 4096, ec);
+        REQUIRE(segment);
+
+        auto fd = shm_open(name.c_str(), O_RDWR, 0600);
+        REQUIRE(fd >= 0);
+        auto header_size = static_cast<std::size_t>(lseek(fd, 0, SEEK_END)) - 2 * 4096;
+        auto memory = mmap(nullptr, header_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        REQUIRE(memory != MAP_FAILED);
+        // magic, version, reserved, capacity
+        std::memcpy(static_cast<char *>(memory) + 16, &capacity, sizeof(capacity));
+        munmap(memory, header_size);
+        REQUIRE(ftruncate(fd, static_cast<off_t>(header_size + 2 * capacity)) == 0);
+        close(fd);
+
+        auto opened = rs::segment_t::open(name, ec);
+        CHECK(!opened);
+        CHECK(ec == r::error_code_t::transport_mismatch);
+    }
+}
+
+TEST_CASE("transport config validation", "[shm]") {
+    r::system_context_ptr_t system_context{new rt::system_context_test_t()};
+    auto sup = system_context->create_supervisor<rt::supervisor_test_t>().timeout(rt::default_timeout).finish();
+    auto name = segment_name("-invalid");
+    auto transport =
+        sup->create_actor<rs::transport_t>().name(name).capacity(5000).timeout(rt::default_timeout).finish();
+    CHECK(!transport);
+
+    sup->do_process();
+    sup->do_shutdown();
+    sup->do_process();
+    CHECK(state_of(sup.get()) == r::state_t::SHUT_DOWN);
+}
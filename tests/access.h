@@ -25,8 +25,8 @@ struct registry {};
 struct queue {};
 struct own_subscriptions {};
 struct request_map {};
+struct address_mapping {};
 struct resources {};
-struct last_req_id {};
 struct promises_map {};
 struct discovery_map {};
 struct forget_link {};
@@ -61,7 +61,7 @@ template <> inline auto &rotor::supervisor_t::access<test::to::parent_supervisor
 template <> inline auto &rotor::supervisor_t::access<test::to::registry>() noexcept { return registry_address; }
 template <> inline auto &rotor::supervisor_t::access<test::to::queue>() noexcept { return queue; }
 template <> inline auto &rotor::supervisor_t::access<test::to::request_map>() noexcept { return request_map; }
-template <> inline auto &rotor::supervisor_t::access<test::to::last_req_id>() noexcept { return last_req_id; }
+template <> inline auto &rotor::supervisor_t::access<test::to::address_mapping>() noexcept { return address_mapping; }
 template <> inline auto &rotor::registry_t::access<test::to::promises_map>() noexcept { return promises_map; }
 
 } // namespace rotor